@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,7 +27,6 @@
  */
 
 #include "apps/oskar_option_parser.h"
-#include "convert/oskar_convert_healpix_ring_to_theta_phi.h"
 #include "log/oskar_log.h"
 #include "math/oskar_angular_distance.h"
 #include "math/oskar_bearing_angle.h"
@@ -39,7 +38,6 @@
 #include "utility/oskar_version_string.h"
 
 #include <algorithm>
-#include <cfloat>
 #include <cstdio>
 #include <string>
 #include <vector>
@@ -55,12 +53,6 @@ using std::string;
 using std::unique;
 using std::vector;
 
-template<typename T>
-bool contains(const std::vector<T>& v, const T& val)
-{
-    return std::find(v.begin(), v.end(), val) != v.end();
-}
-
 template<typename T>
 struct sort_indices
 {
@@ -69,12 +61,12 @@ struct sort_indices
     bool operator() (int a, int b) const {return p[a] < p[b];}
 };
 
-static void check_overlap(int start_component,
+static void check_overlap(int start_component, int cluster,
         const double* ra, const double* dec, const double* major,
         const double* minor, const double* pa_rad, const double sigma,
         const double max_separation_rad, vector<int>& cluster_components,
-        vector<int>& components_removed, const vector<double>& bin_ra,
-        const vector<double>& bin_dec, const vector<vector<int> >& bin_indices)
+        vector<int>& components_removed, vector<int>& component_cluster,
+        const oskar_SkyIndex* index, int* status)
 {
     // Get data for the reference component.
     double ra0  = ra[start_component];
@@ -83,55 +75,46 @@ static void check_overlap(int start_component,
     double minor0 = sigma * FWHM_TO_SIGMA * minor[start_component];
     double pa0 = pa_rad[start_component];
 
-    // Find distances to the nearest bin centres.
-    const int num_bins = (const int)bin_ra.size();
-    vector<double> bin_dist(num_bins);
-    vector<int> bin_index(num_bins);
-    for (int i = 0; i < num_bins; ++i)
-    {
-        bin_index[i] = i;
-        bin_dist[i] = oskar_angular_distance(ra0, bin_ra[i], dec0, bin_dec[i]);
-    }
-    sort(bin_index.begin(), bin_index.end(),
-            sort_indices<double>(&bin_dist[0]));
+    // Find all components within the maximum separation.
+    oskar_Mem* nearby = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    int num_components_to_check = oskar_sky_index_query_radius(index,
+            ra0, dec0, max_separation_rad, nearby, 0, status);
+    const int* nearby_ = oskar_mem_int_const(nearby, status);
 
-    // Loop over all unchecked sources in nearby bins (4 bins is worst case).
-    for (int b = 0; b < 4; ++b)
+    // Loop over all nearby components.
+    for (int i = 0; i < num_components_to_check && !*status; ++i)
     {
-        int bin = bin_index[b];
-        int num_components_to_check = (int)bin_indices[bin].size();
-        for (int i = 0; i < num_components_to_check; ++i)
-        {
-            // Get the component index.
-            int c = bin_indices[bin][i];
+        // Get the component index.
+        int c = nearby_[i];
 
-            // Calculate component separation and Gaussian ellipse radii.
-            double d = oskar_angular_distance(ra0, ra[c], dec0, dec[c]);
-            if (d > max_separation_rad) continue;
+        // Calculate component separation and Gaussian ellipse radii.
+        double d = oskar_angular_distance(ra0, ra[c], dec0, dec[c]);
+        if (d > max_separation_rad) continue;
 
-            // Don't check for overlap if the component to check against
-            // is already marked for removal.
-            if (contains(cluster_components, c)) continue;
+        // Don't check for overlap if the component to check against
+        // is already marked for removal.
+        if (component_cluster[c] == cluster) continue;
 
-            double a0 = oskar_bearing_angle(ra0, ra[c], dec0, dec[c]);
-            double r0 = oskar_ellipse_radius(major0, minor0, pa0, a0);
-            double a1 = oskar_bearing_angle(ra[c], ra0, dec[c], dec0);
-            double r1 = oskar_ellipse_radius(sigma * FWHM_TO_SIGMA * major[c],
-                    sigma * FWHM_TO_SIGMA * minor[c], pa_rad[c], a1);
+        double a0 = oskar_bearing_angle(ra0, ra[c], dec0, dec[c]);
+        double r0 = oskar_ellipse_radius(major0, minor0, pa0, a0);
+        double a1 = oskar_bearing_angle(ra[c], ra0, dec[c], dec0);
+        double r1 = oskar_ellipse_radius(sigma * FWHM_TO_SIGMA * major[c],
+                sigma * FWHM_TO_SIGMA * minor[c], pa_rad[c], a1);
 
-            // Mark for removal if components are overlapping.
-            if (r0 + r1 > d || c == start_component)
-            {
-                components_removed.push_back(c);
-                cluster_components.push_back(c);
-
-                // Recursively check for overlap from component being removed.
-                check_overlap(c, ra, dec, major, minor, pa_rad, sigma,
-                        max_separation_rad, cluster_components,
-                        components_removed, bin_ra, bin_dec, bin_indices);
-            }
+        // Mark for removal if components are overlapping.
+        if (r0 + r1 > d || c == start_component)
+        {
+            components_removed.push_back(c);
+            cluster_components.push_back(c);
+            component_cluster[c] = cluster;
+
+            // Recursively check for overlap from component being removed.
+            check_overlap(c, cluster, ra, dec, major, minor, pa_rad, sigma,
+                    max_separation_rad, cluster_components,
+                    components_removed, component_cluster, index, status);
         }
     }
+    oskar_mem_free(nearby, status);
 }
 
 
@@ -261,42 +244,16 @@ int main(int argc, char** argv)
             num_input, 0, &max_size_rad, 0, 0, &status);
     max_size_rad *= 1.1 * sigma;
 
-    // Create spatial bins.
-    int nside = 5;
-    int num_bins = 12 * nside * nside;
-    vector<double> bin_ra(num_bins), bin_dec(num_bins), bin_dist(num_bins);
-    vector< vector<int> > bin_indices(num_bins);
-    for (int i = 0; i < num_bins; ++i)
-    {
-        oskar_convert_healpix_ring_to_theta_phi_d(nside, i,
-                &bin_dec[i], &bin_ra[i]);
-        bin_dec[i] = 0.5 * M_PI - bin_dec[i];
-    }
-
-    // Spatially bin the input data.
-    for (int i = 0, bin = 0; i < num_input; ++i)
-    {
-        double min_d = DBL_MAX;
-        for (int j = 0; j < num_bins; ++j)
-        {
-            double d = oskar_angular_distance(sky_ra[i], bin_ra[j],
-                    sky_dec[i], bin_dec[j]);
-            if (d < min_d)
-            {
-                bin = j;
-                min_d = d;
-            }
-        }
-        bin_indices[bin].push_back(i);
-    }
+    // Create a spatial index of the component positions.
+    oskar_SkyIndex* index = oskar_sky_index_create(sky_to_filter, &status);
 
     // Loop over input sources.
     vector< vector<int> > output_source_components;
-    vector<int> components_removed;
-    oskar_log_message(log, 'M', 0, "Grouping using %d bins...", num_bins);
+    vector<int> components_removed, component_cluster(num_input, -1);
+    oskar_log_message(log, 'M', 0, "Grouping using spatial index...");
     oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
     oskar_timer_start(timer);
-    for (int i = 0, progress = -num_input; i < num_input; ++i)
+    for (int i = 0, progress = -num_input; i < num_input && !status; ++i)
     {
         // Update progress display.
         if ((num_input > 500) && (i > progress + num_input / 20))
@@ -309,18 +266,28 @@ int main(int argc, char** argv)
 
         // Don't check for overlap if the component is already marked
         // for removal.
-        if (contains(components_removed, i)) continue;
+        if (component_cluster[i] >= 0) continue;
 
         vector<int> components;
-        check_overlap(i, sky_ra, sky_dec, filter_maj, filter_min, filter_pa,
-                sigma, max_size_rad,  components, components_removed,
-                bin_ra, bin_dec, bin_indices);
+        check_overlap(i, (int)output_source_components.size(),
+                sky_ra, sky_dec, filter_maj, filter_min, filter_pa,
+                sigma, max_size_rad, components, components_removed,
+                component_cluster, index, &status);
         output_source_components.push_back(components);
     }
+    oskar_sky_index_free(index);
     int num_output = (int)output_source_components.size();
     oskar_log_message(log, 'M', 1, "100%% done after %6.1f sec.",
             oskar_timer_elapsed(timer));
     oskar_timer_free(timer);
+    if (status)
+    {
+        oskar_log_error(log, "Error grouping components: %s",
+                oskar_get_error_string(status));
+        oskar_sky_free(sky_to_filter, &status);
+        oskar_sky_free(sky_as_filter, &status);
+        return EXIT_FAILURE;
+    }
 
     // Check that all components have been grouped.
     {
@@ -434,7 +401,8 @@ int main(int argc, char** argv)
     // Loop over input component positions.
     for (int i = 0, j = 0, k = 0; i < num_input; ++i)
     {
-        if (i != components_to_remove[k])
+        if (k >= (int)components_to_remove.size() ||
+                i != components_to_remove[k])
         {
             oskar_sky_set_source(sky_out, j++, sky_ra[i], sky_dec[i],
                     sky_I[i], sky_Q[i], sky_U[i], sky_V[i], sky_ref_freq[i],
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2014, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,72 +27,57 @@
  */
 
 #include "apps/oskar_option_parser.h"
-#include "oskar_rebin_sky_cuda.h"
 #include "log/oskar_log.h"
 #include "sky/oskar_sky.h"
-#include "utility/oskar_device_utils.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_version_string.h"
 
 #include <cstdio>
 #include <cstdlib>
 
 int main(int argc, char** argv)
 {
-    oskar_Sky *input, *output, *input_gpu, *output_gpu;
+    oskar_Sky *input, *output;
     int error = 0;
 
-    oskar::OptionParser opt("oskar_rebin_sky");
+    oskar::OptionParser opt("oskar_rebin_sky", oskar_version_string());
     opt.add_required("input sky file");
     opt.add_required("output sky file");
+    opt.add_flag("-d", "Use double precision", false, "--double");
     if (!opt.check_options(argc, argv))
         return OSKAR_ERR_INVALID_ARGUMENT;
+    int type = opt.is_set("-d") ? OSKAR_DOUBLE : OSKAR_SINGLE;
+    const char* input_file = opt.get_arg(0);
+    const char* output_file = opt.get_arg(1);
 
     // Load input and output sky models.
-    printf("Loading input '%s'\n", argv[1]);
-    input = oskar_sky_load(argv[1], OSKAR_SINGLE, &error);
+    printf("Loading input '%s'\n", input_file);
+    input = oskar_sky_load(input_file, type, &error);
     if (error)
     {
         fprintf(stderr, "Error loading input sky file.\n");
         return OSKAR_ERR_FILE_IO;
     }
-    printf("Loading output '%s'\n", argv[2]);
-    output = oskar_sky_load(argv[2], OSKAR_SINGLE, &error);
+    printf("Loading output '%s'\n", output_file);
+    output = oskar_sky_load(output_file, type, &error);
     if (error)
     {
+        oskar_sky_free(input, &error);
         fprintf(stderr, "Error loading output sky file.\n");
         return OSKAR_ERR_FILE_IO;
     }
 
-    // Copy sky models to GPU.
-    input_gpu = oskar_sky_create_copy(input, OSKAR_GPU, &error);
-    output_gpu = oskar_sky_create_copy(output, OSKAR_GPU, &error);
-
-    // Free CPU sky models.
-    oskar_sky_free(input, &error);
-    oskar_sky_free(output, &error);
-
     // Rebin flux in input sky to output source positions.
-    oskar_mem_clear_contents(oskar_sky_I(output_gpu), &error);
-    oskar_rebin_sky_cuda_f(
-            oskar_sky_num_sources(input_gpu),
-            oskar_sky_num_sources(output_gpu),
-            oskar_mem_float_const(oskar_sky_ra_rad_const(input_gpu), &error),
-            oskar_mem_float_const(oskar_sky_dec_rad_const(input_gpu), &error),
-            oskar_mem_float_const(oskar_sky_I_const(input_gpu), &error),
-            oskar_mem_float_const(oskar_sky_ra_rad_const(output_gpu), &error),
-            oskar_mem_float_const(oskar_sky_dec_rad_const(output_gpu), &error),
-            oskar_mem_float(oskar_sky_I(output_gpu), &error));
-    oskar_device_check_error(&error);
+    oskar_sky_rebin(output, input, &error);
     if (error)
-        fprintf(stderr, "CUDA error (%s).\n", oskar_get_error_string(error));
+        fprintf(stderr, "Error rebinning sky model (%s).\n",
+                oskar_get_error_string(error));
 
     // Write new sky model out.
-    output = oskar_sky_create_copy(output_gpu, OSKAR_CPU, &error);
-    oskar_sky_save(argv[2], output, &error);
+    oskar_sky_save(output_file, output, &error);
 
     // Free sky models.
-    oskar_sky_free(input_gpu, &error);
-    oskar_sky_free(output_gpu, &error);
+    oskar_sky_free(input, &error);
     oskar_sky_free(output, &error);
 
     return error;
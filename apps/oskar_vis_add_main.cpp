@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,9 +27,15 @@
  */
 
 #include "apps/oskar_option_parser.h"
-#include "vis/oskar_vis.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_mem.h"
+#include "ms/oskar_measurement_set.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
 #include "utility/oskar_version_string.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
 
 #include <string>
 #include <cmath>
@@ -41,10 +47,43 @@
 using namespace std;
 using namespace oskar;
 
+// Number of elements added by each iteration of the addition loop.
+#define ADD_GRAIN 65536
+
+// Arguments for the task that reads a block from one input file.
+// If the file uses a different number of times per block to the output,
+// its blocks are read into in_blk, and the times needed for the output
+// block are copied from there into blk.
+struct ReadArgs
+{
+    oskar_Binary* h;
+    oskar_VisHeader* hdr;
+    oskar_VisBlock* blk;
+    oskar_VisBlock* in_blk;
+    int block_index, start_time, num_times, cached_block, status;
+};
+
+// Arguments for the loop that adds one array to another.
+struct AddArgs
+{
+    oskar_Mem* out;
+    const oskar_Mem* in;
+    size_t num_elements;
+    int status;
+};
+
 // -----------------------------------------------------------------------------
 static void set_options(OptionParser& opt);
 static bool check_options(OptionParser& opt, int argc, char** argv);
-static bool isCompatible(const oskar_Vis* vis1, const oskar_Vis* vis2);
+static bool isCompatible(const oskar_VisHeader* hdr1,
+        const oskar_VisHeader* hdr2);
+static bool is_ms_path(const string& path);
+static void read_block(void* arg);
+static void copy_times(oskar_VisBlock* dst, const oskar_VisBlock* src,
+        int dst_time, int src_time, int num_times, int* status);
+static void add_range(void* arg, int start, int end);
+static void add_arrays(oskar_ThreadPool* pool, oskar_Mem* out,
+        const oskar_Mem* in, size_t num_elements, int* status);
 static void print_error(int status, const char* message);
 // -----------------------------------------------------------------------------
 
@@ -61,6 +100,7 @@ int main(int argc, char** argv)
     vector<string> in_files = opt.get_input_files(2);
     bool verbose = opt.is_set("-q") ? false : true;
     int num_in_files = (int)in_files.size();
+    bool write_ms = is_ms_path(out_path);
 
     // Print if verbose.
     if (verbose)
@@ -73,61 +113,269 @@ int main(int argc, char** argv)
         }
     }
 
-    // Add the data. ==========================================================
+    // Open all the input files and read their headers. ======================
     int status = 0;
-
-    // Load the first visibility structure.
-    oskar_Binary* h;
-    h = oskar_binary_create(in_files[0].c_str(), 'r', &status);
-    oskar_Vis* out = oskar_vis_read(h, &status);
-    oskar_binary_free(h);
-    if (status)
+    vector<ReadArgs> args(num_in_files);
+    for (int i = 0; i < num_in_files; ++i)
     {
-        string msg = "Failed to read visibility data file " + in_files[0];
-        print_error(status, msg.c_str());
+        args[i].h = 0;
+        args[i].hdr = 0;
+        args[i].blk = 0;
+        args[i].in_blk = 0;
+        args[i].cached_block = -1;
+        args[i].status = 0;
     }
-    oskar_mem_clear_contents(oskar_vis_settings_path(out), &status);
-    // TODO write some sort of tag into here to indicate this is an
-    // accumulated visibility data set...
-
-    // Loop over other visibility files and combine.
-    for (int i = 1; i < num_in_files; ++i)
+    for (int i = 0; i < num_in_files; ++i)
     {
-        if (status) break;
-
-        h = oskar_binary_create(in_files[i].c_str(), 'r', &status);
-        oskar_Vis* in = oskar_vis_read(h, &status);
-        oskar_binary_free(h);
+        args[i].h = oskar_binary_create(in_files[i].c_str(), 'r', &status);
+        args[i].hdr = oskar_vis_header_read(args[i].h, &status);
         if (status)
         {
             string msg = "Failed to read visibility data file " + in_files[i];
             print_error(status, msg.c_str());
             break;
         }
-        if (!isCompatible(out, in))
+        if (i > 0 && !isCompatible(args[0].hdr, args[i].hdr))
         {
             cerr << "ERROR: Input visibility data must match!" << endl;
             status = OSKAR_ERR_TYPE_MISMATCH;
+            break;
+        }
+        args[i].blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+                args[0].hdr, &status);
+        if (oskar_vis_header_max_times_per_block(args[i].hdr) !=
+                oskar_vis_header_max_times_per_block(args[0].hdr))
+            args[i].in_blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+                    args[i].hdr, &status);
+    }
+
+    // Create the output file using the header of the first input. ===========
+    oskar_VisHeader* hdr = 0;
+    oskar_Binary* out_h = 0;
+#ifndef OSKAR_NO_MS
+    oskar_MeasurementSet* out_ms = 0;
+#endif
+    if (!status)
+    {
+        hdr = args[0].hdr;
+        // TODO write some sort of tag into here to indicate this is an
+        // accumulated visibility data set...
+        oskar_mem_clear_contents(oskar_vis_header_settings(hdr), &status);
+        if (verbose)
+            cout << "Writing " << (write_ms ? "Measurement Set" :
+                    "OSKAR visibility file") << ": " << out_path << endl;
+        if (write_ms)
+        {
+#ifndef OSKAR_NO_MS
+            out_ms = oskar_vis_header_write_ms(hdr, out_path.c_str(), 1, 0,
+                    &status);
+#else
+            cerr << "ERROR: OSKAR was compiled without Measurement Set "
+                    "support." << endl;
+            status = OSKAR_ERR_FILE_IO;
+#endif
+        }
+        else
+        {
+            out_h = oskar_vis_header_write(hdr, out_path.c_str(), &status);
+        }
+    }
+
+    // Add the data, one block at a time. =====================================
+    // The blocks of all input files are read concurrently, added to the
+    // block from the first file, and written out before the next is read.
+    int num_threads = oskar_get_num_procs();
+    if (num_threads < num_in_files) num_threads = num_in_files;
+    oskar_ThreadPool* pool = oskar_thread_pool_create(num_threads);
+    oskar_TaskGroup* group = oskar_task_group_create(pool);
+    int num_blocks = 0;
+    if (!status)
+    {
+        const int max_times_per_block =
+                oskar_vis_header_max_times_per_block(hdr);
+        num_blocks = (oskar_vis_header_num_times_total(hdr) +
+                max_times_per_block - 1) / max_times_per_block;
+    }
+    for (int b = 0; b < num_blocks && !status; ++b)
+    {
+        const int max_times_per_block =
+                oskar_vis_header_max_times_per_block(hdr);
+        const int num_times_total = oskar_vis_header_num_times_total(hdr);
+        const int start_time = b * max_times_per_block;
+        const int num_times = (start_time + max_times_per_block <
+                num_times_total ? max_times_per_block :
+                num_times_total - start_time);
+        for (int i = 0; i < num_in_files; ++i)
+        {
+            args[i].block_index = b;
+            args[i].start_time = start_time;
+            args[i].num_times = num_times;
+            oskar_thread_pool_submit(pool, group, read_block, &args[i], -1);
+        }
+        oskar_task_group_wait(group);
+        for (int i = 0; i < num_in_files; ++i)
+        {
+            if (!args[i].status) continue;
+            status = args[i].status;
+            string msg = "Failed to read visibility data file " + in_files[i];
+            print_error(status, msg.c_str());
+            break;
+        }
+        if (status) break;
+
+        // Add the cross- and auto-correlations to the first block.
+        oskar_VisBlock* out = args[0].blk;
+        size_t num_cross = (size_t) oskar_vis_block_num_times(out) *
+                oskar_vis_block_num_channels(out) *
+                oskar_vis_block_num_baselines(out);
+        size_t num_auto = (size_t) oskar_vis_block_num_times(out) *
+                oskar_vis_block_num_channels(out) *
+                oskar_vis_block_num_stations(out);
+        for (int i = 1; i < num_in_files; ++i)
+        {
+            if (oskar_vis_block_has_cross_correlations(out))
+                add_arrays(pool, oskar_vis_block_cross_correlations(out),
+                        oskar_vis_block_cross_correlations_const(args[i].blk),
+                        num_cross, &status);
+            if (oskar_vis_block_has_auto_correlations(out))
+                add_arrays(pool, oskar_vis_block_auto_correlations(out),
+                        oskar_vis_block_auto_correlations_const(args[i].blk),
+                        num_auto, &status);
         }
-        oskar_mem_add(oskar_vis_amplitude(out), oskar_vis_amplitude_const(out),
-                oskar_vis_amplitude_const(in),
-                oskar_mem_length(oskar_vis_amplitude(out)), &status);
         if (status)
             print_error(status, "Visibility amplitude addition failed.");
-        oskar_vis_free(in, &status);
+
+        // Write the block.
+        if (out_h)
+            oskar_vis_block_write_chunks(out, hdr, out_h, b, &status);
+#ifndef OSKAR_NO_MS
+        if (out_ms)
+            oskar_vis_block_write_ms(out, hdr, out_ms, &status);
+#endif
+        if (status)
+            print_error(status, "Failed writing output visibility data.");
     }
 
-    // Write output data ======================================================
-    if (verbose)
-        cout << "Writing OSKAR visibility file: " << out_path << endl;
-    oskar_vis_write(out, 0, out_path.c_str(), &status);
-    oskar_vis_free(out, &status);
-    if (status)
-        print_error(status, "Failed writing output visibility structure to file.");
+    // Clean up. ==============================================================
+    oskar_task_group_free(group);
+    oskar_thread_pool_free(pool);
+    oskar_binary_free(out_h);
+#ifndef OSKAR_NO_MS
+    if (out_ms)
+        oskar_ms_close(out_ms);
+#endif
+    for (int i = 0; i < num_in_files; ++i)
+    {
+        oskar_vis_block_free(args[i].blk, &status);
+        oskar_vis_block_free(args[i].in_blk, &status);
+        oskar_vis_header_free(args[i].hdr, &status);
+        oskar_binary_free(args[i].h);
+    }
 
     return status;
 }
 
+static void read_block(void* arg)
+{
+    ReadArgs* a = (ReadArgs*) arg;
+    if (!a->in_blk)
+    {
+        oskar_vis_block_read(a->blk, a->hdr, a->h, a->block_index,
+                &a->status);
+        return;
+    }
+
+    // Copy the times for the output block from the input blocks that
+    // contain them. The last input block read is kept for the next call.
+    const int in_max_times = oskar_vis_header_max_times_per_block(a->hdr);
+    const int end_time = a->start_time + a->num_times;
+    for (int t = a->start_time; t < end_time && !a->status;)
+    {
+        const int in_block = t / in_max_times;
+        const int in_start = in_block * in_max_times;
+        const int in_end = in_start + in_max_times < end_time ?
+                in_start + in_max_times : end_time;
+        if (in_block != a->cached_block)
+        {
+            oskar_vis_block_read(a->in_blk, a->hdr, a->h, in_block,
+                    &a->status);
+            a->cached_block = a->status ? -1 : in_block;
+        }
+        copy_times(a->blk, a->in_blk, t - a->start_time, t - in_start,
+                in_end - t, &a->status);
+        t = in_end;
+    }
+}
+
+static void copy_times(oskar_VisBlock* dst, const oskar_VisBlock* src,
+        int dst_time, int src_time, int num_times, int* status)
+{
+    if (*status) return;
+    const size_t num_channels = oskar_vis_block_num_channels(dst);
+    if (num_channels != (size_t) oskar_vis_block_num_channels(src))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_vis_block_has_cross_correlations(dst))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_baselines(dst);
+        oskar_mem_copy_contents(oskar_vis_block_cross_correlations(dst),
+                oskar_vis_block_cross_correlations_const(src),
+                dst_time * n, src_time * n, num_times * n, status);
+    }
+    if (oskar_vis_block_has_auto_correlations(dst))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_stations(dst);
+        oskar_mem_copy_contents(oskar_vis_block_auto_correlations(dst),
+                oskar_vis_block_auto_correlations_const(src),
+                dst_time * n, src_time * n, num_times * n, status);
+    }
+}
+
+static void add_range(void* arg, int start, int end)
+{
+    int status = 0;
+    AddArgs* a = (AddArgs*) arg;
+    const size_t offset = (size_t) start * ADD_GRAIN;
+    size_t num_elements = (size_t) (end - start) * ADD_GRAIN;
+    if (offset + num_elements > a->num_elements)
+        num_elements = a->num_elements - offset;
+    oskar_Mem* out = oskar_mem_create_alias(a->out, offset, num_elements,
+            &status);
+    oskar_Mem* in = oskar_mem_create_alias(a->in, offset, num_elements,
+            &status);
+    oskar_mem_add(out, out, in, num_elements, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(in, &status);
+    if (status) a->status = status;
+}
+
+static void add_arrays(oskar_ThreadPool* pool, oskar_Mem* out,
+        const oskar_Mem* in, size_t num_elements, int* status)
+{
+    if (*status || num_elements == 0) return;
+    if (oskar_mem_type(out) != oskar_mem_type(in))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mem_length(out) < num_elements ||
+            oskar_mem_length(in) < num_elements)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    AddArgs a;
+    a.out = out;
+    a.in = in;
+    a.num_elements = num_elements;
+    a.status = 0;
+    const int num_ranges = (int) ((num_elements + ADD_GRAIN - 1) / ADD_GRAIN);
+    oskar_thread_pool_parallel_for(pool, 0, num_ranges, 0, add_range, &a);
+    *status = a.status;
+}
+
 static void print_error(int status, const char* message)
 {
     cerr << "ERROR[" << status << "] " << message << endl;
@@ -135,40 +383,58 @@ static void print_error(int status, const char* message)
 }
 
 
-static bool isCompatible(const oskar_Vis* v1, const oskar_Vis* v2)
+static bool is_ms_path(const string& path)
 {
-    if (oskar_vis_num_channels(v1) != oskar_vis_num_channels(v2))
+    size_t len = path.length();
+    if (len > 0 && path[len - 1] == '/')
+        len--;
+    if (len < 3)
+        return false;
+    string ext = path.substr(len - 3, 3);
+    return (ext == ".ms" || ext == ".MS");
+}
+
+
+static bool isCompatible(const oskar_VisHeader* v1, const oskar_VisHeader* v2)
+{
+    if (oskar_vis_header_num_channels_total(v1) !=
+            oskar_vis_header_num_channels_total(v2))
+        return false;
+    if (oskar_vis_header_num_times_total(v1) !=
+            oskar_vis_header_num_times_total(v2))
         return false;
-    if (oskar_vis_num_times(v1) != oskar_vis_num_times(v2))
+    if (oskar_vis_header_num_stations(v1) !=
+            oskar_vis_header_num_stations(v2))
         return false;
-    if (oskar_vis_num_stations(v1) != oskar_vis_num_stations(v2))
+    if (oskar_vis_header_write_auto_correlations(v1) !=
+            oskar_vis_header_write_auto_correlations(v2))
         return false;
-    if (oskar_vis_num_baselines(v1) != oskar_vis_num_baselines(v2))
+    if (oskar_vis_header_write_cross_correlations(v1) !=
+            oskar_vis_header_write_cross_correlations(v2))
         return false;
-    if (fabs(oskar_vis_freq_start_hz(v1) -
-            oskar_vis_freq_start_hz(v2)) > DBL_EPSILON)
+    if (fabs(oskar_vis_header_freq_start_hz(v1) -
+            oskar_vis_header_freq_start_hz(v2)) > DBL_EPSILON)
         return false;
-    if (fabs(oskar_vis_freq_inc_hz(v1) -
-            oskar_vis_freq_inc_hz(v2)) > DBL_EPSILON)
+    if (fabs(oskar_vis_header_freq_inc_hz(v1) -
+            oskar_vis_header_freq_inc_hz(v2)) > DBL_EPSILON)
         return false;
-    if (fabs(oskar_vis_channel_bandwidth_hz(v1) -
-            oskar_vis_channel_bandwidth_hz(v2)) > DBL_EPSILON)
+    if (fabs(oskar_vis_header_channel_bandwidth_hz(v1) -
+            oskar_vis_header_channel_bandwidth_hz(v2)) > DBL_EPSILON)
         return false;
-    if (fabs(oskar_vis_time_start_mjd_utc(v1) -
-            oskar_vis_time_start_mjd_utc(v2)) > DBL_EPSILON)
+    if (fabs(oskar_vis_header_time_start_mjd_utc(v1) -
+            oskar_vis_header_time_start_mjd_utc(v2)) > DBL_EPSILON)
         return false;
-    if (fabs(oskar_vis_time_inc_sec(v1) -
-            oskar_vis_time_inc_sec(v2)) > DBL_EPSILON)
+    if (fabs(oskar_vis_header_time_inc_sec(v1) -
+            oskar_vis_header_time_inc_sec(v2)) > DBL_EPSILON)
         return false;
-    if (fabs(oskar_vis_phase_centre_ra_deg(v1) -
-            oskar_vis_phase_centre_ra_deg(v2)) > DBL_EPSILON)
+    if (fabs(oskar_vis_header_phase_centre_ra_deg(v1) -
+            oskar_vis_header_phase_centre_ra_deg(v2)) > DBL_EPSILON)
         return false;
-    if (fabs(oskar_vis_phase_centre_dec_deg(v1) -
-            oskar_vis_phase_centre_dec_deg(v2)) > DBL_EPSILON)
+    if (fabs(oskar_vis_header_phase_centre_dec_deg(v1) -
+            oskar_vis_header_phase_centre_dec_deg(v2)) > DBL_EPSILON)
         return false;
 
-    if (oskar_mem_type(oskar_vis_amplitude_const(v1)) !=
-            oskar_mem_type(oskar_vis_amplitude_const(v2)))
+    if (oskar_vis_header_amp_type(v1) != oskar_vis_header_amp_type(v2))
         return false;
 
     return true;
@@ -176,12 +442,16 @@ static bool isCompatible(const oskar_Vis* v1, const oskar_Vis* v2)
 
 static void set_options(OptionParser& opt)
 {
-    opt.set_description("Application to combine OSKAR binary visibility files.");
+    opt.set_description("Application to combine OSKAR binary visibility files. "
+            "The files are read and added one block at a time. "
+            "If the output name ends with '.ms', a Measurement Set is "
+            "written instead of an OSKAR visibility file.");
     opt.add_required("OSKAR visibility files...");
     opt.add_flag("-o", "Output visibility file name", 1, "out.vis", false, "--output");
     opt.add_flag("-q", "Disable log messages", false, "--quiet");
     opt.add_example("oskar_vis_add file1.vis file2.vis");
     opt.add_example("oskar_vis_add file1.vis file2.vis -o combined.vis");
+    opt.add_example("oskar_vis_add file1.vis file2.vis -o combined.ms");
     opt.add_example("oskar_vis_add -q file1.vis file2.vis file3.vis");
     opt.add_example("oskar_vis_add *.vis");
 }
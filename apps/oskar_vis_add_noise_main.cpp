@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2017, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -174,7 +174,7 @@ int main(int argc, char** argv)
             oskar_vis_block_read(blk, hdr, h_in, b, &status);
             oskar_vis_block_add_system_noise(blk, hdr, tel, b, station_work,
                     &status);
-            oskar_vis_block_write(blk, h_out, b, &status);
+            oskar_vis_block_write_chunks(blk, hdr, h_out, b, &status);
         }
 
         // Free memory for vis header and vis block, and close files.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -69,6 +69,7 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
     oskar_log_set_file_priority(log,
             s->to_int("write_status_to_log_file", status) ?
             OSKAR_LOG_STATUS : OSKAR_LOG_MESSAGE);
+    oskar_beam_pattern_set_trace_file(h, s->to_string("trace_file", status));
     s->end_group();
 
     // Set observation settings.
@@ -121,6 +122,8 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
             s->to_int("average_time_and_channel", status));
     oskar_beam_pattern_set_separate_time_and_channel(h,
             s->to_int("separate_time_and_channel", status));
+    oskar_beam_pattern_set_time_and_channel_statistics(h,
+            s->to_int("time_and_channel_statistics", status));
     // oskar_beam_pattern_set_stokes(h, s->to_string("stokes", status).c_str());
     s->end_group();
 
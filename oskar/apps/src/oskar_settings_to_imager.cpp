@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -76,6 +76,7 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
     oskar_imager_set_ms_column(h,
             s->to_string("ms_column", status), status);
     oskar_imager_set_output_root(h, s->to_string("root_path", status));
+    oskar_imager_set_trace_file(h, s->to_string("trace_file", status));
 
     // Set remaining imager options.
     oskar_imager_set_image_type(h,
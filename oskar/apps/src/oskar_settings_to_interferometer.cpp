@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -71,12 +71,17 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     oskar_log_set_file_priority(log,
             s->to_int("write_status_to_log_file", status) ?
                     OSKAR_LOG_STATUS : OSKAR_LOG_MESSAGE);
+    oskar_interferometer_set_trace_file(h, s->to_string("trace_file", status));
     s->end_group();
 
     // Set sky settings.
     s->begin_group("sky");
     oskar_interferometer_set_horizon_clip(h,
             s->to_int("advanced/apply_horizon_clip", status));
+    oskar_interferometer_set_sort_sky(h,
+            s->to_int("advanced/sort_sources_spatially", status));
+    oskar_interferometer_set_chunk_cutoff_radius(h,
+            s->to_double("advanced/chunk_cutoff_radius_deg", status));
     oskar_interferometer_set_zero_failed_gaussians(h,
             s->to_int("advanced/zero_failed_gaussians", status));
     oskar_interferometer_set_source_flux_range(h,
@@ -104,10 +109,29 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_int("max_time_samples_per_block", status));
     oskar_interferometer_set_output_vis_file(h,
             s->to_string("oskar_vis_filename", status));
+    int compression = OSKAR_VIS_COMPRESSION_NONE, mantissa_bits = 0;
+    int channels_per_chunk = 0, baselines_per_chunk = 0;
+    if (!s->starts_with("oskar_vis_compression", "N", status))
+        compression = OSKAR_VIS_COMPRESSION_BITSHUFFLE_RLE;
+    if (s->starts_with("oskar_vis_compression", "Lossy", status))
+        mantissa_bits = s->to_int("oskar_vis_compression/mantissa_bits",
+                status);
+    if (!s->starts_with("oskar_vis_compression/channels_per_chunk", "a",
+            status))
+        channels_per_chunk = s->to_int(
+                "oskar_vis_compression/channels_per_chunk", status);
+    if (!s->starts_with("oskar_vis_compression/baselines_per_chunk", "a",
+            status))
+        baselines_per_chunk = s->to_int(
+                "oskar_vis_compression/baselines_per_chunk", status);
+    oskar_interferometer_set_vis_compression(h, compression, mantissa_bits,
+            channels_per_chunk, baselines_per_chunk);
     oskar_interferometer_set_output_measurement_set(h,
             s->to_string("ms_filename", status));
     oskar_interferometer_set_force_polarised_ms(h,
             s->to_int("force_polarised_ms", status));
+    oskar_interferometer_set_num_ms_files(h,
+            s->to_int("ms_num_files", status));
     s->end_group();
 
     // Return handle to interferometer simulator.
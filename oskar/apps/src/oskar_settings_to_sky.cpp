@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -133,6 +133,29 @@ oskar_Sky* oskar_settings_to_sky(SettingsTree* s, oskar_Log* log, int* status)
         return sky;
     }
 
+    /* Rebin sources onto the given positions, if required. */
+    filename = s->to_string("rebin/positions_file", status);
+    if (filename && strlen(filename) > 0 && !*status)
+    {
+        int binary_file_error = 0;
+        if (log) oskar_log_message(log, 'M', 0,
+                "Rebinning %d sources onto positions in '%s' ...",
+                num_sources, filename);
+        oskar_Sky* t = oskar_sky_read(filename, OSKAR_CPU, &binary_file_error);
+        if (binary_file_error)
+            t = oskar_sky_load(filename, type, status);
+        oskar_sky_rebin(t, sky, status);
+        if (!*status)
+        {
+            oskar_sky_resize(sky, 0, status);
+            oskar_sky_append(sky, t, status);
+            if (log) oskar_log_message(log, 'M', 1,
+                    "done. Sky model now contains %d sources.",
+                    oskar_sky_num_sources(sky));
+        }
+        oskar_sky_free(t, status);
+    }
+
     /* Write text file. */
     filename = s->to_string("output_text_file", status);
     if (filename && strlen(filename) > 0 && !*status)
@@ -162,6 +185,7 @@ static void load_osm(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
     int num_files = 0;
     s->begin_group("oskar_sky_model");
     const char* const* files = s->to_string_list("file", &num_files, status);
+    int use_cache = s->to_int("use_binary_cache", status);
     for (int i = 0; i < num_files; ++i)
     {
         int binary_file_error = 0;
@@ -177,8 +201,14 @@ static void load_osm(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
         oskar_Sky* t = oskar_sky_read(files[i],
                 OSKAR_CPU, &binary_file_error);
         if (binary_file_error)
-            t = oskar_sky_load(files[i],
-                    oskar_sky_precision(sky), status);
+        {
+            if (use_cache)
+                t = oskar_sky_load_cached(files[i],
+                        oskar_sky_precision(sky), status);
+            else
+                t = oskar_sky_load(files[i],
+                        oskar_sky_precision(sky), status);
+        }
 
         /* Apply filters and extended source over-ride. */
         set_up_filter(t, s, ra0, dec0, status);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -72,8 +72,14 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
 
     /************************************************************************/
     /* Load telescope model folders to define the stations. */
-    oskar_telescope_load(t,
-            s->to_string("telescope/input_directory", status), log, status);
+    if (s->to_int("telescope/use_binary_cache", status))
+        oskar_telescope_load_cached(t,
+                s->to_string("telescope/input_directory", status),
+                log, status);
+    else
+        oskar_telescope_load(t,
+                s->to_string("telescope/input_directory", status),
+                log, status);
     if (*status) return t;
 
     /* Return if no stations were found. */
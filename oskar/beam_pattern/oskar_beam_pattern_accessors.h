@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -135,6 +135,14 @@ OSKAR_EXPORT
 void oskar_beam_pattern_set_telescope_model(oskar_BeamPattern* h,
         const oskar_Telescope* model, int* status);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_time_and_channel_statistics(oskar_BeamPattern* h,
+        int flag);
+
+OSKAR_EXPORT
+void oskar_beam_pattern_set_trace_file(oskar_BeamPattern* h,
+        const char* path);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_voltage_amp_fits(oskar_BeamPattern* h, int flag);
 
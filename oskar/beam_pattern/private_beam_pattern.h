@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,6 +28,7 @@
 
 #include <mem/oskar_mem.h>
 #include <telescope/oskar_telescope.h>
+#include <utility/oskar_async_writer.h>
 #include <utility/oskar_timer.h>
 #include <utility/oskar_thread.h>
 
@@ -46,17 +47,13 @@ struct DeviceData
     /* Host memory. */
     /* Chunks have dimension max_chunk_size * num_active_stations. */
     /* Cross power beams have dimension max_chunk_size. */
+    int item[2]; /* Index of work item held in each buffer, or -1 if free. */
+    int item_done[2]; /* True when buffer is ready to be written. */
     oskar_Mem* jones_data_cpu[2]; /* On host, for copy back & write. */
 
     /* Per Stokes parameter. */
     oskar_Mem* auto_power_cpu[4][2]; /* On host, for copy back & write. */
-    oskar_Mem* auto_power_time_avg[4];
-    oskar_Mem* auto_power_channel_avg[4];
-    oskar_Mem* auto_power_channel_and_time_avg[4];
     oskar_Mem* cross_power_cpu[4][2]; /* On host, for copy back & write. */
-    oskar_Mem* cross_power_time_avg[4];
-    oskar_Mem* cross_power_channel_avg[4];
-    oskar_Mem* cross_power_channel_and_time_avg[4];
 
     /* Device memory. */
     int previous_chunk_index;
@@ -64,6 +61,7 @@ struct DeviceData
     oskar_StationWork* work;
     oskar_Mem *x, *y, *z, *jones_data;
     oskar_Mem *auto_power[4], *cross_power[4];
+    oskar_Mem *auto_power_avg[4], *cross_power_avg[4]; /* If averaging. */
 
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent calculating pixels. */
@@ -80,6 +78,7 @@ struct DataProduct
     int channel_average;
     fitsfile* fits_file;
     FILE* text_file;
+    oskar_Mem* stats[2]; /* Running statistics, for each pixel in chunk. */
 };
 typedef struct DataProduct DataProduct;
 
@@ -96,16 +95,29 @@ struct oskar_BeamPattern
     int cross_power_amp_txt, cross_power_phase_txt, cross_power_raw_txt;
     int cross_power_amp_fits, cross_power_phase_fits, ixr_txt, ixr_fits;
     int average_time_and_channel, separate_time_and_channel, stokes[4];
+    int time_and_channel_statistics;
     double lon0, lat0, phase_centre_deg[2], fov_deg[2];
     double time_start_mjd_utc, time_inc_sec, length_sec;
     double freq_start_hz, freq_inc_hz;
     char average_single_axis, coord_frame_type, coord_grid_type;
-    char *root_path, *sky_model_file;
+    char *root_path, *sky_model_file, *trace_file;
 
     /* State. */
+    /* Work items are (chunk, time, channel) triples, numbered in the order
+     * in which they must be written. Compute devices take the next item
+     * from the queue when they have a free buffer, and the writer thread
+     * consumes completed items strictly in order. */
     oskar_Mutex* mutex;
-    oskar_Barrier* barrier;
-    int i_global, status;
+    oskar_ConditionVar* cond; /* Protects the work queue state. */
+    oskar_ThreadPool* pool; /* Runs the writer and compute device tasks. */
+    int num_items, i_next_item, status;
+
+    /* Number of time and channel steps in each work item, and the axes
+     * that are averaged on the compute devices.
+     * The number of steps is greater than 1 only if the data are averaged
+     * on the compute devices, which happens if no per-step output is
+     * required. */
+    int num_steps_per_item, device_time_average, device_channel_average;
 
     /* Input data. */
     oskar_Mem *x, *y, *z;
@@ -115,6 +127,14 @@ struct oskar_BeamPattern
     oskar_Mem* pix; /* Real-valued pixel array to write to file. */
     oskar_Mem* ctemp; /* Complex-valued array used for reordering. */
 
+    /* Averaged data, per Stokes parameter (accessed only by writer). */
+    oskar_Mem* auto_power_time_avg[4];
+    oskar_Mem* auto_power_channel_avg[4];
+    oskar_Mem* auto_power_channel_and_time_avg[4];
+    oskar_Mem* cross_power_time_avg[4];
+    oskar_Mem* cross_power_channel_avg[4];
+    oskar_Mem* cross_power_channel_and_time_avg[4];
+
     /* Settings log data. */
     oskar_Log* log;
     char* settings_log;
@@ -124,6 +144,9 @@ struct oskar_BeamPattern
     int num_data_products;
     DataProduct* data_products;
 
+    /* Background file writer, used by the writer thread. */
+    oskar_AsyncWriter* writer;
+
     /* Timers. */
     oskar_Timer *tmr_sim, *tmr_write;
 
@@ -144,7 +167,11 @@ enum OSKAR_BEAM_PATTERN_DATA_PRODUCT_TYPE
     CROSS_POWER_RAW_COMPLEX,
     CROSS_POWER_AMP,
     CROSS_POWER_PHASE,
-    IXR
+    IXR,
+    AUTO_POWER_VARIANCE,
+    AUTO_POWER_MAX,
+    CROSS_POWER_AMP_VARIANCE,
+    CROSS_POWER_AMP_MAX
 };
 
 enum OSKAR_BEAM_DATA_TYPE
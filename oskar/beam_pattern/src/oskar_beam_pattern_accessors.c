@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -300,6 +300,24 @@ void oskar_beam_pattern_set_telescope_model(oskar_BeamPattern* h,
 }
 
 
+void oskar_beam_pattern_set_time_and_channel_statistics(oskar_BeamPattern* h,
+        int flag)
+{
+    h->time_and_channel_statistics = flag;
+}
+
+
+void oskar_beam_pattern_set_trace_file(oskar_BeamPattern* h,
+        const char* path)
+{
+    free(h->trace_file);
+    h->trace_file = 0;
+    if (!path || strlen(path) == 0) return;
+    h->trace_file = (char*) malloc(1 + strlen(path));
+    strcpy(h->trace_file, path);
+}
+
+
 void oskar_beam_pattern_set_voltage_amp_fits(oskar_BeamPattern* h, int flag)
 {
     h->voltage_amp_fits = flag;
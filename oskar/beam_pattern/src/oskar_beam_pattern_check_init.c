@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -53,6 +53,7 @@ extern "C" {
 static void set_up_host_data(oskar_BeamPattern* h, int *status);
 static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
         int* status);
+static void create_statistics_products(oskar_BeamPattern* h, int* status);
 static void set_up_device_data(oskar_BeamPattern* h, int* status);
 static void write_axis(fitsfile* fptr, int axis_id, const char* ctype,
         const char* ctype_comment, double crval, double cdelt, double crpix,
@@ -130,6 +131,21 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
         if (h->settings_log[j] == '\r') h->settings_log[j] = ' ';
     }
 
+    /* Average on the compute devices if no per-step data are needed. */
+    h->device_time_average = 0;
+    h->device_channel_average = 0;
+    if (!h->separate_time_and_channel && !h->time_and_channel_statistics)
+    {
+        if (h->average_single_axis == 'T')
+            h->device_time_average = 1;
+        else if (h->average_single_axis == 'C')
+            h->device_channel_average = 1;
+        else if (h->average_time_and_channel)
+            h->device_time_average = h->device_channel_average = 1;
+    }
+    h->num_steps_per_item = (h->device_time_average ? h->num_time_steps : 1) *
+            (h->device_channel_average ? h->num_channels : 1);
+
     /* Return if data products already exist. */
     if (h->data_products) return;
 
@@ -193,6 +209,8 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
         create_averaged_products(h, 0, 1, status);
     else if (h->average_single_axis == 'T')
         create_averaged_products(h, 1, 0, status);
+    if (h->time_and_channel_statistics)
+        create_statistics_products(h, status);
 
     /* Check that at least one output file will be generated. */
     if (h->num_data_products == 0 && !*status)
@@ -258,6 +276,47 @@ static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
 }
 
 
+static void create_statistics_products(oskar_BeamPattern* h, int* status)
+{
+    int s, i, o, k, t;
+    if (*status) return;
+
+    /* Statistics are computed over both time and channel dimensions. */
+    for (s = -1; s < h->num_active_stations; ++s)
+    {
+        for (t = 0; t < 2; ++t)
+        {
+            k = (s >= 0) ? (t ? AUTO_POWER_MAX : AUTO_POWER_VARIANCE) :
+                    (t ? CROSS_POWER_AMP_MAX : CROSS_POWER_AMP_VARIANCE);
+            for (i = I; i <= V; ++i)
+            {
+                for (o = I; (o <= V) && h->stokes[i]; ++o)
+                {
+                    if (s >= 0 ? h->auto_power_txt : h->cross_power_amp_txt)
+                        new_text_file(h, k, i, o, s, 1, 1, status);
+                    if (h->coord_grid_type != 'B') continue;
+                    if (s >= 0 ? h->auto_power_fits : h->cross_power_amp_fits)
+                        new_fits_file(h, k, i, o, s, 1, 1, status);
+                }
+            }
+        }
+    }
+
+    /* Allocate arrays to hold the running statistics for each pixel. */
+    for (i = 0; i < h->num_data_products; ++i)
+    {
+        DataProduct* p = &h->data_products[i];
+        k = p->type;
+        if (k != AUTO_POWER_VARIANCE && k != AUTO_POWER_MAX &&
+                k != CROSS_POWER_AMP_VARIANCE && k != CROSS_POWER_AMP_MAX)
+            continue;
+        for (t = 0; t < 2 && !p->stats[t]; ++t)
+            p->stats[t] = oskar_mem_create(h->prec, OSKAR_CPU,
+                    h->max_chunk_size, status);
+    }
+}
+
+
 static void write_axis(fitsfile* fptr, int axis_id, const char* ctype,
         const char* ctype_comment, double crval, double cdelt, double crpix,
         int* status)
@@ -530,6 +589,10 @@ static const char* data_type_to_string(int type)
     case CROSS_POWER_AMP:            return "CROSS_POWER_AMP";
     case CROSS_POWER_PHASE:          return "CROSS_POWER_PHASE";
     case IXR:                        return "IXR";
+    case AUTO_POWER_VARIANCE:        return "AUTO_POWER_VAR";
+    case AUTO_POWER_MAX:             return "AUTO_POWER_MAX";
+    case CROSS_POWER_AMP_VARIANCE:   return "CROSS_POWER_AMP_VAR";
+    case CROSS_POWER_AMP_MAX:        return "CROSS_POWER_AMP_MAX";
     default:                         return "";
     }
 }
@@ -555,6 +618,7 @@ static const char* stokes_type_to_string(int type)
 static void set_up_device_data(oskar_BeamPattern* h, int* status)
 {
     int i, beam_type, max_src, max_size, auto_power, cross_power, raw_data;
+    char single_axis;
     if (*status) return;
 
     /* Get local variables. */
@@ -595,6 +659,8 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
 
         /* Device memory. */
         d->previous_chunk_index = -1;
+        d->item[0] = d->item[1] = -1;
+        d->item_done[0] = d->item_done[1] = 0;
         if (!d->tel)
         {
             d->jones_data = oskar_mem_create(beam_type, dev_loc, max_size,
@@ -625,22 +691,15 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                 /* Device memory. */
                 d->auto_power[i_stokes] = oskar_mem_create(beam_type, dev_loc,
                         max_size, status);
+                if (h->num_steps_per_item > 1)
+                    d->auto_power_avg[i_stokes] = oskar_mem_create(
+                            beam_type, dev_loc, max_size, status);
 
                 /* Host memory. */
                 d->auto_power_cpu[i_stokes][0] = oskar_mem_create(
                         beam_type, OSKAR_CPU, max_size, status);
                 d->auto_power_cpu[i_stokes][1] = oskar_mem_create(
                         beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'T')
-                    d->auto_power_time_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'C')
-                    d->auto_power_channel_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_time_and_channel)
-                    d->auto_power_channel_and_time_avg[i_stokes] =
-                            oskar_mem_create(beam_type, OSKAR_CPU,
-                                    max_size, status);
             }
 
             /* Cross-correlation beam output arrays. */
@@ -657,33 +716,71 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                 /* Device memory. */
                 d->cross_power[i_stokes] = oskar_mem_create(
                         beam_type, dev_loc, max_src, status);
+                if (h->num_steps_per_item > 1)
+                    d->cross_power_avg[i_stokes] = oskar_mem_create(
+                            beam_type, dev_loc, max_src, status);
 
                 /* Host memory. */
                 d->cross_power_cpu[i_stokes][0] = oskar_mem_create(
-
                         beam_type, OSKAR_CPU, max_src, status);
                 d->cross_power_cpu[i_stokes][1] = oskar_mem_create(
                         beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'T')
-                    d->cross_power_time_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'C')
-                    d->cross_power_channel_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_time_and_channel)
-                    d->cross_power_channel_and_time_avg[i_stokes] =
-                            oskar_mem_create(beam_type, OSKAR_CPU,
-                                    max_src, status);
             }
             if (d->auto_power[i_stokes])
                 oskar_mem_clear_contents(d->auto_power[i_stokes], status);
             if (d->cross_power[i_stokes])
                 oskar_mem_clear_contents(d->cross_power[i_stokes], status);
+            if (d->auto_power_avg[i_stokes])
+                oskar_mem_clear_contents(d->auto_power_avg[i_stokes], status);
+            if (d->cross_power_avg[i_stokes])
+                oskar_mem_clear_contents(d->cross_power_avg[i_stokes], status);
         }
 
         /* Timers. */
         if (!d->tmr_compute)
+        {
             d->tmr_compute = oskar_timer_create(OSKAR_TIMER_NATIVE);
+            oskar_timer_set_trace_name(d->tmr_compute, "Compute chunk");
+        }
+    }
+
+    /* Averaged data arrays, used only by the writer thread.
+     * Single-axis averages are not needed here if done on the devices. */
+    single_axis = (h->device_time_average || h->device_channel_average) ?
+            0 : h->average_single_axis;
+    for (i = 0; i < 4; ++i)
+    {
+        if (!h->stokes[i] || *status) continue;
+        if (h->device_time_average && h->device_channel_average)
+            continue;
+        if (auto_power && !h->auto_power_time_avg[i] &&
+                !h->auto_power_channel_avg[i] &&
+                !h->auto_power_channel_and_time_avg[i])
+        {
+            if (single_axis == 'T')
+                h->auto_power_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+            if (single_axis == 'C')
+                h->auto_power_channel_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+            if (h->average_time_and_channel)
+                h->auto_power_channel_and_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+        }
+        if (cross_power && !h->cross_power_time_avg[i] &&
+                !h->cross_power_channel_avg[i] &&
+                !h->cross_power_channel_and_time_avg[i])
+        {
+            if (single_axis == 'T')
+                h->cross_power_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+            if (single_axis == 'C')
+                h->cross_power_channel_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+            if (h->average_time_and_channel)
+                h->cross_power_channel_and_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+        }
     }
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,10 +43,12 @@ void oskar_beam_pattern_free(oskar_BeamPattern* h, int* status)
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
     oskar_mutex_free(h->mutex);
-    oskar_barrier_free(h->barrier);
+    oskar_condition_free(h->cond);
+    oskar_thread_pool_free(h->pool);
     free(h->d);
     free(h->root_path);
     free(h->sky_model_file);
+    free(h->trace_file);
     free(h->settings_log);
     free(h->station_ids);
     free(h);
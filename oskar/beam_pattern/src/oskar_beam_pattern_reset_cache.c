@@ -49,6 +49,21 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
     oskar_mem_free(h->pix, status);
     oskar_mem_free(h->ctemp, status);
     h->x = h->y = h->z = h->pix = h->ctemp = NULL;
+    for (i = 0; i < 4; ++i)
+    {
+        oskar_mem_free(h->auto_power_time_avg[i], status);
+        oskar_mem_free(h->auto_power_channel_avg[i], status);
+        oskar_mem_free(h->auto_power_channel_and_time_avg[i], status);
+        oskar_mem_free(h->cross_power_time_avg[i], status);
+        oskar_mem_free(h->cross_power_channel_avg[i], status);
+        oskar_mem_free(h->cross_power_channel_and_time_avg[i], status);
+        h->auto_power_time_avg[i] = NULL;
+        h->auto_power_channel_avg[i] = NULL;
+        h->auto_power_channel_and_time_avg[i] = NULL;
+        h->cross_power_time_avg[i] = NULL;
+        h->cross_power_channel_avg[i] = NULL;
+        h->cross_power_channel_and_time_avg[i] = NULL;
+    }
 
     /* Close files and free data products. */
     for (i = 0; i < h->num_data_products; ++i)
@@ -57,6 +72,8 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
             fclose(h->data_products[i].text_file);
         if (h->data_products[i].fits_file)
             ffclos(h->data_products[i].fits_file, status);
+        oskar_mem_free(h->data_products[i].stats[0], status);
+        oskar_mem_free(h->data_products[i].stats[1], status);
     }
     free(h->data_products);
     h->data_products = NULL;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -38,6 +38,7 @@
 #include "utility/oskar_device_utils.h"
 #include "utility/oskar_file_exists.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_trace.h"
 #include "oskar_version.h"
 
 #include <stdlib.h>
@@ -53,14 +54,23 @@
 extern "C" {
 #endif
 
-static void* run_blocks(void* arg);
-static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
-        int i_channel, int i_active, int device_id, int* status);
-static void write_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
-        int i_channel, int i_active, int* status);
+static void run_blocks(void* arg);
+static void step_indices(const oskar_BeamPattern* h, int step, int* i_chunk,
+        int* i_time, int* i_channel);
+static void sim_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int i_step, int i_active, int device_id, int* status);
+static void write_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int device_id, int i_active, int* status);
+static void write_averaged_chunks(oskar_BeamPattern* h, const DeviceData* d,
+        int i_chunk, int i_time, int i_channel, int i_active, int* status);
 static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
         const oskar_Mem* in, int chunk_desc, int stokes_in, int* status);
+static void write_to_files(oskar_BeamPattern* h, const DataProduct* p,
+        int i_chunk, int i_time, int i_channel, int num_pix, int* status);
+static void update_statistics(oskar_BeamPattern* h, int i_chunk, int i_step,
+        int num_pix, const oskar_Mem* in, int chunk_desc, int stokes_in,
+        int* status);
 static void complex_to_amp(const oskar_Mem* complex_in, const int offset,
         const int stride, const int num_points, oskar_Mem* output, int* status);
 static void complex_to_phase(const oskar_Mem* complex_in, const int offset,
@@ -79,18 +89,18 @@ static void record_timing(oskar_BeamPattern* h);
 static unsigned int disp_width(unsigned int value);
 
 
-struct ThreadArgs
+struct TaskArgs
 {
     oskar_BeamPattern* h;
-    int num_threads, thread_id;
+    int thread_id;
 };
-typedef struct ThreadArgs ThreadArgs;
+typedef struct TaskArgs TaskArgs;
 
 void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 {
-    int i, num_threads;
-    oskar_Thread** threads = 0;
-    ThreadArgs* args = 0;
+    int i, num_threads, tracing;
+    oskar_TaskGroup* group = 0;
+    TaskArgs* args = 0;
     if (*status || !h) return;
 
     /* Check root name exists. */
@@ -104,15 +114,20 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     /* Initialise if required. */
     oskar_beam_pattern_check_init(h, status);
 
-    /* Set up worker threads. */
+    /* Set up the work queue and worker threads. */
+    h->num_items = h->num_chunks * h->num_time_steps * h->num_channels /
+            h->num_steps_per_item;
+    h->i_next_item = 0;
     num_threads = h->num_devices + 1;
-    oskar_barrier_set_num_threads(h->barrier, num_threads);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
-    args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
+    if (oskar_thread_pool_num_threads(h->pool) != num_threads)
+    {
+        oskar_thread_pool_free(h->pool);
+        h->pool = oskar_thread_pool_create(num_threads);
+    }
+    args = (TaskArgs*) calloc(num_threads, sizeof(TaskArgs));
     for (i = 0; i < num_threads; ++i)
     {
         args[i].h = h;
-        args[i].num_threads = num_threads;
         args[i].thread_id = i;
     }
 
@@ -130,24 +145,33 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     /* Set status code. */
     h->status = *status;
 
-    /* Start simulation timer. */
-    oskar_timer_start(h->tmr_sim);
+    /* Start the background file writer.
+     * Pixel data are copied, so limit the amount waiting to be written. */
+    h->writer = oskar_async_writer_create(
+            h->num_data_products < 4 ? h->num_data_products : 4,
+            ((size_t)1) << 28);
 
-    /* Start the worker threads. */
-    for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+    /* Start simulation timer, and trace if required. */
+    oskar_timer_start(h->tmr_sim);
+    tracing = oskar_trace_start(h->trace_file);
 
-    /* Wait for worker threads to finish. */
+    /* Run the writer and compute device tasks, and wait for them to finish.
+     * Each task must run concurrently with the others, and the pool has
+     * one worker thread for each. */
+    group = oskar_task_group_create(h->pool);
     for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+        oskar_thread_pool_submit(h->pool, group, run_blocks,
+                (void*)&args[i], i);
+    oskar_task_group_free(group);
     free(args);
 
-    /* Get status code. */
+    /* Get status code, and wait for all file writes to finish. */
     *status = h->status;
+    oskar_timer_resume(h->tmr_write);
+    oskar_async_writer_free(h->writer, status);
+    oskar_timer_pause(h->tmr_write);
+    h->writer = 0;
+    if (tracing) oskar_trace_stop(h->log, status);
 
     /* Record memory usage. */
     if (h->log && !*status)
@@ -169,19 +193,15 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 
 /* Private methods. */
 
-static void* run_blocks(void* arg)
+static void run_blocks(void* arg)
 {
     oskar_BeamPattern* h;
-    int i_inner, i_outer, num_inner, num_outer, c, t, f;
-    int thread_id, device_id, num_threads, *status;
-
-    /* Loop indices for previous iteration (accessed only by thread 0). */
-    int cp = 0, tp = 0, fp = 0;
+    int c, t, f, i, item, step, thread_id, device_id, *status;
+    DeviceData* d;
 
-    /* Get thread function arguments. */
-    h = ((ThreadArgs*)arg)->h;
-    num_threads = ((ThreadArgs*)arg)->num_threads;
-    thread_id = ((ThreadArgs*)arg)->thread_id;
+    /* Get task function arguments. */
+    h = ((TaskArgs*)arg)->h;
+    thread_id = ((TaskArgs*)arg)->thread_id;
     device_id = thread_id - 1;
     status = &(h->status);
 
@@ -194,75 +214,134 @@ static void* run_blocks(void* arg)
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->gpu_ids[device_id], status);
 
-    /* Set ranges of inner and outer loops based on averaging mode. */
-    if (h->average_single_axis != 'T')
-    {
-        num_outer = h->num_time_steps;
-        num_inner = h->num_channels; /* Channel on inner loop. */
-    }
-    else
-    {
-        num_outer = h->num_channels;
-        num_inner = h->num_time_steps; /* Time on inner loop. */
-    }
-
-    /* Loop over image pixel chunks, running simulation and file writing one
-     * chunk at a time. Simulation and file output are overlapped by using
-     * double buffering, and a dedicated thread is used for file output.
+    /* Work items are processed using a shared queue, so that faster devices
+     * are never left waiting for slower ones.
      *
-     * Thread 0 is used for file writes.
+     * Thread 0 is used for file writes, and consumes completed items in
+     * order, so that the output files do not depend on the number of
+     * devices or the order in which items complete.
      * Threads 1 to n (mapped to compute devices) do the simulation.
+     * Each compute device has two host buffers, so it can continue with the
+     * next item while the writer is still busy with the previous one.
      */
-    for (c = 0; c < h->num_chunks; c += h->num_devices)
+    if (thread_id == 0)
     {
-        for (i_outer = 0; i_outer < num_outer; ++i_outer)
+        for (item = 0; item < h->num_items; ++item)
         {
-            for (i_inner = 0; i_inner < num_inner; ++i_inner)
+            /* Wait until the next item in sequence has been computed. */
+            oskar_condition_lock(h->cond);
+            d = 0;
+            while (!*status)
             {
-                /* Set time and channel indices based on averaging mode. */
-                if (h->average_single_axis != 'T')
-                {
-                    t = i_outer;
-                    f = i_inner;
-                }
-                else
+                for (i = 0; i < 2 * h->num_devices; ++i)
                 {
-                    f = i_outer;
-                    t = i_inner;
-                }
-                if (thread_id > 0 || num_threads == 1)
-                    sim_chunks(h, c, t, f, h->i_global & 1, device_id, status);
-                if (thread_id == 0 && h->i_global > 0)
-                    write_chunks(h, cp, tp, fp, h->i_global & 1, status);
-
-                /* Barrier 1: Set indices of the previous chunk(s). */
-                oskar_barrier_wait(h->barrier);
-                if (thread_id == 0)
-                {
-                    cp = c;
-                    tp = t;
-                    fp = f;
-                    h->i_global++;
+                    DeviceData* dd = &h->d[i >> 1];
+                    if (dd->item[i & 1] == item && dd->item_done[i & 1])
+                    {
+                        d = dd;
+                        break;
+                    }
                 }
+                if (d) break;
+                oskar_condition_wait(h->cond);
+            }
+            oskar_condition_unlock(h->cond);
+            if (!d) break;
+
+            /* Write the item, then release the buffer. */
+            step_indices(h, (item + 1) * h->num_steps_per_item - 1, &c, &t, &f);
+            write_chunks(h, c, t, f, i >> 1, i & 1, status);
+            oskar_condition_lock(h->cond);
+            d->item[i & 1] = -1;
+            d->item_done[i & 1] = 0;
+            oskar_condition_notify_all(h->cond);
+            oskar_condition_unlock(h->cond);
+        }
+    }
+    else
+    {
+        d = &h->d[device_id];
+        for (;;)
+        {
+            /* Wait for a free buffer, then take the next item. */
+            oskar_condition_lock(h->cond);
+            while (!*status && h->i_next_item < h->num_items &&
+                    d->item[0] >= 0 && d->item[1] >= 0)
+                oskar_condition_wait(h->cond);
+            if (*status || h->i_next_item >= h->num_items)
+            {
+                oskar_condition_unlock(h->cond);
+                break;
+            }
+            i = (d->item[0] >= 0) ? 1 : 0;
+            item = h->i_next_item++;
+            d->item[i] = item;
+            oskar_condition_unlock(h->cond);
 
-                /* Barrier 2: Check sim and write are done. */
-                oskar_barrier_wait(h->barrier);
+            /* Simulate the item, then hand it to the writer. */
+            for (step = 0; step < h->num_steps_per_item; ++step)
+            {
+                step_indices(h, item * h->num_steps_per_item + step,
+                        &c, &t, &f);
+                sim_chunks(h, c, t, f, step, i, device_id, status);
             }
+            oskar_condition_lock(h->cond);
+            d->item_done[i] = 1;
+            oskar_condition_notify_all(h->cond);
+            oskar_condition_unlock(h->cond);
         }
     }
 
-    /* Write the very last chunk(s). */
-    if (thread_id == 0)
-        write_chunks(h, cp, tp, fp, h->i_global & 1, status);
+    /* Make sure no thread is left waiting if an error occurred. */
+    if (*status)
+    {
+        oskar_condition_lock(h->cond);
+        oskar_condition_notify_all(h->cond);
+        oskar_condition_unlock(h->cond);
+    }
+}
+
+
+static void step_indices(const oskar_BeamPattern* h, int step, int* i_chunk,
+        int* i_time, int* i_channel)
+{
+    int i_inner, i_outer, num_inner, num_outer;
+
+    /* Set ranges of inner and outer loops based on averaging mode. */
+    if (h->average_single_axis != 'T')
+    {
+        num_outer = h->num_time_steps;
+        num_inner = h->num_channels; /* Channel on inner loop. */
+    }
+    else
+    {
+        num_outer = h->num_channels;
+        num_inner = h->num_time_steps; /* Time on inner loop. */
+    }
+
+    /* Steps are ordered by chunk, then by outer and inner loop index. */
+    *i_chunk = step / (num_outer * num_inner);
+    i_outer = (step / num_inner) % num_outer;
+    i_inner = step % num_inner;
 
-    return 0;
+    /* Set time and channel indices based on averaging mode. */
+    if (h->average_single_axis != 'T')
+    {
+        *i_time = i_outer;
+        *i_channel = i_inner;
+    }
+    else
+    {
+        *i_channel = i_outer;
+        *i_time = i_inner;
+    }
 }
 
 
-static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
-        int i_channel, int i_active, int device_id, int* status)
+static void sim_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int i_step, int i_active, int device_id, int* status)
 {
-    int chunk_size, i_chunk, i;
+    int chunk_size, num_steps, i;
     double dt_dump, mjd, gast, freq_hz;
     oskar_Mem *input_alias, *output_alias;
     DeviceData* d;
@@ -270,13 +349,8 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     /* Check if safe to proceed. */
     if (*status) return;
 
-    /* Get chunk index from GPU ID and chunk start,
-     * and return immediately if it's out of range. */
-    d = &h->d[device_id];
-    i_chunk = i_chunk_start + device_id;
-    if (i_chunk >= h->num_chunks) return;
-
     /* Get time and frequency values. */
+    d = &h->d[device_id];
     oskar_timer_resume(d->tmr_compute);
     dt_dump = h->time_inc_sec / 86400.0;
     mjd = h->time_start_mjd_utc + dt_dump * (i_time + 0.5);
@@ -303,6 +377,8 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     /* Generate beam for this pixel chunk, for all active stations. */
     input_alias  = oskar_mem_create_alias(0, 0, 0, status);
     output_alias = oskar_mem_create_alias(0, 0, 0, status);
+    oskar_station_work_child_beam_cache_begin(d->work,
+            oskar_telescope_allow_station_beam_duplication(d->tel));
     for (i = 0; i < h->num_active_stations; ++i)
     {
         oskar_mem_set_alias(input_alias, d->jones_data,
@@ -339,6 +415,7 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
         }
 #endif
     }
+    oskar_station_work_child_beam_cache_end(d->work);
     if (d->cross_power[I])
         oskar_evaluate_cross_power(chunk_size, h->num_active_stations,
                 d->jones_data, d->cross_power[I], status);
@@ -346,18 +423,60 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     oskar_mem_free(output_alias, status);
 
     /* Copy the output data into host memory. */
-    if (d->jones_data_cpu[i_active])
-        oskar_mem_copy_contents(d->jones_data_cpu[i_active], d->jones_data,
-                0, 0, chunk_size * h->num_active_stations, status);
-    for (i = 0; i < 4; ++i)
-    {
-        if (d->auto_power[i])
-            oskar_mem_copy_contents(d->auto_power_cpu[i][i_active],
-                    d->auto_power[i], 0, 0,
+    num_steps = h->num_steps_per_item;
+    if (num_steps == 1)
+    {
+        if (d->jones_data_cpu[i_active])
+            oskar_mem_copy_contents(d->jones_data_cpu[i_active],
+                    d->jones_data, 0, 0,
                     chunk_size * h->num_active_stations, status);
-        if (d->cross_power[i])
-            oskar_mem_copy_contents(d->cross_power_cpu[i][i_active],
-                    d->cross_power[i], 0, 0, chunk_size, status);
+        for (i = 0; i < 4; ++i)
+        {
+            if (d->auto_power[i])
+                oskar_mem_copy_contents(d->auto_power_cpu[i][i_active],
+                        d->auto_power[i], 0, 0,
+                        chunk_size * h->num_active_stations, status);
+            if (d->cross_power[i])
+                oskar_mem_copy_contents(d->cross_power_cpu[i][i_active],
+                        d->cross_power[i], 0, 0, chunk_size, status);
+        }
+    }
+    else
+    {
+        /* Average on the device, and copy back only the result. */
+        for (i = 0; i < 4; ++i)
+        {
+            if (d->auto_power[i])
+                oskar_mem_add(d->auto_power_avg[i], d->auto_power_avg[i],
+                        d->auto_power[i], chunk_size * h->num_active_stations,
+                        status);
+            if (d->cross_power[i])
+                oskar_mem_add(d->cross_power_avg[i], d->cross_power_avg[i],
+                        d->cross_power[i], chunk_size, status);
+        }
+        if (i_step == num_steps - 1)
+        {
+            for (i = 0; i < 4; ++i)
+            {
+                if (d->auto_power[i])
+                {
+                    oskar_mem_scale_real(d->auto_power_avg[i],
+                            1.0 / num_steps, status);
+                    oskar_mem_copy_contents(d->auto_power_cpu[i][i_active],
+                            d->auto_power_avg[i], 0, 0,
+                            chunk_size * h->num_active_stations, status);
+                    oskar_mem_clear_contents(d->auto_power_avg[i], status);
+                }
+                if (d->cross_power[i])
+                {
+                    oskar_mem_scale_real(d->cross_power_avg[i],
+                            1.0 / num_steps, status);
+                    oskar_mem_copy_contents(d->cross_power_cpu[i][i_active],
+                            d->cross_power_avg[i], 0, 0, chunk_size, status);
+                    oskar_mem_clear_contents(d->cross_power_avg[i], status);
+                }
+            }
+        }
     }
 
     if (h->log)
@@ -375,161 +494,240 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
 }
 
 
-static void write_chunks(oskar_BeamPattern* h, int i_chunk_start,
-        int i_time, int i_channel, int i_active, int* status)
+static void write_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int device_id, int i_active, int* status)
 {
-    int i, i_chunk, chunk_sources, chunk_size, stokes;
+    int chunk_sources, chunk_size, stokes, i_step;
+    DeviceData* d;
     if (*status) return;
 
-    /* Write inactive chunk(s) from all GPUs. */
+    /* Write completed chunk from the given device buffer. */
     oskar_timer_resume(h->tmr_write);
-    for (i = 0; i < h->num_devices; ++i)
+    d = &h->d[device_id];
+    if (h->device_time_average || h->device_channel_average)
     {
-        DeviceData* d = &h->d[i];
+        write_averaged_chunks(h, d, i_chunk, i_time, i_channel, i_active,
+                status);
+        oskar_timer_pause(h->tmr_write);
+        return;
+    }
 
-        /* Get chunk index from GPU ID & chunk start. Stop if out of range. */
-        i_chunk = i_chunk_start + i;
-        if (i_chunk >= h->num_chunks || *status) break;
+    /* Get the index of the step within the chunk, for statistics. */
+    i_step = (h->average_single_axis != 'T') ?
+            i_time * h->num_channels + i_channel :
+            i_channel * h->num_time_steps + i_time;
 
-        /* Get the size of the chunk. */
-        chunk_sources = h->max_chunk_size;
-        if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
-            chunk_sources = h->num_pixels - i_chunk * h->max_chunk_size;
-        chunk_size = chunk_sources * h->num_active_stations;
+    /* Get the size of the chunk. */
+    chunk_sources = h->max_chunk_size;
+    if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
+        chunk_sources = h->num_pixels - i_chunk * h->max_chunk_size;
+    chunk_size = chunk_sources * h->num_active_stations;
 
-        /* Write non-averaged raw data, if required. */
+    /* Write non-averaged raw data, if required. */
+    write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
+            d->jones_data_cpu[i_active], JONES_DATA, -1, status);
+
+    /* Loop over Stokes parameters. */
+    for (stokes = 0; stokes < 4; ++stokes)
+    {
+        /* Write non-averaged data, if required. */
         write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                d->jones_data_cpu[!i_active], JONES_DATA, -1, status);
+                d->auto_power_cpu[stokes][i_active],
+                AUTO_POWER_DATA, stokes, status);
+        write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
+                d->cross_power_cpu[stokes][i_active],
+                CROSS_POWER_DATA, stokes, status);
 
-        /* Loop over Stokes parameters. */
-        for (stokes = 0; stokes < 4; ++stokes)
+        /* Update running statistics, if required. */
+        if (h->time_and_channel_statistics)
         {
-            /* Write non-averaged data, if required. */
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->auto_power_cpu[stokes][!i_active],
+            update_statistics(h, i_chunk, i_step, chunk_sources,
+                    d->auto_power_cpu[stokes][i_active],
                     AUTO_POWER_DATA, stokes, status);
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->cross_power_cpu[stokes][!i_active],
+            update_statistics(h, i_chunk, i_step, chunk_sources,
+                    d->cross_power_cpu[stokes][i_active],
                     CROSS_POWER_DATA, stokes, status);
+        }
 
-            /* Time-average the data if required. */
-            if (d->auto_power_time_avg[stokes])
-                oskar_mem_add(d->auto_power_time_avg[stokes],
-                        d->auto_power_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active], chunk_size,
+        /* Time-average the data if required. */
+        if (h->auto_power_time_avg[stokes])
+            oskar_mem_add(h->auto_power_time_avg[stokes],
+                    h->auto_power_time_avg[stokes],
+                    d->auto_power_cpu[stokes][i_active], chunk_size,
+                    status);
+        if (h->cross_power_time_avg[stokes])
+            oskar_mem_add(h->cross_power_time_avg[stokes],
+                    h->cross_power_time_avg[stokes],
+                    d->cross_power_cpu[stokes][i_active], chunk_sources,
+                    status);
+
+        /* Channel-average the data if required. */
+        if (h->auto_power_channel_avg[stokes])
+            oskar_mem_add(h->auto_power_channel_avg[stokes],
+                    h->auto_power_channel_avg[stokes],
+                    d->auto_power_cpu[stokes][i_active], chunk_size,
+                    status);
+        if (h->cross_power_channel_avg[stokes])
+            oskar_mem_add(h->cross_power_channel_avg[stokes],
+                    h->cross_power_channel_avg[stokes],
+                    d->cross_power_cpu[stokes][i_active], chunk_sources,
+                    status);
+
+        /* Channel- and time-average the data if required. */
+        if (h->auto_power_channel_and_time_avg[stokes])
+            oskar_mem_add(h->auto_power_channel_and_time_avg[stokes],
+                    h->auto_power_channel_and_time_avg[stokes],
+                    d->auto_power_cpu[stokes][i_active], chunk_size,
+                    status);
+        if (h->cross_power_channel_and_time_avg[stokes])
+            oskar_mem_add(h->cross_power_channel_and_time_avg[stokes],
+                    h->cross_power_channel_and_time_avg[stokes],
+                    d->cross_power_cpu[stokes][i_active], chunk_sources,
+                    status);
+
+        /* Write time-averaged data. */
+        if (i_time == h->num_time_steps - 1)
+        {
+            if (h->auto_power_time_avg[stokes])
+            {
+                oskar_mem_scale_real(h->auto_power_time_avg[stokes],
+                        1.0 / h->num_time_steps, status);
+                write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
+                        h->auto_power_time_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(h->auto_power_time_avg[stokes],
                         status);
-            if (d->cross_power_time_avg[stokes])
-                oskar_mem_add(d->cross_power_time_avg[stokes],
-                        d->cross_power_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active], chunk_sources,
+            }
+            if (h->cross_power_time_avg[stokes])
+            {
+                oskar_mem_scale_real(h->cross_power_time_avg[stokes],
+                        1.0 / h->num_time_steps, status);
+                write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
+                        h->cross_power_time_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(h->cross_power_time_avg[stokes],
                         status);
+            }
+        }
 
-            /* Channel-average the data if required. */
-            if (d->auto_power_channel_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_avg[stokes],
-                        d->auto_power_channel_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active], chunk_size,
-                        status);
-            if (d->cross_power_channel_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_avg[stokes],
-                        d->cross_power_channel_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active], chunk_sources,
+        /* Write channel-averaged data. */
+        if (i_channel == h->num_channels - 1)
+        {
+            if (h->auto_power_channel_avg[stokes])
+            {
+                oskar_mem_scale_real(h->auto_power_channel_avg[stokes],
+                        1.0 / h->num_channels, status);
+                write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
+                        h->auto_power_channel_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(h->auto_power_channel_avg[stokes],
                         status);
+            }
+            if (h->cross_power_channel_avg[stokes])
+            {
+                oskar_mem_scale_real(h->cross_power_channel_avg[stokes],
+                        1.0 / h->num_channels, status);
+                write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
+                        h->cross_power_channel_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        h->cross_power_channel_avg[stokes], status);
+            }
+        }
 
-            /* Channel- and time-average the data if required. */
-            if (d->auto_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active], chunk_size,
-                        status);
-            if (d->cross_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active], chunk_sources,
+        /* Write channel- and time-averaged data. */
+        if ((i_time == h->num_time_steps - 1) &&
+                (i_channel == h->num_channels - 1))
+        {
+            if (h->auto_power_channel_and_time_avg[stokes])
+            {
+                oskar_mem_scale_real(
+                        h->auto_power_channel_and_time_avg[stokes],
+                        1.0 / (h->num_channels * h->num_time_steps), status);
+                write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        h->auto_power_channel_and_time_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        h->auto_power_channel_and_time_avg[stokes],
                         status);
-
-            /* Write time-averaged data. */
-            if (i_time == h->num_time_steps - 1)
+            }
+            if (h->cross_power_channel_and_time_avg[stokes])
             {
-                if (d->auto_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->auto_power_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->cross_power_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->cross_power_time_avg[stokes],
-                            status);
-                }
+                oskar_mem_scale_real(
+                        h->cross_power_channel_and_time_avg[stokes],
+                        1.0 / (h->num_channels * h->num_time_steps), status);
+                write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        h->cross_power_channel_and_time_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        h->cross_power_channel_and_time_avg[stokes],
+                        status);
             }
+        }
+    }
+    oskar_timer_pause(h->tmr_write);
+}
+
+
+static void write_averaged_chunks(oskar_BeamPattern* h, const DeviceData* d,
+        int i_chunk, int i_time, int i_channel, int i_active, int* status)
+{
+    int chunk_sources, chunk_size, stokes, ta, ca, num_outer, last;
+    oskar_Mem *avg, *in;
+
+    /* Get the size of the chunk. */
+    chunk_sources = h->max_chunk_size;
+    if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
+        chunk_sources = h->num_pixels - i_chunk * h->max_chunk_size;
+    chunk_size = chunk_sources * h->num_active_stations;
+
+    /* Work out which axes have been averaged on the device. */
+    ta = h->device_time_average;
+    ca = h->device_channel_average;
+    num_outer = ta ? h->num_channels : h->num_time_steps;
+    last = ta ? (i_channel == num_outer - 1) : (i_time == num_outer - 1);
 
-            /* Write channel-averaged data. */
-            if (i_channel == h->num_channels - 1)
+    /* Loop over Stokes parameters. */
+    for (stokes = 0; stokes < 4; ++stokes)
+    {
+        /* Write the averaged data. */
+        write_pixels(h, i_chunk, ta ? 0 : i_time, ca ? 0 : i_channel,
+                chunk_sources, ca, ta, d->auto_power_cpu[stokes][i_active],
+                AUTO_POWER_DATA, stokes, status);
+        write_pixels(h, i_chunk, ta ? 0 : i_time, ca ? 0 : i_channel,
+                chunk_sources, ca, ta, d->cross_power_cpu[stokes][i_active],
+                CROSS_POWER_DATA, stokes, status);
+        if (ta && ca) continue;
+
+        /* Average the single-axis averages over the other axis,
+         * if required. */
+        avg = h->auto_power_channel_and_time_avg[stokes];
+        in = d->auto_power_cpu[stokes][i_active];
+        if (avg)
+        {
+            oskar_mem_add(avg, avg, in, chunk_size, status);
+            if (last)
             {
-                if (d->auto_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_channel_avg[stokes],
-                            1.0 / h->num_channels, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->auto_power_channel_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_channel_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_channel_avg[stokes],
-                            1.0 / h->num_channels, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->cross_power_channel_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_avg[stokes], status);
-                }
+                oskar_mem_scale_real(avg, 1.0 / num_outer, status);
+                write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        avg, AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(avg, status);
             }
-
-            /* Write channel- and time-averaged data. */
-            if ((i_time == h->num_time_steps - 1) &&
-                    (i_channel == h->num_channels - 1))
+        }
+        avg = h->cross_power_channel_and_time_avg[stokes];
+        in = d->cross_power_cpu[stokes][i_active];
+        if (avg)
+        {
+            oskar_mem_add(avg, avg, in, chunk_sources, status);
+            if (last)
             {
-                if (d->auto_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps), status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->auto_power_channel_and_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps), status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->cross_power_channel_and_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            status);
-                }
+                oskar_mem_scale_real(avg, 1.0 / num_outer, status);
+                write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        avg, CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(avg, status);
             }
         }
     }
-    oskar_timer_pause(h->tmr_write);
 }
 
 
@@ -544,17 +742,18 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
     num_pol = h->pol_mode == OSKAR_POL_MODE_FULL ? 4 : 1;
     for (i = 0; i < h->num_data_products; ++i)
     {
-        fitsfile* f;
         FILE* t;
         int dp, stokes_out, i_station, off;
 
         /* Get data product info. */
-        f          = h->data_products[i].fits_file;
         t          = h->data_products[i].text_file;
         dp         = h->data_products[i].type;
         stokes_out = h->data_products[i].stokes_out;
         i_station  = h->data_products[i].i_station;
 
+        /* Statistics are written by update_statistics(). */
+        if (h->data_products[i].stats[0]) continue;
+
         /* Check averaging mode and polarisation input type. */
         if (h->data_products[i].time_average != time_average ||
                 h->data_products[i].channel_average != channel_average ||
@@ -567,14 +766,15 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
             oskar_Mem* station_data;
             station_data = oskar_mem_create_alias(in, i_station * num_pix,
                     num_pix, status);
-            oskar_mem_save_ascii(t, 1, num_pix, status, station_data);
+            oskar_async_writer_save_ascii(h->writer, t, station_data,
+                    num_pix, status);
             oskar_mem_free(station_data, status);
             continue;
         }
         if (dp == CROSS_POWER_RAW_COMPLEX &&
                 chunk_desc == CROSS_POWER_DATA && t)
         {
-            oskar_mem_save_ascii(t, 1, num_pix, status, in);
+            oskar_async_writer_save_ascii(h->writer, t, in, num_pix, status);
             continue;
         }
 
@@ -635,20 +835,129 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         }
         else continue;
 
-        /* Check for FITS file. */
-        if (f && h->width && h->height)
+        /* Write the pixel data. */
+        write_to_files(h, &h->data_products[i], i_chunk, i_time, i_channel,
+                num_pix, status);
+    }
+}
+
+
+static void write_to_files(oskar_BeamPattern* h, const DataProduct* p,
+        int i_chunk, int i_time, int i_channel, int num_pix, int* status)
+{
+    /* Check for FITS file. */
+    if (p->fits_file && h->width && h->height)
+    {
+        long firstpix[4];
+        firstpix[0] = 1 + (i_chunk * h->max_chunk_size) % h->width;
+        firstpix[1] = 1 + (i_chunk * h->max_chunk_size) / h->width;
+        firstpix[2] = 1 + i_channel;
+        firstpix[3] = 1 + i_time;
+        oskar_async_writer_fits_write_pix(h->writer, p->fits_file,
+                (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT), 4,
+                firstpix, num_pix, oskar_mem_void_const(h->pix), 1, status);
+    }
+
+    /* Check for text file. */
+    if (p->text_file)
+        oskar_async_writer_save_ascii(h->writer, p->text_file, h->pix,
+                num_pix, status);
+}
+
+
+static void update_statistics(oskar_BeamPattern* h, int i_chunk, int i_step,
+        int num_pix, const oskar_Mem* in, int chunk_desc, int stokes_in,
+        int* status)
+{
+    int i, j, dp, off, n, num_steps;
+    if (!in) return;
+
+    /* Loop over data products. */
+    n = i_step + 1;
+    num_steps = h->num_time_steps * h->num_channels;
+    for (i = 0; i < h->num_data_products; ++i)
+    {
+        DataProduct* p = &h->data_products[i];
+        dp = p->type;
+        if (p->stokes_in != stokes_in) continue;
+        if (chunk_desc == AUTO_POWER_DATA &&
+                dp != AUTO_POWER_VARIANCE && dp != AUTO_POWER_MAX)
+            continue;
+        if (chunk_desc == CROSS_POWER_DATA &&
+                dp != CROSS_POWER_AMP_VARIANCE && dp != CROSS_POWER_AMP_MAX)
+            continue;
+
+        /* Convert power to pixel amplitude. */
+        off = (chunk_desc == AUTO_POWER_DATA) ? p->i_station * num_pix : 0;
+        if (p->stokes_out == I)
+            power_to_stokes_I(in, off, num_pix, h->ctemp, status);
+        else if (p->stokes_out == Q)
+            power_to_stokes_Q(in, off, num_pix, h->ctemp, status);
+        else if (p->stokes_out == U)
+            power_to_stokes_U(in, off, num_pix, h->ctemp, status);
+        else if (p->stokes_out == V)
+            power_to_stokes_V(in, off, num_pix, h->ctemp, status);
+        else continue;
+        complex_to_amp(h->ctemp, 0, 1, num_pix, h->pix, status);
+
+        /* Update the running statistics for each pixel, using
+         * Welford's algorithm for the variance. */
+        if (h->prec == OSKAR_SINGLE)
+        {
+            float *x, *s0, *s1, d;
+            x = oskar_mem_float(h->pix, status);
+            s0 = oskar_mem_float(p->stats[0], status);
+            s1 = oskar_mem_float(p->stats[1], status);
+            if (dp == AUTO_POWER_MAX || dp == CROSS_POWER_AMP_MAX)
+            {
+                for (j = 0; j < num_pix; ++j)
+                    if (n == 1 || x[j] > s0[j]) s0[j] = x[j];
+                if (n == num_steps)
+                    for (j = 0; j < num_pix; ++j) x[j] = s0[j];
+            }
+            else
+            {
+                for (j = 0; j < num_pix; ++j)
+                {
+                    if (n == 1) s0[j] = s1[j] = 0.0f;
+                    d = x[j] - s0[j];
+                    s0[j] += d / n;
+                    s1[j] += d * (x[j] - s0[j]);
+                }
+                if (n == num_steps)
+                    for (j = 0; j < num_pix; ++j) x[j] = s1[j] / n;
+            }
+        }
+        else
         {
-            long firstpix[4];
-            firstpix[0] = 1 + (i_chunk * h->max_chunk_size) % h->width;
-            firstpix[1] = 1 + (i_chunk * h->max_chunk_size) / h->width;
-            firstpix[2] = 1 + i_channel;
-            firstpix[3] = 1 + i_time;
-            fits_write_pix(f, (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
-                    firstpix, num_pix, oskar_mem_void(h->pix), status);
+            double *x, *s0, *s1, d;
+            x = oskar_mem_double(h->pix, status);
+            s0 = oskar_mem_double(p->stats[0], status);
+            s1 = oskar_mem_double(p->stats[1], status);
+            if (dp == AUTO_POWER_MAX || dp == CROSS_POWER_AMP_MAX)
+            {
+                for (j = 0; j < num_pix; ++j)
+                    if (n == 1 || x[j] > s0[j]) s0[j] = x[j];
+                if (n == num_steps)
+                    for (j = 0; j < num_pix; ++j) x[j] = s0[j];
+            }
+            else
+            {
+                for (j = 0; j < num_pix; ++j)
+                {
+                    if (n == 1) s0[j] = s1[j] = 0.0;
+                    d = x[j] - s0[j];
+                    s0[j] += d / n;
+                    s1[j] += d * (x[j] - s0[j]);
+                }
+                if (n == num_steps)
+                    for (j = 0; j < num_pix; ++j) x[j] = s1[j] / n;
+            }
         }
 
-        /* Check for text file. */
-        if (t) oskar_mem_save_ascii(t, 1, num_pix, status, h->pix);
+        /* Write the statistics after the last step in the chunk. */
+        if (n == num_steps)
+            write_to_files(h, p, i_chunk, 0, 0, num_pix, status);
     }
 }
 
@@ -920,6 +1229,7 @@ static void power_to_stokes_V(const oskar_Mem* power_in, const int offset,
 static void record_timing(oskar_BeamPattern* h)
 {
     int i;
+    size_t cache_hits = 0, cache_misses = 0;
     oskar_log_section(h->log, 'M', "Simulation timing");
     oskar_log_value(h->log, 'M', 0, "Total wall time", "%.3f s",
             oskar_timer_elapsed(h->tmr_sim));
@@ -930,6 +1240,17 @@ static void record_timing(oskar_BeamPattern* h)
     }
     oskar_log_value(h->log, 'M', 0, "Write", "%.3f s",
             oskar_timer_elapsed(h->tmr_write));
+    for (i = 0; i < h->num_devices; ++i)
+    {
+        if (!h->d[i].work) continue;
+        cache_hits += oskar_station_work_child_beam_cache_hits(h->d[i].work);
+        cache_misses +=
+                oskar_station_work_child_beam_cache_misses(h->d[i].work);
+    }
+    if (cache_hits + cache_misses > 0)
+        oskar_log_value(h->log, 'M', 0, "Tile beam cache",
+                "%lu hits, %lu misses", (unsigned long) cache_hits,
+                (unsigned long) cache_misses);
 }
 
 
@@ -55,16 +55,12 @@ void oskar_beam_pattern_free_device_data(oskar_BeamPattern* h, int* status)
         {
             oskar_mem_free(d->auto_power_cpu[j][0], status);
             oskar_mem_free(d->auto_power_cpu[j][1], status);
-            oskar_mem_free(d->auto_power_time_avg[j], status);
-            oskar_mem_free(d->auto_power_channel_avg[j], status);
-            oskar_mem_free(d->auto_power_channel_and_time_avg[j], status);
             oskar_mem_free(d->auto_power[j], status);
             oskar_mem_free(d->cross_power_cpu[j][0], status);
             oskar_mem_free(d->cross_power_cpu[j][1], status);
-            oskar_mem_free(d->cross_power_time_avg[j], status);
-            oskar_mem_free(d->cross_power_channel_avg[j], status);
-            oskar_mem_free(d->cross_power_channel_and_time_avg[j], status);
             oskar_mem_free(d->cross_power[j], status);
+            oskar_mem_free(d->auto_power_avg[j], status);
+            oskar_mem_free(d->cross_power_avg[j], status);
         }
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->work, status);
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "beam_pattern/oskar_beam_pattern.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+#include "math/oskar_cmath.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+static oskar_Telescope* create_telescope(int* status)
+{
+    const int num_elements = 16;
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            1, status);
+    oskar_Mem *x, *err;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1, status);
+    err = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1, status);
+    oskar_mem_clear_contents(x, status);
+    oskar_mem_clear_contents(err, status);
+    oskar_telescope_set_station_coords_enu(tel, 116.7 * M_PI / 180.0,
+            -26.7 * M_PI / 180.0, 0.0, 1, x, x, x, err, err, err, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(err, status);
+    oskar_Station* s = oskar_telescope_station(tel, 0);
+    oskar_station_resize(s, num_elements, status);
+    oskar_station_resize_element_types(s, 1, status);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        double xyz[] = {0.0, 0.0, 0.0};
+        xyz[0] = 1.5 * (i % 4 - 1.5);
+        xyz[1] = 1.5 * (i / 4 - 1.5);
+        oskar_station_set_element_coords(s, i, xyz, xyz, status);
+    }
+    oskar_element_set_element_type(oskar_station_element(s, 0),
+            "Isotropic", status);
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_pol_mode(tel, "Scalar", status);
+    oskar_telescope_set_station_type(tel, "Aperture array", status);
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            0.0, -30.0 * M_PI / 180.0);
+    return tel;
+}
+
+static void run_beam_pattern(oskar_Telescope* tel, const char* root,
+        char single_axis, int num_times, int num_channels, int statistics,
+        int* status)
+{
+    oskar_BeamPattern* h = oskar_beam_pattern_create(OSKAR_DOUBLE, status);
+    oskar_beam_pattern_set_gpus(h, 0, 0, status);
+    oskar_beam_pattern_set_num_devices(h, 1);
+    oskar_beam_pattern_set_observation_time(h, 58000.0, 600.0, num_times);
+    oskar_beam_pattern_set_observation_frequency(h, 100e6, 1e6,
+            num_channels);
+    oskar_beam_pattern_set_image_size(h, 8, 8);
+    oskar_beam_pattern_set_image_fov(h, 60.0, 60.0);
+    oskar_beam_pattern_set_max_chunk_size(h, 20);
+    oskar_beam_pattern_set_root_path(h, root);
+    oskar_beam_pattern_set_auto_power_text(h, 1);
+    oskar_beam_pattern_set_separate_time_and_channel(h, 0);
+    oskar_beam_pattern_set_average_single_axis(h, single_axis);
+    oskar_beam_pattern_set_time_and_channel_statistics(h, statistics);
+    oskar_beam_pattern_set_telescope_model(h, tel, status);
+    oskar_beam_pattern_run(h, status);
+    oskar_beam_pattern_free(h, status);
+}
+
+static vector<double> read_pixels(const string& filename)
+{
+    vector<double> values;
+    char line[1024];
+    FILE* f = fopen(filename.c_str(), "r");
+    if (!f) return values;
+    while (fgets(line, sizeof(line), f))
+    {
+        double val = 0.0;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%lf", &val) == 1) values.push_back(val);
+    }
+    fclose(f);
+    return values;
+}
+
+static void check_single_axis_average(char single_axis, int num_times,
+        int num_channels)
+{
+    int status = 0;
+    const int num_pixels = 8 * 8;
+    const string device_root = "temp_test_beam_pattern_device";
+    const string host_root = "temp_test_beam_pattern_host";
+    const string suffix = string(single_axis == 'T' ?
+            "_S0000_TIME_AVG_CHAN_SEP" : "_S0000_TIME_SEP_CHAN_AVG") +
+            "_AUTO_POWER_I_I.txt";
+    oskar_Telescope* tel = create_telescope(&status);
+    ASSERT_EQ(0, status);
+
+    // Average on the compute device, and on the host using per-step data.
+    // (Per-step data are needed for statistics, so this disables device
+    // averaging.)
+    run_beam_pattern(tel, device_root.c_str(), single_axis,
+            num_times, num_channels, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    run_beam_pattern(tel, host_root.c_str(), single_axis,
+            num_times, num_channels, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_telescope_free(tel, &status);
+
+    // Check the averaged data products contain the same values.
+    vector<double> device = read_pixels(device_root + suffix);
+    vector<double> host = read_pixels(host_root + suffix);
+    const int num_outer = single_axis == 'T' ? num_channels : num_times;
+    ASSERT_EQ((size_t) (num_outer * num_pixels), host.size());
+    ASSERT_EQ(host.size(), device.size());
+    for (size_t i = 0; i < host.size(); ++i)
+        EXPECT_NEAR(host[i], device[i], 1e-10 * fabs(host[i]) + 1e-14);
+    remove((device_root + suffix).c_str());
+    remove((host_root + suffix).c_str());
+    remove((host_root +
+            "_S0000_TIME_AVG_CHAN_AVG_AUTO_POWER_VAR_I_I.txt").c_str());
+    remove((host_root +
+            "_S0000_TIME_AVG_CHAN_AVG_AUTO_POWER_MAX_I_I.txt").c_str());
+}
+
+TEST(beam_pattern_averaging, time_average_single_channel)
+{
+    check_single_axis_average('T', 3, 1);
+}
+
+TEST(beam_pattern_averaging, channel_average_single_time)
+{
+    check_single_axis_average('C', 1, 3);
+}
+
+TEST(beam_pattern_averaging, time_average)
+{
+    check_single_axis_average('T', 3, 2);
+}
+
+TEST(beam_pattern_averaging, time_average_single_time)
+{
+    check_single_axis_average('T', 1, 2);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2015, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -67,7 +67,8 @@ enum OSKAR_TAG_GROUPS
     OSKAR_TAG_GROUP_SPLINE_DATA      = 9,
     OSKAR_TAG_GROUP_ELEMENT_DATA     = 10,
     OSKAR_TAG_GROUP_VIS_HEADER       = 11,
-    OSKAR_TAG_GROUP_VIS_BLOCK        = 12
+    OSKAR_TAG_GROUP_VIS_BLOCK        = 12,
+    OSKAR_TAG_GROUP_TELESCOPE        = 13
 };
 
 /* Standard metadata tags. */
@@ -113,7 +114,16 @@ enum OSKAR_BINARY_ERROR_CODES
     OSKAR_ERR_BINARY_TAG_NOT_FOUND         = -115,
     OSKAR_ERR_BINARY_TAG_TOO_LONG          = -116,
     OSKAR_ERR_BINARY_TAG_OUT_OF_RANGE      = -117,
-    OSKAR_ERR_BINARY_CRC_FAIL              = -118
+    OSKAR_ERR_BINARY_CRC_FAIL              = -118,
+    OSKAR_ERR_BINARY_NOT_MAPPED            = -119
+};
+
+/* Options for checking CRC codes when reading. */
+enum OSKAR_BINARY_CRC_CHECK
+{
+    OSKAR_BINARY_CRC_CHECK_NONE            = 0,
+    OSKAR_BINARY_CRC_CHECK_IMMEDIATE       = 1,
+    OSKAR_BINARY_CRC_CHECK_DEFERRED        = 2
 };
 
 #ifdef __cplusplus
@@ -123,6 +133,7 @@ enum OSKAR_BINARY_ERROR_CODES
 #include <binary/oskar_binary_data_types.h>
 #include <binary/oskar_binary_create.h>
 #include <binary/oskar_binary_free.h>
+#include <binary/oskar_binary_map.h>
 #include <binary/oskar_binary_query.h>
 #include <binary/oskar_binary_read.h>
 #include <binary/oskar_binary_write.h>
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,8 +48,13 @@ extern "C" {
  * The handle must be released by calling oskar_binary_free() when it has been
  * finished with.
  *
+ * Mode 'm' opens the file for reading, and also maps it into memory so that
+ * payloads can be accessed without copying using oskar_binary_map().
+ * If the file cannot be mapped, it is read as if opened with mode 'r'.
+ *
  * @param[in] filename    Filename to open.
- * @param[in] mode        Mode: either 'w' (write), or 'r' (read).
+ * @param[in] mode        Mode: 'w' (write), 'a' (append), 'r' (read),
+ *                        or 'm' (read, memory-mapped).
  * @param[in,out] status  Status return code.
  */
 OSKAR_BINARY_EXPORT
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_BINARY_MAP_H_
+#define OSKAR_BINARY_MAP_H_
+
+/**
+ * @file oskar_binary_map.h
+ */
+
+#include <binary/oskar_binary_macros.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Returns true if the binary file is memory-mapped.
+ *
+ * @details
+ * Returns true if the file was opened in mode 'm' and could be mapped
+ * into memory. If mapping failed, the handle works as if opened in mode 'r'.
+ *
+ * @param[in] handle  Binary file handle.
+ */
+OSKAR_BINARY_EXPORT
+int oskar_binary_is_mapped(const oskar_Binary* handle);
+
+/**
+ * @brief Returns a pointer to the payload of a chunk in a mapped file.
+ *
+ * @details
+ * This low-level function returns a pointer to the payload of a chunk in
+ * a memory-mapped binary file, without copying any data.
+ * The mapping is read-only: the data must not be written through
+ * the pointer.
+ *
+ * The chunk is specified by its sequence number in the stream, as returned by
+ * oskar_binary_query() or oskar_binary_query_ext().
+ *
+ * The pointer remains valid until the handle is freed.
+ * The payload is in native byte order, since oskar_binary_create() rejects
+ * files with a different byte order, but it may not be aligned to the size
+ * of its data type: callers should check the alignment before accessing it
+ * through a typed pointer.
+ *
+ * The CRC code of the chunk is checked only if the CRC check mode is
+ * OSKAR_BINARY_CRC_CHECK_IMMEDIATE (the default).
+ *
+ * @param[in,out] handle   Binary file handle, opened with mode 'm'.
+ * @param[in] chunk_index  Sequence index of the chunk's tag in the file.
+ * @param[in,out] status   Status return code.
+ *
+ * @return Pointer to the start of the payload.
+ */
+OSKAR_BINARY_EXPORT
+void* oskar_binary_map_block(oskar_Binary* handle, int chunk_index,
+        int* status);
+
+/**
+ * @brief Returns a pointer to the payload of a standard tag in a mapped file.
+ *
+ * @details
+ * This function returns a pointer to the payload of a standard
+ * tag in a memory-mapped binary file, without copying any data.
+ * See oskar_binary_map_block() for details.
+ *
+ * @param[in,out] handle   Binary file handle, opened with mode 'm'.
+ * @param[in] data_type    Type of the payload.
+ * @param[in] id_group     Tag group identifier.
+ * @param[in] id_tag       Tag identifier.
+ * @param[in] user_index   User-defined index.
+ * @param[out] data_size   If not NULL, the payload size in bytes.
+ * @param[in,out] status   Status return code.
+ *
+ * @return Pointer to the start of the payload.
+ */
+OSKAR_BINARY_EXPORT
+void* oskar_binary_map(oskar_Binary* handle,
+        unsigned char data_type, unsigned char id_group, unsigned char id_tag,
+        int user_index, size_t* data_size, int* status);
+
+/**
+ * @brief Sets when CRC codes are checked on read.
+ *
+ * @details
+ * Sets when CRC codes are checked when reading or mapping chunks:
+ *
+ * - OSKAR_BINARY_CRC_CHECK_IMMEDIATE: Check each chunk as it is read
+ *   (the default).
+ * - OSKAR_BINARY_CRC_CHECK_DEFERRED: Do not check chunks as they are read;
+ *   the caller must instead call oskar_binary_verify(), for example from
+ *   a background thread.
+ * - OSKAR_BINARY_CRC_CHECK_NONE: Do not check CRC codes.
+ *
+ * @param[in,out] handle  Binary file handle.
+ * @param[in] mode        Enumerated CRC check mode.
+ */
+OSKAR_BINARY_EXPORT
+void oskar_binary_set_crc_check(oskar_Binary* handle, int mode);
+
+/**
+ * @brief Checks the CRC codes of all chunks in a binary file.
+ *
+ * @details
+ * This function checks the CRC codes of all chunks in a file opened for
+ * reading, and sets the status code to OSKAR_ERR_BINARY_CRC_FAIL if any
+ * of them do not match.
+ *
+ * If the file is memory-mapped, the handle is not modified, so this
+ * function may be called from a separate thread while other data are
+ * being read. Otherwise, it must not be called concurrently with any other
+ * function using the same handle.
+ *
+ * @param[in,out] handle  Binary file handle.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_BINARY_EXPORT
+void oskar_binary_verify(oskar_Binary* handle, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_BINARY_MAP_H_ */
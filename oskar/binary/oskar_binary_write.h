@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -109,6 +109,28 @@ OSKAR_BINARY_EXPORT
 void oskar_binary_write_int(oskar_Binary* handle, unsigned char id_group,
         unsigned char id_tag, int user_index, int value, int* status);
 
+/**
+ * @brief Writes a padding chunk to align the next payload in the file.
+ *
+ * @details
+ * This function writes a chunk of zero bytes, so that the payload of the
+ * next standard tag written to the stream starts at a file offset that is
+ * a multiple of \p alignment bytes. This allows payloads to be accessed
+ * in place from a memory-mapped file.
+ *
+ * The padding chunk is written as a standard tag containing character data,
+ * which readers should ignore.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] id_group     Tag group identifier of the padding chunk.
+ * @param[in] id_tag       Tag identifier of the padding chunk.
+ * @param[in] alignment    Required alignment in bytes (a power of 2, <= 64).
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_BINARY_EXPORT
+void oskar_binary_write_padding(oskar_Binary* handle, unsigned char id_group,
+        unsigned char id_tag, int alignment, int* status);
+
 /**
  * @brief Writes a block of binary data to an output stream.
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2015, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -76,6 +76,8 @@ enum OSKAR_CRC_TYPE
  * http://dx.doi.org/10.1109/26.231911
  *
  * @param[in,out] type Enumerated CRC type.
+ *
+ * @return A new CRC structure, or NULL if the type is not recognised.
  */
 OSKAR_BINARY_EXPORT
 oskar_CRC* oskar_crc_create(int type);
@@ -104,6 +106,10 @@ void oskar_crc_free(oskar_CRC* data);
  * http://web.archive.org/web/20121011093914/http://www.intel.com/technology/comms/perfnet/download/CRC_generators.pdf
  * http://create.stephan-brumme.com/crc32/
  *
+ * For CRC-32C, the SSE4.2 crc32 instruction is used instead if the CPU
+ * supports it. If OpenMP is available, large blocks are split between
+ * threads, and the results are combined using oskar_crc_combine().
+ *
  * @param[in] crc_data  Pointer to CRC data table, which defines the type.
  * @param[in] crc       CRC code to update.
  * @param[in] data      Pointer to data block to use.
@@ -133,6 +139,43 @@ OSKAR_BINARY_EXPORT
 unsigned long oskar_crc_compute(const oskar_CRC* crc_data, const void* data,
         size_t num_bytes);
 
+/**
+ * @brief
+ * Combines the CRC values of two consecutive blocks of memory.
+ *
+ * @details
+ * Returns the CRC value of the concatenation of two blocks of memory,
+ * given the CRC values of each block (as returned by oskar_crc_compute())
+ * and the length of the second block. This allows CRC values of sub-ranges
+ * of a large block to be computed in parallel.
+ *
+ * @param[in] crc_data   Pointer to CRC data table, which defines the type.
+ * @param[in] crc1       CRC value of the first block.
+ * @param[in] crc2       CRC value of the second block.
+ * @param[in] num_bytes2 Length of the second block in bytes.
+ *
+ * @return The combined CRC value.
+ */
+OSKAR_BINARY_EXPORT
+unsigned long oskar_crc_combine(const oskar_CRC* crc_data,
+        unsigned long crc1, unsigned long crc2, size_t num_bytes2);
+
+/**
+ * @brief
+ * Enables or disables use of CPU instructions for CRC computation.
+ *
+ * @details
+ * Hardware CRC instructions are used by default for CRC-32C if the
+ * CPU supports them. This function can be used to disable them,
+ * for example to compare the results with the lookup-table method.
+ * Enabling them has no effect if they are not supported.
+ *
+ * @param[in,out] crc_data  Pointer to CRC data table.
+ * @param[in] flag          If true, use hardware CRC instructions if possible.
+ */
+OSKAR_BINARY_EXPORT
+void oskar_crc_set_hardware(oskar_CRC* crc_data, int flag);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -192,6 +192,12 @@ struct oskar_Binary
 
     /* Data tables used for CRC computation. */
     oskar_CRC* crc_data;
+    int crc_check;              /* When to check CRC codes on read. */
+
+    /* Memory-mapped file, if opened with mode 'm'. */
+    char* map_data;             /* Start of mapped file, or NULL. */
+    size_t map_size;            /* Size of mapped region in bytes. */
+    void* map_handle;           /* File mapping handle (Windows only). */
 };
 
 #ifndef OSKAR_BINARY_TYPEDEF_
@@ -199,6 +205,12 @@ struct oskar_Binary
 typedef struct oskar_Binary oskar_Binary;
 #endif /* OSKAR_BINARY_TYPEDEF_ */
 
+/* Maps the whole file into memory, or leaves it unmapped on failure. */
+void oskar_binary_map_file(oskar_Binary* handle, const char* filename);
+
+/* Unmaps the file, if it is mapped. */
+void oskar_binary_unmap_file(oskar_Binary* handle);
+
 #ifdef __cplusplus
 }
 #endif
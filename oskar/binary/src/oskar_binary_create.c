@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -54,7 +54,7 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
     int i;
 
     /* Open the file and check or write the header, depending on the mode. */
-    if (mode == 'r')
+    if (mode == 'r' || mode == 'm')
     {
         stream = fopen(filename, "rb");
         if (!stream)
@@ -98,11 +98,15 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
     /* Allocate index and store the stream handle. */
     handle = (oskar_Binary*) malloc(sizeof(oskar_Binary));
     handle->stream = stream;
-    handle->open_mode = mode;
+    handle->open_mode = (mode == 'm') ? 'r' : mode;
     handle->query_search_start = 0;
+    handle->map_data = 0;
+    handle->map_size = 0;
+    handle->map_handle = 0;
 
     /* Create the CRC lookup tables. */
     handle->crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    handle->crc_check = OSKAR_BINARY_CRC_CHECK_IMMEDIATE;
 
     /* Initialise tag index. */
     handle->num_chunks = 0;
@@ -293,6 +297,10 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         handle->num_chunks = i + 1;
     }
 
+    /* Map the file into memory if required, once the index is complete. */
+    if (mode == 'm' && !*status)
+        oskar_binary_map_file(handle, filename);
+
     return handle;
 }
 
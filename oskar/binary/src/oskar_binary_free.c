@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,7 +41,8 @@ void oskar_binary_free(oskar_Binary* handle)
     /* Check if structure exists. */
     if (!handle) return;
 
-    /* Close the file. */
+    /* Unmap and close the file. */
+    oskar_binary_unmap_file(handle);
     if (handle->stream)
         fclose(handle->stream);
 
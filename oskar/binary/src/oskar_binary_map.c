@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "binary/oskar_binary.h"
+#include "binary/private_binary.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_binary_map_file(oskar_Binary* handle, const char* filename)
+{
+#ifdef _WIN32
+    HANDLE file, mapping;
+    LARGE_INTEGER size;
+    void* ptr;
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 ||
+            (unsigned long long) size.QuadPart > (size_t)(-1))
+    {
+        CloseHandle(file);
+        return;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return;
+    ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!ptr)
+    {
+        CloseHandle(mapping);
+        return;
+    }
+    handle->map_handle = mapping;
+    handle->map_size = (size_t) size.QuadPart;
+    handle->map_data = (char*) ptr;
+#else
+    struct stat buf;
+    void* ptr;
+    int fd;
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) return;
+    if (fstat(fd, &buf) != 0 || buf.st_size <= 0)
+    {
+        close(fd);
+        return;
+    }
+
+    /* The mapping is read-only, so the file can never be modified
+     * through it. */
+    ptr = mmap(NULL, (size_t) buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) return;
+    handle->map_size = (size_t) buf.st_size;
+    handle->map_data = (char*) ptr;
+#endif
+}
+
+void oskar_binary_unmap_file(oskar_Binary* handle)
+{
+    if (!handle->map_data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(handle->map_data);
+    CloseHandle((HANDLE) handle->map_handle);
+    handle->map_handle = 0;
+#else
+    munmap(handle->map_data, handle->map_size);
+#endif
+    handle->map_data = 0;
+    handle->map_size = 0;
+}
+
+int oskar_binary_is_mapped(const oskar_Binary* handle)
+{
+    return handle->map_data != 0;
+}
+
+void* oskar_binary_map_block(oskar_Binary* handle, int chunk_index,
+        int* status)
+{
+    char* p;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Check the file is mapped. */
+    if (!handle->map_data)
+    {
+        *status = OSKAR_ERR_BINARY_NOT_MAPPED;
+        return 0;
+    }
+
+    /* Check index is in range. */
+    if (chunk_index < 0 || chunk_index >= handle->num_chunks)
+    {
+        *status = OSKAR_ERR_BINARY_TAG_OUT_OF_RANGE;
+        return 0;
+    }
+
+    /* Check the payload is inside the mapped region. */
+    if ((size_t) handle->payload_offset_bytes[chunk_index] +
+            handle->payload_size_bytes[chunk_index] > handle->map_size)
+    {
+        *status = OSKAR_ERR_BINARY_FILE_INVALID;
+        return 0;
+    }
+    p = handle->map_data + handle->payload_offset_bytes[chunk_index];
+
+    /* Check CRC-32 code, if present and required now. */
+    if (handle->crc[chunk_index] &&
+            handle->crc_check == OSKAR_BINARY_CRC_CHECK_IMMEDIATE)
+    {
+        unsigned long crc;
+        crc = oskar_crc_update(handle->crc_data,
+                handle->crc_header[chunk_index], p,
+                handle->payload_size_bytes[chunk_index]);
+        if (crc != handle->crc[chunk_index])
+        {
+            *status = OSKAR_ERR_BINARY_CRC_FAIL;
+            return 0;
+        }
+    }
+    return p;
+}
+
+void* oskar_binary_map(oskar_Binary* handle,
+        unsigned char data_type, unsigned char id_group, unsigned char id_tag,
+        int user_index, size_t* data_size, int* status)
+{
+    int chunk_index;
+    chunk_index = oskar_binary_query(handle, data_type,
+            id_group, id_tag, user_index, data_size, status);
+    return oskar_binary_map_block(handle, chunk_index, status);
+}
+
+void oskar_binary_set_crc_check(oskar_Binary* handle, int mode)
+{
+    handle->crc_check = mode;
+}
+
+void oskar_binary_verify(oskar_Binary* handle, int* status)
+{
+    int i, crc_check;
+    char* buffer = 0;
+    size_t buffer_size = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check file was opened for reading. */
+    if (handle->open_mode != 'r')
+    {
+        *status = OSKAR_ERR_BINARY_NOT_OPEN_FOR_READ;
+        return;
+    }
+
+    /* If the file is mapped, check the payloads in place. */
+    if (handle->map_data)
+    {
+        for (i = 0; i < handle->num_chunks && !*status; ++i)
+        {
+            const size_t size = handle->payload_size_bytes[i];
+            const long offset = handle->payload_offset_bytes[i];
+            if (!handle->crc[i]) continue;
+            if ((size_t) offset + size > handle->map_size)
+                *status = OSKAR_ERR_BINARY_FILE_INVALID;
+            else if (handle->crc[i] != oskar_crc_update(handle->crc_data,
+                    handle->crc_header[i], handle->map_data + offset, size))
+                *status = OSKAR_ERR_BINARY_CRC_FAIL;
+        }
+        return;
+    }
+
+    /* Otherwise, read each chunk with immediate checking enabled. */
+    crc_check = handle->crc_check;
+    handle->crc_check = OSKAR_BINARY_CRC_CHECK_IMMEDIATE;
+    for (i = 0; i < handle->num_chunks && !*status; ++i)
+    {
+        const size_t size = handle->payload_size_bytes[i];
+        if (!handle->crc[i] || size == 0) continue;
+        if (size > buffer_size)
+        {
+            char* t = (char*) realloc(buffer, size);
+            if (!t)
+            {
+                *status = OSKAR_ERR_BINARY_MEMORY_NOT_ALLOCATED;
+                break;
+            }
+            buffer = t;
+            buffer_size = size;
+        }
+        oskar_binary_read_block(handle, i, buffer_size, buffer, status);
+    }
+    handle->crc_check = crc_check;
+    free(buffer);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -69,31 +69,48 @@ void oskar_binary_read_block(oskar_Binary* handle,
         return;
     }
 
-    /* Copy the data out of the stream. */
-    if (fseek(handle->stream,
-            handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
+    /* Copy the data out of the mapped file, if possible. */
+    if (handle->map_data)
     {
-        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
-        return;
+        if ((size_t) handle->payload_offset_bytes[chunk_index] +
+                handle->payload_size_bytes[chunk_index] > handle->map_size)
+        {
+            *status = OSKAR_ERR_BINARY_FILE_INVALID;
+            return;
+        }
+        memcpy(data, handle->map_data +
+                handle->payload_offset_bytes[chunk_index],
+                handle->payload_size_bytes[chunk_index]);
     }
-
-    /* Read the data in chunks of 2^29 bytes (512 MB). */
-    /* This works around a bug in some versions of fread() which are
-     * limited to reading a maximum of 2 GB at once. */
-    for (p = (char*)data, bytes = handle->payload_size_bytes[chunk_index];
-            bytes > 0; p += chunk_size)
+    else
     {
-        if (bytes < chunk_size) chunk_size = bytes;
-        if (fread(p, 1, chunk_size, handle->stream) != chunk_size)
+        /* Copy the data out of the stream. */
+        if (fseek(handle->stream,
+                handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
         {
-            *status = OSKAR_ERR_BINARY_READ_FAIL;
+            *status = OSKAR_ERR_BINARY_SEEK_FAIL;
             return;
         }
-        bytes -= chunk_size;
+
+        /* Read the data in chunks of 2^29 bytes (512 MB). */
+        /* This works around a bug in some versions of fread() which are
+         * limited to reading a maximum of 2 GB at once. */
+        for (p = (char*)data, bytes = handle->payload_size_bytes[chunk_index];
+                bytes > 0; p += chunk_size)
+        {
+            if (bytes < chunk_size) chunk_size = bytes;
+            if (fread(p, 1, chunk_size, handle->stream) != chunk_size)
+            {
+                *status = OSKAR_ERR_BINARY_READ_FAIL;
+                return;
+            }
+            bytes -= chunk_size;
+        }
     }
 
-    /* Check CRC-32 code, if present. */
-    if (handle->crc[chunk_index])
+    /* Check CRC-32 code, if present and required now. */
+    if (handle->crc[chunk_index] &&
+            handle->crc_check == OSKAR_BINARY_CRC_CHECK_IMMEDIATE)
     {
         unsigned long crc;
         crc = handle->crc_header[chunk_index];
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -149,6 +149,41 @@ void oskar_binary_write_int(oskar_Binary* handle, unsigned char id_group,
             user_index, sizeof(int), &value, status);
 }
 
+void oskar_binary_write_padding(oskar_Binary* handle, unsigned char id_group,
+        unsigned char id_tag, int alignment, int* status)
+{
+    const char zeros[64] = {0};
+    long offset;
+    size_t chunk_size, padding;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check the alignment is a power of 2 within range. */
+    if (alignment < 1 || alignment > (int) sizeof(zeros) ||
+            (alignment & (alignment - 1)) != 0)
+    {
+        *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+        return;
+    }
+
+    /* Get the current offset. */
+    offset = ftell(handle->stream);
+    if (offset < 0)
+    {
+        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
+        return;
+    }
+
+    /* The padding chunk holds a tag, the padding and a CRC code.
+     * The next payload will then start after another tag. */
+    chunk_size = sizeof(oskar_BinaryTag) + 4;
+    padding = (size_t) offset + chunk_size + sizeof(oskar_BinaryTag);
+    padding = (alignment - (padding % alignment)) % alignment;
+    oskar_binary_write(handle, OSKAR_CHAR, id_group, id_tag, 0,
+            padding, zeros, status);
+}
+
 void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
         const char* name_group, const char* name_tag, int user_index,
         size_t data_size, const void* data, int* status)
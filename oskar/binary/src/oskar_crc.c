@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,6 +31,25 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Use SSE4.2 instructions for CRC-32C on x86-64, if the CPU has them. */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OSKAR_CRC_HW
+#define OSKAR_CRC_HW_TARGET __attribute__((target("sse4.2")))
+#include <nmmintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define OSKAR_CRC_HW
+#define OSKAR_CRC_HW_TARGET
+#include <intrin.h>
+#include <nmmintrin.h>
+#endif
+
+/* Minimum number of bytes for each thread to make parallel CRCs worthwhile. */
+#define MIN_BYTES_PER_THREAD (1 << 22)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -38,6 +57,7 @@ extern "C" {
 struct oskar_CRC
 {
     int type;
+    int use_hw;
     unsigned long poly;
     unsigned long init;
     unsigned long xorout;
@@ -48,6 +68,12 @@ struct oskar_CRC
 typedef struct oskar_CRC oskar_CRC;
 #endif /* OSKAR_CRC_TYPEDEF_ */
 
+static int oskar_crc_hw_available(void);
+static unsigned long oskar_crc_shift(const oskar_CRC* crc_data,
+        unsigned long crc, size_t num_bytes);
+static unsigned long oskar_crc_update_reg(const oskar_CRC* crc_data,
+        unsigned long crc, const unsigned char* byte, size_t num_bytes);
+
 
 oskar_CRC* oskar_crc_create(int type)
 {
@@ -56,7 +82,9 @@ oskar_CRC* oskar_crc_create(int type)
 
     /* Create the data structure. */
     d = (oskar_CRC*) malloc(sizeof(oskar_CRC));
+    if (!d) return 0;
     d->type = type;
+    d->use_hw = 0;
 
     /* Set the polynomial, initial and post-XOR values based on type. */
     /* Always need the "reversed" form of the polynomial for this generator. */
@@ -77,6 +105,12 @@ oskar_CRC* oskar_crc_create(int type)
         d->poly   = 0x82f63b78uL;
         d->init   = 0xFFFFFFFFuL;
         d->xorout = 0xFFFFFFFFuL;
+        d->use_hw = oskar_crc_hw_available();
+    }
+    else
+    {
+        free(d);
+        return 0;
     }
 
     /* Fill the lookup table, starting with standard Sarwate CRC algorithm. */
@@ -112,15 +146,89 @@ void oskar_crc_free(oskar_CRC* data)
     free(data);
 }
 
+void oskar_crc_set_hardware(oskar_CRC* crc_data, int flag)
+{
+    crc_data->use_hw = flag && crc_data->type == OSKAR_CRC_32C &&
+            oskar_crc_hw_available();
+}
+
 unsigned long oskar_crc_update(const oskar_CRC* crc_data, unsigned long crc,
         const void* data, size_t num_bytes)
 {
-    const unsigned char* byte;
+    const unsigned char* byte = (const unsigned char*) data;
+#ifdef _OPENMP
+    int i, num_threads = 1;
+    unsigned long* part = 0;
+#endif
+
+    /* Convert from the final CRC value to the register value. */
+    if (crc != crc_data->init) crc ^= crc_data->xorout;
+
+#ifdef _OPENMP
+    /* Split large blocks between threads, and combine the results.
+     * If the buffer for the partial results can't be allocated,
+     * fall through to the serial path. */
+    if (!omp_in_parallel())
+    {
+        num_threads = omp_get_max_threads();
+        if ((size_t) num_threads > num_bytes / MIN_BYTES_PER_THREAD)
+            num_threads = (int) (num_bytes / MIN_BYTES_PER_THREAD);
+    }
+    if (num_threads > 1)
+        part = (unsigned long*) malloc(num_threads * sizeof(unsigned long));
+    if (part)
+    {
+        const size_t part_size = num_bytes / num_threads;
+#pragma omp parallel for num_threads(num_threads)
+        for (i = 0; i < num_threads; ++i)
+        {
+            const size_t start = i * part_size;
+            const size_t size = (i == num_threads - 1) ?
+                    num_bytes - start : part_size;
+            const unsigned long reg = (i == 0) ? crc : 0;
+            part[i] = oskar_crc_update_reg(crc_data, reg, byte + start, size);
+        }
+
+        /* Each part was started from zero, so shift the running value
+         * past it and add the part. */
+        crc = part[0];
+        for (i = 1; i < num_threads; ++i)
+        {
+            const size_t size = (i == num_threads - 1) ?
+                    num_bytes - i * part_size : part_size;
+            crc = oskar_crc_shift(crc_data, crc, size) ^ part[i];
+        }
+        free(part);
+        return crc ^ crc_data->xorout;
+    }
+#endif
+
+    crc = oskar_crc_update_reg(crc_data, crc, byte, num_bytes);
+    return crc ^ crc_data->xorout;
+}
+
+unsigned long oskar_crc_compute(const oskar_CRC* crc_data, const void* data,
+        size_t num_bytes)
+{
+    return oskar_crc_update(crc_data, crc_data->init, data, num_bytes);
+}
+
+unsigned long oskar_crc_combine(const oskar_CRC* crc_data,
+        unsigned long crc1, unsigned long crc2, size_t num_bytes2)
+{
+    /* The register value of the second block includes the effect of the
+     * initial value, which must be replaced by the first register value. */
+    return oskar_crc_shift(crc_data,
+            crc1 ^ crc_data->xorout ^ crc_data->init, num_bytes2) ^ crc2;
+}
+
+/* Updates the CRC register value using the lookup tables. */
+static unsigned long oskar_crc_update_sw(const oskar_CRC* crc_data,
+        unsigned long crc, const unsigned char* byte, size_t num_bytes)
+{
     unsigned char d[8];
 
     /* Use 8-byte chunks. */
-    if (crc != crc_data->init) crc ^= crc_data->xorout;
-    byte = (const unsigned char*) data;
     if (oskar_endian() == OSKAR_LITTLE_ENDIAN)
     {
         while (num_bytes >= 8)
@@ -160,13 +268,120 @@ unsigned long oskar_crc_update(const oskar_CRC* crc_data, unsigned long crc,
     while (num_bytes--)
         crc = (crc >> 8) ^ crc_data->t[0][(crc & 0xFF) ^ *byte++];
 
-    return crc ^ crc_data->xorout;
+    return crc;
 }
 
-unsigned long oskar_crc_compute(const oskar_CRC* crc_data, const void* data,
-        size_t num_bytes)
+#ifdef OSKAR_CRC_HW
+/* Updates the CRC-32C register value using the SSE4.2 crc32 instruction. */
+OSKAR_CRC_HW_TARGET
+static unsigned long oskar_crc_update_hw(unsigned long crc,
+        const unsigned char* byte, size_t num_bytes)
 {
-    return oskar_crc_update(crc_data, crc_data->init, data, num_bytes);
+    unsigned long long c = crc;
+
+    /* Do leading bytes individually to align the rest. */
+    while (num_bytes > 0 && ((size_t) byte & 7) != 0)
+    {
+        c = _mm_crc32_u8((unsigned int) c, *byte++);
+        num_bytes--;
+    }
+
+    /* Use 8-byte chunks. */
+    while (num_bytes >= 8)
+    {
+        unsigned long long d;
+        memcpy(&d, byte, 8);
+        c = _mm_crc32_u64(c, d);
+        byte += 8;
+        num_bytes -= 8;
+    }
+
+    /* Do remaining bytes individually. */
+    while (num_bytes--)
+        c = _mm_crc32_u8((unsigned int) c, *byte++);
+    return (unsigned long) c;
+}
+#endif
+
+/* Updates the CRC register value using the fastest available method. */
+static unsigned long oskar_crc_update_reg(const oskar_CRC* crc_data,
+        unsigned long crc, const unsigned char* byte, size_t num_bytes)
+{
+#ifdef OSKAR_CRC_HW
+    if (crc_data->use_hw)
+        return oskar_crc_update_hw(crc, byte, num_bytes);
+#endif
+    return oskar_crc_update_sw(crc_data, crc, byte, num_bytes);
+}
+
+/* Returns true if the CPU supports the SSE4.2 crc32 instruction. */
+static int oskar_crc_hw_available(void)
+{
+#if defined(OSKAR_CRC_HW) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#elif defined(OSKAR_CRC_HW)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return 0;
+#endif
+}
+
+/* Multiplies a vector by a 32x32 matrix over GF(2). */
+static unsigned long gf2_matrix_times(const unsigned long* mat,
+        unsigned long vec)
+{
+    unsigned long sum = 0;
+    while (vec)
+    {
+        if (vec & 1) sum ^= *mat;
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+/* Squares a 32x32 matrix over GF(2). */
+static void gf2_matrix_square(unsigned long* square, const unsigned long* mat)
+{
+    int n;
+    for (n = 0; n < 32; n++)
+        square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+/* Returns the CRC register value after appending the given number of
+ * zero bytes, using repeated squaring of the operator for one zero bit,
+ * as in zlib's crc32_combine(). */
+static unsigned long oskar_crc_shift(const oskar_CRC* crc_data,
+        unsigned long crc, size_t num_bytes)
+{
+    int n;
+    unsigned long row, even[32], odd[32];
+    if (num_bytes == 0) return crc;
+
+    /* Operator for one zero bit. */
+    odd[0] = crc_data->poly;
+    for (n = 1, row = 1; n < 32; n++, row <<= 1)
+        odd[n] = row;
+
+    /* Operators for two and four zero bits. */
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+
+    /* Apply the operator for each set bit of the byte count. */
+    do
+    {
+        gf2_matrix_square(even, odd);
+        if (num_bytes & 1) crc = gf2_matrix_times(even, crc);
+        num_bytes >>= 1;
+        if (num_bytes == 0) break;
+        gf2_matrix_square(odd, even);
+        if (num_bytes & 1) crc = gf2_matrix_times(odd, crc);
+        num_bytes >>= 1;
+    } while (num_bytes != 0);
+    return crc;
 }
 
 #ifdef __cplusplus
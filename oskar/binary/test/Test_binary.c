@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -176,6 +176,59 @@ int main(void)
     oskar_binary_free(h);
     ASSERT_INT_EQ(0, status);
 
+    /* Map the file and check the arrays can be used in place. */
+    h = oskar_binary_create(filename, 'm', &status);
+    ASSERT_INT_EQ(0, status);
+    ASSERT_INT_EQ(1, oskar_binary_is_mapped(h));
+    {
+        const char* p;
+        size_t size = 0;
+        p = (const char*) oskar_binary_map(h, OSKAR_INT,
+                14, 5, 6, &size, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ((int) size_int, (int) size);
+        for (i = 0; i < num_elements_int; ++i)
+        {
+            memcpy(&a, p + i * sizeof(int), sizeof(int));
+            ASSERT_INT_EQ(i * 75, a);
+        }
+        oskar_binary_read_int(h, 12, 0, 0, &b, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ(b1, b);
+        oskar_binary_verify(h, &status);
+        ASSERT_INT_EQ(0, status);
+    }
+    oskar_binary_free(h);
+
+    /* Append a padded array, and check it is aligned when mapped. */
+    h = oskar_binary_create(filename, 'a', &status);
+    oskar_binary_write_padding(h, 0, 0, (int) sizeof(double), &status);
+    ASSERT_INT_EQ(0, status);
+    {
+        data_double = calloc(num_elements_double, sizeof(double));
+        for (i = 0; i < num_elements_double; ++i)
+            data_double[i] = i * 0.5;
+        oskar_binary_write(h, OSKAR_DOUBLE,
+                5, 1, 0, size_double, &data_double[0], &status);
+        ASSERT_INT_EQ(0, status);
+        free(data_double);
+    }
+    oskar_binary_free(h);
+    h = oskar_binary_create(filename, 'm', &status);
+    oskar_binary_set_crc_check(h, OSKAR_BINARY_CRC_CHECK_DEFERRED);
+    {
+        const double* p;
+        p = (const double*) oskar_binary_map(h, OSKAR_DOUBLE,
+                5, 1, 0, 0, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ(0, (int) ((size_t) p % sizeof(double)));
+        for (i = 0; i < num_elements_double; ++i)
+            ASSERT_DOUBLE_EQ(i * 0.5, p[i]);
+        oskar_binary_verify(h, &status);
+        ASSERT_INT_EQ(0, status);
+    }
+    oskar_binary_free(h);
+
     /* Remove the file. */
     remove(filename);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -691,6 +691,21 @@ void oskar_imager_set_time_max_utc(oskar_Imager* h, double time_max_mjd_utc);
 OSKAR_EXPORT
 void oskar_imager_set_time_min_utc(oskar_Imager* h, double time_min_mjd_utc);
 
+/**
+ * @brief
+ * Sets the name of the trace file to write.
+ *
+ * @details
+ * If set, a trace of oskar_imager_run() is recorded and written to this file
+ * when it completes. See oskar_trace.h for details.
+ * If not set, the environment variable OSKAR_TRACE_FILE is used instead.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     filename   Path of trace file.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_trace_file(oskar_Imager* h, const char* filename);
+
 /**
  * @brief
  * Sets the maximum UV baseline length to image.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -63,7 +63,7 @@ struct oskar_Imager
     int generate_w_kernels_on_gpu, set_cellsize, set_fov, weighting;
     int num_files, scale_norm_with_num_input_files;
     char direction_type, kernel_type;
-    char **input_files, *input_root, *output_root, *ms_column;
+    char **input_files, *input_root, *output_root, *ms_column, *trace_file;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
     double uv_filter_min, uv_filter_max;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
@@ -76,8 +76,10 @@ struct oskar_Imager
     /* State. */
     int status, i_block;
     oskar_Mutex* mutex;
+    oskar_ThreadPool* pool;
 
     /* Scratch data. */
+    oskar_MemArena* arena;
     oskar_Mem *uu_im, *vv_im, *ww_im, *vis_im, *weight_im, *time_im;
     oskar_Mem *uu_tmp, *vv_tmp, *ww_tmp, *stokes, *weight_tmp;
     int coords_only; /* Set if doing a first pass for uniform weighting. */
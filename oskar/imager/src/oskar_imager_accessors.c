@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -583,6 +583,20 @@ void oskar_imager_set_time_min_utc(oskar_Imager* h, double time_min_mjd_utc)
 }
 
 
+void oskar_imager_set_trace_file(oskar_Imager* h, const char* filename)
+{
+    int len = 0;
+    free(h->trace_file);
+    h->trace_file = 0;
+    if (filename) len = (int) strlen(filename);
+    if (len > 0)
+    {
+        h->trace_file = calloc(1 + len, 1);
+        strcpy(h->trace_file, filename);
+    }
+}
+
+
 void oskar_imager_set_uv_filter_max(oskar_Imager* h, double max_wavelength)
 {
     h->uv_filter_max = max_wavelength;
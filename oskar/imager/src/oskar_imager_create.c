@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,6 +42,7 @@ extern "C" {
 oskar_Imager* oskar_imager_create(int imager_precision, int* status)
 {
     oskar_Imager* h = 0;
+    int cat;
     h = (oskar_Imager*) calloc(1, sizeof(oskar_Imager));
 
     /* Create timers. */
@@ -50,10 +51,16 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->tmr_init = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_read = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_set_trace_name(h->tmr_grid_finalise, "Finalise grid");
+    oskar_timer_set_trace_name(h->tmr_grid_update, "Update grid");
+    oskar_timer_set_trace_name(h->tmr_init, "Initialise imager");
+    oskar_timer_set_trace_name(h->tmr_read, "Read visibilities");
+    oskar_timer_set_trace_name(h->tmr_write, "Write image");
     h->mutex = oskar_mutex_create();
 
     /* Create scratch arrays. */
     h->imager_prec = imager_precision;
+    cat = oskar_mem_set_category(OSKAR_MEM_CAT_VIS);
     h->uu_im       = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->vv_im       = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->ww_im       = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
@@ -65,6 +72,7 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->weight_im   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->weight_tmp  = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->time_im     = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    oskar_mem_set_category(cat);
 
     /* Check data type. */
     if (imager_precision != OSKAR_SINGLE && imager_precision != OSKAR_DOUBLE)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -40,7 +40,9 @@
 #include "math/oskar_fftpack_cfft_f.h"
 #include "math/oskar_fftphase.h"
 #include "mem/oskar_mem.h"
+#include "utility/oskar_async_writer.h"
 #include "utility/oskar_device_utils.h"
+#include "utility/oskar_mem_log.h"
 #include "utility/oskar_timer.h"
 
 #include <fitsio.h>
@@ -52,8 +54,8 @@
 extern "C" {
 #endif
 
-static void write_plane(oskar_Imager* h, oskar_Mem* plane,
-        int c, int p, int* status);
+static void write_plane(oskar_Imager* h, oskar_AsyncWriter* writer,
+        const oskar_Mem* plane, int c, int p, int* status);
 
 
 void oskar_imager_finalise(oskar_Imager* h,
@@ -62,6 +64,7 @@ void oskar_imager_finalise(oskar_Imager* h,
 {
     size_t n;
     int c, p, i, plane_size;
+    oskar_AsyncWriter* writer;
     if (*status || !h->planes) return;
 
     /* Adjust normalisation if required. */
@@ -87,33 +90,38 @@ void oskar_imager_finalise(oskar_Imager* h,
         n = h->image_size * h->image_size;
         plane_size = oskar_imager_plane_size(h);
 
-        /* Finalise all the planes. */
-        for (i = 0; i < h->num_planes; ++i)
-        {
-            oskar_imager_finalise_plane(h, h->planes[i],
-                    h->plane_norm[i], status);
-            oskar_imager_trim_image(h, h->planes[i],
-                    plane_size, h->image_size, status);
-        }
-
-        /* Copy images to output image planes if given. */
-        for (i = 0; (i < h->num_planes) && (i < num_output_images); ++i)
+        /* Finalise all the planes, and write each one to file in the
+         * background as soon as it is ready. Planes for each polarisation
+         * are in different files, so they can be written concurrently. */
+        writer = oskar_async_writer_create(h->num_im_pols, 0);
+        for (c = 0, i = 0; c < h->num_im_channels; ++c)
         {
-            if (!(output_images[i]))
-                output_images[i] = oskar_mem_create(h->imager_prec,
-                        OSKAR_CPU, n, status);
-            if (oskar_mem_length(output_images[i]) < n)
-                oskar_mem_realloc(output_images[i], n, status);
-            memcpy(oskar_mem_void(output_images[i]),
-                    oskar_mem_void_const(h->planes[i]),
-                    n * oskar_mem_element_size(h->imager_prec));
+            for (p = 0; p < h->num_im_pols; ++p, ++i)
+            {
+                oskar_imager_finalise_plane(h, h->planes[i],
+                        h->plane_norm[i], status);
+                oskar_imager_trim_image(h, h->planes[i],
+                        plane_size, h->image_size, status);
+
+                /* Copy image to output image plane if given. */
+                if (i < num_output_images && !*status)
+                {
+                    if (!(output_images[i]))
+                        output_images[i] = oskar_mem_create(h->imager_prec,
+                                OSKAR_CPU, n, status);
+                    if (oskar_mem_length(output_images[i]) < n)
+                        oskar_mem_realloc(output_images[i], n, status);
+                    memcpy(oskar_mem_void(output_images[i]),
+                            oskar_mem_void_const(h->planes[i]),
+                            n * oskar_mem_element_size(h->imager_prec));
+                }
+                write_plane(h, writer, h->planes[i], c, p, status);
+            }
         }
 
-        /* Write to files if required. */
+        /* Wait for writes to finish. */
         oskar_timer_resume(h->tmr_write);
-        for (c = 0, i = 0; c < h->num_im_channels; ++c)
-            for (p = 0; p < h->num_im_pols; ++p, ++i)
-                write_plane(h, h->planes[i], c, p, status);
+        oskar_async_writer_free(writer, status);
         oskar_timer_pause(h->tmr_write);
     }
 
@@ -134,6 +142,8 @@ void oskar_imager_finalise(oskar_Imager* h,
                 oskar_timer_elapsed(h->tmr_read));
         oskar_log_value(h->log, 'M', 0, "Write image data", "%.3f s",
                 oskar_timer_elapsed(h->tmr_write));
+        oskar_log_section(h->log, 'M', "Imager memory usage");
+        oskar_mem_log(h->log, 0);
         oskar_log_section(h->log, 'M', "Imaging complete");
         if (h->output_root)
         {
@@ -356,8 +366,8 @@ void oskar_imager_trim_image(oskar_Imager* h, oskar_Mem* plane,
 }
 
 
-void write_plane(oskar_Imager* h, oskar_Mem* plane,
-        int c, int p, int* status)
+void write_plane(oskar_Imager* h, oskar_AsyncWriter* writer,
+        const oskar_Mem* plane, int c, int p, int* status)
 {
     int datatype, num_pixels;
     long firstpix[3];
@@ -368,8 +378,8 @@ void write_plane(oskar_Imager* h, oskar_Mem* plane,
     firstpix[1] = 1;
     firstpix[2] = 1 + c;
     num_pixels = h->image_size * h->image_size;
-    fits_write_pix(h->fits_file[p], datatype, firstpix, num_pixels,
-            oskar_mem_void(plane), status);
+    oskar_async_writer_fits_write_pix(writer, h->fits_file[p], datatype,
+            3, firstpix, num_pixels, oskar_mem_void_const(plane), 0, status);
 }
 
 
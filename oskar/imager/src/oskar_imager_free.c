@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -60,6 +60,8 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     oskar_timer_free(h->tmr_read);
     oskar_timer_free(h->tmr_write);
     oskar_mutex_free(h->mutex);
+    oskar_thread_pool_free(h->pool);
+    oskar_mem_arena_free(h->arena);
 
     oskar_imager_free_device_data(h, status);
     for (i = 0; i < h->num_gpus; ++i)
@@ -72,6 +74,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     free(h->input_files);
     free(h->input_root);
     free(h->output_root);
+    free(h->trace_file);
     free(h->ms_column);
     free(h->gpu_ids);
     free(h->d);
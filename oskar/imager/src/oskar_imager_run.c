@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,6 +31,7 @@
 #include "imager/private_imager_read_data.h"
 #include "imager/private_imager_read_dims.h"
 #include "imager/oskar_imager.h"
+#include "utility/oskar_trace.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -40,10 +41,26 @@ extern "C" {
 #endif
 
 static int oskar_imager_is_ms(const char* filename);
+static void run_files(oskar_Imager* h,
+        int num_output_images, oskar_Mem** output_images,
+        int num_output_grids, oskar_Mem** output_grids, int* status);
 
 void oskar_imager_run(oskar_Imager* h,
         int num_output_images, oskar_Mem** output_images,
         int num_output_grids, oskar_Mem** output_grids, int* status)
+{
+    int tracing;
+    if (*status) return;
+    tracing = oskar_trace_start(h->trace_file);
+    run_files(h, num_output_images, output_images,
+            num_output_grids, output_grids, status);
+    if (tracing) oskar_trace_stop(h->log, status);
+}
+
+
+static void run_files(oskar_Imager* h,
+        int num_output_images, oskar_Mem** output_images,
+        int num_output_grids, oskar_Mem** output_grids, int* status)
 {
     int i, num_files, percent_done = 0, percent_next = 10;
     const char* filename;
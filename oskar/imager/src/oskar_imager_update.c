@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -94,24 +94,27 @@ void oskar_imager_update_from_block(oskar_Imager* h,
             oskar_vis_header_phase_centre_ra_deg(header),
             oskar_vis_header_phase_centre_dec_deg(header));
 
-    /* Create scratch arrays. Weights are all 1. */
+    /* Get scratch arrays from the arena, which is reset for each block.
+     * Weights are all 1. */
+    if (!h->arena) h->arena = oskar_mem_arena_create();
+    oskar_mem_arena_reset(h->arena);
     if (num_channels > 1)
-        scratch = oskar_mem_create(oskar_mem_type(
+        scratch = oskar_mem_arena_get(h->arena, oskar_mem_type(
                 oskar_vis_block_cross_correlations_const(block)),
-                OSKAR_CPU, num_rows * num_channels, status);
+                num_rows * num_channels, status);
     if (!weight)
     {
         size_t weight_len = num_rows * num_pols;
-        weight = oskar_mem_create(oskar_mem_precision(
+        weight = oskar_mem_arena_get(h->arena, oskar_mem_precision(
                 oskar_vis_block_cross_correlations_const(block)),
-                OSKAR_CPU, weight_len, status);
+                weight_len, status);
         oskar_mem_set_value_real(weight, 1.0, 0, weight_len, status);
         weight_ptr = weight;
     }
 
     /* Fill in the time centroid values. */
-    time_centroid = oskar_mem_create(OSKAR_DOUBLE,
-            OSKAR_CPU, num_rows, status);
+    time_centroid = oskar_mem_arena_get(h->arena, OSKAR_DOUBLE,
+            num_rows, status);
     time_slice = oskar_mem_create_alias(0, 0, 0, status);
     for (t = 0; t < num_times; ++t)
     {
@@ -167,9 +170,6 @@ void oskar_imager_update_from_block(oskar_Imager* h,
             oskar_vis_block_baseline_vv_metres_const(block),
             oskar_vis_block_baseline_ww_metres_const(block),
             ptr, weight_ptr, time_centroid, status);
-    oskar_mem_free(weight, status);
-    oskar_mem_free(scratch, status);
-    oskar_mem_free(time_centroid, status);
     oskar_mem_free(time_slice, status);
 }
 
@@ -511,8 +511,9 @@ void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
 
 void oskar_imager_allocate_planes(oskar_Imager* h, int *status)
 {
-    int i, plane_size;
+    int i, cat, plane_size;
     if (*status) return;
+    cat = oskar_mem_set_category(OSKAR_MEM_CAT_IMAGE);
 
     /* Allocate empty weights grids if required. */
     if (!h->weights_grids)
@@ -526,7 +527,11 @@ void oskar_imager_allocate_planes(oskar_Imager* h, int *status)
 
     /* If we're in coordinate-only mode, or the planes already exist,
      * there's nothing more to do here. */
-    if (h->coords_only || h->planes) return;
+    if (h->coords_only || h->planes)
+    {
+        oskar_mem_set_category(cat);
+        return;
+    }
 
     /* Allocate the image or visibility planes. */
     h->planes = (oskar_Mem**) calloc(h->num_planes, sizeof(oskar_Mem*));
@@ -535,6 +540,7 @@ void oskar_imager_allocate_planes(oskar_Imager* h, int *status)
     for (i = 0; i < h->num_planes; ++i)
         h->planes[i] = oskar_mem_create(oskar_imager_plane_type(h), OSKAR_CPU,
                 plane_size * plane_size, status);
+    oskar_mem_set_category(cat);
 
     /* Create FITS files for the planes if required. */
     oskar_imager_create_fits_files(h, status);
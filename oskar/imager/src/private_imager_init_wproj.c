@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -108,7 +108,7 @@ static void compact_kernels(const int num_w_planes, const int* support,
 void oskar_imager_init_wproj(oskar_Imager* h, int* status)
 {
     size_t max_mem_bytes, max_bytes_per_plane, element_size, copy_len;
-    int i, iw, ix, iy, *supp, new_conv_size, oversample, prec;
+    int i, cat, iw, ix, iy, *supp, new_conv_size, oversample, prec;
     int conv_size, conv_size_half, inner, nearest;
     double l_max, max_conv_size, max_uvw, max_val, sampling, sum;
     double *maxes;
@@ -161,6 +161,7 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_support, status);
     oskar_mem_free(h->w_kernels_compact, status);
     oskar_mem_free(h->w_kernel_start, status);
+    cat = oskar_mem_set_category(OSKAR_MEM_CAT_W_KERNELS);
     h->w_support = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
             h->num_w_planes, status);
     h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
@@ -170,6 +171,7 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
             ((size_t) conv_size_half), status);
     h->w_kernels_compact = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
             0, status);
+    oskar_mem_set_category(cat);
     supp = oskar_mem_int(h->w_support, status);
     element_size = oskar_mem_element_size(oskar_mem_type(h->w_kernels));
     if (*status) return;
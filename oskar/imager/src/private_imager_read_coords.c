@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -168,7 +168,7 @@ void oskar_imager_read_coords_vis(oskar_Imager* h, const char* filename,
     if (*status) return;
 
     /* Read the header. */
-    vis_file = oskar_binary_create(filename, 'r', status);
+    vis_file = oskar_binary_create(filename, 'm', status);
     header = oskar_vis_header_read(vis_file, status);
     if (*status)
     {
@@ -242,11 +242,11 @@ void oskar_imager_read_coords_vis(oskar_Imager* h, const char* filename,
         }
 
         /* Read the baseline coordinates. */
-        oskar_binary_read_mem(vis_file, uu, OSKAR_TAG_GROUP_VIS_BLOCK,
+        oskar_binary_map_mem(vis_file, uu, OSKAR_TAG_GROUP_VIS_BLOCK,
                 OSKAR_VIS_BLOCK_TAG_BASELINE_UU, i_block, status);
-        oskar_binary_read_mem(vis_file, vv, OSKAR_TAG_GROUP_VIS_BLOCK,
+        oskar_binary_map_mem(vis_file, vv, OSKAR_TAG_GROUP_VIS_BLOCK,
                 OSKAR_VIS_BLOCK_TAG_BASELINE_VV, i_block, status);
-        oskar_binary_read_mem(vis_file, ww, OSKAR_TAG_GROUP_VIS_BLOCK,
+        oskar_binary_map_mem(vis_file, ww, OSKAR_TAG_GROUP_VIS_BLOCK,
                 OSKAR_VIS_BLOCK_TAG_BASELINE_WW, i_block, status);
 
         /* Update the imager with the data. */
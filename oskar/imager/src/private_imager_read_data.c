@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -175,12 +175,13 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
     oskar_VisHeader* header;
     oskar_Mem *weight, *time_centroid, *time_slice, *scratch = 0, *ptr;
     int max_times_per_block, tags_per_block, i_block, num_blocks;
+    int sel_start_chan = 0, sel_end_chan = -1;
     int num_times_tot, num_channels_tot, num_stations, num_baselines, num_pols;
     double time_start_mjd, time_inc_sec;
     if (*status) return;
 
     /* Read the header. */
-    vis_file = oskar_binary_create(filename, 'r', status);
+    vis_file = oskar_binary_create(filename, 'm', status);
     header = oskar_vis_header_read(vis_file, status);
     if (*status)
     {
@@ -188,6 +189,10 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
         oskar_binary_free(vis_file);
         return;
     }
+
+    /* If the file is mapped, visibility blocks will be aliased rather than
+     * copied. The CRC code of each chunk is still checked as it is mapped,
+     * so corrupt data are rejected before they are gridded. */
     max_times_per_block = oskar_vis_header_max_times_per_block(header);
     tags_per_block = oskar_vis_header_num_tags_per_block(header);
     num_times_tot = oskar_vis_header_num_times_total(header);
@@ -208,6 +213,25 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
             oskar_vis_header_phase_centre_ra_deg(header),
             oskar_vis_header_phase_centre_dec_deg(header));
 
+    /* Find the range of channels needed, so that only those are read
+     * if the amplitudes are stored in chunks. */
+    if (h->num_sel_freqs > 0 && oskar_vis_header_freq_inc_hz(header) != 0.0)
+    {
+        int i, c;
+        const double f0 = oskar_vis_header_freq_start_hz(header);
+        const double df = oskar_vis_header_freq_inc_hz(header);
+        sel_start_chan = num_channels_tot - 1;
+        sel_end_chan = 0;
+        for (i = 0; i < h->num_sel_freqs; ++i)
+        {
+            c = (int) round((h->sel_freqs[i] - f0) / df);
+            if (c < sel_start_chan) sel_start_chan = c;
+            if (c > sel_end_chan) sel_end_chan = c;
+        }
+        if (sel_start_chan < 0) sel_start_chan = 0;
+        if (sel_end_chan >= num_channels_tot) sel_end_chan = -1;
+    }
+
     /* Create scratch arrays. Weights are all 1. */
     time_centroid = oskar_mem_create(OSKAR_DOUBLE,
             OSKAR_CPU, num_baselines * max_times_per_block, status);
@@ -231,7 +255,8 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
         oskar_timer_resume(h->tmr_read);
         oskar_binary_set_query_search_start(vis_file,
                 i_block * tags_per_block, status);
-        oskar_vis_block_read(block, header, vis_file, i_block, status);
+        oskar_vis_block_read_channels(block, header, vis_file, i_block,
+                sel_start_chan, sel_end_chan, status);
         start_time   = oskar_vis_block_start_time_index(block);
         start_chan   = oskar_vis_block_start_channel_index(block);
         num_times    = oskar_vis_block_num_times(block);
@@ -302,6 +327,8 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
             *percent_next = 10 + 10 * (*percent_done / 10);
         }
     }
+    if (*status == OSKAR_ERR_BINARY_CRC_FAIL)
+        oskar_log_error(h->log, "CRC check failed for file '%s'", filename);
     oskar_mem_free(scratch, status);
     oskar_mem_free(weight, status);
     oskar_mem_free(time_centroid, status);
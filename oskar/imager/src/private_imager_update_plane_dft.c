@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,7 +44,7 @@
 extern "C" {
 #endif
 
-static void* run_blocks(void* arg);
+static void run_blocks(void* arg);
 
 struct ThreadArgs
 {
@@ -60,7 +60,7 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
         double* plane_norm, int* status)
 {
     size_t i, num_pixels, num_threads;
-    oskar_Thread** threads = 0;
+    oskar_TaskGroup* group = 0;
     ThreadArgs* args = 0;
     if (*status) return;
 
@@ -89,8 +89,12 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
             oskar_mem_copy(h->d[i].ww, ww, status);
     }
 
-    /* Set up worker threads. */
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    /* Set up the tasks, one for each device. */
+    if (oskar_thread_pool_num_threads(h->pool) != (int) num_threads)
+    {
+        oskar_thread_pool_free(h->pool);
+        h->pool = oskar_thread_pool_create((int) num_threads);
+    }
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -103,18 +107,13 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     /* Set status code. */
     h->status = *status;
 
-    /* Start the worker threads. */
+    /* Run the tasks using the thread pool, and wait for them to finish. */
     h->i_block = 0;
+    group = oskar_task_group_create(h->pool);
     for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
-
-    /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+        oskar_thread_pool_submit(h->pool, group, run_blocks,
+                (void*)&args[i], (int) i);
+    oskar_task_group_free(group);
     free(args);
 
     /* Get status code. */
@@ -135,7 +134,7 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     }
 }
 
-static void* run_blocks(void* arg)
+static void run_blocks(void* arg)
 {
     oskar_Imager* h;
     oskar_Mem *t, *plane;
@@ -218,7 +217,6 @@ static void* run_blocks(void* arg)
         oskar_mem_add(t, t, d->block_cpu, block_size, status);
     }
     oskar_mem_free(t, status);
-    return 0;
 }
 
 #ifdef __cplusplus
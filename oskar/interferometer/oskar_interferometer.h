@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -59,6 +59,29 @@ int oskar_interferometer_coords_only(const oskar_Interferometer* h);
 OSKAR_EXPORT
 oskar_Interferometer* oskar_interferometer_create(int precision, int* status);
 
+/**
+ * @brief
+ * Estimates the peak memory needed by the simulation.
+ *
+ * @details
+ * Estimates the peak amount of memory that will be held by arrays when
+ * the simulation runs, from the current settings and the sizes of the
+ * telescope and sky models, before any per-device memory is allocated.
+ * This includes the sky model chunks, the visibility blocks, and the
+ * Jones matrices and station work arrays for each device, but not the
+ * telescope model copies or memory used by third-party libraries.
+ *
+ * The telescope model must have been set before calling this function.
+ *
+ * @param[in] h               Handle to simulator.
+ * @param[out] host_bytes     Estimated host memory, in bytes.
+ * @param[out] device_bytes   Estimated memory on each GPU, in bytes.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_estimate_memory(const oskar_Interferometer* h,
+        size_t* host_bytes, size_t* device_bytes, int* status);
+
 OSKAR_EXPORT
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         int block_index, int* status);
@@ -91,6 +114,10 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 OSKAR_EXPORT
 void oskar_interferometer_run(oskar_Interferometer* h, int* status);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_chunk_cutoff_radius(oskar_Interferometer* h,
+        double radius_deg);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status);
@@ -124,6 +151,9 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
 OSKAR_EXPORT
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_num_ms_files(oskar_Interferometer* h, int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels);
@@ -148,6 +178,9 @@ OSKAR_EXPORT
 void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
         const oskar_Sky* sky, int* status);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_sort_sky(oskar_Interferometer* h, int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         const oskar_Telescope* model, int* status);
@@ -156,6 +189,31 @@ OSKAR_EXPORT
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy);
 
+/**
+ * @brief
+ * Sets the name of the trace file to write.
+ *
+ * @details
+ * If set, a trace of the simulation is recorded and written to this file
+ * when the run completes. See oskar_trace.h for details.
+ * If not set, the environment variable OSKAR_TRACE_FILE is used instead.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_trace_file(oskar_Interferometer* h,
+        const char* filename);
+
+/**
+ * @brief
+ * Sets the storage layout and compression of the OSKAR visibility file.
+ *
+ * @details
+ * See oskar_vis_header_set_chunking() for details of the parameters.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_vis_compression(oskar_Interferometer* h,
+        int compression, int mantissa_bits, int channels_per_chunk,
+        int baselines_per_chunk);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value);
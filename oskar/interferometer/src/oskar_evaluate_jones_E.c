@@ -83,7 +83,9 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
     }
     else
     {
-        /* Different stations. */
+        /* Different stations, which may share child station beams. */
+        oskar_station_work_child_beam_cache_begin(work,
+                oskar_telescope_allow_station_beam_duplication(tel));
         for (i = 0; i < num_stations; ++i)
         {
             const oskar_Station* station;
@@ -94,6 +96,7 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
                     oskar_telescope_phase_centre_dec_rad(tel),
                     station, work, time_index, frequency_hz, gast, status);
         }
+        oskar_station_work_child_beam_cache_end(work);
     }
     oskar_mem_free(E_st, status);
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -45,8 +45,10 @@
 #include "utility/oskar_device_utils.h"
 #include "utility/oskar_get_memory_usage.h"
 #include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_mem_log.h"
 #include "utility/oskar_thread.h"
 #include "utility/oskar_timer.h"
+#include "utility/oskar_trace.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_block_write_ms.h"
 #include "vis/oskar_vis_header.h"
@@ -80,6 +82,7 @@ struct DeviceData
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
     oskar_Jones *J, *R, *E, *K, *Z;
     oskar_StationWork* station_work;
+    int num_skipped;            /* Number of work units skipped. */
 
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent filling vis blocks. */
@@ -99,25 +102,31 @@ struct oskar_Interferometer
     int prec, num_devices, num_gpus, *gpu_ids, num_channels, num_time_steps;
     int max_sources_per_chunk, max_times_per_block;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only;
+    int coords_only, sort_sky, num_ms_files;
+    int vis_compression, vis_compression_bits;
+    int vis_chunk_channels, vis_chunk_baselines;
+    double chunk_cutoff_rad;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
-    char correlation_type, *vis_name, *ms_name, *settings_path;
+    char correlation_type, *vis_name, *ms_name, *settings_path, *trace_file;
 
     /* State. */
     int init_sky, work_unit_index, status;
     oskar_Mutex* mutex;
-    oskar_Barrier* barrier;
+    oskar_ThreadPool* pool;
 
     /* Sky model and telescope model. */
     int num_sources_total, num_sky_chunks;
     oskar_Sky** sky_chunks;
+    double* chunk_caps; /* Bounding cap (x, y, z, radius) of each chunk. */
     oskar_Telescope* tel;
 
     /* Output data and file handles. */
     oskar_Log* log;
     oskar_VisHeader* header;
-    oskar_MeasurementSet* ms;
+    int num_ms;
+    oskar_MeasurementSet** ms; /* One per channel range. */
+    oskar_ThreadPool* ms_pool; /* Persistent writers for channel ranges. */
     oskar_Binary* vis;
     oskar_Mem* temp;
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
@@ -137,11 +146,21 @@ typedef struct oskar_Interferometer oskar_Interferometer;
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int time_index_simulation, int* status);
+static int chunk_is_visible(const oskar_Interferometer* h, int i_chunk,
+        double gast);
 static void free_device_data(oskar_Interferometer* h, int* status);
 static void set_up_device_data(oskar_Interferometer* h, int* status);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
 static void record_timing(oskar_Interferometer* h);
 static unsigned int disp_width(unsigned int value);
+#ifndef OSKAR_NO_MS
+static int num_ms_parts(const oskar_Interferometer* h);
+static char* ms_part_name(const oskar_Interferometer* h, int part);
+static void ms_part_range(const oskar_Interferometer* h, int part,
+        int* start_channel, int* num_channels);
+static void write_ms(oskar_Interferometer* h, const oskar_VisBlock* block,
+        int* status);
+#endif
 static void system_mem_log(oskar_Log* log);
 
 
@@ -213,9 +232,9 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->prec      = precision;
     h->tmr_sim   = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_set_trace_name(h->tmr_write, "Write block");
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
-    h->barrier   = oskar_barrier_create(0);
 
     /* Set sensible defaults. */
     h->max_sources_per_chunk = 16384;
@@ -225,10 +244,65 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     oskar_interferometer_set_horizon_clip(h, 1);
     oskar_interferometer_set_source_flux_range(h, -DBL_MAX, DBL_MAX);
     oskar_interferometer_set_max_times_per_block(h, 10);
+    oskar_interferometer_set_num_ms_files(h, 1);
     return h;
 }
 
 
+void oskar_interferometer_estimate_memory(const oskar_Interferometer* h,
+        size_t* host_bytes, size_t* device_bytes, int* status)
+{
+    int i, num_devices;
+    size_t num_stations, num_baselines, num_src, num_times, num_channels;
+    size_t prec, vis_size, vis_block, sky_chunk, jones, work, per_device;
+    *host_bytes = 0;
+    *device_bytes = 0;
+    if (*status) return;
+    if (!h->tel)
+    {
+        *status = OSKAR_ERR_SETTINGS_TELESCOPE;
+        return;
+    }
+
+    /* Get dimensions. */
+    num_stations  = (size_t) oskar_telescope_num_stations(h->tel);
+    num_baselines = num_stations * (num_stations - 1) / 2;
+    num_src       = (size_t) h->max_sources_per_chunk;
+    num_times     = (size_t) h->max_times_per_block;
+    num_channels  = (size_t) h->num_channels;
+    prec          = (h->prec == OSKAR_DOUBLE) ? 8 : 4;
+    vis_size      = 2 * prec;
+    if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
+        vis_size *= 4;
+
+    /* Sizes of the arrays held for each device: the visibility block
+     * (amplitudes and baseline coordinates), the sky chunk and its clipped
+     * copy (18 arrays per source), the Jones matrices, and the station
+     * beam work arrays (including element weights). */
+    vis_block = num_times * num_channels * (num_baselines + num_stations) *
+            vis_size + 3 * num_times * num_baselines * prec;
+    sky_chunk = 2 * 18 * num_src * prec;
+    jones = num_stations * num_src * (2 * vis_size + 2 * prec);
+    if (vis_size == 8 * prec)
+        jones += num_stations * num_src * vis_size;
+    work = num_src * (2 * vis_size + 7 * prec + 8) + 3 * num_stations * prec +
+            (size_t) oskar_telescope_max_station_size(h->tel) * 2 * prec;
+    per_device = vis_block + sky_chunk + jones + work;
+
+    /* Add up the totals. Each device also has two blocks on the host. */
+    num_devices = h->num_devices < h->num_gpus ? h->num_gpus : h->num_devices;
+    *host_bytes = (size_t) h->num_sources_total * 18 * prec;
+    for (i = 0; i < num_devices; ++i)
+    {
+        *host_bytes += 2 * vis_block;
+        if (i < h->num_gpus)
+            *device_bytes = per_device;
+        else
+            *host_bytes += per_device;
+    }
+}
+
+
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         int block_index, int* status)
 {
@@ -314,12 +388,14 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
     oskar_mutex_free(h->mutex);
-    oskar_barrier_free(h->barrier);
+    oskar_thread_pool_free(h->pool);
     free(h->sky_chunks);
+    free(h->chunk_caps);
     free(h->gpu_ids);
     free(h->vis_name);
     free(h->ms_name);
     free(h->settings_path);
+    free(h->trace_file);
     free(h->d);
     free(h);
 }
@@ -348,13 +424,21 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
 {
     free_device_data(h, status);
     oskar_binary_free(h->vis);
-    oskar_vis_header_free(h->header, status);
 #ifndef OSKAR_NO_MS
-    oskar_ms_close(h->ms);
+    {
+        int i;
+        oskar_thread_pool_free(h->ms_pool);
+        for (i = 0; i < h->num_ms; ++i)
+            oskar_ms_close(h->ms[i]);
+    }
 #endif
+    oskar_vis_header_free(h->header, status);
+    free(h->ms);
+    h->num_ms = 0;
     h->vis = 0;
     h->header = 0;
     h->ms = 0;
+    h->ms_pool = 0;
 }
 
 
@@ -415,6 +499,7 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     {
         oskar_Sky* sky;
         int i_work_unit, i_chunk, i_time, i_channel, sim_time_idx;
+        double gast, mjd;
 
         oskar_mutex_lock(h->mutex);
         i_work_unit = (h->work_unit_index)++;
@@ -425,6 +510,15 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         i_chunk      = i_work_unit / num_times_block;
         i_time       = i_work_unit - i_chunk * num_times_block;
         sim_time_idx = time_index_start + i_time;
+        mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
+        gast = oskar_convert_mjd_to_gast_fast(mjd);
+
+        /* Skip the chunk if it cannot contribute at this time. */
+        if (!chunk_is_visible(h, i_chunk, gast))
+        {
+            d->num_skipped++;
+            continue;
+        }
 
         /* Copy sky chunk to device only if different from the previous one. */
         if (i_chunk != d->previous_chunk_index)
@@ -438,9 +532,6 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         /* Apply horizon clip if required. */
         if (h->apply_horizon_clip)
         {
-            double gast, mjd;
-            mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
-            gast = oskar_convert_mjd_to_gast_fast(mjd);
             oskar_timer_resume(d->tmr_clip);
             oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
                     d->station_work, status);
@@ -475,80 +566,105 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 }
 
 
-struct ThreadArgs
+struct TaskArgs
 {
     oskar_Interferometer* h;
-    int num_threads, thread_id;
+    int block_index, device_id;
 };
-typedef struct ThreadArgs ThreadArgs;
+typedef struct TaskArgs TaskArgs;
 
-static void* run_blocks(void* arg)
+static void sim_task(void* arg)
 {
-    oskar_Interferometer* h;
-    int b, thread_id, device_id, num_blocks, num_threads, *status;
-
-    /* Get thread function arguments. */
-    h = ((ThreadArgs*)arg)->h;
-    num_threads = ((ThreadArgs*)arg)->num_threads;
-    thread_id = ((ThreadArgs*)arg)->thread_id;
-    device_id = thread_id - 1;
-    status = &(h->status);
-
+    TaskArgs* a = (TaskArgs*) arg;
 #ifdef _OPENMP
     /* Disable any nested parallelism. */
     omp_set_nested(0);
     omp_set_num_threads(1);
 #endif
+    oskar_interferometer_run_block(a->h, a->block_index, a->device_id,
+            &a->h->status);
+}
+
+static void write_task(void* arg)
+{
+    oskar_VisBlock* block;
+    TaskArgs* a = (TaskArgs*) arg;
+#ifdef _OPENMP
+    /* Disable any nested parallelism, but let the writer use any host
+     * cores that are not running compute devices (e.g. for CRC codes). */
+    int num_threads = oskar_get_num_procs() - a->h->num_devices;
+    omp_set_nested(0);
+    omp_set_num_threads(num_threads > 1 ? num_threads : 1);
+#endif
+    oskar_trace_begin("Finalise block");
+    block = oskar_interferometer_finalise_block(a->h, a->block_index,
+            &a->h->status);
+    oskar_trace_end();
+    oskar_interferometer_write_block(a->h, block, a->block_index,
+            &a->h->status);
+}
+
+static void run_blocks(oskar_Interferometer* h, int* status)
+{
+    int b, i, num_blocks;
+    TaskArgs* args;
 
     /* Loop over blocks of observation time, running simulation and file
      * writing one block at a time. Simulation and file output are overlapped
-     * by using double buffering, and a dedicated thread is used for file
-     * output.
+     * by using double buffering, and tasks for each block run in the thread
+     * pool.
      *
-     * Thread 0 is used for file writes.
-     * Threads 1 to n (mapped to compute devices) do the simulation.
+     * Worker 0 is preferred for file writes.
+     * Workers 1 to n (mapped to compute devices) do the simulation.
      *
      * Note that no write is launched on the first loop counter (as no
      * data are ready yet) and no simulation is performed for the last loop
      * counter (which corresponds to the last block + 1) as this iteration
      * simply writes the last block.
      */
+    args = (TaskArgs*) calloc(h->num_devices + 1, sizeof(TaskArgs));
     num_blocks = oskar_interferometer_num_vis_blocks(h);
     for (b = 0; b < num_blocks + 1; ++b)
     {
-        if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
-            oskar_interferometer_run_block(h, b, device_id, status);
-        if (thread_id == 0 && b > 0)
+        oskar_TaskGroup* group = oskar_task_group_create(h->pool);
+        for (i = 0; i < h->num_devices && b < num_blocks; ++i)
         {
-            oskar_VisBlock* block;
-            block = oskar_interferometer_finalise_block(h, b - 1, status);
-            oskar_interferometer_write_block(h, block, b - 1, status);
+            args[i + 1].h = h;
+            args[i + 1].block_index = b;
+            args[i + 1].device_id = i;
+            oskar_thread_pool_submit(h->pool, group, sim_task,
+                    &args[i + 1], i + 1);
         }
-
-        /* Barrier 1: Reset work unit index and print status. */
-        oskar_barrier_wait(h->barrier);
-        if (thread_id == 0)
+        if (b > 0)
         {
-            oskar_interferometer_reset_work_unit_index(h);
-            if (b < num_blocks && h->log && !*status)
-                oskar_log_message(h->log, 'S', 0, "Block %*i/%i (%3.0f%%) "
-                        "complete. Simulation time elapsed: %.3f s",
-                        disp_width(num_blocks), b+1, num_blocks,
-                        100.0 * (b+1) / (double)num_blocks,
-                        oskar_timer_elapsed(h->tmr_sim));
+            args[0].h = h;
+            args[0].block_index = b - 1;
+            oskar_thread_pool_submit(h->pool, group, write_task, &args[0], 0);
         }
 
-        /* Barrier 2: Synchronise before moving to the next block. */
-        oskar_barrier_wait(h->barrier);
+        /* Wait for the block, then reset work unit index and print status. */
+        oskar_trace_begin("Wait for block");
+        oskar_task_group_free(group);
+        oskar_trace_end();
+        oskar_interferometer_reset_work_unit_index(h);
+        if (b < num_blocks && h->log && !*status)
+            oskar_log_message(h->log, 'S', 0, "Block %*i/%i (%3.0f%%) "
+                    "complete. Simulation time elapsed: %.3f s",
+                    disp_width(num_blocks), b+1, num_blocks,
+                    100.0 * (b+1) / (double)num_blocks,
+                    oskar_timer_elapsed(h->tmr_sim));
+        if (b < num_blocks && h->log && !*status)
+            oskar_mem_log_total(h->log, 'S', 1);
     }
-    return 0;
+    free(args);
 }
 
 void oskar_interferometer_run(oskar_Interferometer* h, int* status)
 {
-    int i, num_threads;
-    oskar_Thread** threads = 0;
-    ThreadArgs* args = 0;
+    int tracing;
+#ifdef OSKAR_HAVE_CUDA
+    int i;
+#endif
     if (*status || !h) return;
 
     /* Check the visibilities are going somewhere. */
@@ -568,19 +684,29 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         return;
     }
 
+    /* Estimate memory usage before device memory is allocated. */
+    if (h->log && !*status && h->tel && !h->d[0].tel)
+    {
+        size_t host_bytes = 0, device_bytes = 0;
+        oskar_interferometer_estimate_memory(h,
+                &host_bytes, &device_bytes, status);
+        oskar_log_section(h->log, 'M', "Estimated memory usage");
+        oskar_log_value(h->log, 'M', 0, "Host memory", "%.1f MB",
+                host_bytes / (1024. * 1024.));
+        if (h->num_gpus > 0)
+            oskar_log_value(h->log, 'M', 0, "Memory per GPU", "%.1f MB",
+                    device_bytes / (1024. * 1024.));
+    }
+
     /* Initialise if required. */
     oskar_interferometer_check_init(h, status);
 
-    /* Set up worker threads. */
-    num_threads = h->num_devices + 1;
-    oskar_barrier_set_num_threads(h->barrier, num_threads);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
-    args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
-    for (i = 0; i < num_threads; ++i)
+    /* Set up the thread pool: one worker for file writes,
+     * and one for each compute device. */
+    if (oskar_thread_pool_num_threads(h->pool) != h->num_devices + 1)
     {
-        args[i].h = h;
-        args[i].num_threads = num_threads;
-        args[i].thread_id = i;
+        oskar_thread_pool_free(h->pool);
+        h->pool = oskar_thread_pool_create(h->num_devices + 1);
     }
 
     /* Record memory usage. */
@@ -595,28 +721,20 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         oskar_log_section(h->log, 'M', "Starting simulation...");
     }
 
-    /* Start simulation timer. */
+    /* Start simulation timer, and trace if required. */
     oskar_timer_start(h->tmr_sim);
+    tracing = oskar_trace_start(h->trace_file);
 
     /* Set status code. */
     h->status = *status;
 
-    /* Start the worker threads. */
+    /* Run the simulation. */
     oskar_interferometer_reset_work_unit_index(h);
-    for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
-
-    /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
-    free(args);
+    run_blocks(h, &h->status);
 
-    /* Get status code. */
+    /* Get status code, and write the trace. */
     *status = h->status;
+    if (tracing) oskar_trace_stop(h->log, status);
 
     /* Record memory usage. */
     if (h->log && !*status)
@@ -627,6 +745,7 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
             oskar_cuda_mem_log(h->log, 0, h->gpu_ids[i]);
 #endif
         system_mem_log(h->log);
+        oskar_mem_log(h->log, 0);
     }
 
     /* If there are sources in the simulation and the station beam is not
@@ -667,15 +786,30 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         if (h->vis_name)
             oskar_log_value(h->log, 'M', 1,
                     "OSKAR binary file", "%s", h->vis_name);
+#ifndef OSKAR_NO_MS
         if (h->ms_name)
-            oskar_log_value(h->log, 'M', 1,
-                    "Measurement Set", "%s", h->ms_name);
+        {
+            int i;
+            for (i = 0; i < num_ms_parts(h); ++i)
+            {
+                char* name = ms_part_name(h, i);
+                oskar_log_value(h->log, 'M', 1,
+                        "Measurement Set", "%s", name);
+                free(name);
+            }
+        }
+#endif
 
         /* Write simulation log to the output files. */
         log_data = oskar_log_file_data(h->log, &log_size);
 #ifndef OSKAR_NO_MS
-        if (h->ms)
-            oskar_ms_add_history(h->ms, "OSKAR_LOG", log_data, log_size);
+        {
+            int i;
+            for (i = 0; i < h->num_ms; ++i)
+                if (h->ms[i])
+                    oskar_ms_add_history(h->ms[i], "OSKAR_LOG",
+                            log_data, log_size);
+        }
 #endif
         if (h->vis)
             oskar_binary_write(h->vis, OSKAR_CHAR, OSKAR_TAG_GROUP_RUN,
@@ -688,6 +822,13 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
 }
 
 
+void oskar_interferometer_set_chunk_cutoff_radius(oskar_Interferometer* h,
+        double radius_deg)
+{
+    h->chunk_cutoff_rad = radius_deg * M_PI / 180.0;
+}
+
+
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status)
 {
@@ -798,6 +939,12 @@ void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
 }
 
 
+void oskar_interferometer_set_num_ms_files(oskar_Interferometer* h, int value)
+{
+    h->num_ms_files = value < 1 ? 1 : value;
+}
+
+
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels)
 {
@@ -844,10 +991,31 @@ void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
     /* Split up the sky model into chunks and store them. */
     h->num_sources_total = oskar_sky_num_sources(sky);
     if (h->num_sources_total > 0)
-        oskar_sky_append_to_set(&h->num_sky_chunks, &h->sky_chunks,
-                h->max_sources_per_chunk, sky, status);
+    {
+        const int cat = oskar_mem_set_category(OSKAR_MEM_CAT_SKY);
+        /* Sort if required, so that each chunk covers a compact region. */
+        if (h->sort_sky)
+            oskar_sky_append_to_set_sorted(&h->num_sky_chunks,
+                    &h->sky_chunks, h->max_sources_per_chunk, sky, status);
+        else
+            oskar_sky_append_to_set(&h->num_sky_chunks, &h->sky_chunks,
+                    h->max_sources_per_chunk, sky, status);
+        oskar_mem_set_category(cat);
+    }
     h->init_sky = 0;
 
+    /* Store a bounding cap for each chunk. */
+    h->chunk_caps = (double*) realloc(h->chunk_caps,
+            4 * (h->num_sky_chunks + 1) * sizeof(double));
+    for (i = 0; i < h->num_sky_chunks; ++i)
+    {
+        double ra, dec, *cap = &h->chunk_caps[4 * i];
+        oskar_sky_bounding_cap(h->sky_chunks[i], &ra, &dec, &cap[3], status);
+        cap[0] = cos(dec) * cos(ra);
+        cap[1] = cos(dec) * sin(ra);
+        cap[2] = sin(dec);
+    }
+
     /* Print summary data. */
     if (h->log)
     {
@@ -863,6 +1031,7 @@ void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
 void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         const oskar_Telescope* model, int* status)
 {
+    int cat;
     if (*status || !h || !model) return;
 
     /* Check the model is not empty. */
@@ -875,7 +1044,9 @@ void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
 
     /* Remove any existing telescope model, and copy the new one. */
     oskar_telescope_free(h->tel, status);
+    cat = oskar_mem_set_category(OSKAR_MEM_CAT_TELESCOPE);
     h->tel = oskar_telescope_create_copy(model, OSKAR_CPU, status);
+    oskar_mem_set_category(cat);
 
     /* Analyse the telescope model. */
     oskar_telescope_analyse(h->tel, status);
@@ -915,6 +1086,12 @@ void oskar_interferometer_set_output_measurement_set(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_sort_sky(oskar_Interferometer* h, int value)
+{
+    h->sort_sky = value;
+}
+
+
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy)
 {
@@ -923,6 +1100,30 @@ void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_vis_compression(oskar_Interferometer* h,
+        int compression, int mantissa_bits, int channels_per_chunk,
+        int baselines_per_chunk)
+{
+    h->vis_compression = compression;
+    h->vis_compression_bits = mantissa_bits;
+    h->vis_chunk_channels = channels_per_chunk;
+    h->vis_chunk_baselines = baselines_per_chunk;
+}
+
+
+void oskar_interferometer_set_trace_file(oskar_Interferometer* h,
+        const char* filename)
+{
+    int len;
+    len = (int) strlen(filename);
+    free(h->trace_file);
+    h->trace_file = 0;
+    if (len == 0) return;
+    h->trace_file = calloc(1 + len, 1);
+    strcpy(h->trace_file, filename);
+}
+
+
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value)
 {
@@ -944,14 +1145,13 @@ void oskar_interferometer_write_block(oskar_Interferometer* h,
     /* Open files only if required, and write the block into them. */
     oskar_timer_resume(h->tmr_write);
 #ifndef OSKAR_NO_MS
-    if (h->ms_name && !h->ms)
-        h->ms = oskar_vis_header_write_ms(h->header, h->ms_name, OSKAR_TRUE,
-                h->force_polarised_ms, status);
-    if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
+    if (h->ms_name) write_ms(h, block, status);
 #endif
     if (h->vis_name && !h->vis)
         h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
-    if (h->vis) oskar_vis_block_write(block, h->vis, block_index, status);
+    if (h->vis)
+        oskar_vis_block_write_chunks(block, h->header, h->vis, block_index,
+                status);
     oskar_timer_pause(h->tmr_write);
 }
 
@@ -1114,6 +1314,11 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
             h->num_channels, num_stations, write_autocorr, write_crosscorr,
             status);
 
+    /* Set the storage layout of the amplitudes in the visibility file. */
+    oskar_vis_header_set_chunking(h->header, h->vis_compression,
+            h->vis_compression_bits, h->vis_chunk_channels,
+            h->vis_chunk_baselines, status);
+
     /* Add metadata from settings. */
     oskar_vis_header_set_freq_start_hz(h->header, h->freq_start_hz);
     oskar_vis_header_set_freq_inc_hz(h->header, h->freq_inc_hz);
@@ -1156,7 +1361,7 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
 
 static void set_up_device_data(oskar_Interferometer* h, int* status)
 {
-    int i, dev_loc, complx, vistype, num_stations, num_src;
+    int i, cat, dev_loc, complx, vistype, num_stations, num_src;
     if (*status) return;
 
     /* Get local variables. */
@@ -1200,17 +1405,26 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->tmr_K         = oskar_timer_create(timer_type);
             d->tmr_join      = oskar_timer_create(timer_type);
             d->tmr_correlate = oskar_timer_create(timer_type);
+            oskar_timer_set_trace_name(d->tmr_compute, "Compute block");
+            oskar_timer_set_trace_name(d->tmr_copy, "Copy");
+            oskar_timer_set_trace_name(d->tmr_clip, "Horizon clip");
+            oskar_timer_set_trace_name(d->tmr_E, "Jones E");
+            oskar_timer_set_trace_name(d->tmr_K, "Jones K");
+            oskar_timer_set_trace_name(d->tmr_join, "Jones join");
+            oskar_timer_set_trace_name(d->tmr_correlate, "Correlate");
         }
 
         /* Visibility blocks. */
         if (!d->vis_block)
         {
+            cat = oskar_mem_set_category(OSKAR_MEM_CAT_VIS);
             d->vis_block = oskar_vis_block_create_from_header(dev_loc,
                     h->header, status);
             d->vis_block_cpu[0] = oskar_vis_block_create_from_header(OSKAR_CPU,
                     h->header, status);
             d->vis_block_cpu[1] = oskar_vis_block_create_from_header(OSKAR_CPU,
                     h->header, status);
+            oskar_mem_set_category(cat);
         }
         oskar_vis_block_clear(d->vis_block, status);
         oskar_vis_block_clear(d->vis_block_cpu[0], status);
@@ -1219,12 +1433,18 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
         /* Device scratch memory. */
         if (!d->tel)
         {
+            cat = oskar_mem_set_category(OSKAR_MEM_CAT_STATION_WORK);
             d->u = oskar_mem_create(h->prec, dev_loc, num_stations, status);
             d->v = oskar_mem_create(h->prec, dev_loc, num_stations, status);
             d->w = oskar_mem_create(h->prec, dev_loc, num_stations, status);
+            d->station_work = oskar_station_work_create(h->prec, dev_loc,
+                    status);
+            oskar_mem_set_category(OSKAR_MEM_CAT_SKY);
             d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
             d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
+            oskar_mem_set_category(OSKAR_MEM_CAT_TELESCOPE);
             d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
+            oskar_mem_set_category(OSKAR_MEM_CAT_JONES);
             d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                     status);
             d->R = oskar_type_is_matrix(vistype) ? oskar_jones_create(vistype,
@@ -1234,13 +1454,69 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->K = oskar_jones_create(complx, dev_loc, num_stations, num_src,
                     status);
             d->Z = 0;
-            d->station_work = oskar_station_work_create(h->prec, dev_loc,
-                    status);
+            oskar_mem_set_category(cat);
         }
     }
 }
 
 
+static int chunk_is_visible(const oskar_Interferometer* h, int i_chunk,
+        double gast)
+{
+    int i, num_stations, above_horizon, in_beam;
+    double min_dot_zenith, min_dot_beam;
+    const double* cap = &h->chunk_caps[4 * i_chunk];
+
+    /* A cap with a radius of 90 degrees or more is always partly above
+     * the horizon. Otherwise, it is entirely below the horizon of a station
+     * if its centre is more than (90 degrees + radius) from the zenith.
+     * The margin allows for rounding errors in the horizon clip. */
+    above_horizon = !h->apply_horizon_clip || cap[3] >= M_PI / 2.0;
+    in_beam = h->chunk_cutoff_rad <= 0.0 ||
+            cap[3] + h->chunk_cutoff_rad >= M_PI;
+    if (above_horizon && in_beam) return 1;
+    min_dot_zenith = -sin(cap[3]) - 1e-5;
+    min_dot_beam = cos(cap[3] + h->chunk_cutoff_rad);
+
+    /* Check the cap against the horizon and beam of every station. */
+    num_stations = oskar_telescope_num_stations(h->tel);
+    for (i = 0; i < num_stations && !(above_horizon && in_beam); ++i)
+    {
+        double lat, lst, v[3];
+        const oskar_Station* s = oskar_telescope_station_const(h->tel, i);
+        if (!above_horizon)
+        {
+            lat = oskar_station_lat_rad(s);
+            lst = gast + oskar_station_lon_rad(s);
+            v[0] = cos(lat) * cos(lst);
+            v[1] = cos(lat) * sin(lst);
+            v[2] = sin(lat);
+            if (cap[0] * v[0] + cap[1] * v[1] + cap[2] * v[2] > min_dot_zenith)
+                above_horizon = 1;
+        }
+        if (!in_beam)
+        {
+            /* Beams not fixed on the sky are not checked. */
+            if (oskar_station_beam_coord_type(s) !=
+                    OSKAR_SPHERICAL_TYPE_EQUATORIAL)
+                in_beam = 1;
+            else
+            {
+                lat = oskar_station_beam_lat_rad(s);
+                lst = oskar_station_beam_lon_rad(s);
+                v[0] = cos(lat) * cos(lst);
+                v[1] = cos(lat) * sin(lst);
+                v[2] = sin(lat);
+                if (cap[0] * v[0] + cap[1] * v[1] + cap[2] * v[2] >=
+                        min_dot_beam)
+                    in_beam = 1;
+            }
+        }
+    }
+    return above_horizon && in_beam;
+}
+
+
 static void free_device_data(oskar_Interferometer* h, int* status)
 {
     int i;
@@ -1283,6 +1559,8 @@ static void record_timing(oskar_Interferometer* h)
     int i;
     double t_copy = 0., t_clip = 0., t_E = 0., t_K = 0., t_join = 0.;
     double t_correlate = 0., t_compute = 0., t_components = 0.;
+    size_t cache_hits = 0, cache_misses = 0;
+    int num_skipped = 0;
     double *compute_times;
     compute_times = (double*) calloc(h->num_devices, sizeof(double));
     for (i = 0; i < h->num_devices; ++i)
@@ -1295,6 +1573,14 @@ static void record_timing(oskar_Interferometer* h)
         t_K += oskar_timer_elapsed(h->d[i].tmr_K);
         t_correlate += oskar_timer_elapsed(h->d[i].tmr_correlate);
         t_compute += compute_times[i];
+        num_skipped += h->d[i].num_skipped;
+        if (h->d[i].station_work)
+        {
+            cache_hits += oskar_station_work_child_beam_cache_hits(
+                    h->d[i].station_work);
+            cache_misses += oskar_station_work_child_beam_cache_misses(
+                    h->d[i].station_work);
+        }
     }
     t_components = t_copy + t_clip + t_E + t_K + t_join + t_correlate;
 
@@ -1322,6 +1608,13 @@ static void record_timing(oskar_Interferometer* h)
             (t_correlate / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Other", "%4.1f%%",
             ((t_compute - t_components) / t_compute) * 100.0);
+    if (cache_hits + cache_misses > 0)
+        oskar_log_value(h->log, 'M', 0, "Tile beam cache",
+                "%lu hits, %lu misses", (unsigned long) cache_hits,
+                (unsigned long) cache_misses);
+    if (num_skipped > 0)
+        oskar_log_value(h->log, 'M', 0, "Sky chunks skipped", "%d of %d",
+                num_skipped, h->num_sky_chunks * h->num_time_steps);
     free(compute_times);
 }
 
@@ -1352,6 +1645,124 @@ static void system_mem_log(oskar_Log* log)
 }
 
 
+#ifndef OSKAR_NO_MS
+struct MSWriterArgs
+{
+    oskar_Interferometer* h;
+    const oskar_VisBlock* block;
+    int part, status;
+};
+typedef struct MSWriterArgs MSWriterArgs;
+
+static int num_ms_parts(const oskar_Interferometer* h)
+{
+    if (h->num_ms_files > h->num_channels)
+        return h->num_channels > 0 ? h->num_channels : 1;
+    return h->num_ms_files;
+}
+
+
+static void ms_part_range(const oskar_Interferometer* h, int part,
+        int* start_channel, int* num_channels)
+{
+    const int num_parts = num_ms_parts(h);
+    *start_channel = (part * h->num_channels) / num_parts;
+    *num_channels = ((part + 1) * h->num_channels) / num_parts -
+            *start_channel;
+}
+
+
+static char* ms_part_name(const oskar_Interferometer* h, int part)
+{
+    char* name;
+    int c, len, num, width;
+
+    /* Use the given name if there is only one Measurement Set. */
+    len = (int) strlen(h->ms_name);
+    name = (char*) calloc(len + 40, 1);
+    if (num_ms_parts(h) == 1)
+    {
+        strcpy(name, h->ms_name);
+        return name;
+    }
+
+    /* Otherwise, insert the channel range before the file extension. */
+    ms_part_range(h, part, &c, &num);
+    width = (int) disp_width((unsigned int) h->num_channels);
+    sprintf(name, "%.*s_ch%0*d-%0*d.MS", len - 3, h->ms_name,
+            width, c, width, c + num - 1);
+    return name;
+}
+
+
+static void write_ms_part(void* arg)
+{
+    int start_channel, num_channels;
+    MSWriterArgs* a = (MSWriterArgs*) arg;
+    oskar_Interferometer* h = a->h;
+    ms_part_range(h, a->part, &start_channel, &num_channels);
+    oskar_vis_block_write_ms_channels(a->block, h->header, h->ms[a->part],
+            start_channel, &a->status);
+}
+
+
+static void write_ms(oskar_Interferometer* h, const oskar_VisBlock* block,
+        int* status)
+{
+    int i, num_parts;
+    oskar_TaskGroup* group;
+    MSWriterArgs* args = 0;
+    if (*status) return;
+
+    /* Create the Measurement Sets one at a time, the first time through. */
+    num_parts = num_ms_parts(h);
+    if (!h->ms)
+    {
+        h->num_ms = num_parts;
+        h->ms = (oskar_MeasurementSet**)
+                calloc(num_parts, sizeof(oskar_MeasurementSet*));
+        for (i = 0; i < num_parts; ++i)
+        {
+            int start_channel, num_channels;
+            char* name = ms_part_name(h, i);
+            ms_part_range(h, i, &start_channel, &num_channels);
+            h->ms[i] = oskar_vis_header_write_ms_channels(h->header, name,
+                    OSKAR_TRUE, h->force_polarised_ms,
+                    start_channel, num_channels, status);
+            free(name);
+        }
+        if (*status) return;
+
+        /* Create a persistent writer thread for each other channel range,
+         * so that each Measurement Set is normally written by the
+         * same thread for every block. */
+        if (num_parts > 1)
+            h->ms_pool = oskar_thread_pool_create(num_parts - 1);
+    }
+    num_parts = h->num_ms;
+
+    /* Write each channel range using its own writer thread.
+     * The calling thread writes the first one. */
+    args = (MSWriterArgs*) calloc(num_parts, sizeof(MSWriterArgs));
+    for (i = 0; i < num_parts; ++i)
+    {
+        args[i].h = h;
+        args[i].block = block;
+        args[i].part = i;
+    }
+    group = h->ms_pool ? oskar_task_group_create(h->ms_pool) : 0;
+    for (i = 1; i < num_parts; ++i)
+        oskar_thread_pool_submit(h->ms_pool, group, write_ms_part,
+                &args[i], i - 1);
+    write_ms_part(&args[0]);
+    oskar_task_group_free(group);
+    for (i = 0; i < num_parts && !*status; ++i)
+        *status = args[i].status;
+    free(args);
+}
+#endif
+
+
 #ifdef __cplusplus
 }
 #endif
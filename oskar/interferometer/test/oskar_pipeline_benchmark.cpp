@@ -0,0 +1,746 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "apps/oskar_option_parser.h"
+#include "beam_pattern/oskar_beam_pattern.h"
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "imager/oskar_imager.h"
+#include "interferometer/oskar_interferometer.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_random_gaussian.h"
+#include "mem/oskar_mem.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_timer.h"
+#include "utility/oskar_trace.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::string;
+using std::vector;
+
+/*
+ * Runs the interferometer, beam pattern and imager pipelines on synthetic
+ * telescope and sky models generated in memory, and writes the results
+ * as JSON so that they can be compared between commits.
+ *
+ * Per-stage times are taken from the regions recorded by the trace
+ * profiler, and peak memory from the oskar_Mem accounting counters.
+ *
+ * If requested, the interferometer visibilities are also compared against
+ * a double-precision reference run of the same case, to validate the
+ * accuracy of single precision. For single precision, a second reference
+ * run uses the same models with their source and station coordinates
+ * rounded to single precision. This separates the error from rounding
+ * the inputs from the error in the arithmetic and accumulation.
+ */
+
+#define D2R (M_PI / 180.0)
+
+/* Observation parameters common to all cases. */
+static const double lon_rad = 116.7 * D2R;
+static const double lat_rad = -26.7 * D2R;
+static const double ra0_rad = 0.0;
+static const double dec0_rad = -30.0 * D2R;
+static const double freq_start_hz = 100e6;
+static const double freq_inc_hz = 1e6;
+static const double time_inc_sec = 60.0;
+static const double sky_radius_rad = 2.0 * D2R;
+
+struct Case
+{
+    string name;
+    int num_stations, num_elements, hierarchical, dipole;
+    int num_sources, gaussian, clustered;
+    int num_channels, num_times;
+};
+
+struct Result
+{
+    string pipeline, name;
+    vector<pair<string, string> > params;
+    double time_sec, throughput;
+    string throughput_units;
+    size_t peak_host_bytes, peak_device_bytes, rss_bytes;
+    vector<pair<string, double> > stages;
+    vector<pair<string, double> > errors;
+};
+
+static const char* stages_interferometer[] = {
+        "Compute block", "Copy", "Horizon clip", "Jones E", "Jones K",
+        "Jones join", "Correlate", "Finalise block", "Write block", 0};
+static const char* stages_beam_pattern[] = {
+        "Compute chunk", "Write chunk", 0};
+static const char* stages_imager[] = {
+        "Initialise imager", "Read visibilities", "Update grid",
+        "Finalise grid", 0};
+
+static double random_uniform(void)
+{
+    return rand() / ((double) RAND_MAX + 1.0);
+}
+
+static oskar_Telescope* create_telescope(const Case& c, int precision,
+        int seed, int* status);
+static oskar_Sky* create_sky(const Case& c, int precision, int seed,
+        int* status);
+static double start_time_mjd(const Case& c);
+static void begin_run(void);
+static void end_run(Result& r, oskar_Timer* timer, const char** stages);
+static void round_to_single(oskar_Mem* mem, int* status);
+static void run_interferometer(const Case& c, int precision,
+        int round_inputs, int seed, int use_gpus, const string& vis_file,
+        Result& r, int* status);
+static void compare_vis(const string& vis_file, const string& ref_file,
+        const char* suffix, Result& r, int* status);
+static void run_beam_pattern(const Case& c, int precision, int seed,
+        int use_gpus, const string& root_path, Result& r, int* status);
+static void run_imager(const Case& c, int precision, int use_gpus,
+        const char* algorithm, const string& vis_file, Result& r,
+        int* status);
+static void add_param(Result& r, const char* key, int value);
+static void add_param(Result& r, const char* key, const char* value);
+static void add_case_params(Result& r, const Case& c);
+static void write_json(FILE* stream, const char* precision, int seed,
+        const vector<Result>& results);
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_pipeline_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-o", "Write JSON results to this file "
+            "(default: standard output).", 1);
+    opt.add_flag("-q", "Run a quick sweep using small models.");
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-e", "Report interferometer visibility errors against a "
+            "double-precision reference run.");
+    opt.add_flag("-c", "Run on the CPU only (default: use all GPUs)");
+    opt.add_flag("-d", "Scratch directory for output files.", 1,
+            "oskar_pipeline_benchmark_scratch");
+    opt.add_flag("-n", "Number of repeats of each case.", 1, "1");
+    opt.add_flag("-seed", "Random number seed.", 1, "1");
+    opt.add_flag("-v", "Display progress.");
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int num_repeats = 1, seed = 1, status = 0;
+    string json_file, scratch;
+    if (opt.is_set("-o"))
+        opt.get("-o")->getString(json_file);
+    opt.get("-d")->getString(scratch);
+    opt.get("-n")->getInt(num_repeats);
+    opt.get("-seed")->getInt(seed);
+    const int precision = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int check_errors = opt.is_set("-e");
+    const int use_gpus = !opt.is_set("-c");
+    const int verbose = opt.is_set("-v");
+    const int quick = opt.is_set("-q");
+
+    /* Define the sweep: a base case, and one parameter varied at a time. */
+    Case base;
+    base.name = "base";
+    base.num_stations = quick ? 8 : 32;
+    base.num_elements = quick ? 16 : 64;
+    base.hierarchical = 0;
+    base.dipole = 0;
+    base.num_sources = quick ? 100 : 1000;
+    base.gaussian = 0;
+    base.clustered = 0;
+    base.num_channels = quick ? 2 : 4;
+    base.num_times = quick ? 2 : 8;
+    vector<Case> cases;
+    cases.push_back(base);
+    Case c = base;
+    c.name = "stations_x4"; c.num_stations *= 4; cases.push_back(c); c = base;
+    c.name = "elements_x4"; c.num_elements *= 4; cases.push_back(c); c = base;
+    c.name = "hierarchical"; c.hierarchical = 1; cases.push_back(c); c = base;
+    c.name = "dipole"; c.dipole = 1; cases.push_back(c); c = base;
+    c.name = "sources_x10"; c.num_sources *= 10; cases.push_back(c); c = base;
+    c.name = "gaussian"; c.gaussian = 1; cases.push_back(c); c = base;
+    c.name = "clustered"; c.clustered = 1; cases.push_back(c); c = base;
+    c.name = "channels_x4"; c.num_channels *= 4; cases.push_back(c);
+
+    /* Run each case. */
+    oskar_dir_mkpath(scratch.c_str());
+    char* vis_path = oskar_dir_get_path(scratch.c_str(), "benchmark.vis");
+    char* ref_path = oskar_dir_get_path(scratch.c_str(), "reference.vis");
+    char* root_path = oskar_dir_get_path(scratch.c_str(), "beam");
+    const string vis_file(vis_path), ref_file(ref_path), root(root_path);
+    free(vis_path);
+    free(ref_path);
+    free(root_path);
+    vector<Result> results;
+    for (size_t i = 0; i < cases.size() && !status; ++i)
+    {
+        const Case& t = cases[i];
+        const int station_case = (i == 0 || t.num_sources == base.num_sources)
+                && !t.gaussian && !t.clustered;
+        for (int j = 0; j < num_repeats && !status; ++j)
+        {
+            Result r;
+            if (verbose) printf("Interferometer: %s\n", t.name.c_str());
+            run_interferometer(t, precision, 0, seed, use_gpus,
+                    vis_file, r, &status);
+            if (check_errors)
+            {
+                Result ref;
+                if (verbose) printf("Reference: %s\n", t.name.c_str());
+                run_interferometer(t, OSKAR_DOUBLE, 0, seed, use_gpus,
+                        ref_file, ref, &status);
+                compare_vis(vis_file, ref_file, "", r, &status);
+                if (precision == OSKAR_SINGLE)
+                {
+                    run_interferometer(t, OSKAR_DOUBLE, 1, seed, use_gpus,
+                            ref_file, ref, &status);
+                    compare_vis(vis_file, ref_file, "_single_inputs", r,
+                            &status);
+                }
+            }
+            results.push_back(r);
+
+            /* The beam pattern does not depend on the sky model. */
+            if (station_case && t.num_channels == base.num_channels)
+            {
+                if (verbose) printf("Beam pattern: %s\n", t.name.c_str());
+                run_beam_pattern(t, precision, seed, use_gpus, root, r,
+                        &status);
+                results.push_back(r);
+            }
+
+            /* Image the visibilities from the base case only. */
+            if (i == 0)
+            {
+                const char* algorithms[] = {"FFT", "W-projection"};
+                for (int k = 0; k < 2; ++k)
+                {
+                    if (verbose) printf("Imager: %s\n", algorithms[k]);
+                    run_imager(t, precision, use_gpus, algorithms[k],
+                            vis_file, r, &status);
+                    results.push_back(r);
+                }
+            }
+        }
+    }
+    oskar_dir_remove(scratch.c_str());
+
+    /* Check for errors. */
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    /* Write the results. */
+    FILE* stream = stdout;
+    if (!json_file.empty())
+    {
+        stream = fopen(json_file.c_str(), "w");
+        if (!stream)
+        {
+            fprintf(stderr, "ERROR: Unable to open '%s'\n", json_file.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    write_json(stream, precision == OSKAR_SINGLE ? "single" : "double",
+            seed, results);
+    if (stream != stdout)
+        fclose(stream);
+    return EXIT_SUCCESS;
+}
+
+
+oskar_Telescope* create_telescope(const Case& c, int precision, int seed,
+        int* status)
+{
+    oskar_Telescope* tel = oskar_telescope_create(precision, OSKAR_CPU,
+            c.num_stations, status);
+
+    /* Stations are distributed uniformly within a 1 km radius. */
+    oskar_Mem *x, *y, *z, *err;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, c.num_stations, status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, c.num_stations, status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, c.num_stations, status);
+    err = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, c.num_stations, status);
+    oskar_mem_clear_contents(z, status);
+    oskar_mem_clear_contents(err, status);
+    srand((unsigned int) seed);
+    for (int i = 0; i < c.num_stations && !*status; ++i)
+    {
+        const double r = 1000.0 * sqrt(random_uniform());
+        const double phi = 2.0 * M_PI * random_uniform();
+        oskar_mem_set_element_real(x, i, r * cos(phi), status);
+        oskar_mem_set_element_real(y, i, r * sin(phi), status);
+    }
+    oskar_telescope_set_station_coords_enu(tel, lon_rad, lat_rad, 0.0,
+            c.num_stations, x, y, z, err, err, err, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(z, status);
+    oskar_mem_free(err, status);
+
+    /* Elements are on a regular grid, or in 4x4 tiles on a regular grid. */
+    const int tile_size = 16;
+    const int num_tiles = c.hierarchical ?
+            (c.num_elements + tile_size - 1) / tile_size : 0;
+    for (int i = 0; i < c.num_stations && !*status; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        if (num_tiles > 0)
+        {
+            const int tiles_side = (int) ceil(sqrt((double) num_tiles));
+            oskar_station_resize(s, num_tiles, status);
+            oskar_station_create_child_stations(s, status);
+            for (int j = 0; j < num_tiles && !*status; ++j)
+            {
+                double xyz[] = {0.0, 0.0, 0.0};
+                xyz[0] = 5.0 * (j % tiles_side - 0.5 * (tiles_side - 1));
+                xyz[1] = 5.0 * (j / tiles_side - 0.5 * (tiles_side - 1));
+                oskar_station_set_element_coords(s, j, xyz, xyz, status);
+                oskar_Station* tile = oskar_station_child(s, j);
+                oskar_station_resize(tile, tile_size, status);
+                oskar_station_resize_element_types(tile, 1, status);
+                for (int k = 0; k < tile_size; ++k)
+                {
+                    xyz[0] = 1.25 * (k % 4 - 1.5);
+                    xyz[1] = 1.25 * (k / 4 - 1.5);
+                    oskar_station_set_element_coords(tile, k, xyz, xyz,
+                            status);
+                }
+                oskar_element_set_element_type(oskar_station_element(tile, 0),
+                        c.dipole ? "Dipole" : "Isotropic", status);
+            }
+        }
+        else
+        {
+            const int side = (int) ceil(sqrt((double) c.num_elements));
+            oskar_station_resize(s, c.num_elements, status);
+            oskar_station_resize_element_types(s, 1, status);
+            for (int j = 0; j < c.num_elements; ++j)
+            {
+                double xyz[] = {0.0, 0.0, 0.0};
+                xyz[0] = 1.5 * (j % side - 0.5 * (side - 1));
+                xyz[1] = 1.5 * (j / side - 0.5 * (side - 1));
+                oskar_station_set_element_coords(s, j, xyz, xyz, status);
+            }
+            oskar_element_set_element_type(oskar_station_element(s, 0),
+                    c.dipole ? "Dipole" : "Isotropic", status);
+        }
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_pol_mode(tel, c.dipole ? "Full" : "Scalar", status);
+    oskar_telescope_set_station_type(tel, "Aperture array", status);
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            ra0_rad, dec0_rad);
+    oskar_telescope_set_allow_station_beam_duplication(tel, 1);
+    return tel;
+}
+
+
+oskar_Sky* create_sky(const Case& c, int precision, int seed, int* status)
+{
+    const int num_clusters = 10;
+    const double cluster_sigma_rad = 0.1 * D2R;
+    double cluster_ra[num_clusters], cluster_dec[num_clusters];
+    oskar_Sky* sky = oskar_sky_create(precision, OSKAR_CPU, c.num_sources,
+            status);
+
+    /* Sources are uniform within the field, or scattered around clusters. */
+    srand((unsigned int) seed + 1);
+    for (int i = 0; i < num_clusters; ++i)
+    {
+        const double r = 0.8 * sky_radius_rad * sqrt(random_uniform());
+        const double phi = 2.0 * M_PI * random_uniform();
+        cluster_ra[i] = ra0_rad + r * cos(phi) / cos(dec0_rad);
+        cluster_dec[i] = dec0_rad + r * sin(phi);
+    }
+    for (int i = 0; i < c.num_sources && !*status; ++i)
+    {
+        double ra, dec, maj = 0.0, min = 0.0, pa = 0.0;
+        if (c.clustered)
+        {
+            double rnd[2];
+            const int k = (int) (num_clusters * random_uniform());
+            oskar_random_gaussian2(seed, i, 0, rnd);
+            ra = cluster_ra[k] + rnd[0] * cluster_sigma_rad / cos(dec0_rad);
+            dec = cluster_dec[k] + rnd[1] * cluster_sigma_rad;
+        }
+        else
+        {
+            const double r = sky_radius_rad * sqrt(random_uniform());
+            const double phi = 2.0 * M_PI * random_uniform();
+            ra = ra0_rad + r * cos(phi) / cos(dec0_rad);
+            dec = dec0_rad + r * sin(phi);
+        }
+        const double flux = 0.1 + random_uniform();
+        if (c.gaussian)
+        {
+            maj = (20.0 + 40.0 * random_uniform()) * D2R / 3600.0;
+            min = 0.5 * maj;
+            pa = M_PI * random_uniform();
+        }
+        oskar_sky_set_source(sky, i, ra, dec, flux, 0.0, 0.0, 0.0,
+                freq_start_hz, -0.7, 0.0, maj, min, pa, status);
+    }
+    return sky;
+}
+
+
+double start_time_mjd(const Case& c)
+{
+    /* Centre the observation on the transit of the phase centre. */
+    const double mjd0 = 58119.0;
+    double ha = oskar_convert_mjd_to_gast_fast(mjd0) + lon_rad - ra0_rad;
+    ha = fmod(ha, 2.0 * M_PI);
+    if (ha < 0.0) ha += 2.0 * M_PI;
+    const double transit = mjd0 + (2.0 * M_PI - ha) / (2.0 * M_PI) *
+            (1.0 / 1.00273790935);
+    return transit - 0.5 * c.num_times * time_inc_sec / 86400.0;
+}
+
+
+void begin_run(void)
+{
+    oskar_trace_clear();
+    oskar_trace_set_enabled(1);
+    oskar_mem_accounting_reset_peak();
+}
+
+
+void end_run(Result& r, oskar_Timer* timer, const char** stages)
+{
+    r.time_sec = oskar_timer_elapsed(timer);
+    oskar_trace_set_enabled(0);
+    r.peak_host_bytes = oskar_mem_accounting_peak(-1, OSKAR_CPU);
+    r.peak_device_bytes = oskar_mem_accounting_peak(-1, OSKAR_GPU);
+    r.rss_bytes = oskar_get_memory_usage();
+    r.errors.clear();
+    r.stages.clear();
+    for (int i = 0; stages[i]; ++i)
+    {
+        int count = 0;
+        const double total = oskar_trace_total(stages[i], &count);
+        if (count > 0)
+            r.stages.push_back(pair<string, double>(stages[i], total));
+    }
+}
+
+
+void round_to_single(oskar_Mem* mem, int* status)
+{
+    if (*status || oskar_mem_precision(mem) != OSKAR_DOUBLE) return;
+    double* d = oskar_mem_double(mem, status);
+    const size_t n = oskar_mem_length(mem);
+    for (size_t i = 0; i < n; ++i)
+        d[i] = (double) (float) d[i];
+}
+
+
+void run_interferometer(const Case& c, int precision,
+        int round_inputs, int seed, int use_gpus, const string& vis_file,
+        Result& r, int* status)
+{
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Telescope* tel = create_telescope(c, precision, seed, status);
+    oskar_Sky* sky = create_sky(c, precision, seed, status);
+    if (round_inputs)
+    {
+        /* Use the same coordinates as a single-precision run. */
+        oskar_Mem* mem[] = {
+                oskar_sky_ra_rad(sky), oskar_sky_dec_rad(sky),
+                oskar_sky_I(sky), oskar_sky_reference_freq_hz(sky),
+                oskar_sky_spectral_index(sky),
+                oskar_sky_gaussian_a(sky), oskar_sky_gaussian_b(sky),
+                oskar_sky_gaussian_c(sky),
+                oskar_telescope_station_true_x_offset_ecef_metres(tel),
+                oskar_telescope_station_true_y_offset_ecef_metres(tel),
+                oskar_telescope_station_true_z_offset_ecef_metres(tel),
+                oskar_telescope_station_measured_x_offset_ecef_metres(tel),
+                oskar_telescope_station_measured_y_offset_ecef_metres(tel),
+                oskar_telescope_station_measured_z_offset_ecef_metres(tel),
+                oskar_telescope_station_true_x_enu_metres(tel),
+                oskar_telescope_station_true_y_enu_metres(tel),
+                oskar_telescope_station_true_z_enu_metres(tel),
+                oskar_telescope_station_measured_x_enu_metres(tel),
+                oskar_telescope_station_measured_y_enu_metres(tel),
+                oskar_telescope_station_measured_z_enu_metres(tel)};
+        for (size_t i = 0; i < sizeof(mem) / sizeof(oskar_Mem*); ++i)
+            round_to_single(mem[i], status);
+    }
+    oskar_Interferometer* h = oskar_interferometer_create(precision, status);
+    if (!use_gpus)
+        oskar_interferometer_set_gpus(h, 0, 0, status);
+    oskar_interferometer_set_observation_time(h, start_time_mjd(c),
+            time_inc_sec, c.num_times);
+    oskar_interferometer_set_observation_frequency(h, freq_start_hz,
+            freq_inc_hz, c.num_channels);
+    oskar_interferometer_set_sky_model(h, sky, status);
+    oskar_interferometer_set_telescope_model(h, tel, status);
+    oskar_interferometer_set_output_vis_file(h, vis_file.c_str());
+    begin_run();
+    oskar_timer_start(timer);
+    oskar_interferometer_run(h, status);
+    end_run(r, timer, stages_interferometer);
+
+    /* Count source-baseline-channel products over all time samples. */
+    const double num_baselines = 0.5 * c.num_stations * (c.num_stations - 1);
+    r.pipeline = "interferometer";
+    r.name = c.name;
+    r.throughput = (double)c.num_sources * num_baselines * c.num_channels *
+            c.num_times / r.time_sec;
+    r.throughput_units = "source-baseline-channels/s";
+    add_case_params(r, c);
+    oskar_interferometer_free(h, status);
+    oskar_sky_free(sky, status);
+    oskar_telescope_free(tel, status);
+    oskar_timer_free(timer);
+}
+
+
+void compare_vis(const string& vis_file, const string& ref_file,
+        const char* suffix, Result& r, int* status)
+{
+    /* Compare cross-correlations block by block, in double precision. */
+    double max_abs = 0.0, sum_diff_sq = 0.0, sum_ref_sq = 0.0;
+    oskar_Binary* file[2] = {0, 0};
+    oskar_VisHeader* hdr[2] = {0, 0};
+    oskar_VisBlock* block[2] = {0, 0};
+    file[0] = oskar_binary_create(vis_file.c_str(), 'r', status);
+    file[1] = oskar_binary_create(ref_file.c_str(), 'r', status);
+    for (int i = 0; i < 2; ++i)
+    {
+        hdr[i] = oskar_vis_header_read(file[i], status);
+        block[i] = oskar_vis_block_create_from_header(OSKAR_CPU, hdr[i],
+                status);
+    }
+    if (!*status)
+    {
+        const int max_times = oskar_vis_header_max_times_per_block(hdr[0]);
+        const int num_blocks = (oskar_vis_header_num_times_total(hdr[0]) +
+                max_times - 1) / max_times;
+        for (int b = 0; b < num_blocks && !*status; ++b)
+        {
+            oskar_Mem* amp[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                oskar_vis_block_read(block[i], hdr[i], file[i], b, status);
+                amp[i] = oskar_mem_convert_precision(
+                        oskar_vis_block_cross_correlations_const(block[i]),
+                        OSKAR_DOUBLE, status);
+            }
+            if (!*status &&
+                    oskar_mem_length(amp[0]) != oskar_mem_length(amp[1]))
+                *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            if (!*status)
+            {
+                const size_t n = oskar_mem_length(amp[0]) *
+                        (oskar_type_is_matrix(oskar_mem_type(amp[0])) ? 8 : 2);
+                const double* a = (const double*) oskar_mem_void_const(amp[0]);
+                const double* ref =
+                        (const double*) oskar_mem_void_const(amp[1]);
+                for (size_t j = 0; j < n; ++j)
+                {
+                    const double diff = fabs(a[j] - ref[j]);
+                    if (diff > max_abs) max_abs = diff;
+                    sum_diff_sq += diff * diff;
+                    sum_ref_sq += ref[j] * ref[j];
+                }
+            }
+            oskar_mem_free(amp[0], status);
+            oskar_mem_free(amp[1], status);
+        }
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_vis_block_free(block[i], status);
+        oskar_vis_header_free(hdr[i], status);
+        oskar_binary_free(file[i]);
+    }
+    r.errors.push_back(pair<string, double>(string("max_abs_jy") + suffix,
+            max_abs));
+    r.errors.push_back(pair<string, double>(string("rms_rel") + suffix,
+            sum_ref_sq > 0.0 ? sqrt(sum_diff_sq / sum_ref_sq) : 0.0));
+}
+
+
+void run_beam_pattern(const Case& c, int precision, int seed, int use_gpus,
+        const string& root_path, Result& r, int* status)
+{
+    const int image_size = 64;
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Telescope* tel = create_telescope(c, precision, seed, status);
+    oskar_BeamPattern* h = oskar_beam_pattern_create(precision, status);
+    if (!use_gpus)
+        oskar_beam_pattern_set_gpus(h, 0, 0, status);
+    oskar_beam_pattern_set_observation_time(h, start_time_mjd(c),
+            time_inc_sec, c.num_times);
+    oskar_beam_pattern_set_observation_frequency(h, freq_start_hz,
+            freq_inc_hz, c.num_channels);
+    oskar_beam_pattern_set_image_size(h, image_size, image_size);
+    oskar_beam_pattern_set_image_fov(h, 4.0, 4.0);
+    oskar_beam_pattern_set_root_path(h, root_path.c_str());
+    oskar_beam_pattern_set_auto_power_fits(h, 1);
+    oskar_beam_pattern_set_telescope_model(h, tel, status);
+    begin_run();
+    oskar_timer_start(timer);
+    oskar_beam_pattern_run(h, status);
+    end_run(r, timer, stages_beam_pattern);
+    r.pipeline = "beam_pattern";
+    r.name = c.name;
+    r.throughput = (double)image_size * image_size * c.num_channels *
+            c.num_times / r.time_sec;
+    r.throughput_units = "pixel-channels/s";
+    add_case_params(r, c);
+    oskar_beam_pattern_free(h, status);
+    oskar_telescope_free(tel, status);
+    oskar_timer_free(timer);
+}
+
+
+void run_imager(const Case& c, int precision, int use_gpus,
+        const char* algorithm, const string& vis_file, Result& r,
+        int* status)
+{
+    const int image_size = 256;
+    const char* files[] = {vis_file.c_str()};
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Imager* h = oskar_imager_create(precision, status);
+    if (!use_gpus)
+        oskar_imager_set_gpus(h, 0, 0, status);
+    oskar_imager_set_algorithm(h, algorithm, status);
+    oskar_imager_set_fov(h, 4.0);
+    oskar_imager_set_size(h, image_size, status);
+    oskar_imager_set_input_files(h, 1, files, status);
+    begin_run();
+    oskar_timer_start(timer);
+    oskar_imager_run(h, 0, 0, 0, 0, status);
+    end_run(r, timer, stages_imager);
+    const double num_baselines = 0.5 * c.num_stations * (c.num_stations - 1);
+    r.pipeline = "imager";
+    r.name = algorithm;
+    r.throughput = num_baselines * c.num_channels * c.num_times / r.time_sec;
+    r.throughput_units = "visibilities/s";
+    r.params.clear();
+    add_param(r, "algorithm", algorithm);
+    add_param(r, "image_size", image_size);
+    add_param(r, "num_stations", c.num_stations);
+    add_param(r, "num_channels", c.num_channels);
+    add_param(r, "num_times", c.num_times);
+    oskar_imager_free(h, status);
+    oskar_timer_free(timer);
+}
+
+
+void add_param(Result& r, const char* key, int value)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%d", value);
+    r.params.push_back(pair<string, string>(key, buffer));
+}
+
+
+void add_param(Result& r, const char* key, const char* value)
+{
+    r.params.push_back(pair<string, string>(key,
+            string("\"") + value + "\""));
+}
+
+
+void add_case_params(Result& r, const Case& c)
+{
+    r.params.clear();
+    add_param(r, "num_stations", c.num_stations);
+    add_param(r, "num_elements", c.num_elements);
+    r.params.push_back(pair<string, string>("hierarchical",
+            c.hierarchical ? "true" : "false"));
+    add_param(r, "element_type", c.dipole ? "dipole" : "isotropic");
+    add_param(r, "num_sources", c.num_sources);
+    add_param(r, "source_type", c.gaussian ? "gaussian" : "point");
+    add_param(r, "distribution", c.clustered ? "clustered" : "uniform");
+    add_param(r, "num_channels", c.num_channels);
+    add_param(r, "num_times", c.num_times);
+}
+
+
+void write_json(FILE* stream, const char* precision, int seed,
+        const vector<Result>& results)
+{
+    fprintf(stream, "{\n");
+    fprintf(stream, "  \"version\": \"%s\",\n", OSKAR_VERSION_STR);
+    fprintf(stream, "  \"precision\": \"%s\",\n", precision);
+    fprintf(stream, "  \"seed\": %d,\n", seed);
+    fprintf(stream, "  \"results\": [");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        fprintf(stream, "%s\n    {\n", i > 0 ? "," : "");
+        fprintf(stream, "      \"pipeline\": \"%s\",\n", r.pipeline.c_str());
+        fprintf(stream, "      \"name\": \"%s\",\n", r.name.c_str());
+        fprintf(stream, "      \"params\": {");
+        for (size_t j = 0; j < r.params.size(); ++j)
+            fprintf(stream, "%s\"%s\": %s", j > 0 ? ", " : "",
+                    r.params[j].first.c_str(), r.params[j].second.c_str());
+        fprintf(stream, "},\n");
+        fprintf(stream, "      \"time_sec\": %.6f,\n", r.time_sec);
+        fprintf(stream, "      \"throughput\": %.6e,\n", r.throughput);
+        fprintf(stream, "      \"throughput_units\": \"%s\",\n",
+                r.throughput_units.c_str());
+        fprintf(stream, "      \"peak_host_bytes\": %lu,\n",
+                (unsigned long) r.peak_host_bytes);
+        fprintf(stream, "      \"peak_device_bytes\": %lu,\n",
+                (unsigned long) r.peak_device_bytes);
+        fprintf(stream, "      \"rss_bytes\": %lu,\n",
+                (unsigned long) r.rss_bytes);
+        fprintf(stream, "      \"stages\": {");
+        for (size_t j = 0; j < r.stages.size(); ++j)
+            fprintf(stream, "%s\"%s\": %.6f", j > 0 ? ", " : "",
+                    r.stages[j].first.c_str(), r.stages[j].second);
+        fprintf(stream, "}");
+        if (!r.errors.empty())
+        {
+            fprintf(stream, ",\n      \"errors\": {");
+            for (size_t j = 0; j < r.errors.size(); ++j)
+                fprintf(stream, "%s\"%s\": %.6e", j > 0 ? ", " : "",
+                        r.errors[j].first.c_str(), r.errors[j].second);
+            fprintf(stream, "}");
+        }
+        fprintf(stream, "\n    }");
+    }
+    fprintf(stream, "\n  ]\n}\n");
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2014, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -83,6 +83,36 @@ void oskar_binary_read_mem_ext(oskar_Binary* handle, oskar_Mem* mem,
         const char* name_group, const char* name_tag, int user_index,
         int* status);
 
+/**
+ * @brief
+ * Aliases or loads an OSKAR memory block from an OSKAR binary file.
+ *
+ * @details
+ * If the binary file is memory-mapped (opened with mode 'm'), the memory
+ * block is in CPU memory, and the payload is suitably aligned in the file,
+ * this function sets the memory block to alias the payload directly,
+ * without copying it. Any memory owned by the block is released first.
+ * The alias is read-only, and remains valid only until the binary file
+ * handle is freed: the memory block must not be written to, resized or
+ * used after that while it aliases the file. The block does not own the
+ * aliased memory, so it can still be freed in the normal way.
+ *
+ * Otherwise, the data are copied into the memory block as in
+ * oskar_binary_read_mem(), and a block that was previously aliased
+ * is given its own memory again.
+ *
+ * @param[in] handle       Handle to binary file.
+ * @param[in,out] mem      Pointer to data structure.
+ * @param[in] id_group     Tag group identifier.
+ * @param[in] id_tag       Tag identifier.
+ * @param[in] user_index   User-defined index.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_binary_map_mem(oskar_Binary* handle, oskar_Mem* mem,
+        unsigned char id_group, unsigned char id_tag, int user_index,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -81,9 +81,12 @@ enum OSKAR_MEM_LOCATION
 
 #include <binary/oskar_binary_data_types.h>
 #include <mem/oskar_mem_accessors.h>
+#include <mem/oskar_mem_accounting.h>
 #include <mem/oskar_mem_add.h>
 #include <mem/oskar_mem_add_real.h>
+#include <mem/oskar_mem_allocator.h>
 #include <mem/oskar_mem_append_raw.h>
+#include <mem/oskar_mem_arena.h>
 #include <mem/oskar_mem_clear_contents.h>
 #include <mem/oskar_mem_copy.h>
 #include <mem/oskar_mem_copy_contents.h>
@@ -100,6 +103,7 @@ enum OSKAR_MEM_LOCATION
 #include <mem/oskar_mem_get_element.h>
 #include <mem/oskar_mem_load_ascii.h>
 #include <mem/oskar_mem_multiply.h>
+#include <mem/oskar_mem_multiply_scale.h>
 #include <mem/oskar_mem_random_gaussian.h>
 #include <mem/oskar_mem_random_range.h>
 #include <mem/oskar_mem_random_uniform.h>
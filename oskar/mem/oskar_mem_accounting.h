@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_ACCOUNTING_H_
+#define OSKAR_MEM_ACCOUNTING_H_
+
+/**
+ * @file oskar_mem_accounting.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Categories used to account for memory owned by oskar_Mem.
+ */
+enum OSKAR_MEM_CATEGORY
+{
+    OSKAR_MEM_CAT_OTHER = 0,
+    OSKAR_MEM_CAT_SKY,           /* Sky model chunks. */
+    OSKAR_MEM_CAT_TELESCOPE,     /* Telescope and station models. */
+    OSKAR_MEM_CAT_JONES,         /* Jones matrices. */
+    OSKAR_MEM_CAT_STATION_WORK,  /* Station beam work arrays. */
+    OSKAR_MEM_CAT_VIS,           /* Visibility blocks. */
+    OSKAR_MEM_CAT_IMAGE,         /* Image planes and grids. */
+    OSKAR_MEM_CAT_W_KERNELS,     /* W-projection kernels. */
+    OSKAR_MEM_NUM_CATEGORIES
+};
+
+/**
+ * @brief
+ * Sets the category of memory allocated by the calling thread.
+ *
+ * @details
+ * Sets the category used to account for memory owned by arrays created
+ * by the calling thread using oskar_mem_create(). Each array keeps its
+ * category for its lifetime, so memory added to it later by
+ * oskar_mem_realloc() is charged to the same category, regardless of
+ * the thread that resizes it.
+ *
+ * The previous category is returned, so that it can be restored:
+ *
+ * @code
+ * const int cat = oskar_mem_set_category(OSKAR_MEM_CAT_JONES);
+ * ...
+ * oskar_mem_set_category(cat);
+ * @endcode
+ *
+ * @param[in] category  Enumerated memory category.
+ *
+ * @return The previous category of the calling thread.
+ */
+OSKAR_EXPORT
+int oskar_mem_set_category(int category);
+
+/**
+ * @brief
+ * Returns the name of a memory category.
+ *
+ * @param[in] category  Enumerated memory category.
+ */
+OSKAR_EXPORT
+const char* oskar_mem_category_name(int category);
+
+/**
+ * @brief
+ * Returns the number of bytes currently held in a memory category.
+ *
+ * @details
+ * Returns the number of bytes currently owned by arrays in the given
+ * category, either in host memory (if \p location is OSKAR_CPU) or in
+ * the memory of any compute device (for other locations).
+ *
+ * If \p category is negative, the total over all categories is returned.
+ *
+ * @param[in] category  Enumerated memory category, or -1 for all.
+ * @param[in] location  Enumerated memory location.
+ */
+OSKAR_EXPORT
+size_t oskar_mem_accounting_current(int category, int location);
+
+/**
+ * @brief
+ * Returns the peak number of bytes held in a memory category.
+ *
+ * @details
+ * Returns the high-water mark of oskar_mem_accounting_current().
+ * If \p category is negative, the peak of the total over all categories
+ * is returned, which may be less than the sum of the peaks of each one.
+ *
+ * @param[in] category  Enumerated memory category, or -1 for all.
+ * @param[in] location  Enumerated memory location.
+ */
+OSKAR_EXPORT
+size_t oskar_mem_accounting_peak(int category, int location);
+
+/**
+ * @brief
+ * Resets the peak values to the current values.
+ */
+OSKAR_EXPORT
+void oskar_mem_accounting_reset_peak(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_ACCOUNTING_H_ */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_ALLOCATOR_H_
+#define OSKAR_MEM_ALLOCATOR_H_
+
+/**
+ * @file oskar_mem_allocator.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+/**
+ * @brief Alignment of all host memory blocks, in bytes.
+ */
+#define OSKAR_MEM_ALIGNMENT 64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Statistics reported by the host memory allocator.
+ */
+struct oskar_MemAllocStats
+{
+    unsigned long long num_allocs;      /* Host blocks allocated. */
+    unsigned long long num_frees;       /* Host blocks freed. */
+    unsigned long long bytes_allocated; /* Total bytes allocated. */
+    unsigned long long bytes_in_use;    /* Bytes currently allocated. */
+    unsigned long long bytes_peak;      /* Peak value of bytes_in_use. */
+    unsigned long long num_handles;     /* Handles taken from the system. */
+};
+typedef struct oskar_MemAllocStats oskar_MemAllocStats;
+
+/**
+ * @brief
+ * Allocates a block of host memory.
+ *
+ * @details
+ * Returns a block of host memory aligned to OSKAR_MEM_ALIGNMENT bytes,
+ * which must be released using oskar_mem_host_free().
+ *
+ * If the block is at least as large as the threshold set using
+ * oskar_mem_allocator_set_huge_page_threshold(), the operating system
+ * is asked to back it with huge pages, where supported.
+ *
+ * @param[in] num_bytes  Size of the block, in bytes.
+ * @param[in] clear      If set, the block is filled with zeros.
+ *
+ * @return A pointer to the block, or NULL if it could not be allocated.
+ */
+OSKAR_EXPORT
+void* oskar_mem_host_alloc(size_t num_bytes, int clear);
+
+/**
+ * @brief
+ * Resizes a block of host memory.
+ *
+ * @details
+ * Resizes a block returned by oskar_mem_host_alloc(), preserving its
+ * contents up to the smaller of the old and new sizes.
+ * Any extra memory is not initialised.
+ *
+ * A block that shrinks by less than half is kept in place.
+ *
+ * @param[in] ptr        Pointer to the block (may be NULL).
+ * @param[in] num_bytes  New size of the block, in bytes.
+ *
+ * @return A pointer to the block, or NULL if it could not be allocated,
+ * in which case the original block is left unchanged.
+ */
+OSKAR_EXPORT
+void* oskar_mem_host_realloc(void* ptr, size_t num_bytes);
+
+/**
+ * @brief
+ * Frees a block of host memory.
+ *
+ * @details
+ * Frees a block returned by oskar_mem_host_alloc() or
+ * oskar_mem_host_realloc(). It is safe to pass a NULL pointer.
+ *
+ * @param[in] ptr  Pointer to the block.
+ */
+OSKAR_EXPORT
+void oskar_mem_host_free(void* ptr);
+
+/**
+ * @brief
+ * Sets the size above which host blocks use huge pages.
+ *
+ * @details
+ * Sets the minimum size of host blocks that should be backed by huge pages,
+ * which can reduce TLB misses when accessing large Jones matrix and
+ * visibility arrays. This currently has an effect only on Linux, using
+ * transparent huge pages.
+ *
+ * A value of 0 (the default) disables the use of huge pages.
+ * The default can also be set using the environment variable
+ * OSKAR_HUGE_PAGE_THRESHOLD_MB.
+ *
+ * @param[in] num_bytes  Minimum block size, in bytes, or 0 to disable.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_set_huge_page_threshold(size_t num_bytes);
+
+/**
+ * @brief
+ * Returns the current allocator statistics.
+ *
+ * @details
+ * Returns a snapshot of the host memory allocator statistics.
+ * To measure the allocations made by a stage of processing, take a
+ * snapshot before and after it and subtract the counters, or call
+ * oskar_mem_allocator_reset_stats() before it starts.
+ *
+ * @param[out] stats  Current statistics.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_stats(oskar_MemAllocStats* stats);
+
+/**
+ * @brief
+ * Resets the allocator statistics.
+ *
+ * @details
+ * Sets all cumulative counters to zero and the peak number of bytes
+ * to the number of bytes currently in use.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_reset_stats(void);
+
+/**
+ * @brief
+ * Releases memory cached by the calling thread.
+ *
+ * @details
+ * Handles released by oskar_mem_free() on a worker thread of an
+ * oskar_ThreadPool are kept by that thread for re-use by later calls to
+ * oskar_mem_create() and oskar_mem_create_alias(). Handles released on
+ * any other thread are freed immediately.
+ *
+ * This function releases the cached handles. It is registered using
+ * oskar_thread_add_exit_hook(), so pool worker threads call it
+ * automatically before they exit.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_release_thread_cache(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_ALLOCATOR_H_ */
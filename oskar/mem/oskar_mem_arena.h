@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_ARENA_H_
+#define OSKAR_MEM_ARENA_H_
+
+/**
+ * @file oskar_mem_arena.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_MemArena;
+#ifndef OSKAR_MEM_ARENA_TYPEDEF_
+#define OSKAR_MEM_ARENA_TYPEDEF_
+typedef struct oskar_MemArena oskar_MemArena;
+#endif /* OSKAR_MEM_ARENA_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates an arena for scratch arrays in host memory.
+ *
+ * @details
+ * An arena hands out scratch arrays from a single block of host memory,
+ * which are all released together by oskar_mem_arena_reset(), typically
+ * once per unit of work. After the first few resets, the block is large
+ * enough for the whole unit of work, and no further allocations are needed.
+ *
+ * An arena is not thread-safe: each thread should use its own.
+ *
+ * @return A handle to the new arena.
+ */
+OSKAR_EXPORT
+oskar_MemArena* oskar_mem_arena_create(void);
+
+/**
+ * @brief
+ * Returns a scratch array from the arena.
+ *
+ * @details
+ * Returns a handle to an array in host memory, aligned to
+ * OSKAR_MEM_ALIGNMENT bytes. The contents of the array are not initialised.
+ *
+ * The handle is owned by the arena, and must not be freed or resized.
+ * It remains valid until the next call to oskar_mem_arena_reset()
+ * or oskar_mem_arena_free().
+ *
+ * @param[in] arena         Handle to arena.
+ * @param[in] type          Enumerated data type of the array.
+ * @param[in] num_elements  Number of elements in the array.
+ * @param[in,out] status    Status return code.
+ *
+ * @return A handle to the array.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_mem_arena_get(oskar_MemArena* arena, int type,
+        size_t num_elements, int* status);
+
+/**
+ * @brief
+ * Releases all arrays returned by the arena.
+ *
+ * @details
+ * Releases all arrays returned by oskar_mem_arena_get(), so that their
+ * memory can be re-used. If the arena ran out of space since the last
+ * reset, its block is replaced by one large enough for all of them.
+ *
+ * @param[in] arena  Handle to arena.
+ */
+OSKAR_EXPORT
+void oskar_mem_arena_reset(oskar_MemArena* arena);
+
+/**
+ * @brief
+ * Returns the size of the arena's memory block, in bytes.
+ *
+ * @param[in] arena  Handle to arena.
+ */
+OSKAR_EXPORT
+size_t oskar_mem_arena_capacity(const oskar_MemArena* arena);
+
+/**
+ * @brief
+ * Frees the arena and all its memory.
+ *
+ * @param[in] arena  Handle to arena.
+ */
+OSKAR_EXPORT
+void oskar_mem_arena_free(oskar_MemArena* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_ARENA_H_ */
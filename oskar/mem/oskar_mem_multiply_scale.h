@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_MULTIPLY_SCALE_H_
+#define OSKAR_MEM_MULTIPLY_SCALE_H_
+
+/**
+ * @file oskar_mem_multiply_scale.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Multiplies (element-wise) two arrays and scales the result.
+ *
+ * @details
+ * This function evaluates c = a .* b * value in a single pass over the data,
+ * instead of separate calls to oskar_mem_multiply() and
+ * oskar_mem_scale_real().
+ *
+ * If b is NULL, the operation becomes c = a * value, which can be used to
+ * scale an array while copying it into another one.
+ *
+ * The arrays must all be of the same type, except that a complex matrix can
+ * be multiplied by a complex scalar (in either order) to give a complex
+ * matrix. The output array may be the same as either input array.
+ *
+ * The arrays must all be in the same location, which may be the CPU or
+ * a GPU.
+ *
+ * @param[out]    c      Output array.
+ * @param[in]     a      First input array.
+ * @param[in]     b      Second input array (may be NULL).
+ * @param[in]     value  Real value by which to scale the result.
+ * @param[in]     num    If >0, use only this number of elements.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mem_multiply_scale(oskar_Mem* c, const oskar_Mem* a,
+        const oskar_Mem* b, double value, size_t num, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_MULTIPLY_SCALE_H_ */
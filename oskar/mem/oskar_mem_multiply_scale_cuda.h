@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_MULTIPLY_SCALE_CUDA_H_
+#define OSKAR_MEM_MULTIPLY_SCALE_CUDA_H_
+
+/**
+ * @file oskar_mem_multiply_scale_cuda.h
+ */
+
+#include <oskar_global.h>
+#include <utility/oskar_vector_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Single precision. */
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_r_r_f(int num, float* d_c,
+        const float* d_a, float value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_rr_r_f(int num, float* d_c,
+        const float* d_a, const float* d_b, float value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_cc_c_f(int num, float2* d_c,
+        const float2* d_a, const float2* d_b, float value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_mc_m_f(int num, float4c* d_c,
+        const float4c* d_a, const float2* d_b, float value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_mm_m_f(int num, float4c* d_c,
+        const float4c* d_a, const float4c* d_b, float value);
+
+/* Double precision. */
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_r_r_d(int num, double* d_c,
+        const double* d_a, double value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_rr_r_d(int num, double* d_c,
+        const double* d_a, const double* d_b, double value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_cc_c_d(int num, double2* d_c,
+        const double2* d_a, const double2* d_b, double value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_mc_m_d(int num, double4c* d_c,
+        const double4c* d_a, const double2* d_b, double value);
+
+OSKAR_EXPORT
+void oskar_mem_multiply_scale_cuda_mm_m_d(int num, double4c* d_c,
+        const double4c* d_a, const double4c* d_b, double value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_MULTIPLY_SCALE_CUDA_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -51,6 +51,7 @@ struct oskar_Mem
     size_t num_elements; /* Number of elements in memory block. */
     int owner;           /* Flag set if the structure owns the memory. */
     void* data;          /* Data pointer. */
+    int category;        /* Enumerated category used for accounting. */
 
 #ifdef OSKAR_HAVE_OPENCL
     cl_mem buffer;       /* Handle to OpenCL buffer. */
@@ -62,4 +63,24 @@ struct oskar_Mem
 typedef struct oskar_Mem oskar_Mem;
 #endif /* OSKAR_MEM_TYPEDEF_ */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns a cleared handle, re-using one released by this thread if any. */
+oskar_Mem* oskar_mem_handle_alloc(void);
+
+/* Releases a handle, keeping it for re-use by this thread if possible. */
+void oskar_mem_handle_free(oskar_Mem* mem);
+
+/* Returns the memory category set by this thread. */
+int oskar_mem_current_category(void);
+
+/* Charges a change in the size of owned memory to its category. */
+void oskar_mem_account(const oskar_Mem* mem, long long num_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* OSKAR_PRIVATE_MEM_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include "mem/oskar_binary_read_mem.h"
+#include "mem/private_mem.h"
 
 #include <stdlib.h>
 #include <math.h>
@@ -116,6 +117,60 @@ void oskar_binary_read_mem_ext(oskar_Binary* handle, oskar_Mem* mem,
     oskar_mem_free(temp, status);
 }
 
+void oskar_binary_map_mem(oskar_Binary* handle, oskar_Mem* mem,
+        unsigned char id_group, unsigned char id_tag, int user_index,
+        int* status)
+{
+    int chunk_index;
+    size_t size_bytes = 0, element_size = 0, alignment = 0;
+    void* ptr = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Find the payload in the mapped file, if possible. */
+    element_size = oskar_mem_element_size(mem->type);
+    if (element_size == 0)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (mem->location == OSKAR_CPU && oskar_binary_is_mapped(handle))
+    {
+        chunk_index = oskar_binary_query(handle, (unsigned char)(mem->type),
+                id_group, id_tag, user_index, &size_bytes, status);
+        ptr = oskar_binary_map_block(handle, chunk_index, status);
+        if (*status) return;
+    }
+
+    /* Alias the payload if it is aligned to its base type. */
+    alignment = element_size;
+    if (oskar_mem_is_matrix(mem)) alignment /= 4;
+    if (oskar_mem_is_complex(mem)) alignment /= 2;
+    if (ptr && ((size_t)ptr % alignment) == 0)
+    {
+        if (mem->owner)
+        {
+            oskar_mem_account(mem, -(long long)
+                    (mem->num_elements * element_size));
+            oskar_mem_host_free(mem->data);
+        }
+        mem->owner = 0;
+        mem->data = ptr;
+        mem->num_elements = size_bytes / element_size;
+        return;
+    }
+
+    /* Otherwise copy the data, after restoring ownership if required. */
+    if (!mem->owner)
+    {
+        mem->owner = 1;
+        mem->data = 0;
+        mem->num_elements = 0;
+    }
+    oskar_binary_read_mem(handle, mem, id_group, id_tag, user_index, status);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/oskar_mem.h"
+#include "mem/private_mem.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef OSKAR_OS_WIN
+#define THREAD_LOCAL __declspec(thread)
+#define ATOMIC_ADD(PTR, VAL) InterlockedExchangeAdd64((PTR), (VAL))
+#define ATOMIC_CAS(PTR, OLD, NEW) \
+        InterlockedCompareExchange64((PTR), (NEW), (OLD))
+typedef LONG64 Counter;
+#else
+#define THREAD_LOCAL __thread
+#define ATOMIC_ADD(PTR, VAL) __sync_fetch_and_add((PTR), (VAL))
+#define ATOMIC_CAS(PTR, OLD, NEW) \
+        __sync_val_compare_and_swap((PTR), (OLD), (NEW))
+typedef long long Counter;
+#endif
+
+/* Index OSKAR_MEM_NUM_CATEGORIES holds the total over all categories.
+ * The second index is 0 for host memory, and 1 for device memory. */
+static volatile Counter current_[OSKAR_MEM_NUM_CATEGORIES + 1][2];
+static volatile Counter peak_[OSKAR_MEM_NUM_CATEGORIES + 1][2];
+static THREAD_LOCAL int category_ = OSKAR_MEM_CAT_OTHER;
+
+static const char* names_[] = {"Other", "Sky", "Telescope", "Jones",
+        "Station work", "Visibilities", "Images", "W-kernels"};
+
+
+static void update(int category, int loc, Counter delta)
+{
+    Counter in_use, peak, old;
+    in_use = ATOMIC_ADD(&current_[category][loc], delta) + delta;
+    peak = peak_[category][loc];
+    while (in_use > peak)
+    {
+        old = ATOMIC_CAS(&peak_[category][loc], peak, in_use);
+        if (old == peak) break;
+        peak = old;
+    }
+}
+
+
+static int index_of(int category)
+{
+    return (category < 0 || category >= OSKAR_MEM_NUM_CATEGORIES) ?
+            OSKAR_MEM_NUM_CATEGORIES : category;
+}
+
+
+int oskar_mem_set_category(int category)
+{
+    const int previous = category_;
+    if (category >= 0 && category < OSKAR_MEM_NUM_CATEGORIES)
+        category_ = category;
+    return previous;
+}
+
+
+const char* oskar_mem_category_name(int category)
+{
+    return (category >= 0 && category < OSKAR_MEM_NUM_CATEGORIES) ?
+            names_[category] : "All";
+}
+
+
+size_t oskar_mem_accounting_current(int category, int location)
+{
+    const Counter v = current_[index_of(category)][location != OSKAR_CPU];
+    return v > 0 ? (size_t) v : 0;
+}
+
+
+size_t oskar_mem_accounting_peak(int category, int location)
+{
+    const Counter v = peak_[index_of(category)][location != OSKAR_CPU];
+    return v > 0 ? (size_t) v : 0;
+}
+
+
+void oskar_mem_accounting_reset_peak(void)
+{
+    int i;
+    for (i = 0; i <= OSKAR_MEM_NUM_CATEGORIES; ++i)
+    {
+        peak_[i][0] = current_[i][0];
+        peak_[i][1] = current_[i][1];
+    }
+}
+
+
+int oskar_mem_current_category(void)
+{
+    return category_;
+}
+
+
+void oskar_mem_account(const oskar_Mem* mem, long long num_bytes)
+{
+    const int loc = (mem->location != OSKAR_CPU);
+    if (num_bytes == 0) return;
+    update(mem->category, loc, (Counter) num_bytes);
+    update(OSKAR_MEM_NUM_CATEGORIES, loc, (Counter) num_bytes);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE /* For posix_memalign() and madvise(). */
+#endif
+
+#include "mem/oskar_mem.h"
+#include "mem/private_mem.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Each host block is preceded by a header holding its size, padded to
+ * the alignment so that the returned pointer is also aligned. */
+#define HEADER_SIZE OSKAR_MEM_ALIGNMENT
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+/* Maximum number of released handles kept by each thread. */
+#define MAX_CACHED_HANDLES 64
+
+#ifdef OSKAR_OS_WIN
+#define THREAD_LOCAL __declspec(thread)
+#define ATOMIC_ADD(PTR, VAL) InterlockedExchangeAdd64((PTR), (VAL))
+#define ATOMIC_CAS(PTR, OLD, NEW) \
+        InterlockedCompareExchange64((PTR), (NEW), (OLD))
+typedef LONG64 Counter;
+#else
+#define THREAD_LOCAL __thread
+#define ATOMIC_ADD(PTR, VAL) __sync_fetch_and_add((PTR), (VAL))
+#define ATOMIC_CAS(PTR, OLD, NEW) \
+        __sync_val_compare_and_swap((PTR), (OLD), (NEW))
+typedef long long Counter;
+#endif
+
+typedef struct
+{
+    size_t capacity;
+} BlockHeader;
+
+static volatile Counter num_allocs_ = 0;
+static volatile Counter num_frees_ = 0;
+static volatile Counter bytes_allocated_ = 0;
+static volatile Counter bytes_in_use_ = 0;
+static volatile Counter bytes_peak_ = 0;
+static volatile Counter num_handles_ = 0;
+static size_t huge_page_threshold_ = 0;
+static int huge_page_threshold_set_ = 0;
+
+/* Singly-linked list of released handles, using the data pointer. */
+static THREAD_LOCAL oskar_Mem* cached_handles_ = 0;
+static THREAD_LOCAL int num_cached_handles_ = 0;
+static volatile int exit_hook_added_ = 0;
+
+
+static size_t huge_page_threshold(void)
+{
+    if (!huge_page_threshold_set_)
+    {
+        const char* str = getenv("OSKAR_HUGE_PAGE_THRESHOLD_MB");
+        const double mb = str ? atof(str) : 0.0;
+        if (mb > 0.0) huge_page_threshold_ = (size_t)(mb * 1048576.0);
+        huge_page_threshold_set_ = 1;
+    }
+    return huge_page_threshold_;
+}
+
+
+static void* raw_alloc(size_t alignment, size_t num_bytes)
+{
+#ifdef _WIN32
+    return _aligned_malloc(num_bytes, alignment);
+#else
+    void* ptr = 0;
+    return posix_memalign(&ptr, alignment, num_bytes) ? 0 : ptr;
+#endif
+}
+
+
+static void raw_free(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+
+static void record_alloc(size_t num_bytes)
+{
+    Counter in_use, peak, old;
+    ATOMIC_ADD(&num_allocs_, 1);
+    ATOMIC_ADD(&bytes_allocated_, (Counter) num_bytes);
+    in_use = ATOMIC_ADD(&bytes_in_use_, (Counter) num_bytes) +
+            (Counter) num_bytes;
+    peak = bytes_peak_;
+    while (in_use > peak)
+    {
+        old = ATOMIC_CAS(&bytes_peak_, peak, in_use);
+        if (old == peak) break;
+        peak = old;
+    }
+}
+
+
+void* oskar_mem_host_alloc(size_t num_bytes, int clear)
+{
+    size_t alignment = OSKAR_MEM_ALIGNMENT, threshold;
+    unsigned char* base;
+    if (num_bytes > (size_t)(-1) - HUGE_PAGE_SIZE) return 0;
+    threshold = huge_page_threshold();
+    if (threshold > 0 && num_bytes >= threshold)
+        alignment = HUGE_PAGE_SIZE;
+    base = (unsigned char*) raw_alloc(alignment, num_bytes + HEADER_SIZE);
+    if (!base) return 0;
+#ifdef MADV_HUGEPAGE
+    if (alignment == HUGE_PAGE_SIZE)
+        (void) madvise(base, num_bytes + HEADER_SIZE, MADV_HUGEPAGE);
+#endif
+    ((BlockHeader*) base)->capacity = num_bytes;
+    if (clear) memset(base + HEADER_SIZE, 0, num_bytes);
+    record_alloc(num_bytes);
+    return base + HEADER_SIZE;
+}
+
+
+void* oskar_mem_host_realloc(void* ptr, size_t num_bytes)
+{
+    size_t capacity;
+    void* ptr_new;
+    if (!ptr) return oskar_mem_host_alloc(num_bytes, 0);
+    capacity = ((const BlockHeader*)
+            ((unsigned char*) ptr - HEADER_SIZE))->capacity;
+    if (num_bytes <= capacity && num_bytes >= capacity / 2)
+        return ptr;
+    ptr_new = oskar_mem_host_alloc(num_bytes, 0);
+    if (!ptr_new) return 0;
+    memcpy(ptr_new, ptr, num_bytes < capacity ? num_bytes : capacity);
+    oskar_mem_host_free(ptr);
+    return ptr_new;
+}
+
+
+void oskar_mem_host_free(void* ptr)
+{
+    unsigned char* base;
+    if (!ptr) return;
+    base = (unsigned char*) ptr - HEADER_SIZE;
+    ATOMIC_ADD(&num_frees_, 1);
+    ATOMIC_ADD(&bytes_in_use_, -(Counter) ((BlockHeader*) base)->capacity);
+    raw_free(base);
+}
+
+
+void oskar_mem_allocator_set_huge_page_threshold(size_t num_bytes)
+{
+    huge_page_threshold_ = num_bytes;
+    huge_page_threshold_set_ = 1;
+}
+
+
+void oskar_mem_allocator_stats(oskar_MemAllocStats* stats)
+{
+    stats->num_allocs = (unsigned long long) num_allocs_;
+    stats->num_frees = (unsigned long long) num_frees_;
+    stats->bytes_allocated = (unsigned long long) bytes_allocated_;
+    stats->bytes_in_use = (unsigned long long) bytes_in_use_;
+    stats->bytes_peak = (unsigned long long) bytes_peak_;
+    stats->num_handles = (unsigned long long) num_handles_;
+}
+
+
+void oskar_mem_allocator_reset_stats(void)
+{
+    num_allocs_ = 0;
+    num_frees_ = 0;
+    bytes_allocated_ = 0;
+    bytes_peak_ = bytes_in_use_;
+    num_handles_ = 0;
+}
+
+
+void oskar_mem_allocator_release_thread_cache(void)
+{
+    while (cached_handles_)
+    {
+        oskar_Mem* next = (oskar_Mem*) cached_handles_->data;
+        free(cached_handles_);
+        cached_handles_ = next;
+    }
+    num_cached_handles_ = 0;
+}
+
+
+oskar_Mem* oskar_mem_handle_alloc(void)
+{
+    oskar_Mem* mem = cached_handles_;
+    if (mem)
+    {
+        cached_handles_ = (oskar_Mem*) mem->data;
+        num_cached_handles_--;
+        memset(mem, 0, sizeof(oskar_Mem));
+        return mem;
+    }
+    mem = (oskar_Mem*) calloc(1, sizeof(oskar_Mem));
+    if (mem) ATOMIC_ADD(&num_handles_, 1);
+    return mem;
+}
+
+
+void oskar_mem_handle_free(oskar_Mem* mem)
+{
+    /* Only cache handles on pool worker threads, which release their
+     * cache through the exit hook. Other threads may exit without
+     * releasing it, so free the handle immediately.
+     * Registering the hook more than once is harmless. */
+    if (!oskar_thread_is_pool_worker())
+    {
+        free(mem);
+        return;
+    }
+    if (!exit_hook_added_)
+        exit_hook_added_ = oskar_thread_add_exit_hook(
+                oskar_mem_allocator_release_thread_cache);
+    if (exit_hook_added_ && num_cached_handles_ < MAX_CACHED_HANDLES)
+    {
+        mem->data = cached_handles_;
+        cached_handles_ = mem;
+        num_cached_handles_++;
+        return;
+    }
+    free(mem);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/oskar_mem.h"
+#include "mem/private_mem.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_MemArena
+{
+    unsigned char* block;   /* Main block of memory. */
+    size_t capacity;        /* Size of main block, in bytes. */
+    size_t used;            /* Bytes requested since last reset. */
+    int num_overflow;       /* Number of blocks used when main block full. */
+    void** overflow;        /* Blocks used when main block full. */
+    int num_handles_used;   /* Number of handles returned since last reset. */
+    int num_handles;        /* Number of handles owned by the arena. */
+    oskar_Mem** handles;    /* Handles owned by the arena. */
+};
+
+#define ALIGN_UP(X) \
+        (((X) + OSKAR_MEM_ALIGNMENT - 1) & ~((size_t)OSKAR_MEM_ALIGNMENT - 1))
+
+
+oskar_MemArena* oskar_mem_arena_create(void)
+{
+    return (oskar_MemArena*) calloc(1, sizeof(oskar_MemArena));
+}
+
+
+oskar_Mem* oskar_mem_arena_get(oskar_MemArena* arena, int type,
+        size_t num_elements, int* status)
+{
+    size_t element_size, num_bytes;
+    unsigned char* ptr;
+    oskar_Mem* mem;
+    if (*status) return 0;
+    element_size = oskar_mem_element_size(type);
+    if (element_size == 0)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+    num_bytes = ALIGN_UP(num_elements * element_size);
+    if (num_bytes == 0) num_bytes = OSKAR_MEM_ALIGNMENT;
+
+    /* Take the memory from the main block if it fits,
+     * or from a separate block if not. */
+    if (arena->used + num_bytes <= arena->capacity)
+        ptr = arena->block + arena->used;
+    else
+    {
+        ptr = (unsigned char*) oskar_mem_host_alloc(num_bytes, 0);
+        if (!ptr)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return 0;
+        }
+        arena->overflow = (void**) realloc(arena->overflow,
+                (arena->num_overflow + 1) * sizeof(void*));
+        arena->overflow[arena->num_overflow++] = ptr;
+    }
+    arena->used += num_bytes;
+
+    /* Get a handle to describe the memory. */
+    if (arena->num_handles_used == arena->num_handles)
+    {
+        mem = oskar_mem_handle_alloc();
+        if (!mem)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return 0;
+        }
+        arena->handles = (oskar_Mem**) realloc(arena->handles,
+                (arena->num_handles + 1) * sizeof(oskar_Mem*));
+        arena->handles[arena->num_handles++] = mem;
+    }
+    mem = arena->handles[arena->num_handles_used++];
+    mem->type = type;
+    mem->location = OSKAR_CPU;
+    mem->num_elements = num_elements;
+    mem->owner = 0;
+    mem->data = ptr;
+    return mem;
+}
+
+
+void oskar_mem_arena_reset(oskar_MemArena* arena)
+{
+    int i;
+    if (!arena) return;
+    if (arena->num_overflow > 0)
+    {
+        for (i = 0; i < arena->num_overflow; ++i)
+            oskar_mem_host_free(arena->overflow[i]);
+        arena->num_overflow = 0;
+        oskar_mem_host_free(arena->block);
+        arena->block = (unsigned char*) oskar_mem_host_alloc(arena->used, 0);
+        arena->capacity = arena->block ? arena->used : 0;
+    }
+    arena->used = 0;
+    arena->num_handles_used = 0;
+}
+
+
+size_t oskar_mem_arena_capacity(const oskar_MemArena* arena)
+{
+    return arena ? arena->capacity : 0;
+}
+
+
+void oskar_mem_arena_free(oskar_MemArena* arena)
+{
+    int i;
+    if (!arena) return;
+    for (i = 0; i < arena->num_overflow; ++i)
+        oskar_mem_host_free(arena->overflow[i]);
+    for (i = 0; i < arena->num_handles; ++i)
+        oskar_mem_handle_free(arena->handles[i]);
+    oskar_mem_host_free(arena->block);
+    free(arena->overflow);
+    free(arena->handles);
+    free(arena);
+}
+
+#ifdef __cplusplus
+}
+#endif
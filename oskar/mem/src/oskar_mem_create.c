@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2017, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,7 +48,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     size_t element_size, bytes;
 
     /* Create the structure. */
-    mem = (oskar_Mem*) calloc(1, sizeof(oskar_Mem));
+    mem = oskar_mem_handle_alloc();
     if (!mem)
     {
         *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
@@ -62,6 +62,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     mem->num_elements = 0;
     mem->owner = 1;
     mem->data = NULL;
+    mem->category = oskar_mem_current_category();
 
     /* Check if allocation should happen or not. */
     if (!status || *status || num_elements == 0)
@@ -81,7 +82,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     if (location == OSKAR_CPU)
     {
         /* Allocate host memory. */
-        mem->data = calloc(bytes, 1);
+        mem->data = oskar_mem_host_alloc(bytes, 1);
         if (mem->data == NULL)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
     }
@@ -115,6 +116,10 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
         *status = OSKAR_ERR_BAD_LOCATION;
     }
 
+    /* Record the allocation. This is undone by oskar_mem_free(),
+     * so must match the number of elements set above. */
+    oskar_mem_account(mem, (long long) bytes);
+
     /* Return a handle to the structure .*/
     return mem;
 }
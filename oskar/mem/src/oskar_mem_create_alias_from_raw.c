@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2015, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,7 +41,7 @@ oskar_Mem* oskar_mem_create_alias_from_raw(void* ptr, int type, int location,
     oskar_Mem* mem = 0;
 
     /* Create the structure. */
-    mem = (oskar_Mem*) calloc(1, sizeof(oskar_Mem));
+    mem = oskar_mem_handle_alloc();
     if (!mem)
     {
         *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
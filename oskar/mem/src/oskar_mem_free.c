@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2014, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -47,6 +47,9 @@ void oskar_mem_free(oskar_Mem* mem, int* status)
 
     /* Must proceed with trying to free the memory, regardless of the
      * status code value. */
+    if (mem->owner)
+        oskar_mem_account(mem, -(long long)
+                (mem->num_elements * oskar_mem_element_size(mem->type)));
 
 #ifdef OSKAR_HAVE_OPENCL
     /* Free OpenCL memory if there is a buffer object here. */
@@ -67,7 +70,7 @@ void oskar_mem_free(oskar_Mem* mem, int* status)
         if (mem->location == OSKAR_CPU)
         {
             /* Free host memory. */
-            free(mem->data);
+            oskar_mem_host_free(mem->data);
         }
         else if (mem->location == OSKAR_GPU)
         {
@@ -82,7 +85,7 @@ void oskar_mem_free(oskar_Mem* mem, int* status)
     }
 
     /* Free the structure itself. */
-    free(mem);
+    oskar_mem_handle_free(mem);
 }
 
 #ifdef __cplusplus
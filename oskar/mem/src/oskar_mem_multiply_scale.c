@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/oskar_mem.h"
+#include "mem/oskar_mem_multiply_scale_cuda.h"
+#include "mem/private_mem.h"
+
+#include "math/oskar_multiply_inline.h"
+#include "utility/oskar_cl_utils.h"
+#include "utility/oskar_device_utils.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Operations, named by the types of the inputs and output. */
+enum { R_R, RR_R, CC_C, MC_M, MM_M };
+
+/* Single precision. */
+static void multiply_scale_r_r_f(size_t num, float* c, const float* a,
+        float value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+        c[i] = a[i] * value;
+}
+
+static void multiply_scale_rr_r_f(size_t num, float* c, const float* a,
+        const float* b, float value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+        c[i] = a[i] * b[i] * value;
+}
+
+static void multiply_scale_cc_c_f(size_t num, float2* c, const float2* a,
+        const float2* b, float value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        float2 cc;
+        oskar_multiply_complex_f(&cc, &a[i], &b[i]);
+        cc.x *= value;
+        cc.y *= value;
+        c[i] = cc;
+    }
+}
+
+static void multiply_scale_mc_m_f(size_t num, float4c* c, const float4c* a,
+        const float2* b, float value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        float2 bc;
+        float4c ac;
+        ac = a[i];
+        bc = b[i];
+        bc.x *= value;
+        bc.y *= value;
+        oskar_multiply_complex_matrix_complex_scalar_in_place_f(&ac, &bc);
+        c[i] = ac;
+    }
+}
+
+static void multiply_scale_mm_m_f(size_t num, float4c* c, const float4c* a,
+        const float4c* b, float value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        float4c ac, bc;
+        ac = a[i];
+        bc = b[i];
+        oskar_multiply_complex_matrix_in_place_f(&ac, &bc);
+        ac.a.x *= value;
+        ac.a.y *= value;
+        ac.b.x *= value;
+        ac.b.y *= value;
+        ac.c.x *= value;
+        ac.c.y *= value;
+        ac.d.x *= value;
+        ac.d.y *= value;
+        c[i] = ac;
+    }
+}
+
+
+/* Double precision. */
+static void multiply_scale_r_r_d(size_t num, double* c, const double* a,
+        double value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+        c[i] = a[i] * value;
+}
+
+static void multiply_scale_rr_r_d(size_t num, double* c, const double* a,
+        const double* b, double value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+        c[i] = a[i] * b[i] * value;
+}
+
+static void multiply_scale_cc_c_d(size_t num, double2* c, const double2* a,
+        const double2* b, double value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        double2 cc;
+        oskar_multiply_complex_d(&cc, &a[i], &b[i]);
+        cc.x *= value;
+        cc.y *= value;
+        c[i] = cc;
+    }
+}
+
+static void multiply_scale_mc_m_d(size_t num, double4c* c, const double4c* a,
+        const double2* b, double value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        double2 bc;
+        double4c ac;
+        ac = a[i];
+        bc = b[i];
+        bc.x *= value;
+        bc.y *= value;
+        oskar_multiply_complex_matrix_complex_scalar_in_place_d(&ac, &bc);
+        c[i] = ac;
+    }
+}
+
+static void multiply_scale_mm_m_d(size_t num, double4c* c, const double4c* a,
+        const double4c* b, double value)
+{
+    size_t i;
+    for (i = 0; i < num; ++i)
+    {
+        double4c ac, bc;
+        ac = a[i];
+        bc = b[i];
+        oskar_multiply_complex_matrix_in_place_d(&ac, &bc);
+        ac.a.x *= value;
+        ac.a.y *= value;
+        ac.b.x *= value;
+        ac.b.y *= value;
+        ac.c.x *= value;
+        ac.c.y *= value;
+        ac.d.x *= value;
+        ac.d.y *= value;
+        c[i] = ac;
+    }
+}
+
+
+void oskar_mem_multiply_scale(oskar_Mem* c, const oskar_Mem* a,
+        const oskar_Mem* b, double value, size_t num, int* status)
+{
+    const oskar_Mem *m = a, *s = b; /* Pointers to the ordered inputs. */
+    int op, location, precision;
+#ifdef OSKAR_HAVE_OPENCL
+    cl_kernel k = 0;
+#endif
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Set the number of elements to use. */
+    if (num == 0) num = a->num_elements;
+    if (num == 0) return;
+
+    /* Check that there are enough elements. */
+    if (a->num_elements < num || c->num_elements < num ||
+            (b && b->num_elements < num))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Check that the arrays are all in the same place. */
+    location = c->location;
+    if (a->location != location || (b && b->location != location))
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Work out which operation to use from the data types.
+     * A scale without a second input works on the real components. */
+    precision = oskar_type_precision(c->type);
+    if (!b)
+    {
+        op = R_R;
+        if (a->type != c->type)
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+        if (oskar_type_is_complex(c->type))
+            num *= 2;
+        if (oskar_type_is_matrix(c->type))
+            num *= 4;
+    }
+    else if (a->type == c->type && b->type == c->type)
+    {
+        if (oskar_type_is_matrix(c->type))
+            op = MM_M;
+        else if (oskar_type_is_complex(c->type))
+            op = CC_C;
+        else
+            op = RR_R;
+    }
+    else
+    {
+        op = MC_M;
+        if (b->type == c->type)
+        {
+            m = b;
+            s = a;
+        }
+        if (!oskar_type_is_matrix(c->type) || m->type != c->type ||
+                s->type != (precision | OSKAR_COMPLEX))
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+    }
+    if (precision != OSKAR_SINGLE && precision != OSKAR_DOUBLE)
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+    if (*status) return;
+
+    if (location == OSKAR_CPU)
+    {
+        if (precision == OSKAR_SINGLE)
+        {
+            const float v = (float) value;
+            switch (op)
+            {
+            case R_R:
+                multiply_scale_r_r_f(num, (float*)c->data,
+                        (const float*)m->data, v);
+                break;
+            case RR_R:
+                multiply_scale_rr_r_f(num, (float*)c->data,
+                        (const float*)m->data, (const float*)s->data, v);
+                break;
+            case CC_C:
+                multiply_scale_cc_c_f(num, (float2*)c->data,
+                        (const float2*)m->data, (const float2*)s->data, v);
+                break;
+            case MC_M:
+                multiply_scale_mc_m_f(num, (float4c*)c->data,
+                        (const float4c*)m->data, (const float2*)s->data, v);
+                break;
+            case MM_M:
+                multiply_scale_mm_m_f(num, (float4c*)c->data,
+                        (const float4c*)m->data, (const float4c*)s->data, v);
+                break;
+            }
+        }
+        else
+        {
+            switch (op)
+            {
+            case R_R:
+                multiply_scale_r_r_d(num, (double*)c->data,
+                        (const double*)m->data, value);
+                break;
+            case RR_R:
+                multiply_scale_rr_r_d(num, (double*)c->data,
+                        (const double*)m->data, (const double*)s->data, value);
+                break;
+            case CC_C:
+                multiply_scale_cc_c_d(num, (double2*)c->data,
+                        (const double2*)m->data, (const double2*)s->data,
+                        value);
+                break;
+            case MC_M:
+                multiply_scale_mc_m_d(num, (double4c*)c->data,
+                        (const double4c*)m->data, (const double2*)s->data,
+                        value);
+                break;
+            case MM_M:
+                multiply_scale_mm_m_d(num, (double4c*)c->data,
+                        (const double4c*)m->data, (const double4c*)s->data,
+                        value);
+                break;
+            }
+        }
+    }
+    else if (location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        const int n = (int) num;
+        if (precision == OSKAR_SINGLE)
+        {
+            const float v = (float) value;
+            switch (op)
+            {
+            case R_R:
+                oskar_mem_multiply_scale_cuda_r_r_f(n, (float*)c->data,
+                        (const float*)m->data, v);
+                break;
+            case RR_R:
+                oskar_mem_multiply_scale_cuda_rr_r_f(n, (float*)c->data,
+                        (const float*)m->data, (const float*)s->data, v);
+                break;
+            case CC_C:
+                oskar_mem_multiply_scale_cuda_cc_c_f(n, (float2*)c->data,
+                        (const float2*)m->data, (const float2*)s->data, v);
+                break;
+            case MC_M:
+                oskar_mem_multiply_scale_cuda_mc_m_f(n, (float4c*)c->data,
+                        (const float4c*)m->data, (const float2*)s->data, v);
+                break;
+            case MM_M:
+                oskar_mem_multiply_scale_cuda_mm_m_f(n, (float4c*)c->data,
+                        (const float4c*)m->data, (const float4c*)s->data, v);
+                break;
+            }
+        }
+        else
+        {
+            switch (op)
+            {
+            case R_R:
+                oskar_mem_multiply_scale_cuda_r_r_d(n, (double*)c->data,
+                        (const double*)m->data, value);
+                break;
+            case RR_R:
+                oskar_mem_multiply_scale_cuda_rr_r_d(n, (double*)c->data,
+                        (const double*)m->data, (const double*)s->data, value);
+                break;
+            case CC_C:
+                oskar_mem_multiply_scale_cuda_cc_c_d(n, (double2*)c->data,
+                        (const double2*)m->data, (const double2*)s->data,
+                        value);
+                break;
+            case MC_M:
+                oskar_mem_multiply_scale_cuda_mc_m_d(n, (double4c*)c->data,
+                        (const double4c*)m->data, (const double2*)s->data,
+                        value);
+                break;
+            case MM_M:
+                oskar_mem_multiply_scale_cuda_mm_m_d(n, (double4c*)c->data,
+                        (const double4c*)m->data, (const double4c*)s->data,
+                        value);
+                break;
+            }
+        }
+        oskar_device_check_error(status);
+#else
+        *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
+#endif
+    }
+    else if (location & OSKAR_CL)
+    {
+#ifdef OSKAR_HAVE_OPENCL
+        char name[64];
+        const char* ops[] = {"r_r", "rr_r", "cc_c", "mc_m", "mm_m"};
+        sprintf(name, "mem_multiply_scale_%s_%s", ops[op],
+                precision == OSKAR_DOUBLE ? "double" : "float");
+        k = oskar_cl_kernel(name);
+#else
+        *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
+#endif
+    }
+    else
+        *status = OSKAR_ERR_BAD_LOCATION;
+
+#ifdef OSKAR_HAVE_OPENCL
+    /* Call OpenCL kernel if required. */
+    if ((location & OSKAR_CL) && !*status)
+    {
+        if (k)
+        {
+            cl_device_type dev_type;
+            cl_int error, gpu, n, arg = 0;
+            size_t global_size, local_size;
+
+            /* Set kernel arguments. */
+            clGetDeviceInfo(oskar_cl_device_id(),
+                    CL_DEVICE_TYPE, sizeof(cl_device_type), &dev_type, NULL);
+            gpu = dev_type & CL_DEVICE_TYPE_GPU;
+            n = (cl_int) num;
+            error = clSetKernelArg(k, arg++, sizeof(cl_int), &n);
+            error |= clSetKernelArg(k, arg++, sizeof(cl_mem),
+                    oskar_mem_cl_buffer_const(m, status));
+            if (s)
+                error |= clSetKernelArg(k, arg++, sizeof(cl_mem),
+                        oskar_mem_cl_buffer_const(s, status));
+            if (precision == OSKAR_DOUBLE)
+            {
+                cl_double v = (cl_double) value;
+                error |= clSetKernelArg(k, arg++, sizeof(cl_double), &v);
+            }
+            else
+            {
+                cl_float v = (cl_float) value;
+                error |= clSetKernelArg(k, arg++, sizeof(cl_float), &v);
+            }
+            error |= clSetKernelArg(k, arg++, sizeof(cl_mem),
+                    oskar_mem_cl_buffer(c, status));
+            if (*status) return;
+            if (error != CL_SUCCESS)
+            {
+                *status = OSKAR_ERR_INVALID_ARGUMENT;
+                return;
+            }
+
+            /* Launch kernel on current command queue. */
+            local_size = gpu ? 256 : 128;
+            global_size = ((num + local_size - 1) / local_size) * local_size;
+            error = clEnqueueNDRangeKernel(oskar_cl_command_queue(), k, 1, NULL,
+                        &global_size, &local_size, 0, NULL, NULL);
+            if (error != CL_SUCCESS)
+            {
+                *status = OSKAR_ERR_KERNEL_LAUNCH_FAILURE;
+                return;
+            }
+        }
+        else
+        {
+            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        }
+    }
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
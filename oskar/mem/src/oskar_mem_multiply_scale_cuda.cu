@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_multiply_inline.h"
+#include "mem/oskar_mem_multiply_scale_cuda.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Single precision. */
+__global__
+void oskar_mem_multiply_scale_cudak_r_r_f(const int n, const float* a,
+        const float value, float* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    c[i] = a[i] * value;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_rr_r_f(const int n, const float* a,
+        const float* b, const float value, float* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    c[i] = a[i] * b[i] * value;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_cc_c_f(const int n, const float2* a,
+        const float2* b, const float value, float2* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    float2 ac, bc, cc;
+    ac = a[i];
+    bc = b[i];
+    oskar_multiply_complex_f(&cc, &ac, &bc);
+    cc.x *= value;
+    cc.y *= value;
+    c[i] = cc;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_mc_m_f(const int n, const float4c* a,
+        const float2* b, const float value, float4c* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    float2 bc;
+    float4c ac;
+    ac = a[i];
+    bc = b[i];
+    bc.x *= value;
+    bc.y *= value;
+    oskar_multiply_complex_matrix_complex_scalar_in_place_f(&ac, &bc);
+    c[i] = ac;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_mm_m_f(const int n, const float4c* a,
+        const float4c* b, const float value, float4c* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    float4c ac, bc;
+    ac = a[i];
+    bc = b[i];
+    oskar_multiply_complex_matrix_in_place_f(&ac, &bc);
+    ac.a.x *= value;
+    ac.a.y *= value;
+    ac.b.x *= value;
+    ac.b.y *= value;
+    ac.c.x *= value;
+    ac.c.y *= value;
+    ac.d.x *= value;
+    ac.d.y *= value;
+    c[i] = ac;
+}
+
+void oskar_mem_multiply_scale_cuda_r_r_f(int num, float* d_c,
+        const float* d_a, float value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_r_r_f
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_rr_r_f(int num, float* d_c,
+        const float* d_a, const float* d_b, float value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_rr_r_f
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_cc_c_f(int num, float2* d_c,
+        const float2* d_a, const float2* d_b, float value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_cc_c_f
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_mc_m_f(int num, float4c* d_c,
+        const float4c* d_a, const float2* d_b, float value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_mc_m_f
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_mm_m_f(int num, float4c* d_c,
+        const float4c* d_a, const float4c* d_b, float value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_mm_m_f
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+
+/* Double precision. */
+__global__
+void oskar_mem_multiply_scale_cudak_r_r_d(const int n, const double* a,
+        const double value, double* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    c[i] = a[i] * value;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_rr_r_d(const int n, const double* a,
+        const double* b, const double value, double* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    c[i] = a[i] * b[i] * value;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_cc_c_d(const int n, const double2* a,
+        const double2* b, const double value, double2* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    double2 ac, bc, cc;
+    ac = a[i];
+    bc = b[i];
+    oskar_multiply_complex_d(&cc, &ac, &bc);
+    cc.x *= value;
+    cc.y *= value;
+    c[i] = cc;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_mc_m_d(const int n, const double4c* a,
+        const double2* b, const double value, double4c* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    double2 bc;
+    double4c ac;
+    ac = a[i];
+    bc = b[i];
+    bc.x *= value;
+    bc.y *= value;
+    oskar_multiply_complex_matrix_complex_scalar_in_place_d(&ac, &bc);
+    c[i] = ac;
+}
+
+__global__
+void oskar_mem_multiply_scale_cudak_mm_m_d(const int n, const double4c* a,
+        const double4c* b, const double value, double4c* c)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= n) return;
+    double4c ac, bc;
+    ac = a[i];
+    bc = b[i];
+    oskar_multiply_complex_matrix_in_place_d(&ac, &bc);
+    ac.a.x *= value;
+    ac.a.y *= value;
+    ac.b.x *= value;
+    ac.b.y *= value;
+    ac.c.x *= value;
+    ac.c.y *= value;
+    ac.d.x *= value;
+    ac.d.y *= value;
+    c[i] = ac;
+}
+
+void oskar_mem_multiply_scale_cuda_r_r_d(int num, double* d_c,
+        const double* d_a, double value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_r_r_d
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_rr_r_d(int num, double* d_c,
+        const double* d_a, const double* d_b, double value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_rr_r_d
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_cc_c_d(int num, double2* d_c,
+        const double2* d_a, const double2* d_b, double value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_cc_c_d
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_mc_m_d(int num, double4c* d_c,
+        const double4c* d_a, const double2* d_b, double value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_mc_m_d
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+void oskar_mem_multiply_scale_cuda_mm_m_d(int num, double4c* d_c,
+        const double4c* d_a, const double4c* d_b, double value)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_mem_multiply_scale_cudak_mm_m_d
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num, d_a, d_b, value, d_c);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -76,11 +76,16 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
     {
         /* Reallocate the memory. */
         void* mem_new = NULL;
-        mem_new = realloc(mem->data, new_size);
-        if (!mem_new && (new_size > 0))
+        if (new_size == 0)
+            oskar_mem_host_free(mem->data);
+        else
         {
-            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
-            return;
+            mem_new = oskar_mem_host_realloc(mem->data, new_size);
+            if (!mem_new)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                return;
+            }
         }
 
         /* Initialise the new memory if it's larger than the old block. */
@@ -88,8 +93,9 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
             memset((char*)mem_new + old_size, 0, new_size - old_size);
 
         /* Set the new meta-data. */
-        mem->data = (new_size > 0) ? mem_new : 0;
+        mem->data = mem_new;
         mem->num_elements = num_elements;
+        oskar_mem_account(mem, (long long) new_size - (long long) old_size);
     }
     else if (mem->location == OSKAR_GPU)
     {
@@ -129,6 +135,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
         /* Set the new meta-data. */
         mem->data = mem_new;
         mem->num_elements = num_elements;
+        oskar_mem_account(mem, (long long) new_size - (long long) old_size);
 #else
         *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
 #endif
@@ -165,6 +172,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
         /* Set the new meta-data. */
         mem->buffer = mem_new;
         mem->num_elements = num_elements;
+        oskar_mem_account(mem, (long long) new_size - (long long) old_size);
 #else
         *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
 #endif
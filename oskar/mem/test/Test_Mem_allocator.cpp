@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_thread.h"
+#include "mem/oskar_mem.h"
+
+TEST(Mem, allocator_alignment)
+{
+    int status = 0;
+    size_t n;
+    for (n = 1; n < 200; n += 7)
+    {
+        oskar_Mem *mem = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU,
+                n, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(0u, (size_t)oskar_mem_void(mem) % OSKAR_MEM_ALIGNMENT);
+        oskar_mem_realloc(mem, 3 * n + 1, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(0u, (size_t)oskar_mem_void(mem) % OSKAR_MEM_ALIGNMENT);
+        oskar_mem_free(mem, &status);
+    }
+}
+
+
+TEST(Mem, allocator_realloc_preserves_contents)
+{
+    int i, status = 0;
+    oskar_Mem *mem = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 100, &status);
+    int* p = oskar_mem_int(mem, &status);
+    for (i = 0; i < 100; ++i) p[i] = i;
+
+    /* Shrink, then grow again: new elements must be cleared. */
+    oskar_mem_realloc(mem, 60, &status);
+    oskar_mem_realloc(mem, 1000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    p = oskar_mem_int(mem, &status);
+    for (i = 0; i < 60; ++i) ASSERT_EQ(i, p[i]);
+    for (i = 60; i < 1000; ++i) ASSERT_EQ(0, p[i]);
+    oskar_mem_realloc(mem, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(oskar_mem_void(mem) == 0);
+    oskar_mem_free(mem, &status);
+}
+
+
+struct AliasLoopArgs
+{
+    oskar_Mem* mem;
+    unsigned long long num_new_handles;
+};
+
+/* Creates and frees aliases, and counts the handles taken from the system. */
+static void alias_loop(void* arg)
+{
+    int status = 0;
+    oskar_MemAllocStats s0, s1;
+    AliasLoopArgs* a = (AliasLoopArgs*) arg;
+    oskar_Mem* alias = oskar_mem_create_alias(0, 0, 0, &status);
+    oskar_mem_free(alias, &status);
+    oskar_mem_allocator_stats(&s0);
+    for (int i = 0; i < 100; ++i)
+    {
+        alias = oskar_mem_create_alias(a->mem, i, 10, &status);
+        EXPECT_EQ(oskar_mem_double(a->mem, &status) + i,
+                oskar_mem_double(alias, &status));
+        oskar_mem_free(alias, &status);
+    }
+    oskar_mem_allocator_stats(&s1);
+    a->num_new_handles = s1.num_handles - s0.num_handles;
+}
+
+
+TEST(Mem, allocator_stats)
+{
+    int status = 0;
+    oskar_MemAllocStats s0, s1;
+    oskar_Mem *a, *b;
+
+    oskar_mem_allocator_stats(&s0);
+    a = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1000, &status);
+    b = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, 10, &status);
+    oskar_mem_allocator_stats(&s1);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(2u, s1.num_allocs - s0.num_allocs);
+    EXPECT_EQ(8040u, s1.bytes_allocated - s0.bytes_allocated);
+    EXPECT_GE(s1.bytes_peak, s1.bytes_in_use);
+
+    /* Aliases should re-use released handles on pool worker threads,
+     * but not on other threads, which may exit without releasing them. */
+    oskar_mem_allocator_stats(&s0);
+    AliasLoopArgs args;
+    args.mem = a;
+    args.num_new_handles = 0;
+    alias_loop(&args);
+    EXPECT_EQ(100u, args.num_new_handles);
+    oskar_ThreadPool* pool = oskar_thread_pool_create(1);
+    oskar_TaskGroup* group = oskar_task_group_create(pool);
+    oskar_thread_pool_submit(pool, group, alias_loop, &args, -1);
+    oskar_task_group_wait(group);
+    oskar_task_group_free(group);
+    oskar_thread_pool_free(pool);
+    EXPECT_EQ(0u, args.num_new_handles);
+    oskar_mem_allocator_stats(&s1);
+    EXPECT_EQ(0u, s1.num_allocs - s0.num_allocs);
+
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    oskar_mem_allocator_stats(&s0);
+    EXPECT_EQ(2u, s0.num_frees - s1.num_frees);
+    EXPECT_EQ(8040u, s1.bytes_in_use - s0.bytes_in_use);
+}
+
+
+TEST(Mem, arena)
+{
+    int i, status = 0;
+    size_t capacity = 0;
+    oskar_MemAllocStats s0, s1;
+    oskar_MemArena* arena = oskar_mem_arena_create();
+    for (i = 0; i < 4; ++i)
+    {
+        oskar_Mem *a, *b, *c;
+        oskar_mem_arena_reset(arena);
+        if (i == 2)
+        {
+            capacity = oskar_mem_arena_capacity(arena);
+            oskar_mem_allocator_stats(&s0);
+        }
+        a = oskar_mem_arena_get(arena, OSKAR_DOUBLE_COMPLEX, 1001, &status);
+        b = oskar_mem_arena_get(arena, OSKAR_SINGLE, 3, &status);
+        c = oskar_mem_arena_get(arena, OSKAR_INT, 500, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(1001u, oskar_mem_length(a));
+        EXPECT_EQ((int)OSKAR_SINGLE, oskar_mem_type(b));
+        EXPECT_EQ(0u, (size_t)oskar_mem_void(a) % OSKAR_MEM_ALIGNMENT);
+        EXPECT_EQ(0u, (size_t)oskar_mem_void(b) % OSKAR_MEM_ALIGNMENT);
+        EXPECT_EQ(0u, (size_t)oskar_mem_void(c) % OSKAR_MEM_ALIGNMENT);
+        if (i > 0)
+        {
+            EXPECT_GE((char*)oskar_mem_void(b),
+                    (char*)oskar_mem_void(a) + 1001 * 16);
+        }
+        oskar_mem_clear_contents(c, &status);
+    }
+
+    /* After the first reset, the arena should not allocate any more. */
+    oskar_mem_allocator_stats(&s1);
+    EXPECT_GT(capacity, 0u);
+    EXPECT_EQ(capacity, oskar_mem_arena_capacity(arena));
+    EXPECT_EQ(0u, s1.num_allocs - s0.num_allocs);
+    oskar_mem_arena_free(arena);
+}
+
+TEST(Mem, accounting)
+{
+    int status = 0;
+    const int cat = OSKAR_MEM_CAT_JONES;
+    size_t current0, peak0;
+    oskar_mem_accounting_reset_peak();
+    current0 = oskar_mem_accounting_current(cat, OSKAR_CPU);
+    peak0 = oskar_mem_accounting_peak(-1, OSKAR_CPU);
+
+    /* Arrays are charged to the category set when they are created. */
+    int previous = oskar_mem_set_category(cat);
+    oskar_Mem* a = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1000, &status);
+    oskar_mem_set_category(previous);
+    oskar_Mem* b = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(current0 + 8000, oskar_mem_accounting_current(cat, OSKAR_CPU));
+
+    /* Resizing keeps the category, and updates the peak. */
+    oskar_mem_realloc(a, 3000, &status);
+    oskar_mem_realloc(a, 500, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(current0 + 4000, oskar_mem_accounting_current(cat, OSKAR_CPU));
+    EXPECT_GE(oskar_mem_accounting_peak(cat, OSKAR_CPU), current0 + 24000);
+    EXPECT_GE(oskar_mem_accounting_peak(-1, OSKAR_CPU), peak0 + 32000);
+
+    /* Aliases hold no memory of their own. */
+    oskar_Mem* c = oskar_mem_create_alias(a, 0, 100, &status);
+    oskar_mem_free(c, &status);
+    EXPECT_EQ(current0 + 4000, oskar_mem_accounting_current(cat, OSKAR_CPU));
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    EXPECT_EQ(current0, oskar_mem_accounting_current(cat, OSKAR_CPU));
+    EXPECT_STREQ("Jones", oskar_mem_category_name(cat));
+}
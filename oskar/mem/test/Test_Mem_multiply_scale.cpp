@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+
+// Checks oskar_mem_multiply_scale() against separate multiply and scale
+// on the CPU, using inputs and output at the given location.
+static void run_test(int location, int type_c, int type_a, int type_b,
+        int swap)
+{
+    int num_elements = 1000, status = 0;
+    double max_rel_error = 0.0, min_rel_error, avg_rel_error, std_rel_error;
+    const double value = 0.37;
+    oskar_Mem *a, *b, *c, *a_dev, *b_dev, *c_dev, *c_cpu;
+    a = oskar_mem_create(type_a, OSKAR_CPU, num_elements, &status);
+    b = oskar_mem_create(type_b, OSKAR_CPU, num_elements, &status);
+    c = oskar_mem_create(type_c, OSKAR_CPU, num_elements, &status);
+    oskar_mem_random_range(a, 1.0, 2.0, &status);
+    oskar_mem_random_range(b, 1.0, 2.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Reference result using separate passes.
+    if (swap)
+        oskar_mem_multiply(c, b, a, num_elements, &status);
+    else
+        oskar_mem_multiply(c, a, b, num_elements, &status);
+    oskar_mem_scale_real(c, value, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Fused result.
+    a_dev = oskar_mem_create_copy(a, location, &status);
+    b_dev = oskar_mem_create_copy(b, location, &status);
+    c_dev = oskar_mem_create(type_c, location, num_elements, &status);
+    if (swap)
+        oskar_mem_multiply_scale(c_dev, b_dev, a_dev, value, 0, &status);
+    else
+        oskar_mem_multiply_scale(c_dev, a_dev, b_dev, value, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    c_cpu = oskar_mem_create_copy(c_dev, OSKAR_CPU, &status);
+    oskar_mem_evaluate_relative_error(c_cpu, c, &min_rel_error,
+            &max_rel_error, &avg_rel_error, &std_rel_error, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_rel_error, oskar_type_is_double(type_c) ? 1e-14 : 1e-6);
+
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    oskar_mem_free(c, &status);
+    oskar_mem_free(a_dev, &status);
+    oskar_mem_free(b_dev, &status);
+    oskar_mem_free(c_dev, &status);
+    oskar_mem_free(c_cpu, &status);
+}
+
+// Use case: Scale part of an array while copying it into another one.
+static void run_copy_test(int location)
+{
+    int num_elements = 100, num = 60, status = 0;
+    oskar_Mem *in, *out, *in_dev, *out_dev;
+    in = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_elements,
+            &status);
+    double2* A = oskar_mem_double2(in, &status);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        A[i].x = (double)i + 0.1;
+        A[i].y = (double)i + 0.2;
+    }
+    in_dev = oskar_mem_create_copy(in, location, &status);
+    out_dev = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, location, num_elements,
+            &status);
+    oskar_mem_clear_contents(out_dev, &status);
+    oskar_mem_multiply_scale(out_dev, in_dev, 0, 0.5, num, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    out = oskar_mem_create_copy(out_dev, OSKAR_CPU, &status);
+    double2* B = oskar_mem_double2(out, &status);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        EXPECT_DOUBLE_EQ(i < num ? 0.5 * A[i].x : 0.0, B[i].x);
+        EXPECT_DOUBLE_EQ(i < num ? 0.5 * A[i].y : 0.0, B[i].y);
+    }
+    oskar_mem_free(in, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(in_dev, &status);
+    oskar_mem_free(out_dev, &status);
+}
+
+// Runs all the supported type combinations at the given location.
+static void run_all_types(int location)
+{
+    const int t[][3] = {
+            {OSKAR_SINGLE, OSKAR_SINGLE, OSKAR_SINGLE},
+            {OSKAR_DOUBLE, OSKAR_DOUBLE, OSKAR_DOUBLE},
+            {OSKAR_SINGLE_COMPLEX, OSKAR_SINGLE_COMPLEX,
+                    OSKAR_SINGLE_COMPLEX},
+            {OSKAR_DOUBLE_COMPLEX, OSKAR_DOUBLE_COMPLEX,
+                    OSKAR_DOUBLE_COMPLEX},
+            {OSKAR_SINGLE_COMPLEX_MATRIX, OSKAR_SINGLE_COMPLEX_MATRIX,
+                    OSKAR_SINGLE_COMPLEX_MATRIX},
+            {OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_DOUBLE_COMPLEX_MATRIX,
+                    OSKAR_DOUBLE_COMPLEX_MATRIX},
+            {OSKAR_SINGLE_COMPLEX_MATRIX, OSKAR_SINGLE_COMPLEX_MATRIX,
+                    OSKAR_SINGLE_COMPLEX},
+            {OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_DOUBLE_COMPLEX_MATRIX,
+                    OSKAR_DOUBLE_COMPLEX}};
+    for (size_t i = 0; i < sizeof(t) / sizeof(t[0]); ++i)
+    {
+        SCOPED_TRACE(i);
+        run_test(location, t[i][0], t[i][1], t[i][2], 0);
+        if (t[i][1] != t[i][2])
+            run_test(location, t[i][0], t[i][1], t[i][2], 1);
+    }
+    run_copy_test(location);
+}
+
+TEST(Mem, multiply_scale_real)
+{
+    run_test(OSKAR_CPU, OSKAR_SINGLE, OSKAR_SINGLE, OSKAR_SINGLE, 0);
+    run_test(OSKAR_CPU, OSKAR_DOUBLE, OSKAR_DOUBLE, OSKAR_DOUBLE, 0);
+}
+
+TEST(Mem, multiply_scale_complex)
+{
+    run_test(OSKAR_CPU, OSKAR_SINGLE_COMPLEX, OSKAR_SINGLE_COMPLEX,
+            OSKAR_SINGLE_COMPLEX, 0);
+    run_test(OSKAR_CPU, OSKAR_DOUBLE_COMPLEX, OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE_COMPLEX, 0);
+}
+
+TEST(Mem, multiply_scale_matrix)
+{
+    run_test(OSKAR_CPU, OSKAR_SINGLE_COMPLEX_MATRIX,
+            OSKAR_SINGLE_COMPLEX_MATRIX, OSKAR_SINGLE_COMPLEX_MATRIX, 0);
+    run_test(OSKAR_CPU, OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_DOUBLE_COMPLEX_MATRIX, 0);
+}
+
+TEST(Mem, multiply_scale_matrix_complex)
+{
+    run_test(OSKAR_CPU, OSKAR_SINGLE_COMPLEX_MATRIX,
+            OSKAR_SINGLE_COMPLEX_MATRIX, OSKAR_SINGLE_COMPLEX, 0);
+    run_test(OSKAR_CPU, OSKAR_SINGLE_COMPLEX_MATRIX,
+            OSKAR_SINGLE_COMPLEX_MATRIX, OSKAR_SINGLE_COMPLEX, 1);
+    run_test(OSKAR_CPU, OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_DOUBLE_COMPLEX, 0);
+    run_test(OSKAR_CPU, OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_DOUBLE_COMPLEX, 1);
+}
+
+TEST(Mem, multiply_scale_copy)
+{
+    run_copy_test(OSKAR_CPU);
+}
+
+#ifdef OSKAR_HAVE_CUDA
+TEST(Mem, multiply_scale_gpu)
+{
+    run_all_types(OSKAR_GPU);
+}
+#endif
+
+#ifdef OSKAR_HAVE_OPENCL
+TEST(Mem, multiply_scale_cl)
+{
+    run_all_types(OSKAR_CL);
+}
+#endif
+
+TEST(Mem, multiply_scale_type_mismatch)
+{
+    int status = 0;
+    oskar_Mem *a, *b, *c;
+    a = oskar_mem_create(OSKAR_SINGLE_COMPLEX, OSKAR_CPU, 10, &status);
+    b = oskar_mem_create(OSKAR_SINGLE_COMPLEX, OSKAR_CPU, 10, &status);
+    c = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU, 10, &status);
+    oskar_mem_multiply_scale(c, a, b, 2.0, 0, &status);
+    EXPECT_EQ((int)OSKAR_ERR_TYPE_MISMATCH, status);
+    status = 0;
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    oskar_mem_free(c, &status);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -34,6 +34,7 @@
  */
 
 #include <oskar_global.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -173,6 +174,22 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
         unsigned int num_channels, unsigned int num_baselines,
         const float* vis);
 
+/**
+ * @brief
+ * Returns a scratch buffer owned by the Measurement Set handle.
+ *
+ * @details
+ * Returns a pointer to a buffer of at least \p size_bytes, which callers
+ * can use to assemble data before passing it to the write functions.
+ * The buffer is kept for the lifetime of the handle, and is only
+ * reallocated if a larger size is requested, so its contents are not
+ * preserved between calls.
+ *
+ * @param[in] size_bytes    Minimum size of the buffer, in bytes.
+ */
+OSKAR_MS_EXPORT
+void* oskar_ms_staging_buffer(oskar_MeasurementSet* p, size_t size_bytes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,7 +34,13 @@ struct oskar_MeasurementSet
     casacore::MSColumns* msc;       // Pointer to the sub-tables.
     casacore::MSMainColumns* msmc;  // Pointer to the main columns.
     char* app_name;
-    unsigned int *a1, *a2;
+    int *a1, *a2;                   // Baseline antenna indices.
+    void* stage_user;               // Scratch buffer for callers.
+    casacore::Complex* stage_vis;   // Staging buffer for DATA column.
+    double *stage_uvw, *stage_scalar; // Staging buffers for coordinates.
+    float* stage_weight;            // Unit weights for WEIGHT and SIGMA.
+    size_t stage_user_bytes, stage_vis_len, stage_uvw_len, stage_scalar_len;
+    size_t stage_weight_len;
     unsigned int num_pols, num_channels, num_stations, num_receptors;
     int data_written;
     double freq_start_hz, freq_inc_hz;
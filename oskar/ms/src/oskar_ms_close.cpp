@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,6 +44,11 @@ void oskar_ms_close(oskar_MeasurementSet* p)
         delete p->ms;
     free(p->a1);
     free(p->a2);
+    free(p->stage_user);
+    free(p->stage_vis);
+    free(p->stage_uvw);
+    free(p->stage_scalar);
+    free(p->stage_weight);
     free(p->app_name);
     free(p);
 }
@@ -32,6 +32,9 @@
 #include <tables/Tables.h>
 #include <casa/Arrays/Vector.h>
 
+#include <cstdlib>
+#include <cstring>
+
 using namespace casacore;
 
 static void oskar_ms_create_baseline_indices(oskar_MeasurementSet* p,
@@ -39,9 +42,9 @@ static void oskar_ms_create_baseline_indices(oskar_MeasurementSet* p,
 {
     bool write_auto_corr = false, write_cross_corr = false;
     unsigned int num_stations = p->num_stations;
-    size_t size_bytes = num_baselines * sizeof(unsigned int);
-    p->a1 = (unsigned int*) realloc(p->a1, size_bytes);
-    p->a2 = (unsigned int*) realloc(p->a2, size_bytes);
+    size_t size_bytes = num_baselines * sizeof(int);
+    p->a1 = (int*) realloc(p->a1, size_bytes);
+    p->a2 = (int*) realloc(p->a2, size_bytes);
     if (num_baselines == num_stations * (num_stations + 1) / 2)
     {
         write_auto_corr = true;
@@ -63,16 +66,16 @@ static void oskar_ms_create_baseline_indices(oskar_MeasurementSet* p,
         {
             if (write_auto_corr)
             {
-                p->a1[i] = s1;
-                p->a2[i] = s1;
+                p->a1[i] = (int) s1;
+                p->a2[i] = (int) s1;
                 ++i;
             }
             if (write_cross_corr)
             {
                 for (unsigned int s2 = s1 + 1; s2 < num_stations; ++i, ++s2)
                 {
-                    p->a1[i] = s1;
-                    p->a2[i] = s2;
+                    p->a1[i] = (int) s1;
+                    p->a2[i] = (int) s2;
                 }
             }
         }
@@ -93,10 +96,6 @@ void oskar_ms_write_coords(oskar_MeasurementSet* p,
     MSMainColumns* msmc = p->msmc;
     if (!msmc) return;
 
-    // Allocate storage for a (u,v,w) coordinate and a visibility weight.
-    Vector<Double> uvw(3);
-    Vector<Float> weight(p->num_pols, 1.0), sigma(p->num_pols, 1.0);
-
     // Get references to columns.
     ArrayColumn<Double>& col_uvw = msmc->uvw();
     ScalarColumn<Int>& col_antenna1 = msmc->antenna1();
@@ -115,23 +114,64 @@ void oskar_ms_write_coords(oskar_MeasurementSet* p,
     if (!p->a1 || !p->a2)
         oskar_ms_create_baseline_indices(p, num_baselines);
 
-    // Loop over rows to add.
+    // Resize the staging buffers if required.
+    // The weights are all 1, so only need to be set when resized.
+    if (p->stage_uvw_len < num_baselines)
+    {
+        double* t = (double*) realloc(p->stage_uvw,
+                3 * num_baselines * sizeof(double));
+        if (!t) return;
+        p->stage_uvw = t;
+        p->stage_uvw_len = num_baselines;
+    }
+    if (p->stage_scalar_len < num_baselines)
+    {
+        double* t = (double*) realloc(p->stage_scalar,
+                num_baselines * sizeof(double));
+        if (!t) return;
+        p->stage_scalar = t;
+        p->stage_scalar_len = num_baselines;
+    }
+    if (p->stage_weight_len < p->num_pols * num_baselines)
+    {
+        const size_t len = p->num_pols * num_baselines;
+        float* t = (float*) realloc(p->stage_weight, len * sizeof(float));
+        if (!t) return;
+        p->stage_weight = t;
+        p->stage_weight_len = len;
+        for (size_t i = 0; i < p->stage_weight_len; ++i)
+            p->stage_weight[i] = 1.0f;
+    }
+
+    // Wrap the staging buffers in arrays without copying.
+    Array<Double> uvw(IPosition(2, 3, num_baselines), p->stage_uvw, SHARE);
+    Array<Float> weight(IPosition(2, p->num_pols, num_baselines),
+            p->stage_weight, SHARE);
+    Vector<Int> antenna1(IPosition(1, num_baselines), p->a1, SHARE);
+    Vector<Int> antenna2(IPosition(1, num_baselines), p->a2, SHARE);
+    Vector<Double> scalar(IPosition(1, num_baselines), p->stage_scalar, SHARE);
     for (unsigned int r = 0; r < num_baselines; ++r)
     {
-        // Write the data to the Measurement Set.
-        unsigned int row = r + start_row;
-        uvw(0) = uu[r]; uvw(1) = vv[r]; uvw(2) = ww[r];
-        col_uvw.put(row, uvw);
-        col_antenna1.put(row, p->a1[r]);
-        col_antenna2.put(row, p->a2[r]);
-        col_weight.put(row, weight);
-        col_sigma.put(row, sigma);
-        col_exposure.put(row, exposure_sec);
-        col_interval.put(row, interval_sec);
-        col_time.put(row, time_stamp);
-        col_timeCentroid.put(row, time_stamp);
+        p->stage_uvw[3 * r + 0] = uu[r];
+        p->stage_uvw[3 * r + 1] = vv[r];
+        p->stage_uvw[3 * r + 2] = ww[r];
     }
 
+    // Write whole column slices for all the rows.
+    Slicer row_range(IPosition(1, start_row), IPosition(1, num_baselines));
+    col_uvw.putColumnRange(row_range, uvw);
+    col_antenna1.putColumnRange(row_range, antenna1);
+    col_antenna2.putColumnRange(row_range, antenna2);
+    col_weight.putColumnRange(row_range, weight);
+    col_sigma.putColumnRange(row_range, weight);
+    scalar = exposure_sec;
+    col_exposure.putColumnRange(row_range, scalar);
+    scalar = interval_sec;
+    col_interval.putColumnRange(row_range, scalar);
+    scalar = time_stamp;
+    col_time.putColumnRange(row_range, scalar);
+    col_timeCentroid.putColumnRange(row_range, scalar);
+
     // Update time range if required.
     if (time_stamp < p->start_time)
         p->start_time = time_stamp - interval_sec/2.0;
@@ -167,22 +207,32 @@ void oskar_ms_write_vis(oskar_MeasurementSet* p,
     MSMainColumns* msmc = p->msmc;
     if (!msmc) return;
 
-    // Allocate storage for the block of visibility data.
+    // Resize the staging buffer for the block of visibility data.
     unsigned int num_pols = p->num_pols;
+    size_t len = (size_t)num_pols * num_channels * num_baselines;
+    if (p->stage_vis_len < len)
+    {
+        Complex* t = (Complex*) realloc(p->stage_vis, len * sizeof(Complex));
+        if (!t) return;
+        p->stage_vis = t;
+        p->stage_vis_len = len;
+    }
     IPosition shape(3, num_pols, num_channels, num_baselines);
-    Array<Complex> vis_data(shape);
+    Array<Complex> vis_data(shape, p->stage_vis, SHARE);
 
     // Copy visibility data into the array,
     // swapping baseline and channel dimensions.
-    float* out = (float*) vis_data.data();
+    float* out = (float*) p->stage_vis;
     for (unsigned int c = 0; c < num_channels; ++c)
     {
         for (unsigned int b = 0; b < num_baselines; ++b)
         {
-            for (unsigned int p = 0; p < num_pols; ++p)
+            for (unsigned int k = 0; k < num_pols; ++k)
             {
-                unsigned int i = (num_pols * (c * num_baselines + b) + p) << 1;
-                unsigned int j = (num_pols * (b * num_channels + c) + p) << 1;
+                size_t i = num_pols * ((size_t)c * num_baselines + b) + k;
+                size_t j = num_pols * ((size_t)b * num_channels + c) + k;
+                i <<= 1;
+                j <<= 1;
                 out[j]     = vis[i];
                 out[j + 1] = vis[i + 1];
             }
@@ -223,3 +273,15 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
     oskar_ms_write_vis(p, start_row, start_channel,
             num_channels, num_baselines, vis);
 }
+
+void* oskar_ms_staging_buffer(oskar_MeasurementSet* p, size_t size_bytes)
+{
+    if (p->stage_user_bytes < size_bytes)
+    {
+        void* t = realloc(p->stage_user, size_bytes);
+        if (!t) return 0;
+        p->stage_user = t;
+        p->stage_user_bytes = size_bytes;
+    }
+    return p->stage_user;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -182,3 +182,67 @@ TEST(MeasurementSet, test_multi_channel)
     free(uvw);
     oskar_ms_close(ms);
 }
+
+
+TEST(MeasurementSet, test_presized_columns)
+{
+    int status = 0;
+    int n_ant = 4, n_times = 3;
+    int n_baselines = n_ant * (n_ant + 1) / 2;
+    int n_rows = n_baselines * n_times;
+    double interval = 10.0;
+
+    // Create the Measurement Set, and add all the rows up front.
+    oskar_MeasurementSet* ms = oskar_ms_create("presized.ms", "test",
+            n_ant, 1, 1, 400e6, 1.0, 1, 1);
+    ASSERT_TRUE(ms);
+    oskar_ms_ensure_num_rows(ms, n_rows);
+    ASSERT_EQ((unsigned int)n_rows, oskar_ms_num_rows(ms));
+
+    // Write the coordinates, last time step first.
+    std::vector<double> u(n_baselines), v(n_baselines), w(n_baselines);
+    for (int t = n_times - 1; t >= 0; --t)
+    {
+        for (int b = 0; b < n_baselines; ++b)
+        {
+            u[b] = 10.0 * t + b;
+            v[b] = -u[b];
+            w[b] = 0.5 * u[b];
+        }
+        oskar_ms_write_coords_d(ms, t * n_baselines, n_baselines,
+                &u[0], &v[0], &w[0], interval, interval, (t + 0.5) * interval);
+    }
+    ASSERT_EQ((unsigned int)n_rows, oskar_ms_num_rows(ms));
+
+    // Read the columns back.
+    std::vector<double> uvw(3 * n_rows), time(n_rows);
+    std::vector<int> ant1(n_rows), ant2(n_rows);
+    size_t required_size = 0;
+    oskar_ms_read_column(ms, "UVW", 0, n_rows, uvw.size() * sizeof(double),
+            &uvw[0], &required_size, &status);
+    oskar_ms_read_column(ms, "TIME", 0, n_rows, time.size() * sizeof(double),
+            &time[0], &required_size, &status);
+    oskar_ms_read_column(ms, "ANTENNA1", 0, n_rows, ant1.size() * sizeof(int),
+            &ant1[0], &required_size, &status);
+    oskar_ms_read_column(ms, "ANTENNA2", 0, n_rows, ant2.size() * sizeof(int),
+            &ant2[0], &required_size, &status);
+    ASSERT_EQ(0, status);
+
+    // Check the data.
+    for (int t = 0, r = 0; t < n_times; ++t)
+    {
+        for (int ai = 0, b = 0; ai < n_ant; ++ai)
+        {
+            for (int aj = ai; aj < n_ant; ++aj, ++b, ++r)
+            {
+                ASSERT_EQ(10.0 * t + b, uvw[3 * r + 0]);
+                ASSERT_EQ(-(10.0 * t + b), uvw[3 * r + 1]);
+                ASSERT_EQ(0.5 * (10.0 * t + b), uvw[3 * r + 2]);
+                ASSERT_EQ((t + 0.5) * interval, time[r]);
+                ASSERT_EQ(ai, ant1[r]);
+                ASSERT_EQ(aj, ant2[r]);
+            }
+        }
+    }
+    oskar_ms_close(ms);
+}
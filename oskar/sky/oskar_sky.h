@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2016, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -62,7 +62,9 @@ enum OSKAR_SKY_TAGS
     OSKAR_SKY_TAG_FWHM_MAJOR = 11,
     OSKAR_SKY_TAG_FWHM_MINOR = 12,
     OSKAR_SKY_TAG_POSITION_ANGLE = 13,
-    OSKAR_SKY_TAG_ROTATION_MEASURE = 14
+    OSKAR_SKY_TAG_ROTATION_MEASURE = 14,
+    OSKAR_SKY_TAG_SOURCE_FILE_SIZE = 15,
+    OSKAR_SKY_TAG_SOURCE_FILE_MTIME = 16
 };
 
 #ifdef __cplusplus
@@ -72,6 +74,7 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_accessors.h>
 #include <sky/oskar_sky_append_to_set.h>
 #include <sky/oskar_sky_append.h>
+#include <sky/oskar_sky_bounding_cap.h>
 #include <sky/oskar_sky_copy.h>
 #include <sky/oskar_sky_copy_contents.h>
 #include <sky/oskar_sky_create.h>
@@ -87,9 +90,12 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_generate_grid.h>
 #include <sky/oskar_sky_generate_random_power_law.h>
 #include <sky/oskar_sky_horizon_clip.h>
+#include <sky/oskar_sky_index.h>
 #include <sky/oskar_sky_load.h>
+#include <sky/oskar_sky_load_cached.h>
 #include <sky/oskar_sky_override_polarisation.h>
 #include <sky/oskar_sky_read.h>
+#include <sky/oskar_sky_rebin.h>
 #include <sky/oskar_sky_resize.h>
 #include <sky/oskar_sky_rotate_to_position.h>
 #include <sky/oskar_sky_save.h>
@@ -97,6 +103,7 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_set_gaussian_parameters.h>
 #include <sky/oskar_sky_set_source.h>
 #include <sky/oskar_sky_set_spectral_index.h>
+#include <sky/oskar_sky_sort_spatially.h>
 #include <sky/oskar_sky_write.h>
 
 
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_INDEX_H_
+#define OSKAR_SKY_INDEX_H_
+
+/**
+ * @file oskar_sky_index.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_SkyIndex;
+#ifndef OSKAR_SKY_INDEX_TYPEDEF_
+#define OSKAR_SKY_INDEX_TYPEDEF_
+typedef struct oskar_SkyIndex oskar_SkyIndex;
+#endif /* OSKAR_SKY_INDEX_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates a spatial index of the source positions in a sky model.
+ *
+ * @details
+ * Creates an index which can be used to find sources near a given
+ * position on the sky, without checking every source.
+ *
+ * The source positions are converted to unit vectors and sorted into
+ * a grid of cubic cells, sized so that there is about one source per cell.
+ * Queries then only need to check the cells close to the given position.
+ * Building the index takes O(n log n) time.
+ *
+ * The index holds a copy of the source positions, so the sky model may be
+ * freed afterwards, but the index must be re-created if the source
+ * positions change. Queries do not modify the index, so they may be made
+ * from multiple threads at the same time.
+ *
+ * The sky model must reside in CPU memory.
+ *
+ * @param[in] sky         Pointer to sky model.
+ * @param[in,out] status  Status return code.
+ *
+ * @return A handle to the new index.
+ */
+OSKAR_EXPORT
+oskar_SkyIndex* oskar_sky_index_create(const oskar_Sky* sky, int* status);
+
+/**
+ * @brief
+ * Frees memory held by a sky model index.
+ *
+ * @details
+ * Frees memory held by a sky model index.
+ *
+ * @param[in] index  Handle to the index.
+ */
+OSKAR_EXPORT
+void oskar_sky_index_free(oskar_SkyIndex* index);
+
+/**
+ * @brief
+ * Returns the number of sources in the index.
+ *
+ * @details
+ * Returns the number of sources in the index.
+ *
+ * @param[in] index  Handle to the index.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_num_sources(const oskar_SkyIndex* index);
+
+/**
+ * @brief
+ * Returns the index of the source nearest to a given position.
+ *
+ * @details
+ * Returns the index of the source nearest to the given position,
+ * or -1 if the index contains no sources. If more than one source is
+ * at the same distance, the one with the smallest index is returned.
+ *
+ * @param[in] index     Handle to the index.
+ * @param[in] ra_rad    Right Ascension of the position, in radians.
+ * @param[in] dec_rad   Declination of the position, in radians.
+ * @param[out] dist_rad If not NULL, the angular distance to the source,
+ *                      in radians.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double* dist_rad);
+
+/**
+ * @brief
+ * Finds the sources nearest to a given position.
+ *
+ * @details
+ * Finds the \p k sources nearest to the given position, and returns
+ * the number found, which is less than \p k only if the index contains
+ * fewer sources.
+ *
+ * The source indices are returned in order of increasing distance
+ * (sources at the same distance are in index order).
+ * The arrays are resized if necessary.
+ *
+ * @param[in] index       Handle to the index.
+ * @param[in] ra_rad      Right Ascension of the position, in radians.
+ * @param[in] dec_rad     Declination of the position, in radians.
+ * @param[in] k           Number of sources to find.
+ * @param[out] indices    Source indices (integer type, CPU memory).
+ * @param[out] dist_rad   If not NULL, angular distance to each source,
+ *                        in radians (double type, CPU memory).
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_query_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, int k, oskar_Mem* indices,
+        oskar_Mem* dist_rad, int* status);
+
+/**
+ * @brief
+ * Finds the sources within a given radius of a position.
+ *
+ * @details
+ * Finds all sources within \p radius_rad of the given position, and
+ * returns the number found. The source indices are returned in
+ * increasing order. The arrays are resized if necessary.
+ *
+ * @param[in] index       Handle to the index.
+ * @param[in] ra_rad      Right Ascension of the position, in radians.
+ * @param[in] dec_rad     Declination of the position, in radians.
+ * @param[in] radius_rad  Search radius, in radians.
+ * @param[out] indices    Source indices (integer type, CPU memory).
+ * @param[out] dist_rad   If not NULL, angular distance to each source,
+ *                        in radians (double type, CPU memory).
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_query_radius(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double radius_rad, oskar_Mem* indices,
+        oskar_Mem* dist_rad, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_INDEX_H_ */
@@ -84,6 +84,9 @@ extern "C" {
  * - Lines containing 10 or 13 or more columns set the status flag to
  *   indicate an error, and abort the load.
  *
+ * Large files are split at line boundaries and parsed in parallel using
+ * all available CPU cores.
+ *
  * @param[in]  filename  Path to a source list text file.
  * @param[in]  type      Required data type (OSKAR_SINGLE or OSKAR_DOUBLE).
  * @param[in,out] status Status return code.
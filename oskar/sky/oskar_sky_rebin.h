@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_REBIN_H_
+#define OSKAR_SKY_REBIN_H_
+
+/**
+ * @file oskar_sky_rebin.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Rebins the sources in a sky model onto the positions of another.
+ *
+ * @details
+ * Each source in the input sky model is assigned to the nearest source
+ * position in the output sky model, and its Stokes parameters are added
+ * to those of the output source. Nearest positions are found using a
+ * spatial index of the output sky model (see oskar_sky_index_create()),
+ * so the time taken scales with the number of sources rather than the
+ * product of the numbers of input and output sources.
+ *
+ * Input fluxes are first scaled to the reference frequency of the output
+ * source using their spectral index and rotation measure. If the output
+ * source has no reference frequency, that of the first input source
+ * assigned to it is used instead. The spectral index of each output source
+ * is set to the Stokes I weighted mean of those of its input sources,
+ * and its rotation measure to the mean weighted by polarised flux.
+ * The positions and Gaussian source parameters of the output sources
+ * are not changed. Output sources with no input sources assigned to them
+ * have zero flux.
+ *
+ * The sky models may have different precisions, but both must be in
+ * CPU memory.
+ *
+ * @param[in,out] out     Sky model defining the output source positions.
+ * @param[in]     in      Sky model containing the sources to rebin.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_rebin(oskar_Sky* out, const oskar_Sky* in, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_REBIN_H_ */
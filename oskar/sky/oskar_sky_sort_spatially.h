@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_SORT_SPATIALLY_H_
+#define OSKAR_SKY_SORT_SPATIALLY_H_
+
+/**
+ * @file oskar_sky_sort_spatially.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Sorts the sources in a sky model so that neighbouring sources on the
+ * sky are close together in the arrays.
+ *
+ * @details
+ * Sources are ordered along a space-filling curve: each source direction
+ * is projected onto the face of a cube enclosing the sphere, and sources
+ * are sorted by face and then by the distance along a Hilbert curve
+ * covering the face.
+ *
+ * When a sorted sky model is split into chunks, each chunk covers a
+ * compact region of the sky, which can be described by a small
+ * bounding cap (see oskar_sky_bounding_cap()).
+ *
+ * The sky model must be in CPU memory.
+ *
+ * @param[in,out] sky     Sky model to sort.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_sort_spatially(oskar_Sky* sky, int* status);
+
+/**
+ * @brief
+ * Appends a sky model to a set of sky models, with the sources sorted
+ * spatially.
+ *
+ * @details
+ * Sources in \p model are appended to the set in the order used by
+ * oskar_sky_sort_spatially(), without modifying \p model.
+ * The sources are gathered into the set one block of
+ * \p max_sources_per_model at a time, so no sorted copy of the whole
+ * sky model is made.
+ *
+ * See oskar_sky_append_to_set() for a description of the set.
+ *
+ * @param[in,out] set_size              Number of sky models in the set.
+ * @param[in,out] set_ptr               Pointer to the set of sky models.
+ * @param[in] max_sources_per_model     Maximum number of sources per model.
+ * @param[in] model                     Sky model to append (CPU memory).
+ * @param[in,out] status                Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_append_to_set_sorted(int* set_size, oskar_Sky*** set_ptr,
+        int max_sources_per_model, const oskar_Sky* model, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_SORT_SPATIALLY_H_ */
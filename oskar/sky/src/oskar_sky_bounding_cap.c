@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAP_CENTRE(FP) { \
+    const FP *ra_, *dec_; \
+    ra_ = (const FP*) oskar_mem_void_const(oskar_sky_ra_rad_const(sky)); \
+    dec_ = (const FP*) oskar_mem_void_const(oskar_sky_dec_rad_const(sky)); \
+    for (i = 0; i < num_sources; ++i) { \
+        const double cos_dec = cos((double) dec_[i]); \
+        x += cos_dec * cos((double) ra_[i]); \
+        y += cos_dec * sin((double) ra_[i]); \
+        z += sin((double) dec_[i]); \
+    } \
+    }
+
+#define CAP_RADIUS(FP) { \
+    const FP *ra_, *dec_; \
+    ra_ = (const FP*) oskar_mem_void_const(oskar_sky_ra_rad_const(sky)); \
+    dec_ = (const FP*) oskar_mem_void_const(oskar_sky_dec_rad_const(sky)); \
+    for (i = 0; i < num_sources; ++i) { \
+        double dot; \
+        const double cos_dec = cos((double) dec_[i]); \
+        dot = x * cos_dec * cos((double) ra_[i]) + \
+                y * cos_dec * sin((double) ra_[i]) + \
+                z * sin((double) dec_[i]); \
+        if (dot < min_dot) min_dot = dot; \
+    } \
+    }
+
+void oskar_sky_bounding_cap(const oskar_Sky* sky, double* ra_rad,
+        double* dec_rad, double* radius_rad, int* status)
+{
+    int i, num_sources, type;
+    double x = 0.0, y = 0.0, z = 0.0, len, min_dot = 1.0;
+
+    /* Check if safe to proceed. */
+    *ra_rad = *dec_rad = 0.0;
+    *radius_rad = -1.0;
+    if (*status) return;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    type = oskar_sky_precision(sky);
+    num_sources = oskar_sky_num_sources(sky);
+    if (num_sources == 0) return;
+
+    /* Find the mean direction. */
+    if (type == OSKAR_DOUBLE)
+        CAP_CENTRE(double)
+    else if (type == OSKAR_SINGLE)
+        CAP_CENTRE(float)
+    else
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    len = sqrt(x*x + y*y + z*z);
+    if (len < 1e-9 * num_sources)
+    {
+        /* Sources are spread evenly: use the whole sphere. */
+        *dec_rad = M_PI / 2.0;
+        *radius_rad = M_PI;
+        return;
+    }
+    x /= len;
+    y /= len;
+    z /= len;
+    *ra_rad = atan2(y, x);
+    *dec_rad = atan2(z, sqrt(x*x + y*y));
+
+    /* Find the source furthest from the mean direction. */
+    if (type == OSKAR_DOUBLE)
+        CAP_RADIUS(double)
+    else
+        CAP_RADIUS(float)
+    if (min_dot < -1.0) min_dot = -1.0;
+    *radius_rad = acos(min_dot);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,11 +31,22 @@
 #include "sky/oskar_sky_copy_source_data.h"
 #include "sky/oskar_update_horizon_mask.h"
 
+#include <math.h>
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Margin allowed for rounding errors when classifying sources. */
+#define CLIP_MARGIN 1e-5
+
 static double ha0(double longitude, double ra0, double gast);
+static void station_zenith(double ha0_rad, double dec0_rad, double lat_rad,
+        double* ll, double* mm, double* nn);
+static int horizon_mask_bounded(int num_in, const oskar_Sky* in,
+        const oskar_Telescope* telescope, double gast, oskar_Mem* mask,
+        int* status);
 
 void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
         const oskar_Telescope* telescope, double gast,
@@ -84,7 +95,17 @@ void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
     if ((int)oskar_mem_length(source_indices) < num_in)
         oskar_mem_realloc(source_indices, num_in, status);
 
-    /* Create the horizon mask. */
+    /* Create the horizon mask.
+     * On the CPU, first try to use a bound around all stations, so that
+     * only sources near the horizon need to be checked for each station. */
+    if (location == OSKAR_CPU &&
+            horizon_mask_bounded(num_in, in, telescope, gast,
+                    horizon_mask, status))
+    {
+        oskar_sky_copy_source_data(in, horizon_mask, source_indices,
+                out, status);
+        return;
+    }
     oskar_mem_clear_contents(horizon_mask, status);
     num_stations = oskar_telescope_num_stations(telescope);
     for (i = 0; i < num_stations; ++i)
@@ -109,6 +130,134 @@ static double ha0(double longitude, double ra0, double gast)
     return (gast + longitude) - ra0;
 }
 
+/* Direction of the station zenith, relative to the phase centre.
+ * This must match the calculation in oskar_update_horizon_mask(). */
+static void station_zenith(double ha0_rad, double dec0_rad, double lat_rad,
+        double* ll, double* mm, double* nn)
+{
+    double cos_ha0, sin_dec0, cos_dec0, sin_lat, cos_lat;
+    cos_ha0  = cos(ha0_rad);
+    sin_dec0 = sin(dec0_rad);
+    cos_dec0 = cos(dec0_rad);
+    sin_lat  = sin(lat_rad);
+    cos_lat  = cos(lat_rad);
+    *ll = cos_lat * sin(ha0_rad);
+    *mm = sin_lat * cos_dec0 - cos_lat * cos_ha0 * sin_dec0;
+    *nn = sin_lat * sin_dec0 + cos_lat * cos_ha0 * cos_dec0;
+}
+
+#define CLASSIFY_SOURCES(FP) \
+        for (i = 0; i < num_in; ++i) \
+        { \
+            const double d = l_[i] * c[0] + m_[i] * c[1] + n_[i] * c[2]; \
+            if (d > bound) mask_[i] = 1; \
+            else if (d < -bound) mask_[i] = 0; \
+            else \
+            { \
+                const FP* z_ = (const FP*) zenith; \
+                mask_[i] = 0; \
+                for (j = 0; j < num_stations; ++j, z_ += 3) \
+                    if ((l_[i] * z_[0] + m_[i] * z_[1] + n_[i] * z_[2]) > 0) \
+                    { \
+                        mask_[i] = 1; \
+                        break; \
+                    } \
+            } \
+        }
+
+/*
+ * Sets the horizon mask using a cone that contains the zenith directions of
+ * all stations. If the angle between a source and the cone axis is less than
+ * (90 degrees - cone radius), the source must be above the horizon for all
+ * stations; if it is more than (90 degrees + cone radius), it must be below
+ * the horizon for all stations. Only sources in between are checked against
+ * each station in turn, using the same arithmetic as
+ * oskar_update_horizon_mask(), so the result is the same.
+ *
+ * Returns 0 if the stations are too widely separated for this to help.
+ */
+static int horizon_mask_bounded(int num_in, const oskar_Sky* in,
+        const oskar_Telescope* telescope, double gast, oskar_Mem* mask,
+        int* status)
+{
+    int i, j, num_stations, type, *mask_;
+    double c[] = {0.0, 0.0, 0.0}, ra0, dec0, norm, min_dot = 1.0, bound;
+    double* zenith_d;
+    void* zenith;
+
+    /* Get the zenith direction for each station, and the cone axis. */
+    num_stations = oskar_telescope_num_stations(telescope);
+    if (num_stations < 2) return 0;
+    type = oskar_sky_precision(in);
+    ra0 = oskar_sky_reference_ra_rad(in);
+    dec0 = oskar_sky_reference_dec_rad(in);
+    zenith_d = (double*) malloc(3 * num_stations * sizeof(double));
+    for (j = 0; j < num_stations; ++j)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(telescope, j);
+        double* z = &zenith_d[3 * j];
+        station_zenith(ha0(oskar_station_lon_rad(s), ra0, gast), dec0,
+                oskar_station_lat_rad(s), &z[0], &z[1], &z[2]);
+        c[0] += z[0];
+        c[1] += z[1];
+        c[2] += z[2];
+    }
+    norm = sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    if (norm > 0.0)
+    {
+        c[0] /= norm;
+        c[1] /= norm;
+        c[2] /= norm;
+        for (j = 0; j < num_stations; ++j)
+        {
+            const double* z = &zenith_d[3 * j];
+            const double dot = z[0] * c[0] + z[1] * c[1] + z[2] * c[2];
+            if (dot < min_dot) min_dot = dot;
+        }
+    }
+
+    /* Give up if the cone is too wide (more than about 10 degrees). */
+    if (norm <= 0.0 || min_dot < 0.985)
+    {
+        free(zenith_d);
+        return 0;
+    }
+
+    /* Sine of the cone radius, plus a margin for rounding errors. */
+    bound = sqrt(1.0 - (min_dot > 1.0 ? 1.0 : min_dot * min_dot)) +
+            CLIP_MARGIN;
+
+    /* Classify all sources. */
+    zenith = zenith_d;
+    mask_ = oskar_mem_int(mask, status);
+    if (type == OSKAR_SINGLE)
+    {
+        const float *l_, *m_, *n_;
+        float* zenith_f;
+        l_ = oskar_mem_float_const(oskar_sky_l_const(in), status);
+        m_ = oskar_mem_float_const(oskar_sky_m_const(in), status);
+        n_ = oskar_mem_float_const(oskar_sky_n_const(in), status);
+        zenith_f = (float*) malloc(3 * num_stations * sizeof(float));
+        for (j = 0; j < 3 * num_stations; ++j)
+            zenith_f[j] = (float) zenith_d[j];
+        zenith = zenith_f;
+        CLASSIFY_SOURCES(float)
+        free(zenith_f);
+    }
+    else if (type == OSKAR_DOUBLE)
+    {
+        const double *l_, *m_, *n_;
+        l_ = oskar_mem_double_const(oskar_sky_l_const(in), status);
+        m_ = oskar_mem_double_const(oskar_sky_m_const(in), status);
+        n_ = oskar_mem_double_const(oskar_sky_n_const(in), status);
+        CLASSIFY_SOURCES(double)
+    }
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+    free(zenith_d);
+    return 1;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Limits the number of grid cells along each axis, so that cell keys
+ * fit in 64 bits. */
+#define MAX_CELLS_PER_AXIS 2000000
+
+struct CellKey
+{
+    unsigned long long key;
+    int index;
+};
+typedef struct CellKey CellKey;
+
+struct Match
+{
+    int index;
+    double dist2;
+};
+typedef struct Match Match;
+
+/* Uniform grid of cubic cells over the source direction cosines.
+ * Only occupied cells are stored, as a list of sources sorted by cell key,
+ * with the z cell index varying fastest. */
+struct oskar_SkyIndex
+{
+    int num_sources, num_cells;
+    double cell_size;
+    double *x, *y, *z;
+    CellKey* keys;
+};
+
+static double get(const oskar_Mem* mem, int i)
+{
+    return (oskar_mem_precision(mem) == OSKAR_DOUBLE) ?
+            ((const double*) oskar_mem_void_const(mem))[i] :
+            ((const float*) oskar_mem_void_const(mem))[i];
+}
+
+static int compare_keys(const void* a, const void* b)
+{
+    const CellKey *x = (const CellKey*) a, *y = (const CellKey*) b;
+    if (x->key != y->key) return (x->key < y->key) ? -1 : 1;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+static int compare_matches(const void* a, const void* b)
+{
+    const Match *x = (const Match*) a, *y = (const Match*) b;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+static int cell_index(const oskar_SkyIndex* h, double v)
+{
+    int c = (int) ((v + 1.0) / h->cell_size);
+    return (c < 0) ? 0 : (c >= h->num_cells ? h->num_cells - 1 : c);
+}
+
+static unsigned long long cell_key(const oskar_SkyIndex* h,
+        int ix, int iy, int iz)
+{
+    const unsigned long long n = (unsigned long long) h->num_cells;
+    return ((unsigned long long) ix * n + (unsigned long long) iy) * n +
+            (unsigned long long) iz;
+}
+
+/* Returns the position of the first source with a key not less than key. */
+static int lower_bound(const oskar_SkyIndex* h, unsigned long long key)
+{
+    int lo = 0, hi = h->num_sources;
+    while (lo < hi)
+    {
+        const int mid = lo + (hi - lo) / 2;
+        if (h->keys[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static double dist2(const oskar_SkyIndex* h, int j,
+        double x, double y, double z)
+{
+    const double dx = h->x[j] - x, dy = h->y[j] - y, dz = h->z[j] - z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+static double chord_to_angle(double dist2)
+{
+    const double t = 0.5 * sqrt(dist2);
+    return 2.0 * asin(t > 1.0 ? 1.0 : t);
+}
+
+/* Keeps the k closest sources found so far, sorted by distance. */
+static void insert(int j, double d2, int k, int* num, int* best,
+        double* best_dist2)
+{
+    int p = *num;
+    if (p == k)
+    {
+        if (d2 > best_dist2[k - 1] ||
+                (d2 == best_dist2[k - 1] && j > best[k - 1]))
+            return;
+        p--;
+    }
+    else (*num)++;
+    for (; p > 0 && (d2 < best_dist2[p - 1] ||
+            (d2 == best_dist2[p - 1] && j < best[p - 1])); --p)
+    {
+        best[p] = best[p - 1];
+        best_dist2[p] = best_dist2[p - 1];
+    }
+    best[p] = j;
+    best_dist2[p] = d2;
+}
+
+static void check_cell(const oskar_SkyIndex* h, int ix, int iy, int iz,
+        double x, double y, double z, int k, int* num, int* best,
+        double* best_dist2)
+{
+    int i;
+    unsigned long long key;
+    if (ix < 0 || iy < 0 || iz < 0 || ix >= h->num_cells ||
+            iy >= h->num_cells || iz >= h->num_cells)
+        return;
+    key = cell_key(h, ix, iy, iz);
+    for (i = lower_bound(h, key); i < h->num_sources &&
+            h->keys[i].key == key; ++i)
+    {
+        const int j = h->keys[i].index;
+        insert(j, dist2(h, j, x, y, z), k, num, best, best_dist2);
+    }
+}
+
+static int find_nearest(const oskar_SkyIndex* h, double x, double y,
+        double z, int k, int* best, double* best_dist2)
+{
+    int r, dx, dy, dz, num = 0;
+    const int ix = cell_index(h, x), iy = cell_index(h, y),
+            iz = cell_index(h, z);
+    if (k > h->num_sources) k = h->num_sources;
+    if (k <= 0) return 0;
+
+    /* Search shells of cells around the cell containing the direction.
+     * After shell r, any source not yet checked is further away than
+     * r cell widths, so the search can stop once k sources have been
+     * found at least this close. */
+    for (r = 0; ; ++r)
+    {
+        const double side = 2.0 * r + 1.0;
+        if (side * side * side > h->num_sources)
+        {
+            /* Check every source if the search region gets too large. */
+            num = 0;
+            for (r = 0; r < h->num_sources; ++r)
+                insert(r, dist2(h, r, x, y, z), k, &num, best, best_dist2);
+            return num;
+        }
+        for (dz = -r; dz <= r; ++dz)
+        {
+            for (dy = -r; dy <= r; ++dy)
+            {
+                const int face = (dz == -r || dz == r || dy == -r || dy == r);
+                const int step = (face || r == 0) ? 1 : 2 * r;
+                for (dx = -r; dx <= r; dx += step)
+                    check_cell(h, ix + dx, iy + dy, iz + dz, x, y, z,
+                            k, &num, best, best_dist2);
+            }
+        }
+        if (num == k && best_dist2[k - 1] <=
+                (r * h->cell_size) * (r * h->cell_size))
+            return num;
+    }
+}
+
+static void copy_results(const Match* matches, int num,
+        oskar_Mem* indices, oskar_Mem* dist_rad, int* status)
+{
+    int i, *idx;
+    double* dist = 0;
+    if (oskar_mem_type(indices) != OSKAR_INT ||
+            (dist_rad && oskar_mem_type(dist_rad) != OSKAR_DOUBLE))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (oskar_mem_location(indices) != OSKAR_CPU ||
+            (dist_rad && oskar_mem_location(dist_rad) != OSKAR_CPU))
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    oskar_mem_realloc(indices, num, status);
+    if (dist_rad)
+    {
+        oskar_mem_realloc(dist_rad, num, status);
+        dist = oskar_mem_double(dist_rad, status);
+    }
+    idx = oskar_mem_int(indices, status);
+    if (*status) return;
+    for (i = 0; i < num; ++i)
+    {
+        idx[i] = matches[i].index;
+        if (dist) dist[i] = chord_to_angle(matches[i].dist2);
+    }
+}
+
+oskar_SkyIndex* oskar_sky_index_create(const oskar_Sky* sky, int* status)
+{
+    int i;
+    double cap_ra, cap_dec, cap_radius, area;
+    const oskar_Mem *ra, *dec;
+    oskar_SkyIndex* h = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+    h = (oskar_SkyIndex*) calloc(1, sizeof(oskar_SkyIndex));
+    if (!h)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    h->num_sources = oskar_sky_num_sources(sky);
+    h->cell_size = 2.0;
+    h->num_cells = 1;
+    if (h->num_sources == 0) return h;
+
+    /* Choose the cell size so there is about one source per cell,
+     * using the area of the cap containing all the sources. */
+    oskar_sky_bounding_cap(sky, &cap_ra, &cap_dec, &cap_radius, status);
+    if (*status) return h;
+    area = 2.0 * M_PI * (1.0 - cos(cap_radius));
+    h->cell_size = sqrt(area / h->num_sources);
+    if (h->cell_size > 2.0)
+        h->cell_size = 2.0;
+    if (h->cell_size < 2.0 / (MAX_CELLS_PER_AXIS - 1))
+        h->cell_size = 2.0 / (MAX_CELLS_PER_AXIS - 1);
+    h->num_cells = (int) (2.0 / h->cell_size) + 1;
+
+    /* Store the direction cosines, and sort the sources by cell. */
+    h->x = (double*) malloc(h->num_sources * sizeof(double));
+    h->y = (double*) malloc(h->num_sources * sizeof(double));
+    h->z = (double*) malloc(h->num_sources * sizeof(double));
+    h->keys = (CellKey*) malloc(h->num_sources * sizeof(CellKey));
+    if (!h->x || !h->y || !h->z || !h->keys)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return h;
+    }
+    ra = oskar_sky_ra_rad_const(sky);
+    dec = oskar_sky_dec_rad_const(sky);
+    for (i = 0; i < h->num_sources; ++i)
+    {
+        const double ra_ = get(ra, i), dec_ = get(dec, i);
+        const double cos_dec = cos(dec_);
+        h->x[i] = cos_dec * cos(ra_);
+        h->y[i] = cos_dec * sin(ra_);
+        h->z[i] = sin(dec_);
+        h->keys[i].key = cell_key(h, cell_index(h, h->x[i]),
+                cell_index(h, h->y[i]), cell_index(h, h->z[i]));
+        h->keys[i].index = i;
+    }
+    qsort(h->keys, h->num_sources, sizeof(CellKey), compare_keys);
+    return h;
+}
+
+void oskar_sky_index_free(oskar_SkyIndex* index)
+{
+    if (!index) return;
+    free(index->x);
+    free(index->y);
+    free(index->z);
+    free(index->keys);
+    free(index);
+}
+
+int oskar_sky_index_num_sources(const oskar_SkyIndex* index)
+{
+    return index->num_sources;
+}
+
+int oskar_sky_index_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double* dist_rad)
+{
+    int best = -1;
+    double best_dist2 = 0.0;
+    const double cos_dec = cos(dec_rad);
+    if (!find_nearest(index, cos_dec * cos(ra_rad), cos_dec * sin(ra_rad),
+            sin(dec_rad), 1, &best, &best_dist2))
+        return -1;
+    if (dist_rad) *dist_rad = chord_to_angle(best_dist2);
+    return best;
+}
+
+int oskar_sky_index_query_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, int k, oskar_Mem* indices,
+        oskar_Mem* dist_rad, int* status)
+{
+    int i, num = 0, *best = 0;
+    double *best_dist2 = 0;
+    Match* matches = 0;
+    const double cos_dec = cos(dec_rad);
+    if (*status) return 0;
+    if (k > index->num_sources) k = index->num_sources;
+    if (k > 0)
+    {
+        best = (int*) malloc(k * sizeof(int));
+        best_dist2 = (double*) malloc(k * sizeof(double));
+        matches = (Match*) malloc(k * sizeof(Match));
+        if (!best || !best_dist2 || !matches)
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        else
+            num = find_nearest(index, cos_dec * cos(ra_rad),
+                    cos_dec * sin(ra_rad), sin(dec_rad), k,
+                    best, best_dist2);
+        for (i = 0; i < num; ++i)
+        {
+            matches[i].index = best[i];
+            matches[i].dist2 = best_dist2[i];
+        }
+    }
+    copy_results(matches, num, indices, dist_rad, status);
+    free(best);
+    free(best_dist2);
+    free(matches);
+    return *status ? 0 : num;
+}
+
+int oskar_sky_index_query_radius(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double radius_rad, oskar_Mem* indices,
+        oskar_Mem* dist_rad, int* status)
+{
+    int i, ix, iy, x0, x1, y0, y1, z0, z1, num = 0, capacity = 0;
+    double chord, chord2, box_cells;
+    Match* matches = 0;
+    const double cos_dec = cos(dec_rad);
+    const double x = cos_dec * cos(ra_rad), y = cos_dec * sin(ra_rad),
+            z = sin(dec_rad);
+    if (*status) return 0;
+
+    /* Convert the radius to the equivalent chord length. */
+    if (radius_rad < 0.0) radius_rad = -1.0;
+    chord = 2.0 * sin(0.5 * (radius_rad > M_PI ? M_PI : radius_rad));
+    chord2 = (radius_rad < 0.0) ? -1.0 : chord * chord;
+
+    /* Get the range of cells to check. */
+    x0 = cell_index(index, x - chord); x1 = cell_index(index, x + chord);
+    y0 = cell_index(index, y - chord); y1 = cell_index(index, y + chord);
+    z0 = cell_index(index, z - chord); z1 = cell_index(index, z + chord);
+    box_cells = (x1 - x0 + 1.0) * (y1 - y0 + 1.0) * (z1 - z0 + 1.0);
+    for (ix = x0; ix <= x1 && index->num_sources > 0; ++ix)
+    {
+        for (iy = y0; iy <= y1; ++iy)
+        {
+            int start = 0, end = index->num_sources;
+            if (box_cells <= index->num_sources)
+            {
+                /* Sources in cells along z are contiguous in the list. */
+                start = lower_bound(index, cell_key(index, ix, iy, z0));
+                end = lower_bound(index, cell_key(index, ix, iy, z1) + 1);
+            }
+            for (i = start; i < end; ++i)
+            {
+                const int j = index->keys[i].index;
+                const double d2 = dist2(index, j, x, y, z);
+                if (d2 > chord2) continue;
+                if (num == capacity)
+                {
+                    Match* t;
+                    capacity = (capacity > 0) ? 2 * capacity : 64;
+                    t = (Match*) realloc(matches, capacity * sizeof(Match));
+                    if (!t)
+                    {
+                        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                        free(matches);
+                        return 0;
+                    }
+                    matches = t;
+                }
+                matches[num].index = j;
+                matches[num].dist2 = d2;
+                num++;
+            }
+
+            /* All sources have been checked if the box is too large. */
+            if (box_cells > index->num_sources) break;
+        }
+        if (box_cells > index->num_sources) break;
+    }
+    if (num > 1)
+        qsort(matches, num, sizeof(Match), compare_matches);
+    copy_results(matches, num, indices, dist_rad, status);
+    free(matches);
+    return *status ? 0 : num;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,50 +27,75 @@
  */
 
 #include "sky/oskar_sky.h"
-#include "utility/oskar_getline.h"
+#include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_string_to_array.h"
+#include "utility/oskar_thread.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Minimum number of bytes of the file to give to each thread. */
+#define MIN_BYTES_PER_THREAD (1 << 20)
+
+/* Initial size of the buffer used to read the file. */
+#define READ_CHUNK_BYTES (16 << 20)
+
 static const double deg2rad = 1.74532925199432957692369e-2;
 static const double arcsec2rad = 4.84813681109535993589914e-6;
 
-oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
+struct ThreadArgs
 {
-    int n = 0;
-    FILE* file;
-    char* line = 0;
-    size_t bufsize = 0;
     oskar_Sky* sky;
+    char *start, *end; /* Range of the file buffer to parse. */
+    int offset;        /* Row in sky model for first source in range. */
+    int num_lines, num_sources, status;
+};
+typedef struct ThreadArgs ThreadArgs;
 
-    /* Check if safe to proceed. */
-    if (*status) return 0;
-
-    /* Get the data type. */
-    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
-    {
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
-        return 0;
-    }
+static void get_columns(oskar_Sky* sky, void* col[12])
+{
+    col[0] = oskar_mem_void(oskar_sky_ra_rad(sky));
+    col[1] = oskar_mem_void(oskar_sky_dec_rad(sky));
+    col[2] = oskar_mem_void(oskar_sky_I(sky));
+    col[3] = oskar_mem_void(oskar_sky_Q(sky));
+    col[4] = oskar_mem_void(oskar_sky_U(sky));
+    col[5] = oskar_mem_void(oskar_sky_V(sky));
+    col[6] = oskar_mem_void(oskar_sky_reference_freq_hz(sky));
+    col[7] = oskar_mem_void(oskar_sky_spectral_index(sky));
+    col[8] = oskar_mem_void(oskar_sky_rotation_measure_rad(sky));
+    col[9] = oskar_mem_void(oskar_sky_fwhm_major_rad(sky));
+    col[10] = oskar_mem_void(oskar_sky_fwhm_minor_rad(sky));
+    col[11] = oskar_mem_void(oskar_sky_position_angle_rad(sky));
+}
 
-    /* Open the file. */
-    file = fopen(filename, "r");
-    if (!file)
+static void* count_lines(void* arg)
+{
+    ThreadArgs* a = (ThreadArgs*) arg;
+    const char* p = a->start;
+    a->num_lines = 1;
+    while (p < a->end && (p = (const char*) memchr(p, '\n', a->end - p)) != 0)
     {
-        *status = OSKAR_ERR_FILE_IO;
-        return 0;
+        ++p;
+        ++(a->num_lines);
     }
+    return 0;
+}
 
-    /* Initialise the sky model. */
-    sky = oskar_sky_create(type, OSKAR_CPU, 0, status);
-
-    /* Loop over lines in file. */
-    while (oskar_getline(&line, &bufsize, file) != OSKAR_ERR_EOF)
+static void* parse_lines(void* arg)
+{
+    int i, n = 0, type;
+    ThreadArgs* a = (ThreadArgs*) arg;
+    char *line = a->start, *line_end;
+    void* col[12];
+    type = oskar_sky_precision(a->sky);
+    get_columns(a->sky, col);
+    /* Loop over lines in this part of the file. */
+    for (; line < a->end; line = line_end + 1)
     {
         /* Set defaults. */
         /* RA, Dec, I, Q, U, V, freq0, spix, RM, FWHM maj, FWHM min, PA */
@@ -78,59 +103,213 @@ oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
         size_t num_param = sizeof(par) / sizeof(double);
         size_t num_required = 3, num_read = 0;
 
+        /* Terminate the line in place. */
+        line_end = (char*) memchr(line, '\n', a->end - line);
+        if (!line_end) line_end = a->end;
+        *line_end = '\0';
+
         /* Load source parameters (require at least RA, Dec, Stokes I). */
         num_read = oskar_string_to_array_d(line, num_param, par);
         if (num_read < num_required)
             continue;
 
-        /* Ensure enough space in arrays. */
-        if (oskar_sky_num_sources(sky) <= n)
-        {
-            oskar_sky_resize(sky, n + 100, status);
-            if (*status)
-                break;
-        }
-
+        par[0] *= deg2rad;
+        par[1] *= deg2rad;
         if (num_read <= 9)
         {
             /* RA, Dec, I, Q, U, V, freq0, spix, RM */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
-                    par[1] * deg2rad, par[2], par[3], par[4], par[5],
-                    par[6], par[7], par[8], 0.0, 0.0, 0.0, status);
+            par[9] = par[10] = par[11] = 0.0;
         }
         else if (num_read == 11)
         {
             /* Old format, with no rotation measure. */
             /* RA, Dec, I, Q, U, V, freq0, spix, FWHM maj, FWHM min, PA */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
-                    par[1] * deg2rad, par[2], par[3], par[4], par[5],
-                    par[6], par[7], 0.0, par[8] * arcsec2rad,
-                    par[9] * arcsec2rad, par[10] * deg2rad, status);
+            par[11] = par[10] * deg2rad;
+            par[10] = par[9] * arcsec2rad;
+            par[9] = par[8] * arcsec2rad;
+            par[8] = 0.0;
         }
         else if (num_read == 12)
         {
             /* New format. */
             /* RA, Dec, I, Q, U, V, freq0, spix, RM, FWHM maj, FWHM min, PA */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
-                    par[1] * deg2rad, par[2], par[3], par[4], par[5],
-                    par[6], par[7], par[8], par[9] * arcsec2rad,
-                    par[10] * arcsec2rad, par[11] * deg2rad, status);
+            par[9] *= arcsec2rad;
+            par[10] *= arcsec2rad;
+            par[11] *= deg2rad;
         }
         else
         {
             /* Error. */
-            *status = OSKAR_ERR_BAD_SKY_FILE;
+            a->status = OSKAR_ERR_BAD_SKY_FILE;
             break;
         }
+
+        /* Store the source. */
+        if (type == OSKAR_DOUBLE)
+            for (i = 0; i < 12; ++i)
+                ((double*) col[i])[a->offset + n] = par[i];
+        else
+            for (i = 0; i < 12; ++i)
+                ((float*) col[i])[a->offset + n] = (float) par[i];
         ++n;
     }
+    a->num_sources = n;
+    return 0;
+}
+
+static void run_threads(void *(*start_routine)(void*), int num_threads,
+        ThreadArgs* args)
+{
+    int i;
+    oskar_Thread** threads;
+    if (num_threads == 1)
+    {
+        start_routine(&args[0]);
+        return;
+    }
+    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    for (i = 0; i < num_threads; ++i)
+        threads[i] = oskar_thread_create(start_routine, &args[i], 0);
+    for (i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+    free(threads);
+}
+
+/* Reads the whole file into a null-terminated buffer, in chunks until
+ * end-of-file, so that the size is not limited by the range of ftell(). */
+static char* read_file(FILE* file, size_t* bytes, int* status)
+{
+    size_t capacity = READ_CHUNK_BYTES, num_read;
+    char *buffer, *t;
+    *bytes = 0;
+    buffer = (char*) malloc(capacity + 1);
+    if (!buffer)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    for (;;)
+    {
+        num_read = fread(buffer + *bytes, 1, capacity - *bytes, file);
+        *bytes += num_read;
+        if (*bytes < capacity) break;
+        t = (char*) realloc(buffer, 2 * capacity + 1);
+        if (!t)
+        {
+            free(buffer);
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return 0;
+        }
+        buffer = t;
+        capacity *= 2;
+    }
+    if (ferror(file))
+    {
+        free(buffer);
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    buffer[*bytes] = '\0';
+    return buffer;
+}
+
+oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
+{
+    int i, num_threads, num_lines = 0, n = 0;
+    size_t bytes;
+    FILE* file;
+    char* buffer = 0;
+    oskar_Sky* sky = 0;
+    ThreadArgs* args = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Get the data type. */
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+
+    /* Open the file. */
+    file = fopen(filename, "rb");
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+
+    /* Read the whole file into a null-terminated buffer. */
+    buffer = read_file(file, &bytes, status);
+    fclose(file);
+    if (!buffer) return 0;
+
+    /* Split the buffer at line boundaries between threads. */
+    num_threads = oskar_get_num_procs();
+    if ((size_t) num_threads > bytes / MIN_BYTES_PER_THREAD)
+        num_threads = (int) (bytes / MIN_BYTES_PER_THREAD);
+    if (num_threads < 1) num_threads = 1;
+    args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
+    for (i = 0; i < num_threads; ++i)
+    {
+        char* p = buffer + (i * (bytes / num_threads));
+        if (i > 0)
+        {
+            /* Start after the first line break in the nominal range. */
+            if (p < args[i - 1].start) p = args[i - 1].start;
+            p = (char*) memchr(p, '\n', buffer + bytes - p);
+            p = p ? p + 1 : buffer + bytes;
+            args[i - 1].end = p;
+        }
+        args[i].start = p;
+    }
+    args[num_threads - 1].end = buffer + bytes;
+
+    /* Count lines in each part, to size the sky model. */
+    run_threads(count_lines, num_threads, args);
+    for (i = 0; i < num_threads; ++i)
+    {
+        args[i].offset = num_lines;
+        num_lines += args[i].num_lines;
+    }
+
+    /* Parse all lines directly into the sky model columns. */
+    sky = oskar_sky_create(type, OSKAR_CPU, num_lines, status);
+    if (!*status)
+    {
+        for (i = 0; i < num_threads; ++i) args[i].sky = sky;
+        run_threads(parse_lines, num_threads, args);
+    }
+
+    /* Check for errors, and remove gaps between the parts. */
+    for (i = 0; i < num_threads && !*status; ++i)
+    {
+        if (args[i].status)
+            *status = args[i].status;
+        else if (args[i].offset != n && args[i].num_sources > 0)
+        {
+            int c;
+            void* col[12];
+            size_t element_size = oskar_mem_element_size(type);
+            get_columns(sky, col);
+            for (c = 0; c < 12; ++c)
+                memmove((char*)col[c] + n * element_size,
+                        (char*)col[c] + args[i].offset * element_size,
+                        args[i].num_sources * element_size);
+        }
+        n += args[i].num_sources;
+    }
 
     /* Set the size to be the actual number of elements loaded. */
     oskar_sky_resize(sky, n, status);
 
-    /* Free the line buffer and close the file. */
-    if (line) free(line);
-    fclose(file);
+    /* Free the buffers. */
+    free(args);
+    free(buffer);
 
     /* Check if an error occurred. */
     if (*status)
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "binary/oskar_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int cache_is_valid(const char* cache_name, int type,
+        double file_size, double file_mtime)
+{
+    int cache_type = 0, status = 0;
+    double cache_size = 0.0, cache_mtime = 0.0;
+    const unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+    oskar_Binary* h;
+    h = oskar_binary_create(cache_name, 'r', &status);
+    oskar_binary_read_int(h, group, OSKAR_SKY_TAG_DATA_TYPE, 0,
+            &cache_type, &status);
+    oskar_binary_read_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_SIZE, 0,
+            &cache_size, &status);
+    oskar_binary_read_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_MTIME, 0,
+            &cache_mtime, &status);
+    oskar_binary_free(h);
+    return (!status && cache_type == type &&
+            cache_size == file_size && cache_mtime == file_mtime);
+}
+
+static void write_cache(const char* cache_name, const oskar_Sky* sky,
+        double file_size, double file_mtime)
+{
+    int status = 0;
+    const unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+    oskar_Binary* h;
+
+    /* Write the source file details last, so that an incomplete
+     * cache file is never treated as valid. */
+    oskar_sky_write(cache_name, sky, &status);
+    h = oskar_binary_create(cache_name, 'a', &status);
+    oskar_binary_write_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_SIZE, 0,
+            file_size, &status);
+    oskar_binary_write_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_MTIME, 0,
+            file_mtime, &status);
+    oskar_binary_free(h);
+    if (status) remove(cache_name);
+}
+
+oskar_Sky* oskar_sky_load_cached(const char* filename, int type, int* status)
+{
+    char* cache_name;
+    double file_size, file_mtime;
+    struct stat file_info;
+    oskar_Sky* sky = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Get the size and modification time of the text file. */
+    if (stat(filename, &file_info) != 0)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    file_size = (double) file_info.st_size;
+    file_mtime = (double) file_info.st_mtime;
+
+    /* Read the cache if it is up to date. */
+    cache_name = (char*) calloc(strlen(filename) + 7, sizeof(char));
+    sprintf(cache_name, "%s.cache", filename);
+    if (cache_is_valid(cache_name, type, file_size, file_mtime))
+    {
+        int cache_status = 0;
+        sky = oskar_sky_read(cache_name, OSKAR_CPU, &cache_status);
+    }
+
+    /* Otherwise, load the text file and write a new cache. */
+    if (!sky)
+    {
+        sky = oskar_sky_load(filename, type, status);
+        if (sky) write_cache(cache_name, sky, file_size, file_mtime);
+    }
+    free(cache_name);
+    return sky;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "sky/private_sky_scale_flux_with_frequency_inline.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ThreadArgs
+{
+    const oskar_SkyIndex* index;
+    const oskar_Sky* in;
+    int* nearest;
+};
+typedef struct ThreadArgs ThreadArgs;
+
+static double get(const oskar_Mem* mem, int i)
+{
+    return (oskar_mem_precision(mem) == OSKAR_DOUBLE) ?
+            ((const double*) oskar_mem_void_const(mem))[i] :
+            ((const float*) oskar_mem_void_const(mem))[i];
+}
+
+static void find_range(void* arg, int start, int end)
+{
+    int i;
+    const ThreadArgs* a = (const ThreadArgs*) arg;
+    const oskar_Mem* ra = oskar_sky_ra_rad_const(a->in);
+    const oskar_Mem* dec = oskar_sky_dec_rad_const(a->in);
+    for (i = start; i < end; ++i)
+        a->nearest[i] = oskar_sky_index_nearest(a->index,
+                get(ra, i), get(dec, i), 0);
+}
+
+void oskar_sky_rebin(oskar_Sky* out, const oskar_Sky* in, int* status)
+{
+    int i, j, num_in, num_out, *nearest = 0;
+    double *I = 0, *Q = 0, *U = 0, *V = 0, *ref = 0;
+    double *spix_sum = 0, *spix_weight = 0, *rm_sum = 0, *rm_weight = 0;
+    oskar_SkyIndex* index;
+    oskar_ThreadPool* pool;
+    ThreadArgs args;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+    if (oskar_sky_mem_location(out) != OSKAR_CPU ||
+            oskar_sky_mem_location(in) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    num_in = oskar_sky_num_sources(in);
+    num_out = oskar_sky_num_sources(out);
+    if (num_out == 0) return;
+
+    /* Find the nearest output source to each input source. */
+    index = oskar_sky_index_create(out, status);
+    nearest = (int*) malloc((num_in > 0 ? num_in : 1) * sizeof(int));
+    if (!nearest && !*status)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    if (!*status && num_in > 0)
+    {
+        args.index = index;
+        args.in = in;
+        args.nearest = nearest;
+        pool = oskar_thread_pool_create(oskar_get_num_procs());
+        oskar_thread_pool_parallel_for(pool, 0, num_in, 0, find_range, &args);
+        oskar_thread_pool_free(pool);
+    }
+    oskar_sky_index_free(index);
+
+    /* Accumulate the input sources in order, so results are repeatable. */
+    I = (double*) calloc(num_out, sizeof(double));
+    Q = (double*) calloc(num_out, sizeof(double));
+    U = (double*) calloc(num_out, sizeof(double));
+    V = (double*) calloc(num_out, sizeof(double));
+    ref = (double*) calloc(num_out, sizeof(double));
+    spix_sum = (double*) calloc(num_out, sizeof(double));
+    spix_weight = (double*) calloc(num_out, sizeof(double));
+    rm_sum = (double*) calloc(num_out, sizeof(double));
+    rm_weight = (double*) calloc(num_out, sizeof(double));
+    if (!I || !Q || !U || !V || !ref || !spix_sum || !spix_weight ||
+            !rm_sum || !rm_weight)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    if (!*status)
+    {
+        for (j = 0; j < num_out; ++j)
+            ref[j] = get(oskar_sky_reference_freq_hz_const(out), j);
+        for (i = 0; i < num_in; ++i)
+        {
+            double I_, Q_, U_, V_, ref_, spix_, rm_, weight;
+            j = nearest[i];
+            I_ = get(oskar_sky_I_const(in), i);
+            Q_ = get(oskar_sky_Q_const(in), i);
+            U_ = get(oskar_sky_U_const(in), i);
+            V_ = get(oskar_sky_V_const(in), i);
+            ref_ = get(oskar_sky_reference_freq_hz_const(in), i);
+            spix_ = get(oskar_sky_spectral_index_const(in), i);
+            rm_ = get(oskar_sky_rotation_measure_rad_const(in), i);
+            if (ref[j] == 0.0)
+                ref[j] = ref_;
+            if (ref[j] > 0.0)
+                oskar_scale_flux_with_frequency_inline_d(ref[j],
+                        &I_, &Q_, &U_, &V_, &ref_, spix_, rm_);
+            I[j] += I_;
+            Q[j] += Q_;
+            U[j] += U_;
+            V[j] += V_;
+            weight = fabs(I_);
+            spix_sum[j] += weight * spix_;
+            spix_weight[j] += weight;
+            weight = sqrt(Q_ * Q_ + U_ * U_);
+            rm_sum[j] += weight * rm_;
+            rm_weight[j] += weight;
+        }
+
+        /* Store the results in the output sky model. */
+        for (j = 0; j < num_out; ++j)
+        {
+            oskar_mem_set_element_real(oskar_sky_I(out), j, I[j], status);
+            oskar_mem_set_element_real(oskar_sky_Q(out), j, Q[j], status);
+            oskar_mem_set_element_real(oskar_sky_U(out), j, U[j], status);
+            oskar_mem_set_element_real(oskar_sky_V(out), j, V[j], status);
+            oskar_mem_set_element_real(oskar_sky_reference_freq_hz(out), j,
+                    ref[j], status);
+            if (spix_weight[j] > 0.0)
+                oskar_mem_set_element_real(oskar_sky_spectral_index(out), j,
+                        spix_sum[j] / spix_weight[j], status);
+            if (rm_weight[j] > 0.0)
+                oskar_mem_set_element_real(
+                        oskar_sky_rotation_measure_rad(out), j,
+                        rm_sum[j] / rm_weight[j], status);
+        }
+    }
+    free(nearest);
+    free(I);
+    free(Q);
+    free(U);
+    free(V);
+    free(ref);
+    free(spix_sum);
+    free(spix_weight);
+    free(rm_sum);
+    free(rm_weight);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct SortKey
+{
+    unsigned int face, code;
+    int index;
+};
+typedef struct SortKey SortKey;
+
+static int compare_keys(const void* a, const void* b)
+{
+    const SortKey *x = (const SortKey*) a, *y = (const SortKey*) b;
+    if (x->face != y->face) return (x->face < y->face) ? -1 : 1;
+    if (x->code != y->code) return (x->code < y->code) ? -1 : 1;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+/* Returns the distance along a Hilbert curve of order 16 to point (x, y). */
+static unsigned int hilbert_index(unsigned int x, unsigned int y)
+{
+    unsigned int rx, ry, s, t, d = 0;
+    for (s = 1u << 15; s > 0; s >>= 1)
+    {
+        rx = (x & s) > 0;
+        ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = s - 1 - (x & (s - 1));
+                y = s - 1 - (y & (s - 1));
+            }
+            t = x; x = y; y = t;
+        }
+    }
+    return d;
+}
+
+static void make_key(double ra, double dec, int index, SortKey* key)
+{
+    double v[3], a[3], u1, u2;
+    int major = 0, i;
+    v[0] = cos(dec) * cos(ra);
+    v[1] = cos(dec) * sin(ra);
+    v[2] = sin(dec);
+    for (i = 0; i < 3; ++i) a[i] = fabs(v[i]);
+    if (a[1] > a[major]) major = 1;
+    if (a[2] > a[major]) major = 2;
+
+    /* Project onto the cube face, with coordinates in range [0, 1]. */
+    u1 = 0.5 * (v[(major + 1) % 3] / a[major] + 1.0);
+    u2 = 0.5 * (v[(major + 2) % 3] / a[major] + 1.0);
+    key->face = major + (v[major] < 0.0 ? 3 : 0);
+    key->code = hilbert_index((unsigned int) (u1 * 65535.0),
+            (unsigned int) (u2 * 65535.0));
+    key->index = index;
+}
+
+#define NUM_COLUMNS 18
+
+static void columns(oskar_Sky* sky, oskar_Mem** c)
+{
+    c[0] = oskar_sky_ra_rad(sky);
+    c[1] = oskar_sky_dec_rad(sky);
+    c[2] = oskar_sky_I(sky);
+    c[3] = oskar_sky_Q(sky);
+    c[4] = oskar_sky_U(sky);
+    c[5] = oskar_sky_V(sky);
+    c[6] = oskar_sky_reference_freq_hz(sky);
+    c[7] = oskar_sky_spectral_index(sky);
+    c[8] = oskar_sky_rotation_measure_rad(sky);
+    c[9] = oskar_sky_l(sky);
+    c[10] = oskar_sky_m(sky);
+    c[11] = oskar_sky_n(sky);
+    c[12] = oskar_sky_fwhm_major_rad(sky);
+    c[13] = oskar_sky_fwhm_minor_rad(sky);
+    c[14] = oskar_sky_position_angle_rad(sky);
+    c[15] = oskar_sky_gaussian_a(sky);
+    c[16] = oskar_sky_gaussian_b(sky);
+    c[17] = oskar_sky_gaussian_c(sky);
+}
+
+static void columns_const(const oskar_Sky* sky, const oskar_Mem** c)
+{
+    c[0] = oskar_sky_ra_rad_const(sky);
+    c[1] = oskar_sky_dec_rad_const(sky);
+    c[2] = oskar_sky_I_const(sky);
+    c[3] = oskar_sky_Q_const(sky);
+    c[4] = oskar_sky_U_const(sky);
+    c[5] = oskar_sky_V_const(sky);
+    c[6] = oskar_sky_reference_freq_hz_const(sky);
+    c[7] = oskar_sky_spectral_index_const(sky);
+    c[8] = oskar_sky_rotation_measure_rad_const(sky);
+    c[9] = oskar_sky_l_const(sky);
+    c[10] = oskar_sky_m_const(sky);
+    c[11] = oskar_sky_n_const(sky);
+    c[12] = oskar_sky_fwhm_major_rad_const(sky);
+    c[13] = oskar_sky_fwhm_minor_rad_const(sky);
+    c[14] = oskar_sky_position_angle_rad_const(sky);
+    c[15] = oskar_sky_gaussian_a_const(sky);
+    c[16] = oskar_sky_gaussian_b_const(sky);
+    c[17] = oskar_sky_gaussian_c_const(sky);
+}
+
+/* Returns the sort keys in spatial order, or NULL on error. */
+static SortKey* spatial_order(const oskar_Sky* sky, int* status)
+{
+    int i, num_sources;
+    SortKey* keys;
+    if (*status) return 0;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+    num_sources = oskar_sky_num_sources(sky);
+    keys = (SortKey*) malloc((num_sources > 0 ? num_sources : 1) *
+            sizeof(SortKey));
+    if (!keys)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+    {
+        const double *ra, *dec;
+        ra = oskar_mem_double_const(oskar_sky_ra_rad_const(sky), status);
+        dec = oskar_mem_double_const(oskar_sky_dec_rad_const(sky), status);
+        for (i = 0; i < num_sources; ++i)
+            make_key(ra[i], dec[i], i, &keys[i]);
+    }
+    else
+    {
+        const float *ra, *dec;
+        ra = oskar_mem_float_const(oskar_sky_ra_rad_const(sky), status);
+        dec = oskar_mem_float_const(oskar_sky_dec_rad_const(sky), status);
+        for (i = 0; i < num_sources; ++i)
+            make_key(ra[i], dec[i], i, &keys[i]);
+    }
+    qsort(keys, num_sources, sizeof(SortKey), compare_keys);
+    return keys;
+}
+
+/* Copies elements from src to the start of dst in the order given. */
+static void gather(oskar_Mem* dst, const oskar_Mem* src,
+        const SortKey* keys, int num, int* status)
+{
+    int i;
+    size_t element_size;
+    const char* in;
+    char* out;
+    if (*status) return;
+    element_size = oskar_mem_element_size(oskar_mem_type(src));
+    in = (const char*) oskar_mem_void_const(src);
+    out = (char*) oskar_mem_void(dst);
+    for (i = 0; i < num; ++i)
+        memcpy(out + i * element_size,
+                in + keys[i].index * element_size, element_size);
+}
+
+void oskar_sky_sort_spatially(oskar_Sky* sky, int* status)
+{
+    int c, num_sources;
+    SortKey* keys;
+    oskar_Mem *temp, *cols[NUM_COLUMNS];
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+    num_sources = oskar_sky_num_sources(sky);
+    if (num_sources < 2) return;
+
+    /* Reorder each column through a single scratch column. */
+    keys = spatial_order(sky, status);
+    if (!keys) return;
+    temp = oskar_mem_create(oskar_sky_precision(sky), OSKAR_CPU,
+            num_sources, status);
+    columns(sky, cols);
+    for (c = 0; c < NUM_COLUMNS; ++c)
+    {
+        oskar_mem_copy_contents(temp, cols[c], 0, 0, num_sources, status);
+        gather(cols[c], temp, keys, num_sources, status);
+    }
+    oskar_mem_free(temp, status);
+    free(keys);
+}
+
+void oskar_sky_append_to_set_sorted(int* set_size, oskar_Sky*** set_ptr,
+        int max_sources_per_model, const oskar_Sky* model, int* status)
+{
+    int c, i, num_sources;
+    SortKey* keys;
+    oskar_Sky* block;
+    oskar_Mem* cols[NUM_COLUMNS];
+    const oskar_Mem* cols_in[NUM_COLUMNS];
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+    if (max_sources_per_model < 1)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+
+    /* Gather one block of sorted sources at a time, and append it. */
+    keys = spatial_order(model, status);
+    if (!keys) return;
+    num_sources = oskar_sky_num_sources(model);
+    block = oskar_sky_create(oskar_sky_precision(model), OSKAR_CPU,
+            max_sources_per_model, status);
+    columns_const(model, cols_in);
+    for (i = 0; i < num_sources && !*status; i += max_sources_per_model)
+    {
+        const int num = (num_sources - i < max_sources_per_model) ?
+                num_sources - i : max_sources_per_model;
+        oskar_sky_resize(block, num, status);
+        columns(block, cols);
+        for (c = 0; c < NUM_COLUMNS; ++c)
+            gather(cols[c], cols_in[c], keys + i, num, status);
+        oskar_sky_append_to_set(set_size, set_ptr, max_sources_per_model,
+                block, status);
+    }
+    oskar_sky_free(block, status);
+    free(keys);
+}
+
+#ifdef __cplusplus
+}
+#endif
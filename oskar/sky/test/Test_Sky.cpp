@@ -30,12 +30,16 @@
 
 #include "telescope/oskar_telescope.h"
 #include "sky/oskar_sky.h"
+#include "sky/oskar_update_horizon_mask.h"
 #include "convert/oskar_convert_lon_lat_to_relative_directions.h"
+#include "utility/oskar_file_exists.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_cl_utils.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
 #include "math/oskar_cmath.h"
 
 #ifdef OSKAR_HAVE_CUDA
@@ -566,6 +570,83 @@ TEST(SkyModel, horizon_clip)
 }
 
 
+static void check_horizon_clip(int type, double gast)
+{
+    int status = 0, n_sources = 20000, n_stations = 300;
+    const double deg2rad = M_PI / 180.0;
+
+    // Generate random sources over the whole sky.
+    oskar_Sky* sky_in = oskar_sky_create(type, OSKAR_CPU, n_sources, &status);
+    srand(2);
+    for (int i = 0; i < n_sources; ++i)
+    {
+        double ra = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        double dec = asin(2.0 * rand() / (double)RAND_MAX - 1.0);
+        oskar_sky_set_source(sky_in, i, ra, dec, 1.0, 0.0, 0.0, 0.0,
+                100e6, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+    oskar_sky_evaluate_relative_directions(sky_in, 0.3, -0.5, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Create a telescope model spread over a few tens of kilometres.
+    oskar_Telescope* telescope = oskar_telescope_create(type,
+            OSKAR_CPU, n_stations, &status);
+    for (int i = 0; i < n_stations; ++i)
+    {
+        oskar_station_set_position(oskar_telescope_station(telescope, i),
+                (116.7 + 0.3 * rand() / (double)RAND_MAX) * deg2rad,
+                (-26.8 - 0.3 * rand() / (double)RAND_MAX) * deg2rad, 0.0);
+    }
+
+    // Generate the expected mask using every station.
+    oskar_Mem* mask = oskar_mem_create(OSKAR_INT, OSKAR_CPU, n_sources,
+            &status);
+    oskar_mem_clear_contents(mask, &status);
+    for (int i = 0; i < n_stations; ++i)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(telescope, i);
+        oskar_update_horizon_mask(n_sources, oskar_sky_l_const(sky_in),
+                oskar_sky_m_const(sky_in), oskar_sky_n_const(sky_in),
+                gast + oskar_station_lon_rad(s) - 0.3, -0.5,
+                oskar_station_lat_rad(s), mask, &status);
+    }
+    const int* mask_ = oskar_mem_int_const(mask, &status);
+    int n_expected = 0;
+    for (int i = 0; i < n_sources; ++i) n_expected += mask_[i];
+
+    // Horizon clip, and check the same sources are returned in order.
+    oskar_StationWork* work = oskar_station_work_create(type, OSKAR_CPU,
+            &status);
+    oskar_Sky* sky_out = oskar_sky_create(type, OSKAR_CPU, 0, &status);
+    oskar_sky_horizon_clip(sky_out, sky_in, telescope, gast, work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(n_expected, oskar_sky_num_sources(sky_out));
+    ASSERT_GT(n_expected, 0);
+    ASSERT_LT(n_expected, n_sources);
+    for (int i = 0, j = 0; i < n_sources; ++i)
+    {
+        if (!mask_[i]) continue;
+        EXPECT_EQ(oskar_mem_get_element(oskar_sky_ra_rad_const(sky_in),
+                i, &status), oskar_mem_get_element(
+                        oskar_sky_ra_rad_const(sky_out), j++, &status));
+    }
+
+    oskar_mem_free(mask, &status);
+    oskar_sky_free(sky_in, &status);
+    oskar_sky_free(sky_out, &status);
+    oskar_telescope_free(telescope, &status);
+    oskar_station_work_free(work, &status);
+}
+
+
+TEST(SkyModel, horizon_clip_compact_array)
+{
+    check_horizon_clip(OSKAR_SINGLE, 0.0);
+    check_horizon_clip(OSKAR_SINGLE, 2.5);
+    check_horizon_clip(OSKAR_DOUBLE, 1.0);
+}
+
+
 TEST(SkyModel, resize)
 {
     int status = 0;
@@ -1138,6 +1219,161 @@ TEST(SkyModel, load_ascii)
 }
 
 
+TEST(SkyModel, load_cached)
+{
+    int status = 0;
+    const char* filename = "temp_sources_cached.osm";
+    const char* cache_name = "temp_sources_cached.osm.cache";
+    remove(cache_name);
+
+    // Write a sky file.
+    FILE* file = fopen(filename, "w");
+    if (!file) FAIL() << "Unable to create test file";
+    int num_sources = 1013;
+    for (int i = 0; i < num_sources; ++i)
+        fprintf(file, "%f %f %f 0 0 0 1e8 -0.7 0 10 5 %d\n",
+                i/10.0, i/20.0, (float)i, i % 180);
+    fclose(file);
+
+    // Load it, which should create the cache.
+    oskar_Sky* sky1 = oskar_sky_load_cached(filename, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(oskar_file_exists(cache_name));
+
+    // Load it again from the cache, and compare with the text file.
+    oskar_Sky* sky2 = oskar_sky_load_cached(filename, OSKAR_DOUBLE, &status);
+    oskar_Sky* sky3 = oskar_sky_load(filename, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky2));
+    const oskar_Mem* c2[] = {oskar_sky_ra_rad_const(sky2),
+            oskar_sky_I_const(sky2), oskar_sky_fwhm_minor_rad_const(sky2),
+            oskar_sky_position_angle_rad_const(sky2)};
+    const oskar_Mem* c3[] = {oskar_sky_ra_rad_const(sky3),
+            oskar_sky_I_const(sky3), oskar_sky_fwhm_minor_rad_const(sky3),
+            oskar_sky_position_angle_rad_const(sky3)};
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(0, oskar_mem_different(c2[i], c3[i], 0, &status));
+
+    // A cache of a different type must not be used.
+    oskar_Sky* sky4 = oskar_sky_load_cached(filename, OSKAR_SINGLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ((int)OSKAR_SINGLE, oskar_sky_precision(sky4));
+    EXPECT_EQ(num_sources, oskar_sky_num_sources(sky4));
+
+    // Changing the text file must invalidate the cache.
+    file = fopen(filename, "a");
+    fprintf(file, "1 2 3\n");
+    fclose(file);
+    oskar_Sky* sky5 = oskar_sky_load_cached(filename, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources + 1, oskar_sky_num_sources(sky5));
+
+    oskar_sky_free(sky1, &status);
+    oskar_sky_free(sky2, &status);
+    oskar_sky_free(sky3, &status);
+    oskar_sky_free(sky4, &status);
+    oskar_sky_free(sky5, &status);
+    remove(filename);
+    remove(cache_name);
+}
+
+
+TEST(SkyModel, sort_spatially)
+{
+    int status = 0, num_sources = 20000, chunk_size = 100;
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    srand(2);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        double dec = asin(2.0 * rand() / (double)RAND_MAX - 1.0);
+        oskar_sky_set_source(sky, i, ra, dec, (double)i,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+    oskar_Sky* sorted = oskar_sky_create_copy(sky, OSKAR_CPU, &status);
+    oskar_sky_sort_spatially(sorted, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check each source is still present, using Stokes I as its index.
+    const double* ra = oskar_mem_double_const(oskar_sky_ra_rad_const(sky),
+            &status);
+    const double* ra_sorted = oskar_mem_double_const(
+            oskar_sky_ra_rad_const(sorted), &status);
+    const double* I_sorted = oskar_mem_double_const(
+            oskar_sky_I_const(sorted), &status);
+    std::vector<int> found(num_sources, 0);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        int j = (int) I_sorted[i];
+        ASSERT_EQ(ra[j], ra_sorted[i]);
+        found[j]++;
+    }
+    for (int i = 0; i < num_sources; ++i) ASSERT_EQ(1, found[i]);
+
+    // Check chunks of sorted sources have small bounding caps,
+    // which contain all their sources.
+    int num_chunks = 0, num_chunks_sorted = 0;
+    oskar_Sky **chunks = 0, **chunks_sorted = 0;
+    oskar_sky_append_to_set(&num_chunks, &chunks, chunk_size, sky, &status);
+    oskar_sky_append_to_set(&num_chunks_sorted, &chunks_sorted,
+            chunk_size, sorted, &status);
+    ASSERT_EQ(num_chunks, num_chunks_sorted);
+
+    // Check sorting while appending gives the same chunks.
+    int num_chunks_direct = 0;
+    oskar_Sky** chunks_direct = 0;
+    oskar_sky_append_to_set_sorted(&num_chunks_direct, &chunks_direct,
+            chunk_size, sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_chunks_sorted, num_chunks_direct);
+    for (int i = 0; i < num_chunks_direct; ++i)
+    {
+        int n = oskar_sky_num_sources(chunks_direct[i]);
+        ASSERT_EQ(oskar_sky_num_sources(chunks_sorted[i]), n);
+        const double* I1 = oskar_mem_double_const(
+                oskar_sky_I_const(chunks_sorted[i]), &status);
+        const double* I2 = oskar_mem_double_const(
+                oskar_sky_I_const(chunks_direct[i]), &status);
+        for (int j = 0; j < n; ++j) ASSERT_EQ(I1[j], I2[j]);
+        oskar_sky_free(chunks_direct[i], &status);
+    }
+    free(chunks_direct);
+
+    double mean_radius = 0.0, mean_radius_sorted = 0.0;
+    for (int i = 0; i < num_chunks; ++i)
+    {
+        double cap_ra, cap_dec, radius;
+        oskar_sky_bounding_cap(chunks[i], &cap_ra, &cap_dec, &radius, &status);
+        mean_radius += radius;
+        oskar_sky_bounding_cap(chunks_sorted[i], &cap_ra, &cap_dec, &radius,
+                &status);
+        mean_radius_sorted += radius;
+        const double* r = oskar_mem_double_const(
+                oskar_sky_ra_rad_const(chunks_sorted[i]), &status);
+        const double* d = oskar_mem_double_const(
+                oskar_sky_dec_rad_const(chunks_sorted[i]), &status);
+        for (int j = 0; j < oskar_sky_num_sources(chunks_sorted[i]); ++j)
+        {
+            double dist = acos(sin(d[j]) * sin(cap_dec) +
+                    cos(d[j]) * cos(cap_dec) * cos(r[j] - cap_ra));
+            ASSERT_LE(dist, radius + 1e-9);
+        }
+        oskar_sky_free(chunks[i], &status);
+        oskar_sky_free(chunks_sorted[i], &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    mean_radius /= num_chunks;
+    mean_radius_sorted /= num_chunks;
+    EXPECT_GT(mean_radius, 2.5);
+    EXPECT_LT(mean_radius_sorted, 0.3);
+    free(chunks);
+    free(chunks_sorted);
+    oskar_sky_free(sky, &status);
+    oskar_sky_free(sorted, &status);
+}
+
+
 TEST(SkyModel, read_write)
 {
     oskar_Sky *sky, *sky2;
@@ -1238,3 +1474,213 @@ TEST(SkyModel, read_write)
     remove(filename);
 }
 
+
+static void rebin_check(int type)
+{
+    int status = 0, num_in = 20000, num_out = 300;
+    double tol = (type == OSKAR_DOUBLE) ? 1e-10 : 1e-3;
+    srand(1);
+
+    // Create input sources in a patch of sky, plus some further away.
+    oskar_Sky* in = oskar_sky_create(type, OSKAR_CPU, num_in, &status);
+    for (int i = 0; i < num_in; ++i)
+    {
+        double r = (i % 100 == 0) ? 40.0 : 10.0;
+        double ra = (r * rand() / (double)RAND_MAX) * M_PI / 180.0;
+        double dec = (30.0 + r * rand() / (double)RAND_MAX) * M_PI / 180.0;
+        double flux = 1.0 + rand() / (double)RAND_MAX;
+        oskar_sky_set_source(in, i, ra, dec, flux, 0.1 * flux, -0.2 * flux,
+                0.01 * flux, 100e6, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+
+    // Create output positions, including a duplicated one.
+    oskar_Sky* out = oskar_sky_create(type, OSKAR_CPU, num_out, &status);
+    for (int i = 0; i < num_out; ++i)
+    {
+        double ra = (10.0 * rand() / (double)RAND_MAX) * M_PI / 180.0;
+        double dec = (30.0 + 10.0 * rand() / (double)RAND_MAX) * M_PI / 180.0;
+        if (i == num_out - 1)
+        {
+            ra = oskar_mem_get_element(oskar_sky_ra_rad_const(out), 0, &status);
+            dec = oskar_mem_get_element(oskar_sky_dec_rad_const(out), 0,
+                    &status);
+        }
+        oskar_sky_set_source(out, i, ra, dec, 5.0, 0.0, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+    oskar_sky_rebin(out, in, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check against a brute-force search.
+    std::vector<double> I(num_out, 0.0), Q(num_out, 0.0);
+    double total_in = 0.0, total_out = 0.0;
+    for (int i = 0; i < num_in; ++i)
+    {
+        double ra = oskar_mem_get_element(oskar_sky_ra_rad_const(in), i,
+                &status);
+        double dec = oskar_mem_get_element(oskar_sky_dec_rad_const(in), i,
+                &status);
+        double x = cos(dec) * cos(ra), y = cos(dec) * sin(ra), z = sin(dec);
+        double best_dist2 = 5.0;
+        int best = -1;
+        for (int j = 0; j < num_out; ++j)
+        {
+            double ra2 = oskar_mem_get_element(oskar_sky_ra_rad_const(out), j,
+                    &status);
+            double dec2 = oskar_mem_get_element(oskar_sky_dec_rad_const(out),
+                    j, &status);
+            double dx = cos(dec2) * cos(ra2) - x;
+            double dy = cos(dec2) * sin(ra2) - y;
+            double dz = sin(dec2) - z;
+            double dist2 = dx * dx + dy * dy + dz * dz;
+            if (dist2 < best_dist2)
+            {
+                best_dist2 = dist2;
+                best = j;
+            }
+        }
+        double flux = oskar_mem_get_element(oskar_sky_I_const(in), i, &status);
+        I[best] += flux;
+        Q[best] += oskar_mem_get_element(oskar_sky_Q_const(in), i, &status);
+        total_in += flux;
+    }
+    for (int j = 0; j < num_out; ++j)
+    {
+        double flux = oskar_mem_get_element(oskar_sky_I_const(out), j,
+                &status);
+        EXPECT_NEAR(I[j], flux, tol * (1.0 + I[j]));
+        EXPECT_NEAR(Q[j], oskar_mem_get_element(oskar_sky_Q_const(out), j,
+                &status), tol * (1.0 + I[j]));
+        if (I[j] > 0.0)
+        {
+            EXPECT_DOUBLE_EQ(100e6, oskar_mem_get_element(
+                    oskar_sky_reference_freq_hz_const(out), j, &status));
+            EXPECT_NEAR(-0.7, oskar_mem_get_element(
+                    oskar_sky_spectral_index_const(out), j, &status), tol);
+        }
+        total_out += flux;
+    }
+    EXPECT_EQ(0.0, I[num_out - 1]);
+    EXPECT_NEAR(total_in, total_out, tol * total_in);
+
+    // Check that fluxes are scaled to the output reference frequency.
+    oskar_sky_set_source(out, 0, 0.0, 0.5, 0.0, 0.0, 0.0, 0.0,
+            200e6, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_resize(out, 1, &status);
+    oskar_sky_resize(in, 1, &status);
+    oskar_sky_rebin(out, in, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double flux = oskar_mem_get_element(oskar_sky_I_const(in), 0, &status);
+    EXPECT_NEAR(flux * pow(2.0, -0.7), oskar_mem_get_element(
+            oskar_sky_I_const(out), 0, &status), tol);
+    EXPECT_DOUBLE_EQ(200e6, oskar_mem_get_element(
+            oskar_sky_reference_freq_hz_const(out), 0, &status));
+
+    oskar_sky_free(in, &status);
+    oskar_sky_free(out, &status);
+}
+
+TEST(SkyModel, rebin)
+{
+    rebin_check(OSKAR_DOUBLE);
+    rebin_check(OSKAR_SINGLE);
+}
+
+TEST(SkyModel, index)
+{
+    int status = 0, num_sources = 5000;
+    srand(2);
+
+    // Create sources, clustered in one part of the sky.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_SINGLE, OSKAR_CPU, num_sources,
+            &status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double r = (i % 50 == 0) ? 180.0 : 5.0;
+        double ra = (r * rand() / (double)RAND_MAX) * M_PI / 180.0;
+        double dec = (-45.0 + 0.5 * r * rand() / (double)RAND_MAX) *
+                M_PI / 180.0;
+        oskar_sky_set_source(sky, i, ra, dec, 1.0, 0.0, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+    oskar_SkyIndex* index = oskar_sky_index_create(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_index_num_sources(index));
+    oskar_Mem* indices = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    oskar_Mem* dist = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+
+    // Compare queries against a brute-force search.
+    const int k = 7;
+    const double radii[] = {0.0, 0.002, 0.02, 0.5, 4.0};
+    for (int q = 0; q < 50; ++q)
+    {
+        double ra0 = (q < 40 ? 5.0 : 360.0) * rand() / (double)RAND_MAX;
+        double dec0 = (q < 40 ? -45.0 : -90.0) +
+                (q < 40 ? 2.5 : 180.0) * rand() / (double)RAND_MAX;
+        ra0 *= M_PI / 180.0;
+        dec0 *= M_PI / 180.0;
+        std::vector<std::pair<double, int> > all(num_sources);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            double ra1 = oskar_mem_get_element(oskar_sky_ra_rad_const(sky), i,
+                    &status);
+            double dec1 = oskar_mem_get_element(oskar_sky_dec_rad_const(sky),
+                    i, &status);
+            double dx = cos(dec1) * cos(ra1) - cos(dec0) * cos(ra0);
+            double dy = cos(dec1) * sin(ra1) - cos(dec0) * sin(ra0);
+            double dz = sin(dec1) - sin(dec0);
+            all[i] = std::make_pair(
+                    2.0 * asin(0.5 * sqrt(dx * dx + dy * dy + dz * dz)), i);
+        }
+        std::sort(all.begin(), all.end());
+
+        // Nearest neighbours.
+        double d = 0.0;
+        EXPECT_EQ(all[0].second, oskar_sky_index_nearest(index, ra0, dec0, &d));
+        EXPECT_NEAR(all[0].first, d, 1e-12);
+        int num = oskar_sky_index_query_nearest(index, ra0, dec0, k,
+                indices, dist, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(k, num);
+        for (int i = 0; i < k; ++i)
+        {
+            EXPECT_EQ(all[i].second, oskar_mem_int_const(indices,
+                    &status)[i]);
+            EXPECT_NEAR(all[i].first, oskar_mem_double_const(dist,
+                    &status)[i], 1e-12);
+        }
+
+        // Radius queries.
+        for (unsigned int r = 0; r < sizeof(radii) / sizeof(double); ++r)
+        {
+            std::vector<int> expected;
+            for (int i = 0; i < num_sources; ++i)
+                if (all[i].first <= radii[r] * (1.0 - 1e-9))
+                    expected.push_back(all[i].second);
+                else if (all[i].first < radii[r] * (1.0 + 1e-9))
+                    FAIL() << "Source too close to search radius";
+            std::sort(expected.begin(), expected.end());
+            num = oskar_sky_index_query_radius(index, ra0, dec0, radii[r],
+                    indices, 0, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+            ASSERT_EQ((int)expected.size(), num);
+            for (int i = 0; i < num; ++i)
+                EXPECT_EQ(expected[i], oskar_mem_int_const(indices,
+                        &status)[i]);
+        }
+    }
+
+    // Check queries on an empty index.
+    oskar_sky_resize(sky, 0, &status);
+    oskar_sky_index_free(index);
+    index = oskar_sky_index_create(sky, &status);
+    EXPECT_EQ(-1, oskar_sky_index_nearest(index, 0.0, 0.0, 0));
+    EXPECT_EQ(0, oskar_sky_index_query_radius(index, 0.0, 0.0, M_PI,
+            indices, dist, &status));
+    EXPECT_EQ(0, status);
+
+    oskar_mem_free(indices, &status);
+    oskar_mem_free(dist, &status);
+    oskar_sky_index_free(index);
+    oskar_sky_free(sky, &status);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -51,6 +51,32 @@ enum OSKAR_POL_MODE_TYPE
     OSKAR_POL_MODE_SCALAR
 };
 
+/* Tags used in telescope model snapshot files.
+ * To maintain binary compatibility, do not change the values
+ * in the list below. */
+enum OSKAR_TELESCOPE_TAGS
+{
+    OSKAR_TELESCOPE_TAG_DATA_TYPE = 1,
+    OSKAR_TELESCOPE_TAG_POL_MODE = 2,
+    OSKAR_TELESCOPE_TAG_ENABLE_NUMERICAL_PATTERNS = 3,
+    OSKAR_TELESCOPE_TAG_PARAMS_INT = 4,
+    OSKAR_TELESCOPE_TAG_PARAMS_DOUBLE = 5,
+    OSKAR_TELESCOPE_TAG_STATION_COORDS = 6,
+    OSKAR_TELESCOPE_TAG_STATION_PARAMS_INT = 7,
+    OSKAR_TELESCOPE_TAG_STATION_PARAMS_DOUBLE = 8,
+    OSKAR_TELESCOPE_TAG_STATION_ARRAY = 9,
+    OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_INT = 10,
+    OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_DOUBLE = 11,
+    OSKAR_TELESCOPE_TAG_ELEMENT_FREQS = 12,
+    OSKAR_TELESCOPE_TAG_ELEMENT_FILENAME = 13,
+    OSKAR_TELESCOPE_TAG_SPLINE_NUM_KNOTS = 14,
+    OSKAR_TELESCOPE_TAG_SPLINE_SMOOTHING = 15,
+    OSKAR_TELESCOPE_TAG_SPLINE_KNOTS_X = 16,
+    OSKAR_TELESCOPE_TAG_SPLINE_KNOTS_Y = 17,
+    OSKAR_TELESCOPE_TAG_SPLINE_COEFF = 18,
+    OSKAR_TELESCOPE_TAG_SOURCE_MANIFEST = 19
+};
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,12 +89,14 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_duplicate_first_station.h>
 #include <telescope/oskar_telescope_free.h>
 #include <telescope/oskar_telescope_load.h>
+#include <telescope/oskar_telescope_load_cached.h>
 #include <telescope/oskar_telescope_load_pointing_file.h>
 #include <telescope/oskar_telescope_load_position.h>
 #include <telescope/oskar_telescope_load_station_coords_ecef.h>
 #include <telescope/oskar_telescope_load_station_coords_enu.h>
 #include <telescope/oskar_telescope_load_station_coords_wgs84.h>
 #include <telescope/oskar_telescope_log_summary.h>
+#include <telescope/oskar_telescope_read.h>
 #include <telescope/oskar_telescope_resize.h>
 #include <telescope/oskar_telescope_save.h>
 #include <telescope/oskar_telescope_save_layout.h>
@@ -76,5 +104,6 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_set_station_coords_ecef.h>
 #include <telescope/oskar_telescope_set_station_coords_enu.h>
 #include <telescope/oskar_telescope_set_station_coords_wgs84.h>
+#include <telescope/oskar_telescope_write.h>
 
 #endif /* OSKAR_TELESCOPE_H_ */
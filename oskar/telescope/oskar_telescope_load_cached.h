@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TELESCOPE_LOAD_CACHED_H_
+#define OSKAR_TELESCOPE_LOAD_CACHED_H_
+
+/**
+ * @file oskar_telescope_load_cached.h
+ */
+
+#include <oskar_global.h>
+#include <log/oskar_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Loads a telescope model directory, using a binary snapshot if possible.
+ *
+ * @details
+ * This function loads the same telescope model as oskar_telescope_load(),
+ * but keeps a binary snapshot of the loaded model in a file next to the
+ * telescope model directory, with ".cache" appended to its name.
+ *
+ * The name, size and modification time of every file and directory in
+ * the telescope model are stored in the snapshot. If these all still match,
+ * and the snapshot was made using the same precision, polarisation mode
+ * and element pattern options, the telescope model is read from the
+ * snapshot using oskar_telescope_read(). Otherwise, the directory is
+ * loaded and the snapshot is (re-)written.
+ * A snapshot that cannot be written is not an error.
+ *
+ * The telescope model must be initialised and in CPU memory.
+ *
+ * @param[in,out] telescope  Pointer to telescope model to fill.
+ * @param[in]     path       Pathname of telescope model directory to load.
+ * @param[in,out] log        Pointer to log.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_telescope_load_cached(oskar_Telescope* telescope, const char* path,
+        oskar_Log* log, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TELESCOPE_LOAD_CACHED_H_ */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_PRIVATE_TELESCOPE_SNAPSHOT_H_
+#define OSKAR_PRIVATE_TELESCOPE_SNAPSHOT_H_
+
+/* Layout of telescope model snapshot files,
+ * shared by oskar_telescope_write() and oskar_telescope_read().
+ * To maintain binary compatibility, only append to these lists. */
+
+#include <telescope/private_telescope.h>
+#include <telescope/station/private_station.h>
+#include <telescope/station/element/private_element.h>
+#include <splines/private_splines.h>
+
+/* Indices into OSKAR_TELESCOPE_TAG_PARAMS_INT. */
+enum { TI_SUPPLIED_COORD_TYPE, TI_NUM_STATIONS, TI_COUNT };
+
+/* Indices into OSKAR_TELESCOPE_TAG_PARAMS_DOUBLE. */
+enum { TD_LON, TD_LAT, TD_ALT, TD_PM_X, TD_PM_Y, TD_COUNT };
+
+/* Indices into OSKAR_TELESCOPE_TAG_STATION_PARAMS_INT. */
+enum
+{
+    SI_STATION_TYPE, SI_NORMALISE_FINAL_BEAM, SI_BEAM_COORD_TYPE,
+    SI_NUM_ELEMENTS, SI_NUM_ELEMENT_TYPES, SI_NORMALISE_ARRAY_PATTERN,
+    SI_ENABLE_ARRAY_PATTERN, SI_COMMON_ELEMENT_ORIENTATION, SI_ARRAY_IS_3D,
+    SI_APPLY_ELEMENT_ERRORS, SI_APPLY_ELEMENT_WEIGHT,
+    SI_SEED_TIME_VARIABLE_ERRORS, SI_NUM_PERMITTED_BEAMS, SI_HAS_CHILD,
+    SI_COUNT
+};
+
+/* Indices into OSKAR_TELESCOPE_TAG_STATION_PARAMS_DOUBLE. */
+enum
+{
+    SD_LON, SD_LAT, SD_ALT, SD_PM_X, SD_PM_Y, SD_BEAM_LON, SD_BEAM_LAT,
+    SD_GAUSSIAN_FWHM, SD_GAUSSIAN_REF_FREQ, SD_COUNT
+};
+
+/* Indices into OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_INT. */
+enum
+{
+    EI_X_ELEMENT_TYPE, EI_Y_ELEMENT_TYPE, EI_X_TAPER_TYPE, EI_Y_TAPER_TYPE,
+    EI_X_DIPOLE_LENGTH_UNITS, EI_Y_DIPOLE_LENGTH_UNITS, EI_ELEMENT_TYPE,
+    EI_TAPER_TYPE, EI_DIPOLE_LENGTH_UNITS, EI_COORD_SYS, EI_NUM_FREQ,
+    EI_COUNT
+};
+
+/* Indices into OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_DOUBLE. */
+enum
+{
+    ED_X_DIPOLE_LENGTH, ED_Y_DIPOLE_LENGTH, ED_X_COSINE_POWER,
+    ED_Y_COSINE_POWER, ED_X_GAUSSIAN_FWHM, ED_Y_GAUSSIAN_FWHM,
+    ED_X_TAPER_REF_FREQ, ED_Y_TAPER_REF_FREQ, ED_DIPOLE_LENGTH,
+    ED_COSINE_POWER, ED_GAUSSIAN_FWHM, ED_MAX_RADIUS, ED_COUNT
+};
+
+/* Station coordinate arrays, stored with OSKAR_TELESCOPE_TAG_STATION_COORDS
+ * using the array index as the user index. */
+#define TELESCOPE_SNAPSHOT_NUM_COORDS 12
+#define TELESCOPE_SNAPSHOT_COORDS(t) { \
+    (t)->station_true_x_offset_ecef_metres, \
+    (t)->station_true_y_offset_ecef_metres, \
+    (t)->station_true_z_offset_ecef_metres, \
+    (t)->station_true_x_enu_metres, \
+    (t)->station_true_y_enu_metres, \
+    (t)->station_true_z_enu_metres, \
+    (t)->station_measured_x_offset_ecef_metres, \
+    (t)->station_measured_y_offset_ecef_metres, \
+    (t)->station_measured_z_offset_ecef_metres, \
+    (t)->station_measured_x_enu_metres, \
+    (t)->station_measured_y_enu_metres, \
+    (t)->station_measured_z_enu_metres }
+
+/* Per-station arrays, stored with OSKAR_TELESCOPE_TAG_STATION_ARRAY using
+ * (station index * TELESCOPE_SNAPSHOT_NUM_STATION_ARRAYS + array index)
+ * as the user index. */
+#define TELESCOPE_SNAPSHOT_NUM_STATION_ARRAYS 23
+#define TELESCOPE_SNAPSHOT_STATION_ARRAYS(s) { \
+    (s)->noise_freq_hz, \
+    (s)->noise_rms_jy, \
+    (s)->element_true_x_enu_metres, \
+    (s)->element_true_y_enu_metres, \
+    (s)->element_true_z_enu_metres, \
+    (s)->element_measured_x_enu_metres, \
+    (s)->element_measured_y_enu_metres, \
+    (s)->element_measured_z_enu_metres, \
+    (s)->element_gain, \
+    (s)->element_gain_error, \
+    (s)->element_phase_offset_rad, \
+    (s)->element_phase_error_rad, \
+    (s)->element_weight, \
+    (s)->element_types_cpu, \
+    (s)->element_mount_types_cpu, \
+    (s)->element_x_alpha_cpu, \
+    (s)->element_x_beta_cpu, \
+    (s)->element_x_gamma_cpu, \
+    (s)->element_y_alpha_cpu, \
+    (s)->element_y_beta_cpu, \
+    (s)->element_y_gamma_cpu, \
+    (s)->permitted_beam_az_rad, \
+    (s)->permitted_beam_el_rad }
+
+/* Spline surfaces for each element frequency, in the order stored. */
+#define TELESCOPE_SNAPSHOT_NUM_SPLINES 10
+#define TELESCOPE_SNAPSHOT_SPLINES(e, i) { \
+    (e)->x_h_re[i], (e)->x_h_im[i], (e)->x_v_re[i], (e)->x_v_im[i], \
+    (e)->y_h_re[i], (e)->y_h_im[i], (e)->y_v_re[i], (e)->y_v_im[i], \
+    (e)->scalar_re[i], (e)->scalar_im[i] }
+
+/* Running counts of items written or read, used as user indices.
+ * Items are always read in the order in which they were written. */
+struct SnapshotCounters
+{
+    int station, element, filename, spline;
+};
+typedef struct SnapshotCounters SnapshotCounters;
+
+#endif /* OSKAR_PRIVATE_TELESCOPE_SNAPSHOT_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2016, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,11 +31,15 @@
 
 #include "telescope/station/oskar_station_analyse.h"
 #include "telescope/station/oskar_station_different.h"
+#include "telescope/station/oskar_station_hash.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Limit on the number of distinct child station designs to look for. */
+#define MAX_CHILD_TYPES 64
+
 static void max_station_size_and_depth(const oskar_Station* s,
         int* max_elements, int* max_depth, int depth)
 {
@@ -76,9 +80,86 @@ static void set_child_station_locations(oskar_Station* s,
 }
 
 
+static int has_time_variable_errors(const oskar_Station* s, int* status)
+{
+    int i, num_elements;
+    num_elements = oskar_station_num_elements(s);
+    if (oskar_station_precision(s) == OSKAR_DOUBLE)
+    {
+        const double *amp_err, *phase_err;
+        amp_err = oskar_mem_double_const(
+                oskar_station_element_gain_error_const(s), status);
+        phase_err = oskar_mem_double_const(
+                oskar_station_element_phase_error_rad_const(s), status);
+        for (i = 0; i < num_elements; ++i)
+            if (amp_err[i] != 0.0 || phase_err[i] != 0.0) return 1;
+    }
+    else
+    {
+        const float *amp_err, *phase_err;
+        amp_err = oskar_mem_float_const(
+                oskar_station_element_gain_error_const(s), status);
+        phase_err = oskar_mem_float_const(
+                oskar_station_element_phase_error_rad_const(s), status);
+        for (i = 0; i < num_elements; ++i)
+            if (amp_err[i] != 0.0f || phase_err[i] != 0.0f) return 1;
+    }
+    if (oskar_station_has_child(s))
+    {
+        for (i = 0; i < num_elements; ++i)
+            if (has_time_variable_errors(oskar_station_child_const(s, i),
+                    status)) return 1;
+    }
+    return 0;
+}
+
+
+static void set_child_type_ids(oskar_Station* s,
+        const oskar_Station** types, unsigned long long* hashes,
+        int* num_types, int* status)
+{
+    int i, j, num_elements;
+    if (*status || !oskar_station_has_child(s)) return;
+
+    /* Child stations with time-variable errors get independent random
+     * numbers, so their beams can never be shared. */
+    num_elements = oskar_station_num_elements(s);
+    for (i = 0; i < num_elements; ++i)
+    {
+        int id = -1;
+        oskar_Station* child;
+        child = oskar_station_child(s, i);
+        set_child_type_ids(child, types, hashes, num_types, status);
+        if (!has_time_variable_errors(child, status))
+        {
+            const unsigned long long hash = oskar_station_hash(child, status);
+            for (j = 0; j < *num_types; ++j)
+            {
+                if (hashes[j] == hash &&
+                        !oskar_station_different(types[j], child, status))
+                {
+                    id = j;
+                    break;
+                }
+            }
+            if (id < 0 && *num_types < MAX_CHILD_TYPES)
+            {
+                id = (*num_types)++;
+                types[id] = child;
+                hashes[id] = hash;
+            }
+        }
+        oskar_station_set_child_type_id(child, id);
+    }
+}
+
+
 void oskar_telescope_analyse(oskar_Telescope* model, int* status)
 {
     int i = 0, finished_identical_station_check = 0, num_stations;
+    int num_types = 0;
+    const oskar_Station* types[MAX_CHILD_TYPES];
+    unsigned long long hashes[MAX_CHILD_TYPES];
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -106,6 +187,13 @@ void oskar_telescope_analyse(oskar_Telescope* model, int* status)
     /* Check if safe to proceed. */
     if (*status) return;
 
+    /* Find the distinct child station designs across all stations. */
+    for (i = 0; i < num_stations; ++i)
+    {
+        set_child_type_ids(oskar_telescope_station(model, i),
+                types, hashes, &num_types, status);
+    }
+
     /* Check if we need to examine every station. */
     if (finished_identical_station_check)
     {
@@ -113,11 +201,19 @@ void oskar_telescope_analyse(oskar_Telescope* model, int* status)
     }
     else
     {
-        /* Check if the stations are different. */
+        /* Check if the stations are different.
+         * Only compare stations with the same hash as the first. */
+        unsigned long long hash0 = 0;
+        if (num_stations > 0)
+            hash0 = oskar_station_hash(
+                    oskar_telescope_station_const(model, 0), status);
         for (i = 1; i < num_stations; ++i)
         {
-            if (oskar_station_different(oskar_telescope_station(model, 0),
-                    oskar_telescope_station(model, i), status))
+            if (hash0 != oskar_station_hash(
+                    oskar_telescope_station_const(model, i), status) ||
+                    oskar_station_different(
+                    oskar_telescope_station_const(model, 0),
+                    oskar_telescope_station_const(model, i), status))
             {
                 model->identical_stations = 0;
                 break;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,8 @@
 #include "telescope/oskar_telescope.h"
 #include "utility/oskar_dir.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
 #include "telescope/private_TelescopeLoaderApodisation.h"
 #include "telescope/private_TelescopeLoaderElementPattern.h"
 #include "telescope/private_TelescopeLoaderElementTypes.h"
@@ -49,10 +51,27 @@ using std::map;
 using std::string;
 using std::vector;
 
+struct ThreadArgs
+{
+    oskar_Telescope* telescope;
+    const string* cwd;
+    char** children;
+    const vector<oskar_TelescopeLoadAbstract*>* loaders;
+    const map<string, string>* filemap;
+    oskar_Log* log;
+    oskar_Mutex* mutex;
+    int num_stations, next_station, status;
+};
+
 static void load_directories(oskar_Telescope* telescope,
         const string& cwd, oskar_Station* station, int depth,
         const vector<oskar_TelescopeLoadAbstract*>& loaders,
-        map<string, string> filemap, oskar_Log* log, int* status);
+        map<string, string> filemap, oskar_Log* log, oskar_Mutex* mutex,
+        int* status);
+static void load_stations(oskar_Telescope* telescope, const string& cwd,
+        int num_dirs, char** children,
+        const vector<oskar_TelescopeLoadAbstract*>& loaders,
+        const map<string, string>& filemap, oskar_Log* log, int* status);
 
 extern "C"
 void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
@@ -94,7 +113,7 @@ void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
     // Load everything recursively from the telescope directory tree.
     map<string, string> filemap;
     load_directories(telescope, string(path), NULL, 0, loaders,
-            filemap, log, status);
+            filemap, log, NULL, status);
     if (*status)
     {
         oskar_log_error(log, "Failed to load telescope model (%s).",
@@ -118,7 +137,8 @@ void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
 static void load_directories(oskar_Telescope* telescope,
         const string& cwd, oskar_Station* station, int depth,
         const vector<oskar_TelescopeLoadAbstract*>& loaders,
-        map<string, string> filemap, oskar_Log* log, int* status)
+        map<string, string> filemap, oskar_Log* log, oskar_Mutex* mutex,
+        int* status)
 {
     int num_dirs = 0;
     char** children = 0;
@@ -152,7 +172,7 @@ static void load_directories(oskar_Telescope* telescope,
             load_directories(telescope,
                     oskar_TelescopeLoadAbstract::get_path(cwd, children[0]),
                     oskar_telescope_station(telescope, 0), depth + 1,
-                    loaders, filemap, log, status);
+                    loaders, filemap, log, mutex, status);
 
             // Copy station 0 to all the others.
             oskar_telescope_duplicate_first_station(telescope, status);
@@ -166,15 +186,9 @@ static void load_directories(oskar_Telescope* telescope,
                 goto fail;
             }
 
-            // Loop over and descend into all stations.
-            for (int i = 0; i < num_dirs; ++i)
-            {
-                // Recursive call to load the station.
-                load_directories(telescope,
-                        oskar_TelescopeLoadAbstract::get_path(cwd, children[i]),
-                        oskar_telescope_station(telescope, i), depth + 1,
-                        loaders, filemap, log, status);
-            }
+            // Load all stations in parallel.
+            load_stations(telescope, cwd, num_dirs, children, loaders,
+                    filemap, log, status);
         } // End check on number of directories.
     }
 
@@ -189,7 +203,9 @@ static void load_directories(oskar_Telescope* telescope,
             {
                 string s = string("Error in ") + loaders[i]->name() +
                         string(" in '") + cwd + string("'.");
+                if (mutex) oskar_mutex_lock(mutex);
                 oskar_log_error(log, "%s", s.c_str());
+                if (mutex) oskar_mutex_unlock(mutex);
                 goto fail;
             }
         }
@@ -201,7 +217,7 @@ static void load_directories(oskar_Telescope* telescope,
             load_directories(telescope,
                     oskar_TelescopeLoadAbstract::get_path(cwd, children[0]),
                     oskar_station_child(station, 0), depth + 1, loaders,
-                    filemap, log, status);
+                    filemap, log, mutex, status);
 
             // Copy station 0 to all the others.
             oskar_station_duplicate_first_child(station, status);
@@ -222,7 +238,7 @@ static void load_directories(oskar_Telescope* telescope,
                 load_directories(telescope,
                         oskar_TelescopeLoadAbstract::get_path(cwd, children[i]),
                         oskar_station_child(station, i), depth + 1, loaders,
-                        filemap, log, status);
+                        filemap, log, mutex, status);
             }
         } // End check on number of directories.
     } // End check on depth.
@@ -231,3 +247,67 @@ fail:
     for (int i = 0; i < num_dirs; ++i) free(children[i]);
     free(children);
 }
+
+static void* load_stations_thread(void* arg)
+{
+    ThreadArgs* a = (ThreadArgs*) arg;
+    for (;;)
+    {
+        int i, status = 0;
+
+        // Get the next station to load, unless an error has occurred.
+        oskar_mutex_lock(a->mutex);
+        i = a->status ? a->num_stations : a->next_station++;
+        oskar_mutex_unlock(a->mutex);
+        if (i >= a->num_stations) break;
+
+        // Recursive call to load the station.
+        load_directories(a->telescope,
+                oskar_TelescopeLoadAbstract::get_path(*a->cwd, a->children[i]),
+                oskar_telescope_station(a->telescope, i), 1, *a->loaders,
+                *a->filemap, a->log, a->mutex, &status);
+        if (status)
+        {
+            oskar_mutex_lock(a->mutex);
+            if (!a->status) a->status = status;
+            oskar_mutex_unlock(a->mutex);
+        }
+    }
+    return 0;
+}
+
+// Stations are independent once the top-level layout has been loaded,
+// and the loaders only read their own state below the top level,
+// so they can be shared by all threads.
+static void load_stations(oskar_Telescope* telescope, const string& cwd,
+        int num_dirs, char** children,
+        const vector<oskar_TelescopeLoadAbstract*>& loaders,
+        const map<string, string>& filemap, oskar_Log* log, int* status)
+{
+    ThreadArgs args;
+    int i, num_threads;
+    if (*status) return;
+    num_threads = oskar_get_num_procs();
+    if (num_threads > num_dirs) num_threads = num_dirs;
+    if (num_threads < 1) num_threads = 1;
+    args.telescope = telescope;
+    args.cwd = &cwd;
+    args.children = children;
+    args.loaders = &loaders;
+    args.filemap = &filemap;
+    args.log = log;
+    args.mutex = oskar_mutex_create();
+    args.num_stations = num_dirs;
+    args.next_station = 0;
+    args.status = 0;
+    vector<oskar_Thread*> threads(num_threads);
+    for (i = 0; i < num_threads; ++i)
+        threads[i] = oskar_thread_create(load_stations_thread, &args, 0);
+    for (i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+    oskar_mutex_free(args.mutex);
+    *status = args.status;
+}
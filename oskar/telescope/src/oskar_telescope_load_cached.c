@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/oskar_telescope.h"
+#include "telescope/private_telescope.h"
+#include "binary/oskar_binary.h"
+#include "utility/oskar_dir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Manifest
+{
+    char* data;
+    size_t length, capacity;
+};
+typedef struct Manifest Manifest;
+
+/* Appends the name, size and modification time of every item below the
+ * given directory to the manifest, recursively, in sorted order. */
+static void add_items(const char* dir, const char* prefix, Manifest* m)
+{
+    int i, num_items = 0;
+    char** items = 0;
+    oskar_dir_items(dir, NULL, 1, 1, &num_items, &items);
+    for (i = 0; i < num_items; ++i)
+    {
+        struct stat info;
+        char *path, *name;
+        size_t len;
+        path = oskar_dir_get_path(dir, items[i]);
+        name = (char*) calloc(strlen(prefix) + strlen(items[i]) + 2, 1);
+        sprintf(name, "%s%s", prefix, items[i]);
+        if (stat(path, &info) == 0)
+        {
+            len = strlen(name) + 64;
+            if (m->length + len > m->capacity)
+            {
+                m->capacity = 2 * (m->length + len);
+                m->data = (char*) realloc(m->data, m->capacity);
+            }
+            m->length += sprintf(m->data + m->length, "%s\t%.0f\t%.0f\n",
+                    name, (double) info.st_size, (double) info.st_mtime);
+            if (oskar_dir_exists(path))
+            {
+                strcat(name, "/");
+                add_items(path, name, m);
+            }
+        }
+        free(name);
+        free(path);
+        free(items[i]);
+    }
+    free(items);
+}
+
+static int cache_is_valid(const char* cache_name, const oskar_Telescope* t,
+        const Manifest* m)
+{
+    int chunk, type = 0, pol_mode = 0, numerical = 0, status = 0, valid = 0;
+    size_t size = 0;
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    oskar_Binary* h;
+    h = oskar_binary_create(cache_name, 'r', &status);
+    oskar_binary_read_int(h, group, OSKAR_TELESCOPE_TAG_DATA_TYPE, 0,
+            &type, &status);
+    oskar_binary_read_int(h, group, OSKAR_TELESCOPE_TAG_POL_MODE, 0,
+            &pol_mode, &status);
+    oskar_binary_read_int(h, group,
+            OSKAR_TELESCOPE_TAG_ENABLE_NUMERICAL_PATTERNS, 0,
+            &numerical, &status);
+    chunk = oskar_binary_query(h, OSKAR_CHAR, group,
+            OSKAR_TELESCOPE_TAG_SOURCE_MANIFEST, 0, &size, &status);
+    if (!status && type == t->precision && pol_mode == t->pol_mode &&
+            numerical == t->enable_numerical_patterns && size == m->length)
+    {
+        char* data = (char*) malloc(size + 1);
+        oskar_binary_read_block(h, chunk, size, data, &status);
+        valid = (!status && (size == 0 || !memcmp(data, m->data, size)));
+        free(data);
+    }
+    oskar_binary_free(h);
+    return valid;
+}
+
+static void write_cache(const char* cache_name, const oskar_Telescope* t,
+        const Manifest* m)
+{
+    int status = 0;
+    oskar_Binary* h;
+
+    /* Write the manifest last, so that an incomplete
+     * cache file is never treated as valid. */
+    oskar_telescope_write(t, cache_name, &status);
+    h = oskar_binary_create(cache_name, 'a', &status);
+    oskar_binary_write(h, OSKAR_CHAR, OSKAR_TAG_GROUP_TELESCOPE,
+            OSKAR_TELESCOPE_TAG_SOURCE_MANIFEST, 0, m->length, m->data,
+            &status);
+    oskar_binary_free(h);
+    if (status) remove(cache_name);
+}
+
+void oskar_telescope_load_cached(oskar_Telescope* telescope, const char* path,
+        oskar_Log* log, int* status)
+{
+    char* cache_name;
+    size_t len;
+    Manifest m = {0, 0, 0};
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check that the telescope directory has been set and exists. */
+    if (!path || !oskar_dir_exists(path))
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+
+    /* List every item in the telescope model directory. */
+    add_items(path, "", &m);
+
+    /* Get the name of the cache, next to the directory. */
+    len = strlen(path);
+    while (len > 1 && (path[len - 1] == '/' || path[len - 1] == '\\'))
+        len--;
+    cache_name = (char*) calloc(len + 7, sizeof(char));
+    memcpy(cache_name, path, len);
+    strcat(cache_name, ".cache");
+
+    /* Read the cache if it is up to date. */
+    if (cache_is_valid(cache_name, telescope, &m))
+    {
+        int cache_status = 0;
+        oskar_telescope_read(telescope, cache_name, &cache_status);
+        if (!cache_status)
+        {
+            oskar_log_message(log, 'M', 0,
+                    "Loaded telescope model from '%s'", cache_name);
+            free(cache_name);
+            free(m.data);
+            return;
+        }
+        oskar_telescope_resize(telescope, 0, status);
+    }
+
+    /* Otherwise, load the directory and write a new cache. */
+    oskar_telescope_load(telescope, path, log, status);
+    if (!*status) write_cache(cache_name, telescope, &m);
+    free(cache_name);
+    free(m.data);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/oskar_telescope.h"
+#include "telescope/private_telescope_snapshot.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_read_mem.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void read_params(oskar_Binary* h, unsigned char type,
+        unsigned char tag, int index, size_t size, void* data, int* status);
+static void read_station(oskar_Binary* h, oskar_Station* s,
+        SnapshotCounters* counters, int* status);
+static void read_element(oskar_Binary* h, oskar_Element* e,
+        SnapshotCounters* counters, int* status);
+static void read_splines(oskar_Binary* h, oskar_Splines* sp,
+        int index, int* status);
+
+void oskar_telescope_read(oskar_Telescope* telescope, const char* filename,
+        int* status)
+{
+    int i, type = 0, ti[TI_COUNT];
+    double td[TD_COUNT];
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    SnapshotCounters counters = {0, 0, 0, 0};
+    oskar_Binary* h;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check that the telescope model is in CPU memory. */
+    if (telescope->mem_location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Open the file, and check the data type. */
+    h = oskar_binary_create(filename, 'm', status);
+    oskar_binary_read_int(h, group, OSKAR_TELESCOPE_TAG_DATA_TYPE, 0,
+            &type, status);
+    if (!*status && type != telescope->precision)
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+
+    /* Read the telescope position and station coordinates. */
+    read_params(h, OSKAR_INT, OSKAR_TELESCOPE_TAG_PARAMS_INT, 0,
+            sizeof(ti), ti, status);
+    read_params(h, OSKAR_DOUBLE, OSKAR_TELESCOPE_TAG_PARAMS_DOUBLE, 0,
+            sizeof(td), td, status);
+    if (*status)
+    {
+        oskar_binary_free(h);
+        return;
+    }
+    telescope->supplied_coord_type = ti[TI_SUPPLIED_COORD_TYPE];
+    telescope->lon_rad    = td[TD_LON];
+    telescope->lat_rad    = td[TD_LAT];
+    telescope->alt_metres = td[TD_ALT];
+    telescope->pm_x_rad   = td[TD_PM_X];
+    telescope->pm_y_rad   = td[TD_PM_Y];
+
+    /* Replace all the stations. */
+    oskar_telescope_resize(telescope, 0, status);
+    oskar_telescope_resize(telescope, ti[TI_NUM_STATIONS], status);
+    if (!*status)
+    {
+        oskar_Mem* coords[] = TELESCOPE_SNAPSHOT_COORDS(telescope);
+        for (i = 0; i < TELESCOPE_SNAPSHOT_NUM_COORDS; ++i)
+            oskar_binary_read_mem(h, coords[i], group,
+                    OSKAR_TELESCOPE_TAG_STATION_COORDS, i, status);
+    }
+    for (i = 0; i < telescope->num_stations; ++i)
+        read_station(h, telescope->station[i], &counters, status);
+
+    /* Release the handle, and (re-)set unique station IDs. */
+    oskar_binary_free(h);
+    oskar_telescope_set_station_ids(telescope);
+}
+
+/* Reads a fixed-size block of parameters, which must be complete. */
+static void read_params(oskar_Binary* h, unsigned char type,
+        unsigned char tag, int index, size_t size, void* data, int* status)
+{
+    size_t size_bytes = 0;
+    int chunk;
+    chunk = oskar_binary_query(h, type, OSKAR_TAG_GROUP_TELESCOPE, tag,
+            index, &size_bytes, status);
+    if (!*status && size_bytes != size)
+        *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+    oskar_binary_read_block(h, chunk, size, data, status);
+}
+
+static void read_station(oskar_Binary* h, oskar_Station* s,
+        SnapshotCounters* counters, int* status)
+{
+    int i, si[SI_COUNT], idx, chunk;
+    double sd[SD_COUNT];
+    size_t size_bytes = 0;
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    if (*status) return;
+    idx = counters->station++;
+
+    /* Everything after this point was written after the station
+     * parameters, so start all further searches here. */
+    chunk = oskar_binary_query(h, OSKAR_INT, group,
+            OSKAR_TELESCOPE_TAG_STATION_PARAMS_INT, idx, &size_bytes, status);
+    if (!*status) oskar_binary_set_query_search_start(h, chunk, status);
+
+    /* Read the station parameters. */
+    read_params(h, OSKAR_INT, OSKAR_TELESCOPE_TAG_STATION_PARAMS_INT, idx,
+            sizeof(si), si, status);
+    read_params(h, OSKAR_DOUBLE, OSKAR_TELESCOPE_TAG_STATION_PARAMS_DOUBLE,
+            idx, sizeof(sd), sd, status);
+    if (*status) return;
+    s->station_type               = si[SI_STATION_TYPE];
+    s->normalise_final_beam       = si[SI_NORMALISE_FINAL_BEAM];
+    s->beam_coord_type            = si[SI_BEAM_COORD_TYPE];
+    s->normalise_array_pattern    = si[SI_NORMALISE_ARRAY_PATTERN];
+    s->enable_array_pattern       = si[SI_ENABLE_ARRAY_PATTERN];
+    s->common_element_orientation = si[SI_COMMON_ELEMENT_ORIENTATION];
+    s->array_is_3d                = si[SI_ARRAY_IS_3D];
+    s->apply_element_errors       = si[SI_APPLY_ELEMENT_ERRORS];
+    s->apply_element_weight       = si[SI_APPLY_ELEMENT_WEIGHT];
+    s->seed_time_variable_errors  =
+            (unsigned int) si[SI_SEED_TIME_VARIABLE_ERRORS];
+    s->num_permitted_beams        = si[SI_NUM_PERMITTED_BEAMS];
+    s->lon_rad                    = sd[SD_LON];
+    s->lat_rad                    = sd[SD_LAT];
+    s->alt_metres                 = sd[SD_ALT];
+    s->pm_x_rad                   = sd[SD_PM_X];
+    s->pm_y_rad                   = sd[SD_PM_Y];
+    s->beam_lon_rad               = sd[SD_BEAM_LON];
+    s->beam_lat_rad               = sd[SD_BEAM_LAT];
+    s->gaussian_beam_fwhm_rad     = sd[SD_GAUSSIAN_FWHM];
+    s->gaussian_beam_reference_freq_hz = sd[SD_GAUSSIAN_REF_FREQ];
+
+    /* Read the station arrays. */
+    oskar_station_resize(s, si[SI_NUM_ELEMENTS], status);
+    if (*status) return;
+    {
+        oskar_Mem* arrays[] = TELESCOPE_SNAPSHOT_STATION_ARRAYS(s);
+        for (i = 0; i < TELESCOPE_SNAPSHOT_NUM_STATION_ARRAYS; ++i)
+            oskar_binary_read_mem(h, arrays[i], group,
+                    OSKAR_TELESCOPE_TAG_STATION_ARRAY,
+                    idx * TELESCOPE_SNAPSHOT_NUM_STATION_ARRAYS + i, status);
+    }
+    oskar_mem_copy(s->element_types, s->element_types_cpu, status);
+
+    /* Read the element models, and then the child stations. */
+    oskar_station_resize_element_types(s, si[SI_NUM_ELEMENT_TYPES], status);
+    for (i = 0; i < s->num_element_types; ++i)
+        read_element(h, s->element[i], counters, status);
+    if (si[SI_HAS_CHILD])
+    {
+        oskar_station_create_child_stations(s, status);
+        for (i = 0; i < s->num_elements; ++i)
+            read_station(h, s->child[i], counters, status);
+    }
+}
+
+static void read_element(oskar_Binary* h, oskar_Element* e,
+        SnapshotCounters* counters, int* status)
+{
+    int i, j, ei[EI_COUNT], idx;
+    double ed[ED_COUNT];
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    if (*status) return;
+    idx = counters->element++;
+
+    /* Read the element parameters. */
+    read_params(h, OSKAR_INT, OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_INT, idx,
+            sizeof(ei), ei, status);
+    read_params(h, OSKAR_DOUBLE, OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_DOUBLE,
+            idx, sizeof(ed), ed, status);
+    if (*status) return;
+    e->x_element_type            = ei[EI_X_ELEMENT_TYPE];
+    e->y_element_type            = ei[EI_Y_ELEMENT_TYPE];
+    e->x_taper_type              = ei[EI_X_TAPER_TYPE];
+    e->y_taper_type              = ei[EI_Y_TAPER_TYPE];
+    e->x_dipole_length_units     = ei[EI_X_DIPOLE_LENGTH_UNITS];
+    e->y_dipole_length_units     = ei[EI_Y_DIPOLE_LENGTH_UNITS];
+    e->element_type              = ei[EI_ELEMENT_TYPE];
+    e->taper_type                = ei[EI_TAPER_TYPE];
+    e->dipole_length_units       = ei[EI_DIPOLE_LENGTH_UNITS];
+    e->coord_sys                 = ei[EI_COORD_SYS];
+    e->x_dipole_length           = ed[ED_X_DIPOLE_LENGTH];
+    e->y_dipole_length           = ed[ED_Y_DIPOLE_LENGTH];
+    e->x_taper_cosine_power      = ed[ED_X_COSINE_POWER];
+    e->y_taper_cosine_power      = ed[ED_Y_COSINE_POWER];
+    e->x_taper_gaussian_fwhm_rad = ed[ED_X_GAUSSIAN_FWHM];
+    e->y_taper_gaussian_fwhm_rad = ed[ED_Y_GAUSSIAN_FWHM];
+    e->x_taper_ref_freq_hz       = ed[ED_X_TAPER_REF_FREQ];
+    e->y_taper_ref_freq_hz       = ed[ED_Y_TAPER_REF_FREQ];
+    e->dipole_length             = ed[ED_DIPOLE_LENGTH];
+    e->cosine_power              = ed[ED_COSINE_POWER];
+    e->gaussian_fwhm_rad         = ed[ED_GAUSSIAN_FWHM];
+    e->max_radius_rad            = ed[ED_MAX_RADIUS];
+    oskar_element_resize_freq_data(e, ei[EI_NUM_FREQ], status);
+    read_params(h, OSKAR_DOUBLE, OSKAR_TELESCOPE_TAG_ELEMENT_FREQS, idx,
+            e->num_freq * sizeof(double), e->freqs_hz, status);
+
+    /* Read the file names and fitted surfaces for each frequency. */
+    for (i = 0; i < e->num_freq; ++i)
+    {
+        oskar_Mem* names[] = {
+                e->filename_x[i], e->filename_y[i], e->filename_scalar[i] };
+        oskar_Splines* splines[] = TELESCOPE_SNAPSHOT_SPLINES(e, i);
+        for (j = 0; j < 3; ++j)
+            oskar_binary_read_mem(h, names[j], group,
+                    OSKAR_TELESCOPE_TAG_ELEMENT_FILENAME,
+                    counters->filename++, status);
+        for (j = 0; j < TELESCOPE_SNAPSHOT_NUM_SPLINES; ++j)
+            read_splines(h, splines[j], counters->spline++, status);
+    }
+}
+
+static void read_splines(oskar_Binary* h, oskar_Splines* sp,
+        int index, int* status)
+{
+    int num_knots[2];
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    read_params(h, OSKAR_INT, OSKAR_TELESCOPE_TAG_SPLINE_NUM_KNOTS, index,
+            sizeof(num_knots), num_knots, status);
+    oskar_binary_read_double(h, group, OSKAR_TELESCOPE_TAG_SPLINE_SMOOTHING,
+            index, &sp->smoothing_factor, status);
+    oskar_binary_read_mem(h, sp->knots_x_theta, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_KNOTS_X, index, status);
+    oskar_binary_read_mem(h, sp->knots_y_phi, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_KNOTS_Y, index, status);
+    oskar_binary_read_mem(h, sp->coeff, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_COEFF, index, status);
+    sp->num_knots_x_theta = num_knots[0];
+    sp->num_knots_y_phi = num_knots[1];
+}
+
+#ifdef __cplusplus
+}
+#endif
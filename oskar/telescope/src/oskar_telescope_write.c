@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/oskar_telescope.h"
+#include "telescope/private_telescope_snapshot.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_binary_write_metadata.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void write_station(oskar_Binary* h, const oskar_Station* s,
+        SnapshotCounters* counters, int* status);
+static void write_element(oskar_Binary* h, const oskar_Element* e,
+        SnapshotCounters* counters, int* status);
+static void write_splines(oskar_Binary* h, const oskar_Splines* sp,
+        int index, int* status);
+
+void oskar_telescope_write(const oskar_Telescope* telescope,
+        const char* filename, int* status)
+{
+    int i, ti[TI_COUNT];
+    double td[TD_COUNT];
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    const oskar_Mem* coords[] = TELESCOPE_SNAPSHOT_COORDS(telescope);
+    SnapshotCounters counters = {0, 0, 0, 0};
+    oskar_Binary* h;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Create the handle. */
+    h = oskar_binary_create(filename, 'w', status);
+    if (*status)
+    {
+        oskar_binary_free(h);
+        return;
+    }
+
+    /* Write the common metadata, and the options that affect the load. */
+    oskar_binary_write_metadata(h, status);
+    oskar_binary_write_int(h, group, OSKAR_TELESCOPE_TAG_DATA_TYPE, 0,
+            telescope->precision, status);
+    oskar_binary_write_int(h, group, OSKAR_TELESCOPE_TAG_POL_MODE, 0,
+            telescope->pol_mode, status);
+    oskar_binary_write_int(h, group,
+            OSKAR_TELESCOPE_TAG_ENABLE_NUMERICAL_PATTERNS, 0,
+            telescope->enable_numerical_patterns, status);
+
+    /* Write the telescope position and station coordinates. */
+    ti[TI_SUPPLIED_COORD_TYPE] = telescope->supplied_coord_type;
+    ti[TI_NUM_STATIONS]        = telescope->num_stations;
+    td[TD_LON]  = telescope->lon_rad;
+    td[TD_LAT]  = telescope->lat_rad;
+    td[TD_ALT]  = telescope->alt_metres;
+    td[TD_PM_X] = telescope->pm_x_rad;
+    td[TD_PM_Y] = telescope->pm_y_rad;
+    oskar_binary_write(h, OSKAR_INT, group, OSKAR_TELESCOPE_TAG_PARAMS_INT, 0,
+            sizeof(ti), ti, status);
+    oskar_binary_write(h, OSKAR_DOUBLE, group,
+            OSKAR_TELESCOPE_TAG_PARAMS_DOUBLE, 0, sizeof(td), td, status);
+    for (i = 0; i < TELESCOPE_SNAPSHOT_NUM_COORDS; ++i)
+        oskar_binary_write_mem(h, coords[i], group,
+                OSKAR_TELESCOPE_TAG_STATION_COORDS, i, 0, status);
+
+    /* Write the stations. */
+    for (i = 0; i < telescope->num_stations; ++i)
+        write_station(h, telescope->station[i], &counters, status);
+
+    /* Release the handle. */
+    oskar_binary_free(h);
+}
+
+static void write_station(oskar_Binary* h, const oskar_Station* s,
+        SnapshotCounters* counters, int* status)
+{
+    int i, si[SI_COUNT], idx;
+    double sd[SD_COUNT];
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    const oskar_Mem* arrays[] = TELESCOPE_SNAPSHOT_STATION_ARRAYS(s);
+    if (*status) return;
+    idx = counters->station++;
+
+    /* Write the station parameters. */
+    si[SI_STATION_TYPE]                = s->station_type;
+    si[SI_NORMALISE_FINAL_BEAM]        = s->normalise_final_beam;
+    si[SI_BEAM_COORD_TYPE]             = s->beam_coord_type;
+    si[SI_NUM_ELEMENTS]                = s->num_elements;
+    si[SI_NUM_ELEMENT_TYPES]           = s->num_element_types;
+    si[SI_NORMALISE_ARRAY_PATTERN]     = s->normalise_array_pattern;
+    si[SI_ENABLE_ARRAY_PATTERN]        = s->enable_array_pattern;
+    si[SI_COMMON_ELEMENT_ORIENTATION]  = s->common_element_orientation;
+    si[SI_ARRAY_IS_3D]                 = s->array_is_3d;
+    si[SI_APPLY_ELEMENT_ERRORS]        = s->apply_element_errors;
+    si[SI_APPLY_ELEMENT_WEIGHT]        = s->apply_element_weight;
+    si[SI_SEED_TIME_VARIABLE_ERRORS]   = (int) s->seed_time_variable_errors;
+    si[SI_NUM_PERMITTED_BEAMS]         = s->num_permitted_beams;
+    si[SI_HAS_CHILD]                   = (s->child != 0);
+    sd[SD_LON]               = s->lon_rad;
+    sd[SD_LAT]               = s->lat_rad;
+    sd[SD_ALT]               = s->alt_metres;
+    sd[SD_PM_X]              = s->pm_x_rad;
+    sd[SD_PM_Y]              = s->pm_y_rad;
+    sd[SD_BEAM_LON]          = s->beam_lon_rad;
+    sd[SD_BEAM_LAT]          = s->beam_lat_rad;
+    sd[SD_GAUSSIAN_FWHM]     = s->gaussian_beam_fwhm_rad;
+    sd[SD_GAUSSIAN_REF_FREQ] = s->gaussian_beam_reference_freq_hz;
+    oskar_binary_write(h, OSKAR_INT, group,
+            OSKAR_TELESCOPE_TAG_STATION_PARAMS_INT, idx,
+            sizeof(si), si, status);
+    oskar_binary_write(h, OSKAR_DOUBLE, group,
+            OSKAR_TELESCOPE_TAG_STATION_PARAMS_DOUBLE, idx,
+            sizeof(sd), sd, status);
+
+    /* Write the station arrays. */
+    for (i = 0; i < TELESCOPE_SNAPSHOT_NUM_STATION_ARRAYS; ++i)
+        oskar_binary_write_mem(h, arrays[i], group,
+                OSKAR_TELESCOPE_TAG_STATION_ARRAY,
+                idx * TELESCOPE_SNAPSHOT_NUM_STATION_ARRAYS + i, 0, status);
+
+    /* Write the element models, and then the child stations. */
+    for (i = 0; i < s->num_element_types; ++i)
+        write_element(h, s->element[i], counters, status);
+    if (s->child)
+        for (i = 0; i < s->num_elements; ++i)
+            write_station(h, s->child[i], counters, status);
+}
+
+static void write_element(oskar_Binary* h, const oskar_Element* e,
+        SnapshotCounters* counters, int* status)
+{
+    int i, j, ei[EI_COUNT], idx;
+    double ed[ED_COUNT];
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    if (*status) return;
+    idx = counters->element++;
+
+    /* Write the element parameters. */
+    ei[EI_X_ELEMENT_TYPE]        = e->x_element_type;
+    ei[EI_Y_ELEMENT_TYPE]        = e->y_element_type;
+    ei[EI_X_TAPER_TYPE]          = e->x_taper_type;
+    ei[EI_Y_TAPER_TYPE]          = e->y_taper_type;
+    ei[EI_X_DIPOLE_LENGTH_UNITS] = e->x_dipole_length_units;
+    ei[EI_Y_DIPOLE_LENGTH_UNITS] = e->y_dipole_length_units;
+    ei[EI_ELEMENT_TYPE]          = e->element_type;
+    ei[EI_TAPER_TYPE]            = e->taper_type;
+    ei[EI_DIPOLE_LENGTH_UNITS]   = e->dipole_length_units;
+    ei[EI_COORD_SYS]             = e->coord_sys;
+    ei[EI_NUM_FREQ]              = e->num_freq;
+    ed[ED_X_DIPOLE_LENGTH]  = e->x_dipole_length;
+    ed[ED_Y_DIPOLE_LENGTH]  = e->y_dipole_length;
+    ed[ED_X_COSINE_POWER]   = e->x_taper_cosine_power;
+    ed[ED_Y_COSINE_POWER]   = e->y_taper_cosine_power;
+    ed[ED_X_GAUSSIAN_FWHM]  = e->x_taper_gaussian_fwhm_rad;
+    ed[ED_Y_GAUSSIAN_FWHM]  = e->y_taper_gaussian_fwhm_rad;
+    ed[ED_X_TAPER_REF_FREQ] = e->x_taper_ref_freq_hz;
+    ed[ED_Y_TAPER_REF_FREQ] = e->y_taper_ref_freq_hz;
+    ed[ED_DIPOLE_LENGTH]    = e->dipole_length;
+    ed[ED_COSINE_POWER]     = e->cosine_power;
+    ed[ED_GAUSSIAN_FWHM]    = e->gaussian_fwhm_rad;
+    ed[ED_MAX_RADIUS]       = e->max_radius_rad;
+    oskar_binary_write(h, OSKAR_INT, group,
+            OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_INT, idx,
+            sizeof(ei), ei, status);
+    oskar_binary_write(h, OSKAR_DOUBLE, group,
+            OSKAR_TELESCOPE_TAG_ELEMENT_PARAMS_DOUBLE, idx,
+            sizeof(ed), ed, status);
+    oskar_binary_write(h, OSKAR_DOUBLE, group,
+            OSKAR_TELESCOPE_TAG_ELEMENT_FREQS, idx,
+            e->num_freq * sizeof(double), e->freqs_hz, status);
+
+    /* Write the file names and fitted surfaces for each frequency. */
+    for (i = 0; i < e->num_freq; ++i)
+    {
+        const oskar_Mem* names[] = {
+                e->filename_x[i], e->filename_y[i], e->filename_scalar[i] };
+        const oskar_Splines* splines[] = TELESCOPE_SNAPSHOT_SPLINES(e, i);
+        for (j = 0; j < 3; ++j)
+            oskar_binary_write_mem(h, names[j], group,
+                    OSKAR_TELESCOPE_TAG_ELEMENT_FILENAME,
+                    counters->filename++, 0, status);
+        for (j = 0; j < TELESCOPE_SNAPSHOT_NUM_SPLINES; ++j)
+            write_splines(h, splines[j], counters->spline++, status);
+    }
+}
+
+static void write_splines(oskar_Binary* h, const oskar_Splines* sp,
+        int index, int* status)
+{
+    int num_knots[2];
+    const unsigned char group = OSKAR_TAG_GROUP_TELESCOPE;
+    num_knots[0] = sp->num_knots_x_theta;
+    num_knots[1] = sp->num_knots_y_phi;
+    oskar_binary_write(h, OSKAR_INT, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_NUM_KNOTS, index,
+            sizeof(num_knots), num_knots, status);
+    oskar_binary_write_double(h, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_SMOOTHING, index,
+            sp->smoothing_factor, status);
+    oskar_binary_write_mem(h, sp->knots_x_theta, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_KNOTS_X, index, 0, status);
+    oskar_binary_write_mem(h, sp->knots_y_phi, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_KNOTS_Y, index, 0, status);
+    oskar_binary_write_mem(h, sp->coeff, group,
+            OSKAR_TELESCOPE_TAG_SPLINE_COEFF, index, 0, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -35,6 +35,7 @@
 
 #include <oskar_global.h>
 #include <telescope/station/oskar_station.h>
+#include <telescope/station/oskar_station_work.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -52,11 +53,14 @@ extern "C" {
  * - Systematic and random gain and phase variations.
  * - User-supplied apodisation weights.
  *
- * The \p weights and \p weights_error arrays are resized to hold the weights
- * if necessary.
+ * The \p weights array is resized to hold the weights if necessary.
+ *
+ * The random gain and phase errors depend only on the station and the
+ * time index, so they are generated once and cached in \p work for use
+ * with other frequencies and source chunks.
  *
  * @param[in,out] weights       Output array of beamforming weights.
- * @param[in,out] weights_error Work array, for calculating the weights error.
+ * @param[in,out] work          Station work buffers, to cache the errors.
  * @param[in] wavenumber        Wavenumber (2 pi / wavelength).
  * @param[in] station           Pointer to station model.
  * @param[in] x_beam            Beam direction cosine, horizontal x-component.
@@ -67,7 +71,7 @@ extern "C" {
  */
 OSKAR_EXPORT
 void oskar_evaluate_element_weights(oskar_Mem* weights,
-        oskar_Mem* weights_error, double wavenumber,
+        oskar_StationWork* work, double wavenumber,
         const oskar_Station* station, double x_beam, double y_beam,
         double z_beam, int time_index, int* status);
 
@@ -140,6 +140,25 @@ double oskar_station_gaussian_beam_reference_freq_hz(const oskar_Station* model)
 OSKAR_EXPORT
 int oskar_station_identical_children(const oskar_Station* model);
 
+/**
+ * @brief
+ * Returns the index of the child station design within the telescope model.
+ *
+ * @details
+ * Returns the index of the distinct child station (e.g. tile) design
+ * within the telescope model, as set by oskar_telescope_analyse().
+ *
+ * Child stations with the same index have identical beam responses for
+ * the same location, pointing, time and frequency, so their beams can be
+ * shared between stations. A value of -1 means the beam must not be shared.
+ *
+ * @param[in] model   Pointer to station model.
+ *
+ * @return The child station design index, or -1.
+ */
+OSKAR_EXPORT
+int oskar_station_child_type_id(const oskar_Station* model);
+
 OSKAR_EXPORT
 int oskar_station_num_elements(const oskar_Station* model);
 
@@ -327,6 +346,20 @@ const oskar_Mem* oskar_station_permitted_beam_el_rad_const(
 OSKAR_EXPORT
 void oskar_station_set_unique_ids(oskar_Station* model, int* counter);
 
+/**
+ * @brief
+ * Sets the index of the child station design within the telescope model.
+ *
+ * @details
+ * Sets the index of the distinct child station design within the
+ * telescope model. This is set by oskar_telescope_analyse().
+ *
+ * @param[in] model   Pointer to station model.
+ * @param[in] id      Child station design index, or -1 if not shareable.
+ */
+OSKAR_EXPORT
+void oskar_station_set_child_type_id(oskar_Station* model, int id);
+
 /**
  * @brief
  * Sets the station type (aperture array, Gaussian beam, etc).
@@ -100,6 +100,117 @@ OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status);
 
+/**
+ * @brief Returns the cached element errors for a station.
+ *
+ * @details
+ * Returns the array used to hold the complex element gain and phase errors
+ * for the station with the given unique ID.
+ *
+ * If the errors have already been generated for the same time index and
+ * random seed, \p cached is set to true and the array can be used
+ * directly. Otherwise, \p cached is set to false, and the caller must fill
+ * the array using oskar_evaluate_element_weights_errors().
+ *
+ * The errors are assumed not to change for a given station and time index,
+ * so the work buffer must not be shared between different telescope models.
+ *
+ * @param[in,out] work           Pointer to work buffer structure.
+ * @param[in]     output_weights Weights array, used as a template.
+ * @param[in]     station_id     Unique ID of the station.
+ * @param[in]     num_elements   Number of elements in the station.
+ * @param[in]     seed           Random seed for time-variable errors.
+ * @param[in]     time_index     Simulation time index.
+ * @param[out]    cached         True if the returned errors are valid.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_station_work_element_errors(oskar_StationWork* work,
+        const oskar_Mem* output_weights, int station_id, int num_elements,
+        unsigned int seed, int time_index, int* cached, int* status);
+
+/**
+ * @brief Enables the cache of child station beams.
+ *
+ * @details
+ * Enables the cache used to share the beams of identical child stations
+ * (e.g. tiles) between all stations, and discards any existing entries.
+ *
+ * The caller must ensure that the input direction arrays passed to the
+ * station beam functions are not modified until
+ * oskar_station_work_child_beam_cache_end() is called.
+ *
+ * If \p share_locations is false, cached beams are only shared between
+ * child stations at the same location. If true, station locations are
+ * ignored, so that sources will not shift with respect to each station's
+ * horizon (as for station beam duplication).
+ *
+ * @param[in,out] work            Pointer to work buffer structure.
+ * @param[in]     share_locations If true, ignore station locations.
+ */
+OSKAR_EXPORT
+void oskar_station_work_child_beam_cache_begin(oskar_StationWork* work,
+        int share_locations);
+
+/**
+ * @brief Disables the cache of child station beams.
+ *
+ * @details
+ * Disables the cache of child station beams and discards all entries.
+ *
+ * @param[in,out] work            Pointer to work buffer structure.
+ */
+OSKAR_EXPORT
+void oskar_station_work_child_beam_cache_end(oskar_StationWork* work);
+
+OSKAR_EXPORT
+size_t oskar_station_work_child_beam_cache_hits(const oskar_StationWork* work);
+
+OSKAR_EXPORT
+size_t oskar_station_work_child_beam_cache_misses(
+        const oskar_StationWork* work);
+
+/**
+ * @brief Returns a cached child station beam.
+ *
+ * @details
+ * Looks up the beam of a child station in the cache, and returns it if
+ * found. Otherwise, or if the cache is disabled or \p type_id is negative,
+ * NULL is returned.
+ *
+ * @param[in,out] work         Pointer to work buffer structure.
+ * @param[in]     output_beam  Output beam array, used as a template.
+ * @param[in]     type_id      Child station design index.
+ * @param[in]     lon_rad      Longitude of child station, in radians.
+ * @param[in]     lat_rad      Latitude of child station, in radians.
+ * @param[in]     x            Input direction array (used as an identifier).
+ * @param[in]     gast         Greenwich apparent sidereal time, in radians.
+ * @param[in]     frequency_hz Observing frequency, in Hz.
+ * @param[in]     time_index   Simulation time index.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_station_work_child_beam(oskar_StationWork* work,
+        const oskar_Mem* output_beam, int type_id, double lon_rad,
+        double lat_rad, const oskar_Mem* x, double gast, double frequency_hz,
+        int time_index, int* status);
+
+/**
+ * @brief Stores a child station beam in the cache.
+ *
+ * @details
+ * Stores a copy of the beam of a child station in the cache, replacing
+ * the oldest entry if necessary. Parameters are as for
+ * oskar_station_work_child_beam().
+ *
+ * Nothing is stored if the cache is disabled or \p type_id is negative.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_child_beam(oskar_StationWork* work,
+        const oskar_Mem* beam, int type_id, double lon_rad, double lat_rad,
+        const oskar_Mem* x, double gast, double frequency_hz, int time_index,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -67,6 +67,7 @@ struct oskar_Station
 
     /* Data used only for aperture array stations ---------------------------*/
     int identical_children;       /* True if all child stations are identical. */
+    int child_type_id;            /* Index of distinct child station design within telescope (-1 if not shareable). */
     int num_elements;             /* Number of antenna elements in the station (auto determined). */
     int num_element_types;        /* Number of element types (this is the size of element_pattern array). */
     int normalise_array_pattern;  /* True if the station beam should be normalised by the number of antennas. */
@@ -31,6 +31,18 @@
 
 #include <mem/oskar_mem.h>
 
+/* Beam of a child station, cached for use by other stations. */
+struct oskar_StationBeamCacheItem
+{
+    int type_id;                 /* Child station design index. */
+    int time_index;
+    int num_points;
+    const void* x;               /* Identifies the input directions. */
+    double lon_rad, lat_rad, gast, frequency_hz;
+    oskar_Mem* beam;
+};
+typedef struct oskar_StationBeamCacheItem oskar_StationBeamCacheItem;
+
 struct oskar_StationWork
 {
     oskar_Mem* horizon_mask;     /* Integer. */
@@ -43,12 +55,25 @@ struct oskar_StationWork
     oskar_Mem* theta_modified;   /* Real scalar. */
     oskar_Mem* phi_modified;     /* Real scalar. */
     oskar_Mem* weights;          /* Complex scalar. */
-    oskar_Mem* weights_error;    /* Complex scalar. */
     oskar_Mem* array_pattern;    /* Complex scalar. */
     oskar_Mem* normalised_beam;  /* For beam normalisation. */
 
     int num_depths;
     oskar_Mem** beam;            /* For hierarchical stations. */
+
+    /* Element errors, cached per station unique ID. */
+    int num_element_errors;
+    int* element_errors_time_index;
+    unsigned int* element_errors_seed;
+    oskar_Mem** element_errors;  /* Complex scalar. */
+
+    /* Cache of child station beams, shared between stations. */
+    int cache_enabled;           /* True if cache is in use. */
+    int cache_share_locations;   /* True to ignore station locations. */
+    int cache_size;              /* Number of valid cache items. */
+    int cache_next;              /* Index of next item to replace. */
+    size_t cache_hits, cache_misses;
+    oskar_StationBeamCacheItem* cache;
 };
 
 #ifndef OSKAR_STATION_WORK_TYPEDEF_
@@ -35,7 +35,7 @@ extern "C" {
 #endif
 
 void oskar_evaluate_element_weights(oskar_Mem* weights,
-        oskar_Mem* weights_error, double wavenumber,
+        oskar_StationWork* work, double wavenumber,
         const oskar_Station* station, double x_beam, double y_beam,
         double z_beam, int time_index, int* status)
 {
@@ -44,12 +44,10 @@ void oskar_evaluate_element_weights(oskar_Mem* weights,
     /* Check if safe to proceed. */
     if (*status) return;
 
-    /* Resize weights and weights error work arrays if required. */
+    /* Resize weights array if required. */
     num_elements = oskar_station_num_elements(station);
     if ((int)oskar_mem_length(weights) < num_elements)
         oskar_mem_realloc(weights, num_elements, status);
-    if ((int)oskar_mem_length(weights_error) < num_elements)
-        oskar_mem_realloc(weights_error, num_elements, status);
 
     /* Generate DFT weights. */
     oskar_evaluate_element_weights_dft(num_elements,
@@ -61,14 +59,23 @@ void oskar_evaluate_element_weights(oskar_Mem* weights,
     /* Apply time-variable errors. */
     if (oskar_station_apply_element_errors(station))
     {
-        /* Generate weights errors. */
-        oskar_evaluate_element_weights_errors(num_elements,
-                oskar_station_element_gain_const(station),
-                oskar_station_element_gain_error_const(station),
-                oskar_station_element_phase_offset_rad_const(station),
-                oskar_station_element_phase_error_rad_const(station),
-                oskar_station_seed_time_variable_errors(station), time_index,
-                oskar_station_unique_id(station), weights_error, status);
+        int cached = 0;
+        oskar_Mem* weights_error;
+        unsigned int seed;
+
+        /* Generate weights errors, unless already done for this time. */
+        seed = oskar_station_seed_time_variable_errors(station);
+        weights_error = oskar_station_work_element_errors(work, weights,
+                oskar_station_unique_id(station), num_elements, seed,
+                time_index, &cached, status);
+        if (!cached)
+            oskar_evaluate_element_weights_errors(num_elements,
+                    oskar_station_element_gain_const(station),
+                    oskar_station_element_gain_error_const(station),
+                    oskar_station_element_phase_offset_rad_const(station),
+                    oskar_station_element_phase_error_rad_const(station),
+                    seed, time_index, oskar_station_unique_id(station),
+                    weights_error, status);
 
         /* Modify the weights (complex multiply with error vector). */
         oskar_mem_multiply(0, weights, weights_error, num_elements, status);
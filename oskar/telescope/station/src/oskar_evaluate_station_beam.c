@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -177,11 +177,9 @@ void oskar_evaluate_station_beam(oskar_Mem* beam_pattern, int num_points,
             amp = sqrt(val.x * val.x + val.y * val.y);
         }
 
-        /* Scale beam array by normalisation value. */
-        oskar_mem_scale_real(out, 1.0/amp, status);
-
-        /* Copy output beam data. */
-        oskar_mem_copy_contents(beam_pattern, out, 0, 0, num_points-1, status);
+        /* Scale by normalisation value while copying output beam data. */
+        oskar_mem_multiply_scale(beam_pattern, out, 0, 1.0/amp,
+                num_points-1, status);
     }
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2017, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -50,6 +50,12 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
         double frequency_hz, oskar_StationWork* work, int time_index,
         int depth, int* status);
 
+/* Evaluates the beam of a child station, using the cache if possible. */
+static void evaluate_child_beam(oskar_Mem* beam, const oskar_Station* child,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double gast, double frequency_hz,
+        oskar_StationWork* work, int time_index, int depth, int* status);
+
 
 void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
         const oskar_Station* station, int num_points, const oskar_Mem* x,
@@ -114,13 +120,12 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
         int depth, int* status)
 {
     double beam_x, beam_y, beam_z, wavenumber;
-    oskar_Mem *weights, *weights_error, *theta, *phi, *array;
+    oskar_Mem *weights, *theta, *phi, *array;
     int num_elements, is_3d;
 
     num_elements  = oskar_station_num_elements(s);
     is_3d         = oskar_station_array_is_3d(s);
     weights       = work->weights;
-    weights_error = work->weights_error;
     theta         = work->theta_modified;
     phi           = work->phi_modified;
     array         = work->array_pattern;
@@ -155,7 +160,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             if (oskar_station_enable_array_pattern(s))
             {
                 /* Generate beamforming weights and evaluate array pattern. */
-                oskar_evaluate_element_weights(weights, weights_error,
+                oskar_evaluate_element_weights(weights, work,
                         wavenumber, s, beam_x, beam_y, beam_z,
                         time_index, status);
                 oskar_dftw(num_elements, wavenumber,
@@ -165,12 +170,12 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                         weights, num_points, x, y, (is_3d ? z : 0), 0, array,
                         status);
 
-                /* Normalise array response if required. */
-                if (oskar_station_normalise_array_pattern(s))
-                    oskar_mem_scale_real(array, 1.0 / num_elements, status);
-
-                /* Element-wise multiply to join array and element pattern. */
-                oskar_mem_multiply(beam, beam, array, num_points, status);
+                /* Element-wise multiply to join array and element pattern,
+                 * normalising the array response if required. */
+                oskar_mem_multiply_scale(beam, beam, array,
+                        oskar_station_normalise_array_pattern(s) ?
+                                1.0 / num_elements : 1.0,
+                        num_points, status);
             }
         }
 
@@ -237,10 +242,16 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             }
 
             /* Generate beamforming weights. */
-            oskar_evaluate_element_weights(weights, weights_error,
+            oskar_evaluate_element_weights(weights, work,
                     wavenumber, s, beam_x, beam_y, beam_z,
                     time_index, status);
 
+            /* Normalise array response if required.
+             * (Scale the weights, as there are fewer of them.) */
+            if (oskar_station_normalise_array_pattern(s))
+                oskar_mem_multiply_scale(weights, weights, 0,
+                        1.0 / num_elements, num_elements, status);
+
             /* Use DFT to evaluate array response. */
             oskar_dftw(num_elements, wavenumber,
                     oskar_station_element_true_x_enu_metres_const(s),
@@ -251,10 +262,6 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
 
             /* Free element alias. */
             oskar_mem_free(element, status);
-
-            /* Normalise array response if required. */
-            if (oskar_station_normalise_array_pattern(s))
-                oskar_mem_scale_real(beam, 1.0 / num_elements, status);
         }
 
         /* Blank (set to zero) points below the horizon. */
@@ -286,7 +293,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             output0 = oskar_mem_create_alias(signal, 0, num_points, status);
 
             /* Recursive call. */
-            oskar_evaluate_station_beam_aperture_array_private(output0,
+            evaluate_child_beam(output0,
                     oskar_station_child_const(s, 0), num_points,
                     x, y, z, gast, frequency_hz, work, time_index,
                     depth + 1, status);
@@ -310,7 +317,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                         num_points, status);
 
                 /* Recursive call. */
-                oskar_evaluate_station_beam_aperture_array_private(output,
+                evaluate_child_beam(output,
                         oskar_station_child_const(s, i), num_points,
                         x, y, z, gast, frequency_hz, work, time_index,
                         depth + 1, status);
@@ -318,20 +325,49 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             }
         }
 
-        /* Generate beamforming weights and form beam from child stations. */
-        oskar_evaluate_element_weights(weights, weights_error, wavenumber,
+        /* Generate beamforming weights and form beam from child stations.
+         * Normalise array response if required, by scaling the weights. */
+        oskar_evaluate_element_weights(weights, work, wavenumber,
                 s, beam_x, beam_y, beam_z, time_index, status);
+        if (oskar_station_normalise_array_pattern(s))
+            oskar_mem_multiply_scale(weights, weights, 0,
+                    1.0 / num_elements, num_elements, status);
         oskar_dftw(num_elements, wavenumber,
                 oskar_station_element_true_x_enu_metres_const(s),
                 oskar_station_element_true_y_enu_metres_const(s),
                 oskar_station_element_true_z_enu_metres_const(s),
                 weights, num_points, x, y, (is_3d ? z : 0), signal, beam,
                 status);
+    }
+}
 
-        /* Normalise array response if required. */
-        if (oskar_station_normalise_array_pattern(s))
-            oskar_mem_scale_real(beam, 1.0 / num_elements, status);
+static void evaluate_child_beam(oskar_Mem* beam, const oskar_Station* child,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double gast, double frequency_hz,
+        oskar_StationWork* work, int time_index, int depth, int* status)
+{
+    int type_id;
+    double lon, lat;
+    const oskar_Mem* cached;
+
+    /* Check if the beam for an identical child station is available. */
+    type_id = oskar_station_child_type_id(child);
+    lon = oskar_station_lon_rad(child);
+    lat = oskar_station_lat_rad(child);
+    cached = oskar_station_work_child_beam(work, beam, type_id, lon, lat,
+            x, gast, frequency_hz, time_index, status);
+    if (cached)
+    {
+        oskar_mem_copy_contents(beam, cached, 0, 0, num_points, status);
+        return;
     }
+
+    /* Evaluate the beam, and store it for other stations. */
+    oskar_evaluate_station_beam_aperture_array_private(beam, child,
+            num_points, x, y, z, gast, frequency_hz, work, time_index,
+            depth, status);
+    oskar_station_work_set_child_beam(work, beam, type_id, lon, lat,
+            x, gast, frequency_hz, time_index, status);
 }
 
 #ifdef __cplusplus
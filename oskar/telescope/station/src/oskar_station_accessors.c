@@ -140,6 +140,11 @@ int oskar_station_identical_children(const oskar_Station* model)
     return model->identical_children;
 }
 
+int oskar_station_child_type_id(const oskar_Station* model)
+{
+    return model->child_type_id;
+}
+
 int oskar_station_num_elements(const oskar_Station* model)
 {
     return model->num_elements;
@@ -430,6 +435,11 @@ void oskar_station_set_unique_ids(oskar_Station* model, int* counter)
     }
 }
 
+void oskar_station_set_child_type_id(oskar_Station* model, int id)
+{
+    model->child_type_id = id;
+}
+
 void oskar_station_set_station_type(oskar_Station* model, int type)
 {
     model->station_type = type;
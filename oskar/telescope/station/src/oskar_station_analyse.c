@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -168,15 +168,22 @@ void oskar_station_analyse(oskar_Station* station,
         }
         else
         {
-            /* Check if child stations are identical. */
+            /* Check if child stations are identical.
+             * Only compare children with the same hash as the first. */
+            unsigned long long hash0;
+            hash0 = oskar_station_hash(oskar_station_child_const(station, 0),
+                    status);
             station->identical_children = 1;
             for (i = 1; i < station->num_elements; ++i)
             {
-                if (oskar_station_different(
+                if (hash0 != oskar_station_hash(
+                        oskar_station_child_const(station, i), status) ||
+                        oskar_station_different(
                         oskar_station_child_const(station, 0),
                         oskar_station_child_const(station, i), status))
                 {
                     station->identical_children = 0;
+                    break;
                 }
             }
         }
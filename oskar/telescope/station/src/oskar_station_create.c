@@ -57,6 +57,7 @@ oskar_Station* oskar_station_create(int type, int location, int num_elements,
 
     /* Initialise station meta data. */
     model->unique_id = 0;
+    model->child_type_id = -1;
     model->precision = type;
     model->mem_location = location;
 
@@ -73,6 +73,7 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
 
     /* Copy aperture array data, except num_element_types (done later). */
     model->identical_children = src->identical_children;
+    model->child_type_id = src->child_type_id;
     model->num_elements = src->num_elements;
     model->normalise_array_pattern = src->normalise_array_pattern;
     model->enable_array_pattern = src->enable_array_pattern;
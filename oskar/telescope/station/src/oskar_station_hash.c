@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/private_station.h"
+#include "telescope/station/oskar_station.h"
+
+#include "mem/oskar_mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 64-bit FNV-1a hash. */
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static unsigned long long hash_bytes(unsigned long long h,
+        const void* data, size_t size)
+{
+    size_t i;
+    const unsigned char* p = (const unsigned char*) data;
+    for (i = 0; i < size; ++i)
+    {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+#define HASH(H, X) hash_bytes(H, &(X), sizeof(X))
+
+/* Hashes the first num elements of the array, or all of it if num is 0. */
+static unsigned long long hash_mem(unsigned long long h, const oskar_Mem* mem,
+        size_t num, int* status)
+{
+    size_t length;
+    oskar_Mem* temp = 0;
+    if (*status || !mem) return h;
+    length = oskar_mem_length(mem);
+    if (num == 0 || num > length) num = length;
+    h = HASH(h, num);
+    if (num == 0) return h;
+    if (oskar_mem_location(mem) != OSKAR_CPU)
+    {
+        temp = oskar_mem_create_copy(mem, OSKAR_CPU, status);
+        if (*status) return h;
+        mem = temp;
+    }
+    h = hash_bytes(h, oskar_mem_void_const(mem),
+            num * oskar_mem_element_size(oskar_mem_type(mem)));
+    oskar_mem_free(temp, status);
+    return h;
+}
+
+unsigned long long oskar_station_hash(const oskar_Station* model, int* status)
+{
+    int i, j, num_element_types;
+    unsigned long long h = FNV_OFFSET;
+    size_t n;
+    const int has_child = oskar_station_has_child(model);
+    const int has_element = oskar_station_has_element(model);
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Hash the meta-data, as checked by oskar_station_different(). */
+    n = (size_t) model->num_elements;
+    h = HASH(h, model->station_type);
+    h = HASH(h, model->normalise_final_beam);
+    h = HASH(h, model->beam_coord_type);
+    h = HASH(h, model->beam_lon_rad);
+    h = HASH(h, model->beam_lat_rad);
+    h = HASH(h, model->pm_x_rad);
+    h = HASH(h, model->pm_y_rad);
+    h = HASH(h, model->identical_children);
+    h = HASH(h, model->num_elements);
+    h = HASH(h, model->num_element_types);
+    h = HASH(h, model->normalise_array_pattern);
+    h = HASH(h, model->enable_array_pattern);
+    h = HASH(h, model->common_element_orientation);
+    h = HASH(h, model->array_is_3d);
+    h = HASH(h, model->apply_element_errors);
+    h = HASH(h, model->apply_element_weight);
+    h = HASH(h, model->gaussian_beam_fwhm_rad);
+    h = HASH(h, model->gaussian_beam_reference_freq_hz);
+    h = HASH(h, model->num_permitted_beams);
+    h = HASH(h, has_child);
+    h = HASH(h, has_element);
+
+    /* Hash the element pattern filenames, for each element type. */
+    num_element_types = has_element ? model->num_element_types : 0;
+    for (j = 0; j < num_element_types; ++j)
+    {
+        int num_freq;
+        const oskar_Element* e = oskar_station_element_const(model, j);
+        num_freq = oskar_element_num_freq(e);
+        h = HASH(h, num_freq);
+        for (i = 0; i < num_freq; ++i)
+        {
+            h = hash_mem(h, oskar_element_x_filename_const(e, i), 0, status);
+            h = hash_mem(h, oskar_element_y_filename_const(e, i), 0, status);
+        }
+    }
+
+    /* Hash the arrays. */
+    h = hash_mem(h, model->noise_freq_hz, 0, status);
+    h = hash_mem(h, model->noise_rms_jy, 0, status);
+    h = hash_mem(h, model->element_measured_x_enu_metres, n, status);
+    h = hash_mem(h, model->element_measured_y_enu_metres, n, status);
+    h = hash_mem(h, model->element_measured_z_enu_metres, n, status);
+    h = hash_mem(h, model->element_true_x_enu_metres, n, status);
+    h = hash_mem(h, model->element_true_y_enu_metres, n, status);
+    h = hash_mem(h, model->element_true_z_enu_metres, n, status);
+    h = hash_mem(h, model->element_gain, n, status);
+    h = hash_mem(h, model->element_phase_offset_rad, n, status);
+    h = hash_mem(h, model->element_weight, n, status);
+    h = hash_mem(h, model->element_x_alpha_cpu, n, status);
+    h = hash_mem(h, model->element_x_beta_cpu, n, status);
+    h = hash_mem(h, model->element_x_gamma_cpu, n, status);
+    h = hash_mem(h, model->element_y_alpha_cpu, n, status);
+    h = hash_mem(h, model->element_y_beta_cpu, n, status);
+    h = hash_mem(h, model->element_y_gamma_cpu, n, status);
+    h = hash_mem(h, model->element_types_cpu, n, status);
+    h = hash_mem(h, model->element_mount_types_cpu, n, status);
+    h = hash_mem(h, model->permitted_beam_az_rad, n, status);
+    h = hash_mem(h, model->permitted_beam_el_rad, n, status);
+
+    /* Recursively hash child stations. */
+    if (has_child)
+    {
+        for (i = 0; i < model->num_elements; ++i)
+        {
+            unsigned long long c;
+            c = oskar_station_hash(oskar_station_child_const(model, i),
+                    status);
+            h = HASH(h, c);
+        }
+    }
+    return h;
+}
+
+#ifdef __cplusplus
+}
+#endif
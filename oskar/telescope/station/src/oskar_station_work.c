@@ -33,6 +33,9 @@
 extern "C" {
 #endif
 
+/* Maximum number of child station beams to keep. */
+#define MAX_CACHE_ITEMS 16
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status);
 
@@ -58,13 +61,23 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->enu_direction_z = oskar_mem_create(type, location, 0, status);
     work->weights = oskar_mem_create((type | OSKAR_COMPLEX),
             location, 0, status);
-    work->weights_error = oskar_mem_create((type | OSKAR_COMPLEX),
-            location, 0, status);
     work->array_pattern = oskar_mem_create((type | OSKAR_COMPLEX),
             location, 0, status);
     work->normalised_beam = 0;
     work->num_depths = 0;
     work->beam = 0;
+    work->num_element_errors = 0;
+    work->element_errors_time_index = 0;
+    work->element_errors_seed = 0;
+    work->element_errors = 0;
+    work->cache_enabled = 0;
+    work->cache_share_locations = 0;
+    work->cache_size = 0;
+    work->cache_next = 0;
+    work->cache_hits = 0;
+    work->cache_misses = 0;
+    work->cache = (oskar_StationBeamCacheItem*)
+            calloc(MAX_CACHE_ITEMS, sizeof(oskar_StationBeamCacheItem));
 
     return work;
 }
@@ -82,7 +95,6 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     oskar_mem_free(work->enu_direction_y, status);
     oskar_mem_free(work->enu_direction_z, status);
     oskar_mem_free(work->weights, status);
-    oskar_mem_free(work->weights_error, status);
     oskar_mem_free(work->array_pattern, status);
     oskar_mem_free(work->normalised_beam, status);
 
@@ -90,6 +102,18 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     {
         oskar_mem_free(work->beam[i], status);
     }
+    for (i = 0; i < work->num_element_errors; ++i)
+    {
+        oskar_mem_free(work->element_errors[i], status);
+    }
+    free(work->element_errors);
+    free(work->element_errors_time_index);
+    free(work->element_errors_seed);
+    for (i = 0; i < MAX_CACHE_ITEMS; ++i)
+    {
+        oskar_mem_free(work->cache[i].beam, status);
+    }
+    free(work->cache);
 
     /* Free the structure. */
     free(work);
@@ -147,6 +171,150 @@ oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
     return work->beam[depth];
 }
 
+oskar_Mem* oskar_station_work_element_errors(oskar_StationWork* work,
+        const oskar_Mem* output_weights, int station_id, int num_elements,
+        unsigned int seed, int time_index, int* cached, int* status)
+{
+    *cached = 0;
+    if (*status) return 0;
+    if (station_id < 0)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return 0;
+    }
+
+    /* Add slots for stations with higher IDs if required. */
+    if (station_id >= work->num_element_errors)
+    {
+        int i, old_num = work->num_element_errors;
+        work->num_element_errors = station_id + 1;
+        work->element_errors = (oskar_Mem**) realloc(work->element_errors,
+                work->num_element_errors * sizeof(oskar_Mem*));
+        work->element_errors_time_index = (int*) realloc(
+                work->element_errors_time_index,
+                work->num_element_errors * sizeof(int));
+        work->element_errors_seed = (unsigned int*) realloc(
+                work->element_errors_seed,
+                work->num_element_errors * sizeof(unsigned int));
+        for (i = old_num; i < work->num_element_errors; ++i)
+        {
+            work->element_errors[i] = 0;
+            work->element_errors_time_index[i] = -1;
+            work->element_errors_seed[i] = 0;
+        }
+    }
+
+    /* Check if the errors are already valid for this time. */
+    if (work->element_errors[station_id] &&
+            work->element_errors_time_index[station_id] == time_index &&
+            work->element_errors_seed[station_id] == seed &&
+            (int) oskar_mem_length(work->element_errors[station_id]) ==
+                    num_elements &&
+            oskar_mem_type(work->element_errors[station_id]) ==
+                    oskar_mem_type(output_weights) &&
+            oskar_mem_location(work->element_errors[station_id]) ==
+                    oskar_mem_location(output_weights))
+    {
+        *cached = 1;
+        return work->element_errors[station_id];
+    }
+
+    /* Return an array of the right size, to be filled by the caller. */
+    get_mem_from_template(&work->element_errors[station_id], output_weights,
+            num_elements, status);
+    if ((int) oskar_mem_length(work->element_errors[station_id]) !=
+            num_elements)
+        oskar_mem_realloc(work->element_errors[station_id], num_elements,
+                status);
+    work->element_errors_time_index[station_id] = *status ? -1 : time_index;
+    work->element_errors_seed[station_id] = seed;
+    return work->element_errors[station_id];
+}
+
+void oskar_station_work_child_beam_cache_begin(oskar_StationWork* work,
+        int share_locations)
+{
+    work->cache_enabled = 1;
+    work->cache_share_locations = share_locations;
+    work->cache_size = 0;
+    work->cache_next = 0;
+}
+
+void oskar_station_work_child_beam_cache_end(oskar_StationWork* work)
+{
+    work->cache_enabled = 0;
+    work->cache_size = 0;
+    work->cache_next = 0;
+}
+
+size_t oskar_station_work_child_beam_cache_hits(const oskar_StationWork* work)
+{
+    return work->cache_hits;
+}
+
+size_t oskar_station_work_child_beam_cache_misses(
+        const oskar_StationWork* work)
+{
+    return work->cache_misses;
+}
+
+oskar_Mem* oskar_station_work_child_beam(oskar_StationWork* work,
+        const oskar_Mem* output_beam, int type_id, double lon_rad,
+        double lat_rad, const oskar_Mem* x, double gast, double frequency_hz,
+        int time_index, int* status)
+{
+    int i, num_points;
+    const void* x_ptr;
+    if (*status || !work->cache_enabled || type_id < 0) return 0;
+
+    /* Look for a matching item. */
+    num_points = (int) oskar_mem_length(output_beam);
+    x_ptr = oskar_mem_void_const(x);
+    if (work->cache_share_locations) lon_rad = lat_rad = 0.0;
+    for (i = 0; i < work->cache_size; ++i)
+    {
+        const oskar_StationBeamCacheItem* item = &work->cache[i];
+        if (item->type_id == type_id && item->time_index == time_index &&
+                item->num_points == num_points && item->x == x_ptr &&
+                item->lon_rad == lon_rad && item->lat_rad == lat_rad &&
+                item->gast == gast && item->frequency_hz == frequency_hz &&
+                oskar_mem_type(item->beam) == oskar_mem_type(output_beam))
+        {
+            work->cache_hits++;
+            return item->beam;
+        }
+    }
+    work->cache_misses++;
+    return 0;
+}
+
+void oskar_station_work_set_child_beam(oskar_StationWork* work,
+        const oskar_Mem* beam, int type_id, double lon_rad, double lat_rad,
+        const oskar_Mem* x, double gast, double frequency_hz, int time_index,
+        int* status)
+{
+    int num_points;
+    oskar_StationBeamCacheItem* item;
+    if (*status || !work->cache_enabled || type_id < 0) return;
+
+    /* Replace the oldest item. */
+    num_points = (int) oskar_mem_length(beam);
+    if (work->cache_share_locations) lon_rad = lat_rad = 0.0;
+    item = &work->cache[work->cache_next];
+    work->cache_next = (work->cache_next + 1) % MAX_CACHE_ITEMS;
+    if (work->cache_size < MAX_CACHE_ITEMS) work->cache_size++;
+    get_mem_from_template(&item->beam, beam, num_points, status);
+    oskar_mem_copy_contents(item->beam, beam, 0, 0, num_points, status);
+    item->type_id = type_id;
+    item->time_index = time_index;
+    item->num_points = num_points;
+    item->x = oskar_mem_void_const(x);
+    item->lon_rad = lon_rad;
+    item->lat_rad = lat_rad;
+    item->gast = gast;
+    item->frequency_hz = frequency_hz;
+}
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status)
 {
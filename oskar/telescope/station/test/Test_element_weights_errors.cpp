@@ -28,7 +28,10 @@
 
 #include <gtest/gtest.h>
 
+#include "telescope/station/oskar_evaluate_element_weights.h"
 #include "telescope/station/oskar_evaluate_element_weights_errors.h"
+#include "telescope/station/oskar_station.h"
+#include "telescope/station/oskar_station_work.h"
 #include "utility/oskar_get_error_string.h"
 #include "mem/oskar_mem.h"
 
@@ -251,3 +254,71 @@ TEST(element_weights_errors, test_reinit)
     oskar_mem_free(d_phase_error, &status);
     oskar_mem_free(d_errors, &status);
 }
+
+
+TEST(element_weights_errors, test_cached)
+{
+    int num_elements = 100, status = 0, finished = 0;
+    double wavenumber = 2.0 * M_PI / 1.5;
+
+    // Create a station with time-variable element errors.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE, OSKAR_CPU,
+            0, &status);
+    oskar_station_resize(station, num_elements, &status);
+    for (int i = 0; i < num_elements; ++i)
+        oskar_station_set_element_errors(station, i, 1.0, 0.2, 0.0, 10.0,
+                &status);
+    oskar_station_set_seed_time_variable_errors(station, 7);
+    oskar_station_analyse(station, &finished, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(oskar_station_apply_element_errors(station));
+
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_Mem *w[4], *errors;
+    for (int i = 0; i < 4; ++i)
+        w[i] = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                num_elements, &status);
+    errors = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_elements, &status);
+
+    // Evaluate weights twice at time 0, then at time 1, then at time 0.
+    const int time_index[] = {0, 0, 1, 0};
+    for (int i = 0; i < 4; ++i)
+        oskar_evaluate_element_weights(w[i], work, wavenumber, station,
+                0.0, 0.0, 1.0, time_index[i], &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check against errors generated directly.
+    oskar_evaluate_element_weights_errors(num_elements,
+            oskar_station_element_gain_const(station),
+            oskar_station_element_gain_error_const(station),
+            oskar_station_element_phase_offset_rad_const(station),
+            oskar_station_element_phase_error_rad_const(station),
+            7, 0, oskar_station_unique_id(station), errors, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double2* e = oskar_mem_double2_const(errors, &status);
+    const double2* w0 = oskar_mem_double2_const(w[0], &status);
+    const double2* w1 = oskar_mem_double2_const(w[1], &status);
+    const double2* w2 = oskar_mem_double2_const(w[2], &status);
+    const double2* w3 = oskar_mem_double2_const(w[3], &status);
+    int num_different = 0;
+    for (int i = 0; i < num_elements; ++i)
+    {
+        // Weights are unity without errors, as the beam is at the zenith.
+        EXPECT_DOUBLE_EQ(e[i].x, w0[i].x);
+        EXPECT_DOUBLE_EQ(e[i].y, w0[i].y);
+        EXPECT_DOUBLE_EQ(w0[i].x, w1[i].x);
+        EXPECT_DOUBLE_EQ(w0[i].y, w1[i].y);
+        EXPECT_DOUBLE_EQ(w0[i].x, w3[i].x);
+        EXPECT_DOUBLE_EQ(w0[i].y, w3[i].y);
+        if (w0[i].x != w2[i].x || w0[i].y != w2[i].y) num_different++;
+    }
+    EXPECT_EQ(num_elements, num_different);
+
+    for (int i = 0; i < 4; ++i) oskar_mem_free(w[i], &status);
+    oskar_mem_free(errors, &status);
+    oskar_station_work_free(work, &status);
+    oskar_station_free(station, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -34,6 +34,7 @@
 #include "math/oskar_meshgrid.h"
 #include "math/oskar_evaluate_image_lmn_grid.h"
 #include "interferometer/oskar_evaluate_jones_E.h"
+#include "telescope/station/oskar_evaluate_station_beam.h"
 #include "utility/oskar_get_error_string.h"
 
 #include "math/oskar_cmath.h"
@@ -168,3 +169,103 @@ TEST(evaluate_jones_E, evaluate_e)
     ASSERT_EQ(0, error) << oskar_get_error_string(error);
 }
 
+
+static void set_tile(oskar_Station* tile, double spacing, int* status)
+{
+    oskar_station_resize(tile, 4, status);
+    oskar_station_resize_element_types(tile, 1, status);
+    oskar_element_set_element_type(oskar_station_element(tile, 0),
+            "Isotropic", status);
+    for (int i = 0; i < 4; ++i)
+    {
+        double xyz[] = {spacing * (i % 2 - 0.5), spacing * (i / 2 - 0.5), 0.};
+        oskar_station_set_element_coords(tile, i, xyz, xyz, status);
+    }
+}
+
+TEST(evaluate_jones_E, shared_child_station_beams)
+{
+    int status = 0, num_stations = 3, num_tiles = 4, type = OSKAR_DOUBLE;
+    double gast = 0.1, frequency = 100e6, lat = 60.0 * D2R;
+
+    // Construct telescope model with co-located stations, each containing
+    // two tile designs at different positions.
+    oskar_Telescope* tel = oskar_telescope_create(type,
+            OSKAR_CPU, num_stations, &status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, num_tiles, &status);
+        oskar_station_set_position(s, 0.0, lat, 0.0);
+        oskar_station_create_child_stations(s, &status);
+        for (int j = 0; j < num_tiles; ++j)
+        {
+            double xyz[] = {10.0 * (i + 1) * j, -4.0 * j, 0.0};
+            oskar_station_set_element_coords(s, j, xyz, xyz, &status);
+            set_tile(oskar_station_child(s, j), (j % 2) ? 1.5 : 1.0, &status);
+        }
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, lat);
+    oskar_telescope_analyse(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_FALSE(oskar_telescope_identical_stations(tel));
+    oskar_Station* s0 = oskar_telescope_station(tel, 0);
+    ASSERT_FALSE(oskar_station_identical_children(s0));
+    ASSERT_EQ(0, oskar_station_child_type_id(oskar_station_child(s0, 0)));
+    ASSERT_EQ(1, oskar_station_child_type_id(oskar_station_child(s0, 1)));
+    ASSERT_EQ(0, oskar_station_child_type_id(oskar_station_child(s0, 2)));
+
+    // Create pixel positions.
+    int num_l = 32, num_m = 32;
+    int num_pts = 1 + num_l * num_m;
+    oskar_Mem* l = oskar_mem_create(type, OSKAR_CPU, num_pts, &status);
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, num_pts, &status);
+    oskar_Mem* n = oskar_mem_create(type, OSKAR_CPU, num_pts, &status);
+    oskar_evaluate_image_lmn_grid(num_l, num_m, 60.0 * D2R, 60.0 * D2R,
+            1, l, m, n, &status);
+
+    // Evaluate Jones E using the shared child station beams.
+    oskar_Jones* E = oskar_jones_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, num_stations, num_pts - 1, &status);
+    oskar_StationWork* work = oskar_station_work_create(type,
+            OSKAR_CPU, &status);
+    oskar_evaluate_jones_E(E, num_pts - 1, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, gast, frequency, work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(2u, oskar_station_work_child_beam_cache_misses(work));
+    EXPECT_EQ(10u, oskar_station_work_child_beam_cache_hits(work));
+
+    // Check against station beams evaluated without the cache.
+    oskar_Mem* beam = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_pts - 1, &status);
+    oskar_Mem* E_station = oskar_mem_create_alias(0, 0, 0, &status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_StationWork* work_ref = oskar_station_work_create(type,
+                OSKAR_CPU, &status);
+        oskar_evaluate_station_beam(beam, num_pts - 1,
+                OSKAR_RELATIVE_DIRECTIONS, l, m, n,
+                oskar_telescope_phase_centre_ra_rad(tel),
+                oskar_telescope_phase_centre_dec_rad(tel),
+                oskar_telescope_station_const(tel, i), work_ref, 0,
+                frequency, gast, &status);
+        oskar_jones_get_station_pointer(E_station, E, i, &status);
+        EXPECT_EQ(0u, oskar_station_work_child_beam_cache_hits(work_ref));
+        oskar_station_work_free(work_ref, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_FALSE(oskar_mem_different(E_station, beam, 0, &status));
+    }
+
+    oskar_mem_free(E_station, &status);
+    oskar_mem_free(beam, &status);
+    oskar_jones_free(E, &status);
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_telescope_free(tel, &status);
+    oskar_station_work_free(work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
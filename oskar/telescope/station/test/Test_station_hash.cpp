@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/oskar_station.h"
+#include "utility/oskar_get_error_string.h"
+
+static oskar_Station* create_station(int num_tiles, int num_elements,
+        int* status)
+{
+    oskar_Station* s = oskar_station_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_tiles, status);
+    oskar_station_create_child_stations(s, status);
+    for (int i = 0; i < num_tiles; ++i)
+    {
+        double xyz[] = {10.0 * i, 20.0 * i, 0.0};
+        oskar_Station* tile = oskar_station_child(s, i);
+        oskar_station_set_element_coords(s, i, xyz, xyz, status);
+        oskar_station_resize(tile, num_elements, status);
+        for (int j = 0; j < num_elements; ++j)
+        {
+            xyz[0] = 1.0 * j;
+            xyz[1] = 2.0 * j;
+            oskar_station_set_element_coords(tile, j, xyz, xyz, status);
+        }
+    }
+    return s;
+}
+
+TEST(station_hash, same_and_different)
+{
+    int status = 0;
+    oskar_Station* a = create_station(4, 16, &status);
+    oskar_Station* b = create_station(4, 16, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Identical stations must have the same hash.
+    EXPECT_EQ(oskar_station_hash(a, &status), oskar_station_hash(b, &status));
+    EXPECT_FALSE(oskar_station_different(a, b, &status));
+
+    // Changing an element in a child station must change the hash.
+    double xyz[] = {0.5, 0.0, 0.0};
+    oskar_station_set_element_coords(oskar_station_child(b, 3), 15,
+            xyz, xyz, &status);
+    EXPECT_NE(oskar_station_hash(a, &status), oskar_station_hash(b, &status));
+    EXPECT_TRUE(oskar_station_different(a, b, &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    oskar_station_free(a, &status);
+    oskar_station_free(b, &status);
+}
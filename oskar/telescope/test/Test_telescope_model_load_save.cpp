@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2016, The University of Oxford
+ * Copyright (c) 2012-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -465,6 +465,106 @@ TEST(telescope_model_load_save, test_2_level)
     oskar_dir_remove(tm);
 }
 
+TEST(telescope_model_load_save, binary_cache)
+{
+    int err = 0;
+    const char* tm = "temp_test_telescope_cache";
+    const char* cache = "temp_test_telescope_cache.cache";
+    int num_stations = 3, num_tiles = 2, num_elements = 5;
+
+    // Create and save a two-level telescope model.
+    oskar_Telescope* telescope = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations, &err);
+    oskar_telescope_set_position(telescope, 0.1, 0.5, 1.0);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        double xyz[3] = {1.0 * i, 2.0 * i, 3.0 * i};
+        oskar_Station* st = oskar_telescope_station(telescope, i);
+        oskar_telescope_set_station_coords(telescope, i,
+                xyz, xyz, xyz, xyz, &err);
+        oskar_station_resize(st, num_tiles, &err);
+        oskar_station_create_child_stations(st, &err);
+        for (int j = 0; j < num_tiles; ++j)
+        {
+            oskar_Station* tile = oskar_station_child(st, j);
+            xyz[0] = 10.0 * i + j;
+            oskar_station_set_element_coords(st, j, xyz, xyz, &err);
+            oskar_station_resize(tile, num_elements, &err);
+            for (int k = 0; k < num_elements; ++k)
+            {
+                xyz[1] = 100.0 * i + 10.0 * j + k;
+                oskar_station_set_element_coords(tile, k, xyz, xyz, &err);
+            }
+        }
+    }
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    oskar_telescope_save(telescope, tm, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    remove(cache);
+
+    // Load it twice: the first load writes the cache, the second reads it.
+    oskar_Telescope* t[2];
+    for (int n = 0; n < 2; ++n)
+    {
+        t[n] = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &err);
+        oskar_telescope_set_position(t[n], 0.1, 0.5, 1.0);
+        oskar_telescope_load_cached(t[n], tm, NULL, &err);
+        ASSERT_EQ(0, err) << oskar_get_error_string(err);
+        FILE* f = fopen(cache, "rb");
+        ASSERT_TRUE(f != NULL);
+        fclose(f);
+    }
+
+    // Check both models are the same.
+    ASSERT_EQ(num_stations, oskar_telescope_num_stations(t[1]));
+    ASSERT_EQ(oskar_telescope_max_station_depth(t[0]),
+            oskar_telescope_max_station_depth(t[1]));
+    double max_ = 0.0, avg_ = 0.0;
+    oskar_mem_evaluate_relative_error(
+            oskar_telescope_station_true_x_enu_metres(t[0]),
+            oskar_telescope_station_true_x_enu_metres(t[1]),
+            0, &max_, &avg_, 0, &err);
+    EXPECT_EQ(0.0, max_);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        const oskar_Station *s0, *s1;
+        s0 = oskar_telescope_station_const(t[0], i);
+        s1 = oskar_telescope_station_const(t[1], i);
+        ASSERT_TRUE(oskar_station_has_child(s1));
+        ASSERT_EQ(oskar_station_num_elements(s0),
+                oskar_station_num_elements(s1));
+        for (int j = 0; j < num_tiles; ++j)
+        {
+            const oskar_Station *c0, *c1;
+            c0 = oskar_station_child_const(s0, j);
+            c1 = oskar_station_child_const(s1, j);
+            ASSERT_EQ(num_elements, oskar_station_num_elements(c1));
+            oskar_mem_evaluate_relative_error(
+                    oskar_station_element_measured_y_enu_metres_const(c0),
+                    oskar_station_element_measured_y_enu_metres_const(c1),
+                    0, &max_, &avg_, 0, &err);
+            EXPECT_EQ(0.0, max_);
+        }
+    }
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+
+    // Check the cache is not used for a different precision.
+    oskar_Telescope* t_single = oskar_telescope_create(OSKAR_SINGLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_load_cached(t_single, tm, NULL, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    EXPECT_EQ(OSKAR_SINGLE, oskar_telescope_precision(t_single));
+    EXPECT_EQ(num_stations, oskar_telescope_num_stations(t_single));
+
+    // Free models and remove test files.
+    oskar_telescope_free(telescope, &err);
+    oskar_telescope_free(t[0], &err);
+    oskar_telescope_free(t[1], &err);
+    oskar_telescope_free(t_single, &err);
+    oskar_dir_remove(tm);
+    remove(cache);
+}
+
 //
 // TODO: check combinations of telescope model loading and overrides...
 //
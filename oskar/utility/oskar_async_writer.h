@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_ASYNC_WRITER_H_
+#define OSKAR_ASYNC_WRITER_H_
+
+/**
+ * @file oskar_async_writer.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_AsyncWriter;
+#ifndef OSKAR_ASYNC_WRITER_TYPEDEF_
+#define OSKAR_ASYNC_WRITER_TYPEDEF_
+typedef struct oskar_AsyncWriter oskar_AsyncWriter;
+#endif /* OSKAR_ASYNC_WRITER_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates a set of background threads to write output files.
+ *
+ * @details
+ * Creates a set of background threads that write data to output files,
+ * so that the thread producing the data can continue while the writes
+ * are in progress.
+ *
+ * All writes to the same file are made by the same thread, in the order
+ * in which they were submitted. Writes to different files are shared
+ * between the threads, and so can be made concurrently.
+ * If the CFITSIO library was not built to be thread-safe, all writes to
+ * FITS files are made by the same thread.
+ *
+ * Data that are copied when a write is submitted are counted against
+ * \p max_queued_bytes: submitting a write waits until enough
+ * earlier writes have completed.
+ *
+ * @param[in] num_threads       Number of writer threads (at least 1).
+ * @param[in] max_queued_bytes  Maximum size of copied data waiting to be
+ *                              written, in bytes.
+ */
+OSKAR_EXPORT
+oskar_AsyncWriter* oskar_async_writer_create(int num_threads,
+        size_t max_queued_bytes);
+
+/**
+ * @brief
+ * Waits for all writes to finish, and destroys the writer.
+ *
+ * @details
+ * Waits for all writes to finish, stops the writer threads,
+ * and frees resources. Any error from a write is returned in \p status.
+ * The files themselves are not closed.
+ *
+ * @param[in,out] writer   Handle to writer, may be NULL.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_async_writer_free(oskar_AsyncWriter* writer, int* status);
+
+/**
+ * @brief
+ * Submits pixel data to write to a FITS image.
+ *
+ * @details
+ * Submits pixel data to be written to a FITS image using fits_write_pix().
+ *
+ * If \p copy is false, the data are not copied, so they must not be
+ * modified or freed until oskar_async_writer_wait() has returned.
+ *
+ * If an earlier write failed, this returns the error code in \p status.
+ *
+ * @param[in,out] writer       Handle to writer.
+ * @param[in] fits_file        Handle to FITS file (a fitsfile pointer).
+ * @param[in] datatype         CFITSIO data type (TFLOAT or TDOUBLE).
+ * @param[in] num_dims         Number of values in \p firstpix (up to 8).
+ * @param[in] firstpix         Coordinates of the first pixel (1-based).
+ * @param[in] num_pixels       Number of pixels to write.
+ * @param[in] data             Pointer to pixel data.
+ * @param[in] copy             If true, copy the data before returning.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_async_writer_fits_write_pix(oskar_AsyncWriter* writer,
+        void* fits_file, int datatype, int num_dims, const long* firstpix,
+        long num_pixels, const void* data, int copy, int* status);
+
+/**
+ * @brief
+ * Submits an array to write to a text file.
+ *
+ * @details
+ * Submits an array to be written to a text file using
+ * oskar_mem_save_ascii(). The data are always copied.
+ *
+ * @param[in,out] writer       Handle to writer.
+ * @param[in] file             Handle to text file.
+ * @param[in] mem              Array to write.
+ * @param[in] num_elements     Number of elements to write.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_async_writer_save_ascii(oskar_AsyncWriter* writer, FILE* file,
+        const oskar_Mem* mem, size_t num_elements, int* status);
+
+/**
+ * @brief
+ * Waits for all submitted writes to finish.
+ *
+ * @details
+ * Waits for all submitted writes to finish.
+ * Any error from a write is returned in \p status.
+ *
+ * @param[in,out] writer   Handle to writer, may be NULL.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_async_writer_wait(oskar_AsyncWriter* writer, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_ASYNC_WRITER_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_COMPRESS_H_
+#define OSKAR_COMPRESS_H_
+
+/**
+ * @file oskar_compress.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the maximum compressed size of a block of data.
+ *
+ * @details
+ * Returns the size of the output buffer needed by oskar_compress()
+ * to compress \p num_bytes of input data, in the worst case.
+ *
+ * @param[in] num_bytes  Size of the uncompressed data, in bytes.
+ */
+OSKAR_EXPORT
+size_t oskar_compress_bound(size_t num_bytes);
+
+/**
+ * @brief
+ * Compresses an array of floating-point values.
+ *
+ * @details
+ * Compresses an array of single- or double-precision floating-point values.
+ *
+ * The bits of each group of 8 values are first transposed so that bits of
+ * equal significance are stored together (bit-shuffle), and the resulting
+ * bytes are then run-length encoded. This is lossless.
+ *
+ * If \p mantissa_bits is greater than 0 and less than the number of mantissa
+ * bits in the data type (23 for single, or 52 for double precision), each
+ * value is first rounded so that only the given number of mantissa bits are
+ * kept. The relative error is then no more than 2^-(mantissa_bits + 1),
+ * and the discarded bits compress to almost nothing.
+ *
+ * The output buffer must be at least oskar_compress_bound() bytes long.
+ *
+ * @param[in] in             Input values.
+ * @param[in] num_elements   Number of input values.
+ * @param[in] element_size   Size of each value in bytes (4 or 8).
+ * @param[in] mantissa_bits  Number of mantissa bits to keep (0 for all).
+ * @param[out] out           Compressed data.
+ * @param[in,out] status     Status return code.
+ *
+ * @return The size of the compressed data, in bytes.
+ */
+OSKAR_EXPORT
+size_t oskar_compress(const void* in, size_t num_elements, int element_size,
+        int mantissa_bits, void* out, int* status);
+
+/**
+ * @brief
+ * Decompresses an array of floating-point values.
+ *
+ * @details
+ * Decompresses an array of values written by oskar_compress().
+ * The number of values and their size must be the same as those
+ * used to compress the data.
+ *
+ * @param[in] in             Compressed data.
+ * @param[in] in_bytes       Size of the compressed data, in bytes.
+ * @param[in] num_elements   Number of values to decompress.
+ * @param[in] element_size   Size of each value in bytes (4 or 8).
+ * @param[out] out           Decompressed values.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_decompress(const void* in, size_t in_bytes, size_t num_elements,
+        int element_size, void* out, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_COMPRESS_H_ */
@@ -71,6 +71,17 @@ int oskar_device_compute_capability(void);
 OSKAR_EXPORT
 int oskar_device_count(int* status);
 
+/**
+ * @brief
+ * Returns the current device ID of the calling thread.
+ *
+ * @details
+ * This simply calls cudaGetDevice() if CUDA is available.
+ * Returns -1 if CUDA is not available.
+ */
+OSKAR_EXPORT
+int oskar_device_get(void);
+
 /**
  * @brief
  * Returns the amount of free memory on the device.
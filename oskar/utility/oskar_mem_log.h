@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_LOG_H_
+#define OSKAR_MEM_LOG_H_
+
+/**
+ * @file oskar_mem_log.h
+ */
+
+#include <oskar_global.h>
+#include <log/oskar_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Log the memory held by each category of array.
+ *
+ * @details
+ * This function writes the current and peak memory held by arrays in
+ * each memory category to the log, for both host and device memory.
+ * Categories that have never held any memory are not shown.
+ *
+ * @param[in,out] log   Pointer to log structure to use.
+ * @param[in] depth     Depth of log message.
+ */
+OSKAR_EXPORT
+void oskar_mem_log(oskar_Log* log, int depth);
+
+/**
+ * @brief Log the total memory held by all arrays.
+ *
+ * @details
+ * This function writes a single line to the log giving the current and
+ * peak memory held by all arrays, for both host and device memory.
+ *
+ * @param[in,out] log   Pointer to log structure to use.
+ * @param[in] priority  Priority of log message.
+ * @param[in] depth     Depth of log message.
+ */
+OSKAR_EXPORT
+void oskar_mem_log_total(oskar_Log* log, char priority, int depth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_LOG_H_ */
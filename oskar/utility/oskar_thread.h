@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -40,11 +40,17 @@ extern "C" {
 #endif
 
 struct oskar_Mutex;
+struct oskar_ConditionVar;
 struct oskar_Thread;
 struct oskar_Barrier;
+struct oskar_ThreadPool;
+struct oskar_TaskGroup;
 typedef struct oskar_Mutex oskar_Mutex;
+typedef struct oskar_ConditionVar oskar_ConditionVar;
 typedef struct oskar_Thread oskar_Thread;
 typedef struct oskar_Barrier oskar_Barrier;
+typedef struct oskar_ThreadPool oskar_ThreadPool;
+typedef struct oskar_TaskGroup oskar_TaskGroup;
 
 /**
  * @brief Creates a mutex.
@@ -90,6 +96,75 @@ void oskar_mutex_lock(oskar_Mutex* mutex);
 OSKAR_EXPORT
 void oskar_mutex_unlock(oskar_Mutex* mutex);
 
+/**
+ * @brief Creates a condition variable.
+ *
+ * @details
+ * Creates a condition variable, together with the mutex that protects it.
+ */
+OSKAR_EXPORT
+oskar_ConditionVar* oskar_condition_create(void);
+
+/**
+ * @brief Destroys the condition variable.
+ *
+ * @details
+ * Destroys the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_free(oskar_ConditionVar* var);
+
+/**
+ * @brief Locks the mutex associated with the condition variable.
+ *
+ * @details
+ * Locks the mutex associated with the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_lock(oskar_ConditionVar* var);
+
+/**
+ * @brief Unlocks the mutex associated with the condition variable.
+ *
+ * @details
+ * Unlocks the mutex associated with the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_unlock(oskar_ConditionVar* var);
+
+/**
+ * @brief Wakes all threads waiting on the condition variable.
+ *
+ * @details
+ * Wakes all threads waiting on the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_notify_all(oskar_ConditionVar* var);
+
+/**
+ * @brief Waits on the condition variable.
+ *
+ * @details
+ * Atomically releases the associated mutex and blocks the caller until
+ * the condition variable is notified. The mutex must be locked by the
+ * caller, and it is locked again before this function returns.
+ *
+ * Spurious wake-ups are possible, so the caller must re-check its
+ * predicate in a loop.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_wait(oskar_ConditionVar* var);
+
 /**
  * @brief Creates and starts a thread.
  *
@@ -163,6 +238,154 @@ void oskar_barrier_set_num_threads(oskar_Barrier* barrier, int num_threads);
 OSKAR_EXPORT
 int oskar_barrier_wait(oskar_Barrier* barrier);
 
+/**
+ * @brief Registers a function to call when a pool worker thread exits.
+ *
+ * @details
+ * Registers a function to be called by each worker thread of every
+ * thread pool just before the thread exits. This allows other modules
+ * to release any thread-local resources they hold.
+ *
+ * Registering the same function more than once has no further effect.
+ * Up to 8 functions can be registered.
+ *
+ * @param[in] func Function to call.
+ *
+ * @return 1 if the function is registered, or 0 if there is no space.
+ */
+OSKAR_EXPORT
+int oskar_thread_add_exit_hook(void (*func)(void));
+
+/**
+ * @brief Creates a thread pool.
+ *
+ * @details
+ * Creates a pool of persistent worker threads, which run tasks submitted
+ * using oskar_thread_pool_submit() or oskar_thread_pool_parallel_for().
+ *
+ * Each worker thread has its own task queue. Idle workers take tasks
+ * from the queues of other workers (work stealing), so the affinity given
+ * when submitting a task is only a hint.
+ *
+ * @param[in] num_threads Number of worker threads
+ *                        (if <= 0, the number of processors).
+ */
+OSKAR_EXPORT
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads);
+
+/**
+ * @brief Destroys the thread pool.
+ *
+ * @details
+ * Runs any tasks still queued, then stops and joins all worker threads.
+ *
+ * @param[in,out] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_free(oskar_ThreadPool* pool);
+
+/**
+ * @brief Returns the number of worker threads in the pool.
+ *
+ * @details
+ * Returns the number of worker threads in the pool.
+ *
+ * @param[in] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool);
+
+/**
+ * @brief Returns true if the calling thread is a thread pool worker.
+ *
+ * @details
+ * Returns 1 if the calling thread is a worker thread of any thread pool,
+ * or 0 otherwise.
+ */
+OSKAR_EXPORT
+int oskar_thread_is_pool_worker(void);
+
+/**
+ * @brief Submits a task to the thread pool.
+ *
+ * @details
+ * Adds a task to the queue of the worker thread given by \p affinity,
+ * or to each queue in turn if \p affinity is negative.
+ *
+ * If \p group is not NULL, the task is added to the group, and
+ * oskar_task_group_wait() can be used to wait for it to finish.
+ *
+ * @param[in,out] pool  Pointer to thread pool.
+ * @param[in,out] group Task group, or NULL.
+ * @param[in] func      Task function.
+ * @param[in] arg       Argument passed to the task function.
+ * @param[in] affinity  Preferred worker thread index, or -1 for any.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_submit(oskar_ThreadPool* pool, oskar_TaskGroup* group,
+        void (*func)(void*), void* arg, int affinity);
+
+/**
+ * @brief Runs a loop in parallel using the thread pool.
+ *
+ * @details
+ * Splits the index range [\p start, \p end) into blocks of \p grain
+ * indices, and calls \p func for each block using the worker threads,
+ * with the first index and one past the last index of the block.
+ * Returns when all blocks have been processed.
+ *
+ * If \p grain is less than 1, it is chosen so that there are a few
+ * blocks for each worker thread.
+ *
+ * @param[in,out] pool Pointer to thread pool.
+ * @param[in] start    First index.
+ * @param[in] end      One past the last index.
+ * @param[in] grain    Number of indices in each block.
+ * @param[in] func     Function to call for each block.
+ * @param[in] arg      Argument passed to the function.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_parallel_for(oskar_ThreadPool* pool, int start, int end,
+        int grain, void (*func)(void*, int, int), void* arg);
+
+/**
+ * @brief Creates a task group.
+ *
+ * @details
+ * Creates a group of tasks to run using the given thread pool.
+ *
+ * @param[in] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+oskar_TaskGroup* oskar_task_group_create(oskar_ThreadPool* pool);
+
+/**
+ * @brief Destroys the task group.
+ *
+ * @details
+ * Waits for all tasks in the group to finish, then destroys the group.
+ *
+ * @param[in,out] group Pointer to task group.
+ */
+OSKAR_EXPORT
+void oskar_task_group_free(oskar_TaskGroup* group);
+
+/**
+ * @brief Waits for all tasks in the group to finish.
+ *
+ * @details
+ * Blocks the caller until all tasks submitted to the group have finished.
+ *
+ * If the caller is a worker thread of the same pool, it runs queued tasks
+ * itself while waiting, so it is safe to wait from inside a task.
+ * Any other thread just blocks, so tasks only ever run on worker threads,
+ * and cannot change the per-thread state of the caller.
+ *
+ * @param[in,out] group Pointer to task group.
+ */
+OSKAR_EXPORT
+void oskar_task_group_wait(oskar_TaskGroup* group);
+
 #ifdef __cplusplus
 }
 #endif
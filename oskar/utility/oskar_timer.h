@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013, The University of Oxford
+ * Copyright (c) 2013-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -128,6 +128,22 @@ void oskar_timer_resume(oskar_Timer* timer);
 OSKAR_EXPORT
 void oskar_timer_restart(oskar_Timer* timer);
 
+/**
+ * @brief Sets the name used to trace the timer.
+ *
+ * @details
+ * If set, a region with this name is recorded by the trace profiler
+ * (see oskar_trace.h) each time the timer is resumed and then paused.
+ * The timer must be resumed and paused by the same thread.
+ *
+ * Only the pointer is stored, so a string literal should be used.
+ *
+ * @param[in,out] timer Pointer to timer.
+ * @param[in] name Name of region, or NULL to disable tracing of the timer.
+ */
+OSKAR_EXPORT
+void oskar_timer_set_trace_name(oskar_Timer* timer, const char* name);
+
 /**
  * @brief Starts and resets the timer.
  *
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TRACE_H_
+#define OSKAR_TRACE_H_
+
+/**
+ * @file oskar_trace.h
+ *
+ * @brief Functions to record a trace of named regions of code.
+ *
+ * @details
+ * When tracing is enabled, the start time and duration of each region
+ * between oskar_trace_begin() and oskar_trace_end() are recorded in a
+ * ring buffer belonging to the calling thread, so threads do not contend
+ * with each other. When tracing is disabled, these functions return
+ * immediately.
+ *
+ * Timers that have been given a name using oskar_timer_set_trace_name()
+ * also record a region each time they are resumed and paused.
+ *
+ * The trace can be written as a JSON file in the Chrome trace event format,
+ * for viewing in chrome://tracing or https://ui.perfetto.dev,
+ * and summarised in the log.
+ */
+
+#include <oskar_global.h>
+#include <log/oskar_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Starts recording a trace.
+ *
+ * @details
+ * Clears any previous trace and enables tracing, if a trace file name is
+ * given either by \p filename, or if this is NULL or empty, by the
+ * environment variable OSKAR_TRACE_FILE.
+ *
+ * Nothing is done if tracing is already enabled.
+ *
+ * @param[in] filename  Path of trace file to write (may be NULL).
+ *
+ * @return 1 if tracing was started, or 0 if not.
+ */
+OSKAR_EXPORT
+int oskar_trace_start(const char* filename);
+
+/**
+ * @brief
+ * Stops recording a trace, and writes it out.
+ *
+ * @details
+ * Disables tracing, writes a summary of the trace to the log, and writes
+ * the trace file given to oskar_trace_start().
+ *
+ * This must only be called when no other threads are inside a region.
+ *
+ * @param[in,out] log     Pointer to log structure to use (may be NULL).
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_trace_stop(oskar_Log* log, int* status);
+
+/**
+ * @brief
+ * Enables or disables tracing.
+ *
+ * @param[in] value  If true, enable tracing; if false, disable it.
+ */
+OSKAR_EXPORT
+void oskar_trace_set_enabled(int value);
+
+/**
+ * @brief
+ * Returns true if tracing is enabled.
+ */
+OSKAR_EXPORT
+int oskar_trace_enabled(void);
+
+/**
+ * @brief
+ * Marks the start of a named region.
+ *
+ * @details
+ * Marks the start of a region in the calling thread.
+ * Regions may be nested, and each must be closed by oskar_trace_end().
+ *
+ * Only the pointer to the name is stored, so it must remain valid until
+ * the trace has been written: a string literal should be used.
+ *
+ * @param[in] name  Name of the region.
+ */
+OSKAR_EXPORT
+void oskar_trace_begin(const char* name);
+
+/**
+ * @brief
+ * Marks the end of the innermost open region in the calling thread.
+ */
+OSKAR_EXPORT
+void oskar_trace_end(void);
+
+/**
+ * @brief
+ * Sets the name of the calling thread, as shown in the trace file.
+ *
+ * @param[in] name  Name of the thread.
+ */
+OSKAR_EXPORT
+void oskar_trace_set_thread_name(const char* name);
+
+/**
+ * @brief
+ * Clears all recorded regions.
+ *
+ * @details
+ * This must only be called when no other threads are inside a region.
+ */
+OSKAR_EXPORT
+void oskar_trace_clear(void);
+
+/**
+ * @brief
+ * Returns the number of regions currently recorded.
+ */
+OSKAR_EXPORT
+int oskar_trace_num_events(void);
+
+/**
+ * @brief
+ * Returns the total duration of all recorded regions with the given name.
+ *
+ * @details
+ * Returns the sum of the durations of all recorded regions with the
+ * given name, in seconds, over all threads.
+ *
+ * @param[in] name    Name of region.
+ * @param[out] count  If not NULL, the number of regions found.
+ */
+OSKAR_EXPORT
+double oskar_trace_total(const char* name, int* count);
+
+/**
+ * @brief
+ * Writes the recorded regions to a trace file.
+ *
+ * @details
+ * Writes all recorded regions to a JSON file in the Chrome trace event
+ * format, with one track for each thread.
+ *
+ * @param[in] filename    Path of file to write.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_trace_write(const char* filename, int* status);
+
+/**
+ * @brief
+ * Writes a summary of the recorded regions to the log.
+ *
+ * @details
+ * For each region name, writes the number of times it was recorded,
+ * its total duration, and the minimum, median, 95th percentile and maximum
+ * of the individual durations, to show how much they vary.
+ *
+ * @param[in,out] log  Pointer to log structure to use.
+ */
+OSKAR_EXPORT
+void oskar_trace_log_summary(oskar_Log* log);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TRACE_H_ */
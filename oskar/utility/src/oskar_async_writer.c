@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_async_writer.h"
+#include "utility/oskar_thread.h"
+
+#include <fitsio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum JOB_TYPE
+{
+    JOB_FITS_WRITE_PIX,
+    JOB_SAVE_ASCII
+};
+
+#define MAX_DIMS 8
+
+typedef struct Job Job;
+struct Job
+{
+    Job* next;
+    int type;
+    int datatype;
+    int num_dims;
+    long firstpix[MAX_DIMS];
+    long num_pixels;
+    void* stream;
+    union {
+        const void* in;
+        void* fits; /* fits_write_pix() takes a non-const pointer. */
+    } data;
+    void* data_copy;
+    oskar_Mem* mem;
+    size_t num_elements;
+    size_t bytes;
+};
+
+typedef struct WriterThread WriterThread;
+struct WriterThread
+{
+    oskar_AsyncWriter* writer;
+    oskar_Thread* thread;
+    Job *head, *tail;
+};
+
+struct oskar_AsyncWriter
+{
+    oskar_ConditionVar* cv;
+    WriterThread* threads;
+    int num_threads, next_thread, fits_reentrant;
+    int num_streams, shutdown, num_pending, status;
+    void** streams;
+    int* stream_thread;
+    size_t max_queued_bytes, queued_bytes;
+};
+
+static void* writer_thread(void* arg);
+static void run_job(Job* job, int* status);
+static void free_job(Job* job);
+static void submit(oskar_AsyncWriter* w, Job* job, int* status);
+
+
+oskar_AsyncWriter* oskar_async_writer_create(int num_threads,
+        size_t max_queued_bytes)
+{
+    int i;
+    oskar_AsyncWriter* w;
+    if (num_threads < 1) num_threads = 1;
+    w = (oskar_AsyncWriter*) calloc(1, sizeof(oskar_AsyncWriter));
+    w->cv = oskar_condition_create();
+    w->num_threads = num_threads;
+    w->max_queued_bytes = max_queued_bytes;
+    w->fits_reentrant = fits_is_reentrant();
+    w->threads = (WriterThread*) calloc(num_threads, sizeof(WriterThread));
+    for (i = 0; i < num_threads; ++i)
+    {
+        w->threads[i].writer = w;
+        w->threads[i].thread = oskar_thread_create(writer_thread,
+                (void*)&w->threads[i], 0);
+    }
+    return w;
+}
+
+
+void oskar_async_writer_free(oskar_AsyncWriter* writer, int* status)
+{
+    int i;
+    if (!writer) return;
+    oskar_async_writer_wait(writer, status);
+    oskar_condition_lock(writer->cv);
+    writer->shutdown = 1;
+    oskar_condition_notify_all(writer->cv);
+    oskar_condition_unlock(writer->cv);
+    for (i = 0; i < writer->num_threads; ++i)
+    {
+        oskar_thread_join(writer->threads[i].thread);
+        oskar_thread_free(writer->threads[i].thread);
+    }
+    oskar_condition_free(writer->cv);
+    free(writer->threads);
+    free(writer->streams);
+    free(writer->stream_thread);
+    free(writer);
+}
+
+
+void oskar_async_writer_fits_write_pix(oskar_AsyncWriter* writer,
+        void* fits_file, int datatype, int num_dims, const long* firstpix,
+        long num_pixels, const void* data, int copy, int* status)
+{
+    int i;
+    Job* job;
+    if (*status) return;
+    if (num_dims < 1 || num_dims > MAX_DIMS ||
+            (datatype != TFLOAT && datatype != TDOUBLE))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    job = (Job*) calloc(1, sizeof(Job));
+    job->type = JOB_FITS_WRITE_PIX;
+    job->stream = fits_file;
+    job->datatype = datatype;
+    job->num_dims = num_dims;
+    for (i = 0; i < num_dims; ++i) job->firstpix[i] = firstpix[i];
+    job->num_pixels = num_pixels;
+    job->data.in = data;
+    if (copy)
+    {
+        job->bytes = num_pixels *
+                (datatype == TDOUBLE ? sizeof(double) : sizeof(float));
+        job->data_copy = malloc(job->bytes);
+        if (!job->data_copy)
+        {
+            free(job);
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        memcpy(job->data_copy, data, job->bytes);
+        job->data.in = job->data_copy;
+    }
+    submit(writer, job, status);
+}
+
+
+void oskar_async_writer_save_ascii(oskar_AsyncWriter* writer, FILE* file,
+        const oskar_Mem* mem, size_t num_elements, int* status)
+{
+    Job* job;
+    if (*status) return;
+    job = (Job*) calloc(1, sizeof(Job));
+    job->type = JOB_SAVE_ASCII;
+    job->stream = file;
+    job->num_elements = num_elements;
+    job->mem = oskar_mem_create(oskar_mem_type(mem), OSKAR_CPU,
+            num_elements, status);
+    oskar_mem_copy_contents(job->mem, mem, 0, 0, num_elements, status);
+    job->bytes = oskar_mem_length(job->mem) *
+            oskar_mem_element_size(oskar_mem_type(job->mem));
+    if (*status)
+    {
+        free_job(job);
+        return;
+    }
+    submit(writer, job, status);
+}
+
+
+void oskar_async_writer_wait(oskar_AsyncWriter* writer, int* status)
+{
+    if (!writer) return;
+    oskar_condition_lock(writer->cv);
+    while (writer->num_pending > 0)
+        oskar_condition_wait(writer->cv);
+    if (!*status) *status = writer->status;
+    oskar_condition_unlock(writer->cv);
+}
+
+
+static void submit(oskar_AsyncWriter* w, Job* job, int* status)
+{
+    int i, t = -1;
+    WriterThread* thread;
+    oskar_condition_lock(w->cv);
+
+    /* Wait for space in the queue. */
+    while (w->queued_bytes > 0 && !w->status &&
+            w->queued_bytes + job->bytes > w->max_queued_bytes)
+        oskar_condition_wait(w->cv);
+    if (w->status)
+    {
+        *status = w->status;
+        oskar_condition_unlock(w->cv);
+        free_job(job);
+        return;
+    }
+
+    /* Find the thread that writes to this file, or assign a new one.
+     * If CFITSIO is not thread-safe, all FITS files use the same thread. */
+    if (job->type == JOB_FITS_WRITE_PIX && !w->fits_reentrant)
+        t = 0;
+    else
+    {
+        for (i = 0; i < w->num_streams; ++i)
+        {
+            if (w->streams[i] == job->stream)
+            {
+                t = w->stream_thread[i];
+                break;
+            }
+        }
+        if (t < 0)
+        {
+            i = w->num_streams++;
+            w->streams = (void**) realloc(w->streams,
+                    w->num_streams * sizeof(void*));
+            w->stream_thread = (int*) realloc(w->stream_thread,
+                    w->num_streams * sizeof(int));
+            t = w->next_thread;
+            w->next_thread = (w->next_thread + 1) % w->num_threads;
+            w->streams[i] = job->stream;
+            w->stream_thread[i] = t;
+        }
+    }
+
+    /* Append the job to the thread's queue. */
+    thread = &w->threads[t];
+    if (thread->tail)
+        thread->tail->next = job;
+    else
+        thread->head = job;
+    thread->tail = job;
+    w->queued_bytes += job->bytes;
+    w->num_pending++;
+    oskar_condition_notify_all(w->cv);
+    oskar_condition_unlock(w->cv);
+}
+
+
+static void* writer_thread(void* arg)
+{
+    WriterThread* thread = (WriterThread*) arg;
+    oskar_AsyncWriter* w = thread->writer;
+    oskar_condition_lock(w->cv);
+    for (;;)
+    {
+        int status;
+        Job* job;
+        while (!thread->head && !w->shutdown)
+            oskar_condition_wait(w->cv);
+        if (!thread->head) break;
+        job = thread->head;
+        thread->head = job->next;
+        if (!thread->head) thread->tail = 0;
+
+        /* Skip the job if an earlier one failed. */
+        status = w->status;
+        oskar_condition_unlock(w->cv);
+        run_job(job, &status);
+        oskar_condition_lock(w->cv);
+        if (status && !w->status) w->status = status;
+        w->queued_bytes -= job->bytes;
+        w->num_pending--;
+        free_job(job);
+        oskar_condition_notify_all(w->cv);
+    }
+    oskar_condition_unlock(w->cv);
+    return 0;
+}
+
+
+static void run_job(Job* job, int* status)
+{
+    if (*status) return;
+    switch (job->type)
+    {
+    case JOB_FITS_WRITE_PIX:
+        fits_write_pix((fitsfile*) job->stream, job->datatype,
+                job->firstpix, job->num_pixels, job->data.fits, status);
+        break;
+    case JOB_SAVE_ASCII:
+        oskar_mem_save_ascii((FILE*) job->stream, 1, job->num_elements,
+                status, job->mem);
+        break;
+    default:
+        break;
+    }
+}
+
+
+static void free_job(Job* job)
+{
+    int status = 0;
+    oskar_mem_free(job->mem, &status);
+    free(job->data_copy);
+    free(job);
+}
+
+#ifdef __cplusplus
+}
+#endif
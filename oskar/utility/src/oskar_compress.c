@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_compress.h"
+#include "binary/oskar_binary.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Control bytes below this value start a literal of (c + 1) bytes;
+ * others start a run of (c - RUN_BIAS) copies of the next byte. */
+#define RUN_FLAG 128
+#define RUN_BIAS 125
+#define RUN_MIN 3
+#define RUN_MAX (255 - RUN_BIAS)
+#define LITERAL_MAX 128
+
+static unsigned long long transpose8(unsigned long long x);
+static void round_mantissa(unsigned char* data, size_t num_elements,
+        int element_size, int mantissa_bits);
+static void shuffle(const unsigned char* in, size_t num_elements,
+        int element_size, int mantissa_bits, unsigned char* out);
+static void unshuffle(const unsigned char* in, size_t num_elements,
+        int element_size, unsigned char* out);
+static size_t rle_encode(const unsigned char* in, size_t num_bytes,
+        unsigned char* out);
+static int rle_decode(const unsigned char* in, size_t in_bytes,
+        unsigned char* out, size_t out_bytes);
+
+
+size_t oskar_compress_bound(size_t num_bytes)
+{
+    return num_bytes + (num_bytes + LITERAL_MAX - 1) / LITERAL_MAX + 1;
+}
+
+
+size_t oskar_compress(const void* in, size_t num_elements, int element_size,
+        int mantissa_bits, void* out, int* status)
+{
+    unsigned char* shuffled;
+    size_t num_bytes, out_bytes;
+    if (*status) return 0;
+    if (element_size != 4 && element_size != 8)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+    num_bytes = num_elements * element_size;
+    if (num_bytes == 0) return 0;
+    shuffled = (unsigned char*) malloc(num_bytes);
+    if (!shuffled)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    shuffle((const unsigned char*) in, num_elements, element_size,
+            mantissa_bits, shuffled);
+    out_bytes = rle_encode(shuffled, num_bytes, (unsigned char*) out);
+    free(shuffled);
+    return out_bytes;
+}
+
+
+void oskar_decompress(const void* in, size_t in_bytes, size_t num_elements,
+        int element_size, void* out, int* status)
+{
+    unsigned char* shuffled;
+    size_t num_bytes;
+    if (*status) return;
+    if (element_size != 4 && element_size != 8)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    num_bytes = num_elements * element_size;
+    if (num_bytes == 0) return;
+    shuffled = (unsigned char*) malloc(num_bytes);
+    if (!shuffled)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    if (rle_decode((const unsigned char*) in, in_bytes, shuffled, num_bytes))
+        *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+    else
+        unshuffle(shuffled, num_elements, element_size, (unsigned char*) out);
+    free(shuffled);
+}
+
+
+/* Transposes an 8x8 bit matrix held in a 64-bit word
+ * (Hacker's Delight, section 7-3). The operation is its own inverse. */
+static unsigned long long transpose8(unsigned long long x)
+{
+    unsigned long long t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+
+/* Rounds IEEE 754 values to the nearest value with the given number
+ * of mantissa bits. Infinities and NaNs are left unchanged. */
+static void round_mantissa(unsigned char* data, size_t num_elements,
+        int element_size, int mantissa_bits)
+{
+    size_t i;
+    if (mantissa_bits <= 0) return;
+    if (element_size == 4)
+    {
+        const unsigned int exp_mask = 0x7F800000u;
+        unsigned int drop, mask, half, v, r;
+        if (mantissa_bits >= 23) return;
+        drop = 23 - mantissa_bits;
+        mask = (1u << drop) - 1u;
+        half = 1u << (drop - 1);
+        for (i = 0; i < num_elements; ++i)
+        {
+            memcpy(&v, data + 4 * i, 4);
+            if ((v & exp_mask) == exp_mask) continue;
+            r = (v + half) & ~mask;
+            if ((r & exp_mask) == exp_mask) r = v & ~mask;
+            memcpy(data + 4 * i, &r, 4);
+        }
+    }
+    else
+    {
+        const unsigned long long exp_mask = 0x7FF0000000000000ULL;
+        unsigned long long mask, half, v, r;
+        unsigned int drop;
+        if (mantissa_bits >= 52) return;
+        drop = 52 - mantissa_bits;
+        mask = (1ULL << drop) - 1ULL;
+        half = 1ULL << (drop - 1);
+        for (i = 0; i < num_elements; ++i)
+        {
+            memcpy(&v, data + 8 * i, 8);
+            if ((v & exp_mask) == exp_mask) continue;
+            r = (v + half) & ~mask;
+            if ((r & exp_mask) == exp_mask) r = v & ~mask;
+            memcpy(data + 8 * i, &r, 8);
+        }
+    }
+}
+
+
+/* Bit-shuffles groups of 8 elements so that each output "plane" holds one
+ * bit from the same position in each element. Planes are stored
+ * contiguously for the whole array, and any remaining elements that do not
+ * fill a group are appended unchanged. */
+static void shuffle(const unsigned char* in, size_t num_elements,
+        int element_size, int mantissa_bits, unsigned char* out)
+{
+    unsigned char group[64];
+    size_t g, num_groups, tail;
+    int j, k, lane;
+    num_groups = num_elements / 8;
+    for (g = 0; g < num_groups; ++g)
+    {
+        memcpy(group, in + g * 8 * element_size, 8 * element_size);
+        round_mantissa(group, 8, element_size, mantissa_bits);
+        for (lane = 0; lane < element_size; ++lane)
+        {
+            unsigned long long x = 0ULL;
+            for (j = 0; j < 8; ++j)
+                x |= ((unsigned long long) group[j * element_size + lane])
+                        << (8 * j);
+            x = transpose8(x);
+            for (k = 0; k < 8; ++k)
+                out[(8 * lane + k) * num_groups + g] =
+                        (unsigned char) (x >> (8 * k));
+        }
+    }
+    tail = num_groups * 8 * element_size;
+    memcpy(out + tail, in + tail, num_elements * element_size - tail);
+    round_mantissa(out + tail, num_elements - num_groups * 8,
+            element_size, mantissa_bits);
+}
+
+
+static void unshuffle(const unsigned char* in, size_t num_elements,
+        int element_size, unsigned char* out)
+{
+    size_t g, num_groups, tail;
+    int j, k, lane;
+    num_groups = num_elements / 8;
+    for (g = 0; g < num_groups; ++g)
+    {
+        unsigned char* group = out + g * 8 * element_size;
+        for (lane = 0; lane < element_size; ++lane)
+        {
+            unsigned long long x = 0ULL;
+            for (k = 0; k < 8; ++k)
+                x |= ((unsigned long long)
+                        in[(8 * lane + k) * num_groups + g]) << (8 * k);
+            x = transpose8(x);
+            for (j = 0; j < 8; ++j)
+                group[j * element_size + lane] =
+                        (unsigned char) (x >> (8 * j));
+        }
+    }
+    tail = num_groups * 8 * element_size;
+    memcpy(out + tail, in + tail, num_elements * element_size - tail);
+}
+
+
+static size_t rle_encode(const unsigned char* in, size_t num_bytes,
+        unsigned char* out)
+{
+    size_t i = 0, o = 0, lit_start = 0, lit_len = 0;
+    while (i < num_bytes)
+    {
+        /* Find the length of the run starting here. */
+        size_t run = 1;
+        while (i + run < num_bytes && run < RUN_MAX &&
+                in[i + run] == in[i])
+            ++run;
+        if (run >= RUN_MIN || lit_len == LITERAL_MAX)
+        {
+            /* Flush any pending literal. */
+            if (lit_len > 0)
+            {
+                out[o++] = (unsigned char) (lit_len - 1);
+                memcpy(out + o, in + lit_start, lit_len);
+                o += lit_len;
+                lit_len = 0;
+            }
+        }
+        if (run >= RUN_MIN)
+        {
+            out[o++] = (unsigned char) (run + RUN_BIAS);
+            out[o++] = in[i];
+            i += run;
+        }
+        else
+        {
+            if (lit_len == 0) lit_start = i;
+            ++lit_len;
+            ++i;
+        }
+    }
+    if (lit_len > 0)
+    {
+        out[o++] = (unsigned char) (lit_len - 1);
+        memcpy(out + o, in + lit_start, lit_len);
+        o += lit_len;
+    }
+    return o;
+}
+
+
+/* Returns non-zero if the input is malformed. */
+static int rle_decode(const unsigned char* in, size_t in_bytes,
+        unsigned char* out, size_t out_bytes)
+{
+    size_t i = 0, o = 0, n;
+    while (i < in_bytes)
+    {
+        const unsigned char c = in[i++];
+        if (c < RUN_FLAG)
+        {
+            n = (size_t) c + 1;
+            if (i + n > in_bytes || o + n > out_bytes) return 1;
+            memcpy(out + o, in + i, n);
+            i += n;
+        }
+        else
+        {
+            n = (size_t) c - RUN_BIAS;
+            if (i >= in_bytes || o + n > out_bytes) return 1;
+            memset(out + o, in[i++], n);
+        }
+        o += n;
+    }
+    return (o != out_bytes);
+}
+
+#ifdef __cplusplus
+}
+#endif
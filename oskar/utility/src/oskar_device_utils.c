@@ -74,6 +74,17 @@ int oskar_device_count(int *status)
 }
 
 
+int oskar_device_get(void)
+{
+    int device = -1;
+#ifdef OSKAR_HAVE_CUDA
+    if (cudaGetDevice(&device) != cudaSuccess)
+        device = -1;
+#endif
+    return device;
+}
+
+
 void oskar_device_mem_info(size_t* mem_free, size_t* mem_total)
 {
     if (!mem_free || !mem_total) return;
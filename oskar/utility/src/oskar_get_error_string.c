@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2017, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -111,6 +111,7 @@ const char* oskar_get_error_string(int error)
     case OSKAR_ERR_BINARY_TAG_TOO_LONG:    return "binary tag name too long";
     case OSKAR_ERR_BINARY_TAG_OUT_OF_RANGE:return "binary tag out of range";
     case OSKAR_ERR_BINARY_CRC_FAIL:        return "CRC code mismatch";
+    case OSKAR_ERR_BINARY_NOT_MAPPED:      return "binary file is not mapped";
 
     /* OSKAR settings errors. */
     case OSKAR_ERR_SETTINGS_NO_VALUE:
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_mem_log.h"
+#include "mem/oskar_mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MB (1024.0 * 1024.0)
+
+static void log_category(oskar_Log* log, int depth, int category)
+{
+    oskar_log_value(log, 'M', depth, oskar_mem_category_name(category),
+            "%.1f (%.1f) / %.1f (%.1f)",
+            oskar_mem_accounting_current(category, OSKAR_CPU) / MB,
+            oskar_mem_accounting_peak(category, OSKAR_CPU) / MB,
+            oskar_mem_accounting_current(category, OSKAR_GPU) / MB,
+            oskar_mem_accounting_peak(category, OSKAR_GPU) / MB);
+}
+
+
+void oskar_mem_log(oskar_Log* log, int depth)
+{
+    int i;
+    oskar_log_message(log, 'M', depth, "Memory held by arrays in MB, "
+            "as current (peak) on host / devices:");
+    for (i = 0; i < OSKAR_MEM_NUM_CATEGORIES; ++i)
+    {
+        if (oskar_mem_accounting_peak(i, OSKAR_CPU) == 0 &&
+                oskar_mem_accounting_peak(i, OSKAR_GPU) == 0)
+            continue;
+        log_category(log, depth + 1, i);
+    }
+    log_category(log, depth + 1, -1);
+}
+
+
+void oskar_mem_log_total(oskar_Log* log, char priority, int depth)
+{
+    oskar_log_message(log, priority, depth, "Memory held by arrays: "
+            "%.1f MB (peak %.1f MB) on host, %.1f MB (peak %.1f MB) on devices",
+            oskar_mem_accounting_current(-1, OSKAR_CPU) / MB,
+            oskar_mem_accounting_peak(-1, OSKAR_CPU) / MB,
+            oskar_mem_accounting_current(-1, OSKAR_GPU) / MB,
+            oskar_mem_accounting_peak(-1, OSKAR_GPU) / MB);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -82,14 +82,16 @@ size_t oskar_string_to_array_f(char* str, size_t n, float* data)
 size_t oskar_string_to_array_d(char* str, size_t n, double* data)
 {
     size_t i = 0;
-    char *save_ptr = 0, *token = 0;
+    char *save_ptr = 0, *token = 0, *end = 0;
+    double value;
     do
     {
         token = strtok_r(str, DELIMITERS, &save_ptr);
         str = NULL;
         if (!token) break;
         if (token[0] == '#') break;
-        if (sscanf(token, "%lf", &data[i]) > 0) i++;
+        value = strtod(token, &end);
+        if (end != token) data[i++] = value;
     }
     while (i < n);
     return i;
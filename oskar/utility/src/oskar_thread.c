@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,9 @@
  */
 
 #include "utility/oskar_thread.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_trace.h"
+#include <stdio.h>
 #include <stdlib.h>
 
 #ifdef OSKAR_OS_WIN
@@ -120,7 +123,6 @@ struct oskar_ConditionVar
     pthread_cond_t var;
 #endif
 };
-typedef struct oskar_ConditionVar oskar_ConditionVar;
 
 static void oskar_condition_init(oskar_ConditionVar* var)
 {
@@ -142,17 +144,32 @@ static void oskar_condition_uninit(oskar_ConditionVar* var)
 #endif
 }
 
-static void oskar_condition_lock(oskar_ConditionVar* var)
+oskar_ConditionVar* oskar_condition_create(void)
+{
+    oskar_ConditionVar* var;
+    var = (oskar_ConditionVar*) calloc(1, sizeof(oskar_ConditionVar));
+    oskar_condition_init(var);
+    return var;
+}
+
+void oskar_condition_free(oskar_ConditionVar* var)
+{
+    if (!var) return;
+    oskar_condition_uninit(var);
+    free(var);
+}
+
+void oskar_condition_lock(oskar_ConditionVar* var)
 {
     oskar_mutex_lock(&var->lock);
 }
 
-static void oskar_condition_unlock(oskar_ConditionVar* var)
+void oskar_condition_unlock(oskar_ConditionVar* var)
 {
     oskar_mutex_unlock(&var->lock);
 }
 
-static void oskar_condition_notify_all(oskar_ConditionVar* var)
+void oskar_condition_notify_all(oskar_ConditionVar* var)
 {
 #if defined(OSKAR_OS_WIN)
     WakeAllConditionVariable(&var->var);
@@ -161,7 +178,7 @@ static void oskar_condition_notify_all(oskar_ConditionVar* var)
 #endif
 }
 
-static void oskar_condition_wait(oskar_ConditionVar* var)
+void oskar_condition_wait(oskar_ConditionVar* var)
 {
 #if defined(OSKAR_OS_WIN)
     SleepConditionVariableCS(&var->var, &(var->lock.lock), INFINITE);
@@ -302,6 +319,369 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
     return 0;
 }
 
+
+/* =========================================================================
+ *  THREAD POOL
+ * =========================================================================*/
+
+struct Task
+{
+    void (*func)(void*);
+    void* arg;
+    oskar_TaskGroup* group;
+};
+typedef struct Task Task;
+
+/* Double-ended task queue, held in a ring buffer.
+ * The owning worker takes tasks from the back, and others from the front. */
+struct TaskQueue
+{
+    oskar_Mutex lock;
+    Task* tasks;
+    int capacity, head, count;
+};
+typedef struct TaskQueue TaskQueue;
+
+struct WorkerArgs
+{
+    oskar_ThreadPool* pool;
+    int index;
+};
+typedef struct WorkerArgs WorkerArgs;
+
+struct oskar_ThreadPool
+{
+    /* The condition variable protects the counters and all task groups. */
+    oskar_ConditionVar wake;
+    int num_threads, num_queued, next_queue, shutdown;
+    TaskQueue* queues;
+    WorkerArgs* args;
+    oskar_Thread** threads;
+};
+
+struct oskar_TaskGroup
+{
+    oskar_ThreadPool* pool;
+    int num_pending;
+};
+
+/* The pool and index of the calling thread, if it is a worker thread. */
+#ifdef OSKAR_OS_WIN
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+static THREAD_LOCAL oskar_ThreadPool* worker_pool_ = 0;
+static THREAD_LOCAL int worker_index_ = -1;
+
+/* Functions called by each worker thread before it exits.
+ * The lock is initialised statically, so hooks can be added at any time. */
+#define MAX_EXIT_HOOKS 8
+static void (*exit_hooks_[MAX_EXIT_HOOKS])(void);
+static int num_exit_hooks_ = 0;
+#ifdef OSKAR_OS_WIN
+static SRWLOCK exit_hooks_lock_ = SRWLOCK_INIT;
+#define EXIT_HOOKS_LOCK   AcquireSRWLockExclusive(&exit_hooks_lock_)
+#define EXIT_HOOKS_UNLOCK ReleaseSRWLockExclusive(&exit_hooks_lock_)
+#else
+static pthread_mutex_t exit_hooks_lock_ = PTHREAD_MUTEX_INITIALIZER;
+#define EXIT_HOOKS_LOCK   pthread_mutex_lock(&exit_hooks_lock_)
+#define EXIT_HOOKS_UNLOCK pthread_mutex_unlock(&exit_hooks_lock_)
+#endif
+
+int oskar_thread_add_exit_hook(void (*func)(void))
+{
+    int i, added = 0;
+    EXIT_HOOKS_LOCK;
+    for (i = 0; i < num_exit_hooks_; ++i)
+        if (exit_hooks_[i] == func) added = 1;
+    if (!added && num_exit_hooks_ < MAX_EXIT_HOOKS)
+    {
+        exit_hooks_[num_exit_hooks_++] = func;
+        added = 1;
+    }
+    EXIT_HOOKS_UNLOCK;
+    return added;
+}
+
+static void run_exit_hooks(void)
+{
+    int i, num_hooks;
+    void (*hooks[MAX_EXIT_HOOKS])(void);
+    EXIT_HOOKS_LOCK;
+    num_hooks = num_exit_hooks_;
+    for (i = 0; i < num_hooks; ++i) hooks[i] = exit_hooks_[i];
+    EXIT_HOOKS_UNLOCK;
+    for (i = 0; i < num_hooks; ++i) hooks[i]();
+}
+
+static int queue_pop(TaskQueue* q, int back, Task* task)
+{
+    int found = 0;
+    oskar_mutex_lock(&q->lock);
+    if (q->count > 0)
+    {
+        const int i = back ? (q->head + q->count - 1) % q->capacity : q->head;
+        *task = q->tasks[i];
+        if (!back) q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        found = 1;
+    }
+    oskar_mutex_unlock(&q->lock);
+    return found;
+}
+
+static void queue_push(TaskQueue* q, const Task* task)
+{
+    oskar_mutex_lock(&q->lock);
+    if (q->count == q->capacity)
+    {
+        int i;
+        const int old_capacity = q->capacity;
+        q->capacity = old_capacity ? 2 * old_capacity : 16;
+        q->tasks = (Task*) realloc(q->tasks, q->capacity * sizeof(Task));
+        /* Move the wrapped part of the ring to the new space. */
+        for (i = 0; i < q->head + q->count - old_capacity; ++i)
+            q->tasks[old_capacity + i] = q->tasks[i];
+    }
+    q->tasks[(q->head + q->count) % q->capacity] = *task;
+    q->count++;
+    oskar_mutex_unlock(&q->lock);
+}
+
+/* Takes a task from the given worker's own queue, or steals one from
+ * another queue. Use index -1 if the caller is not a worker thread. */
+static int get_task(oskar_ThreadPool* pool, int index, Task* task)
+{
+    int i, found = 0;
+    if (index >= 0) found = queue_pop(&pool->queues[index], 1, task);
+    for (i = 1; !found && i <= pool->num_threads; ++i)
+    {
+        const int victim = (index + i + pool->num_threads) % pool->num_threads;
+        if (victim != index) found = queue_pop(&pool->queues[victim], 0, task);
+    }
+    if (found)
+    {
+        oskar_condition_lock(&pool->wake);
+        pool->num_queued--;
+        oskar_condition_unlock(&pool->wake);
+    }
+    return found;
+}
+
+static void run_task(oskar_ThreadPool* pool, const Task* task)
+{
+    task->func(task->arg);
+    if (task->group)
+    {
+        oskar_condition_lock(&pool->wake);
+        if (--(task->group->num_pending) == 0)
+            oskar_condition_notify_all(&pool->wake);
+        oskar_condition_unlock(&pool->wake);
+    }
+}
+
+static void* worker(void* arg)
+{
+    Task task;
+    char name[32];
+    oskar_ThreadPool* pool = ((WorkerArgs*)arg)->pool;
+    const int index = ((WorkerArgs*)arg)->index;
+    worker_pool_ = pool;
+    worker_index_ = index;
+    sprintf(name, "Worker %d", index);
+    oskar_trace_set_thread_name(name);
+    for (;;)
+    {
+        if (get_task(pool, index, &task))
+        {
+            run_task(pool, &task);
+            continue;
+        }
+        oskar_condition_lock(&pool->wake);
+        while (pool->num_queued == 0 && !pool->shutdown)
+            oskar_condition_wait(&pool->wake);
+        if (pool->num_queued == 0 && pool->shutdown)
+        {
+            oskar_condition_unlock(&pool->wake);
+            break;
+        }
+        oskar_condition_unlock(&pool->wake);
+    }
+    run_exit_hooks();
+    return 0;
+}
+
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads)
+{
+    int i;
+    oskar_ThreadPool* pool;
+    if (num_threads <= 0) num_threads = oskar_get_num_procs();
+    if (num_threads <= 0) num_threads = 1;
+    pool = (oskar_ThreadPool*) calloc(1, sizeof(oskar_ThreadPool));
+    oskar_condition_init(&pool->wake);
+    pool->num_threads = num_threads;
+    pool->queues = (TaskQueue*) calloc(num_threads, sizeof(TaskQueue));
+    pool->args = (WorkerArgs*) calloc(num_threads, sizeof(WorkerArgs));
+    pool->threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    for (i = 0; i < num_threads; ++i)
+    {
+        oskar_mutex_init(&pool->queues[i].lock);
+        pool->args[i].pool = pool;
+        pool->args[i].index = i;
+    }
+    for (i = 0; i < num_threads; ++i)
+        pool->threads[i] = oskar_thread_create(worker, &pool->args[i], 0);
+    return pool;
+}
+
+void oskar_thread_pool_free(oskar_ThreadPool* pool)
+{
+    int i;
+    if (!pool) return;
+    oskar_condition_lock(&pool->wake);
+    pool->shutdown = 1;
+    oskar_condition_notify_all(&pool->wake);
+    oskar_condition_unlock(&pool->wake);
+    for (i = 0; i < pool->num_threads; ++i)
+    {
+        oskar_thread_join(pool->threads[i]);
+        oskar_thread_free(pool->threads[i]);
+        oskar_mutex_uninit(&pool->queues[i].lock);
+        free(pool->queues[i].tasks);
+    }
+    oskar_condition_uninit(&pool->wake);
+    free(pool->threads);
+    free(pool->args);
+    free(pool->queues);
+    free(pool);
+}
+
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool)
+{
+    return pool ? pool->num_threads : 0;
+}
+
+int oskar_thread_is_pool_worker(void)
+{
+    return worker_pool_ != 0;
+}
+
+void oskar_thread_pool_submit(oskar_ThreadPool* pool, oskar_TaskGroup* group,
+        void (*func)(void*), void* arg, int affinity)
+{
+    Task task;
+    task.func = func;
+    task.arg = arg;
+    task.group = group;
+    oskar_condition_lock(&pool->wake);
+    if (affinity < 0)
+    {
+        affinity = pool->next_queue;
+        pool->next_queue = (pool->next_queue + 1) % pool->num_threads;
+    }
+    if (group) group->num_pending++;
+    pool->num_queued++;
+    oskar_condition_unlock(&pool->wake);
+    queue_push(&pool->queues[affinity % pool->num_threads], &task);
+    oskar_condition_lock(&pool->wake);
+    oskar_condition_notify_all(&pool->wake);
+    oskar_condition_unlock(&pool->wake);
+}
+
+struct LoopBlock
+{
+    void (*func)(void*, int, int);
+    void* arg;
+    int start, end;
+};
+typedef struct LoopBlock LoopBlock;
+
+static void run_loop_block(void* arg)
+{
+    LoopBlock* b = (LoopBlock*) arg;
+    b->func(b->arg, b->start, b->end);
+}
+
+void oskar_thread_pool_parallel_for(oskar_ThreadPool* pool, int start, int end,
+        int grain, void (*func)(void*, int, int), void* arg)
+{
+    int i, num_blocks;
+    LoopBlock* blocks;
+    oskar_TaskGroup* group;
+    if (end <= start) return;
+    if (grain < 1)
+    {
+        grain = (end - start) / (4 * pool->num_threads);
+        if (grain < 1) grain = 1;
+    }
+    num_blocks = (end - start + grain - 1) / grain;
+    if (num_blocks == 1)
+    {
+        func(arg, start, end);
+        return;
+    }
+    blocks = (LoopBlock*) calloc(num_blocks, sizeof(LoopBlock));
+    group = oskar_task_group_create(pool);
+    for (i = 0; i < num_blocks; ++i)
+    {
+        blocks[i].func = func;
+        blocks[i].arg = arg;
+        blocks[i].start = start + i * grain;
+        blocks[i].end = blocks[i].start + grain;
+        if (blocks[i].end > end) blocks[i].end = end;
+        oskar_thread_pool_submit(pool, group, run_loop_block, &blocks[i],
+                i % pool->num_threads);
+    }
+    oskar_task_group_free(group);
+    free(blocks);
+}
+
+oskar_TaskGroup* oskar_task_group_create(oskar_ThreadPool* pool)
+{
+    oskar_TaskGroup* group;
+    group = (oskar_TaskGroup*) calloc(1, sizeof(oskar_TaskGroup));
+    group->pool = pool;
+    return group;
+}
+
+void oskar_task_group_free(oskar_TaskGroup* group)
+{
+    if (!group) return;
+    oskar_task_group_wait(group);
+    free(group);
+}
+
+void oskar_task_group_wait(oskar_TaskGroup* group)
+{
+    Task task;
+    oskar_ThreadPool* pool = group->pool;
+
+    /* Tasks can change per-thread state (such as the number of OpenMP
+     * threads or the current GPU), so only worker threads of the pool
+     * may run them. A worker helps to run queued tasks while it waits,
+     * but any other thread just blocks. */
+    const int index = (worker_pool_ == pool) ? worker_index_ : -1;
+    for (;;)
+    {
+        if (index >= 0 && get_task(pool, index, &task))
+        {
+            run_task(pool, &task);
+            continue;
+        }
+        oskar_condition_lock(&pool->wake);
+        while (group->num_pending > 0 &&
+                (index < 0 || pool->num_queued == 0))
+            oskar_condition_wait(&pool->wake);
+        if (group->num_pending == 0)
+        {
+            oskar_condition_unlock(&pool->wake);
+            break;
+        }
+        oskar_condition_unlock(&pool->wake);
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
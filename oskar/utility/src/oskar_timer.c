@@ -28,6 +28,7 @@
 
 #include "utility/oskar_timer.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_trace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
@@ -54,6 +55,7 @@ struct oskar_Timer
     double elapsed;
     double start;
     oskar_Mutex* mutex;
+    const char* trace_name;
 #ifdef OSKAR_HAVE_CUDA
     cudaEvent_t start_cuda;
     cudaEvent_t end_cuda;
@@ -188,15 +190,24 @@ void oskar_timer_pause(oskar_Timer* timer)
         return;
     (void)oskar_timer_elapsed(timer);
     timer->paused = 1;
+    if (timer->trace_name)
+        oskar_trace_end();
 }
 
 void oskar_timer_resume(oskar_Timer* timer)
 {
     if (!timer->paused)
         return;
+    if (timer->trace_name)
+        oskar_trace_begin(timer->trace_name);
     oskar_timer_restart(timer);
 }
 
+void oskar_timer_set_trace_name(oskar_Timer* timer, const char* name)
+{
+    timer->trace_name = name;
+}
+
 void oskar_timer_restart(oskar_Timer* timer)
 {
     timer->paused = 0;
@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_trace.h"
+#include "utility/oskar_thread.h"
+#include "log/oskar_log.h"
+#include "binary/oskar_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef OSKAR_OS_WIN
+#include <sys/time.h>
+#include <unistd.h>
+#else
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of regions kept by each thread. Older regions are overwritten. */
+#define MAX_EVENTS 65536
+
+/* Maximum depth of nested regions recorded. */
+#define MAX_DEPTH 32
+
+#define NAME_LENGTH 64
+
+#ifdef OSKAR_OS_WIN
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+typedef struct
+{
+    const char* name;
+    double start, duration;
+} Event;
+
+typedef struct
+{
+    int id, depth;
+    char name[NAME_LENGTH];
+    const char* open_name[MAX_DEPTH];
+    double open_start[MAX_DEPTH];
+    size_t num_written;
+    Event* events;
+} ThreadTrace;
+
+typedef struct
+{
+    const char* name;
+    int num, capacity;
+    double total, *duration;
+} Stage;
+
+static volatile int enabled_ = 0;
+static int generation_ = 0;
+static double start_time_ = 0.0;
+static char* filename_ = 0;
+static oskar_Mutex* mutex_ = 0;
+static int num_threads_ = 0;
+static ThreadTrace** threads_ = 0;
+
+/* Each thread keeps a pointer to its own trace. If the trace has been
+ * cleared since it was created, the pointer is no longer valid. */
+static THREAD_LOCAL ThreadTrace* local_trace_ = 0;
+static THREAD_LOCAL int local_generation_ = -1;
+static THREAD_LOCAL char local_name_[NAME_LENGTH];
+
+
+static double wtime(void)
+{
+#ifdef OSKAR_OS_WIN
+    LARGE_INTEGER cntr, freq;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&cntr);
+    return (double)(cntr.QuadPart) / (double)(freq.QuadPart);
+#else
+#if _POSIX_MONOTONIC_CLOCK > 0
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+#endif
+}
+
+
+static ThreadTrace* thread_trace(void)
+{
+    ThreadTrace* t;
+    if (local_trace_ && local_generation_ == generation_)
+        return local_trace_;
+
+    /* Register a new trace for this thread. */
+    t = (ThreadTrace*) calloc(1, sizeof(ThreadTrace));
+    if (!t) return 0;
+    t->events = (Event*) malloc(MAX_EVENTS * sizeof(Event));
+    if (!t->events)
+    {
+        free(t);
+        return 0;
+    }
+    oskar_mutex_lock(mutex_);
+    t->id = num_threads_;
+    if (local_name_[0])
+        strcpy(t->name, local_name_);
+    else
+        sprintf(t->name, "Thread %d", t->id);
+    threads_ = (ThreadTrace**) realloc(threads_,
+            (num_threads_ + 1) * sizeof(ThreadTrace*));
+    threads_[num_threads_++] = t;
+    local_generation_ = generation_;
+    oskar_mutex_unlock(mutex_);
+    local_trace_ = t;
+    return t;
+}
+
+
+int oskar_trace_start(const char* filename)
+{
+    if (enabled_) return 0;
+    if (!filename || !filename[0])
+        filename = getenv("OSKAR_TRACE_FILE");
+    if (!filename || !filename[0]) return 0;
+    free(filename_);
+    filename_ = (char*) malloc(1 + strlen(filename));
+    strcpy(filename_, filename);
+    if (!local_name_[0]) oskar_trace_set_thread_name("Main");
+    oskar_trace_clear();
+    oskar_trace_set_enabled(1);
+    return 1;
+}
+
+
+void oskar_trace_stop(oskar_Log* log, int* status)
+{
+    oskar_trace_set_enabled(0);
+    if (log) oskar_trace_log_summary(log);
+    if (filename_)
+    {
+        oskar_trace_write(filename_, status);
+        if (log && !*status)
+            oskar_log_message(log, 'M', 0, "Trace written to '%s'",
+                    filename_);
+        free(filename_);
+        filename_ = 0;
+    }
+}
+
+
+void oskar_trace_set_enabled(int value)
+{
+    if (value && !mutex_) mutex_ = oskar_mutex_create();
+    if (value && start_time_ == 0.0) start_time_ = wtime();
+    enabled_ = value;
+}
+
+
+int oskar_trace_enabled(void)
+{
+    return enabled_;
+}
+
+
+void oskar_trace_begin(const char* name)
+{
+    ThreadTrace* t;
+    if (!enabled_) return;
+    t = thread_trace();
+    if (!t) return;
+    if (t->depth < MAX_DEPTH)
+    {
+        t->open_name[t->depth] = name;
+        t->open_start[t->depth] = wtime();
+    }
+    t->depth++;
+}
+
+
+void oskar_trace_end(void)
+{
+    ThreadTrace* t;
+    if (!enabled_) return;
+    t = local_trace_;
+    if (!t || local_generation_ != generation_ || t->depth == 0) return;
+    t->depth--;
+    if (t->depth < MAX_DEPTH)
+    {
+        const double now = wtime();
+        Event* e = &t->events[t->num_written++ % MAX_EVENTS];
+        e->name = t->open_name[t->depth];
+        e->start = t->open_start[t->depth] - start_time_;
+        e->duration = now - t->open_start[t->depth];
+    }
+}
+
+
+void oskar_trace_set_thread_name(const char* name)
+{
+    strncpy(local_name_, name, NAME_LENGTH - 1);
+    local_name_[NAME_LENGTH - 1] = 0;
+    if (local_trace_ && local_generation_ == generation_)
+        strcpy(local_trace_->name, local_name_);
+}
+
+
+void oskar_trace_clear(void)
+{
+    int i;
+    if (mutex_) oskar_mutex_lock(mutex_);
+    for (i = 0; i < num_threads_; ++i)
+    {
+        free(threads_[i]->events);
+        free(threads_[i]);
+    }
+    free(threads_);
+    threads_ = 0;
+    num_threads_ = 0;
+    generation_++;
+    start_time_ = wtime();
+    if (mutex_) oskar_mutex_unlock(mutex_);
+}
+
+
+int oskar_trace_num_events(void)
+{
+    int i;
+    size_t num = 0;
+    for (i = 0; i < num_threads_; ++i)
+        num += (threads_[i]->num_written < MAX_EVENTS) ?
+                threads_[i]->num_written : MAX_EVENTS;
+    return (int) num;
+}
+
+
+double oskar_trace_total(const char* name, int* count)
+{
+    int i, n = 0;
+    size_t j, num, first;
+    double total = 0.0;
+    for (i = 0; i < num_threads_; ++i)
+    {
+        const ThreadTrace* t = threads_[i];
+        num = t->num_written < MAX_EVENTS ? t->num_written : MAX_EVENTS;
+        first = t->num_written - num;
+        for (j = 0; j < num; ++j)
+        {
+            const Event* e = &t->events[(first + j) % MAX_EVENTS];
+            if (e->name != name && strcmp(e->name, name)) continue;
+            total += e->duration;
+            n++;
+        }
+    }
+    if (count) *count = n;
+    return total;
+}
+
+
+static void write_string(FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (; *str; ++str)
+    {
+        if (*str == '"' || *str == '\\') fputc('\\', file);
+        if ((unsigned char)(*str) >= 0x20) fputc(*str, file);
+    }
+    fputc('"', file);
+}
+
+
+void oskar_trace_write(const char* filename, int* status)
+{
+    int i;
+    size_t j, num, first;
+    FILE* file;
+    if (*status) return;
+    file = fopen(filename, "w");
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", "
+            "\"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"OSKAR\"}}");
+    for (i = 0; i < num_threads_; ++i)
+    {
+        const ThreadTrace* t = threads_[i];
+        fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                "\"pid\": 1, \"tid\": %d, \"args\": {\"name\": ", t->id);
+        write_string(file, t->name);
+        fprintf(file, "}}");
+        fprintf(file, ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", "
+                "\"pid\": 1, \"tid\": %d, \"args\": {\"sort_index\": %d}}",
+                t->id, t->id);
+
+        /* Write the events in the ring buffer, oldest first. */
+        num = t->num_written < MAX_EVENTS ? t->num_written : MAX_EVENTS;
+        first = t->num_written - num;
+        for (j = 0; j < num; ++j)
+        {
+            const Event* e = &t->events[(first + j) % MAX_EVENTS];
+            fprintf(file, ",\n{\"name\": ");
+            write_string(file, e->name);
+            fprintf(file, ", \"cat\": \"oskar\", \"ph\": \"X\", \"pid\": 1, "
+                    "\"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                    t->id, e->start * 1e6, e->duration * 1e6);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    if (ferror(file)) *status = OSKAR_ERR_FILE_IO;
+    fclose(file);
+}
+
+
+static int compare_doubles(const void* a, const void* b)
+{
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+static int compare_stages(const void* a, const void* b)
+{
+    const double x = ((const Stage*)a)->total, y = ((const Stage*)b)->total;
+    return (x < y) - (x > y);
+}
+
+
+static double percentile(const Stage* s, double p)
+{
+    return s->duration[(int)(p * (s->num - 1) + 0.5)];
+}
+
+
+void oskar_trace_log_summary(oskar_Log* log)
+{
+    int i, k, num_stages = 0;
+    size_t j, num, first, num_dropped = 0;
+    Stage* stages = 0;
+
+    /* Collect the durations of regions with the same name. */
+    for (i = 0; i < num_threads_; ++i)
+    {
+        const ThreadTrace* t = threads_[i];
+        num = t->num_written < MAX_EVENTS ? t->num_written : MAX_EVENTS;
+        first = t->num_written - num;
+        num_dropped += first;
+        for (j = 0; j < num; ++j)
+        {
+            Stage* s;
+            const Event* e = &t->events[(first + j) % MAX_EVENTS];
+            for (k = 0; k < num_stages; ++k)
+                if (stages[k].name == e->name ||
+                        !strcmp(stages[k].name, e->name)) break;
+            if (k == num_stages)
+            {
+                stages = (Stage*) realloc(stages,
+                        ++num_stages * sizeof(Stage));
+                memset(&stages[k], 0, sizeof(Stage));
+                stages[k].name = e->name;
+            }
+            s = &stages[k];
+            if (s->num == s->capacity)
+            {
+                s->capacity = s->capacity ? 2 * s->capacity : 64;
+                s->duration = (double*) realloc(s->duration,
+                        s->capacity * sizeof(double));
+            }
+            s->duration[s->num++] = e->duration;
+            s->total += e->duration;
+        }
+    }
+
+    /* Write statistics for each stage, largest total time first. */
+    if (num_stages > 0)
+    {
+        oskar_log_section(log, 'M', "Trace summary");
+        oskar_log_message(log, 'M', 0, "Region durations in ms as "
+                "min / median / 95th percentile / max:");
+        qsort(stages, num_stages, sizeof(Stage), compare_stages);
+    }
+    for (k = 0; k < num_stages; ++k)
+    {
+        Stage* s = &stages[k];
+        qsort(s->duration, s->num, sizeof(double), compare_doubles);
+        oskar_log_value(log, 'M', 1, s->name,
+                "%.3f s (%d), %.3f / %.3f / %.3f / %.3f",
+                s->total, s->num, 1e3 * s->duration[0],
+                1e3 * percentile(s, 0.5), 1e3 * percentile(s, 0.95),
+                1e3 * s->duration[s->num - 1]);
+        free(s->duration);
+    }
+    if (num_dropped > 0)
+        oskar_log_warning(log, "Trace buffers were full: "
+                "%lu regions were not recorded.", (unsigned long) num_dropped);
+    free(stages);
+}
+
+#ifdef __cplusplus
+}
+#endif
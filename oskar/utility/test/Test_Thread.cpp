@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, The University of Oxford
+ * Copyright (c) 2017-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,10 +27,15 @@
  */
 
 #include <gtest/gtest.h>
+#include "utility/oskar_device_utils.h"
 #include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_thread.h"
 #include "utility/oskar_timer.h"
 #include <cstdlib>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define ENABLE_PRINT 1
 
@@ -124,3 +129,201 @@ TEST(thread, barriers)
     free(args);
     free(threads);
 }
+
+struct QueueArgs
+{
+    oskar_ConditionVar* var;
+    int *next, *consumed, num_items;
+};
+typedef struct QueueArgs QueueArgs;
+
+void* thread_consumer(void* arg)
+{
+    QueueArgs* args = (QueueArgs*) arg;
+    for (int i = 0; i < args->num_items; ++i)
+    {
+        // Wait until the producer has made the next item available.
+        oskar_condition_lock(args->var);
+        while (*(args->next) <= i)
+            oskar_condition_wait(args->var);
+        (*(args->consumed))++;
+        oskar_condition_notify_all(args->var);
+        oskar_condition_unlock(args->var);
+    }
+    return 0;
+}
+
+TEST(thread, condition_variable)
+{
+    int next = 0, consumed = 0, num_items = 1000;
+    QueueArgs args;
+    args.var = oskar_condition_create();
+    args.next = &next;
+    args.consumed = &consumed;
+    args.num_items = num_items;
+
+    // Start the consumer, and produce items one at a time.
+    oskar_Thread* thread = oskar_thread_create(thread_consumer, &args, 0);
+    for (int i = 0; i < num_items; ++i)
+    {
+        oskar_condition_lock(args.var);
+        while (consumed < next)
+            oskar_condition_wait(args.var);
+        next++;
+        oskar_condition_notify_all(args.var);
+        oskar_condition_unlock(args.var);
+    }
+    oskar_thread_join(thread);
+    oskar_thread_free(thread);
+    oskar_condition_free(args.var);
+    ASSERT_EQ(num_items, consumed);
+}
+
+static void fill_range(void* arg, int start, int end)
+{
+    int* data = (int*) arg;
+    for (int i = start; i < end; ++i) data[i] += i;
+}
+
+TEST(thread_pool, parallel_for)
+{
+    const int n = 100000;
+    std::vector<int> data(n, 0);
+    oskar_ThreadPool* pool = oskar_thread_pool_create(4);
+    ASSERT_EQ(4, oskar_thread_pool_num_threads(pool));
+
+    // Every index must be visited exactly once, for any grain size.
+    oskar_thread_pool_parallel_for(pool, 0, n, 0, fill_range, &data[0]);
+    oskar_thread_pool_parallel_for(pool, 0, n, 1000, fill_range, &data[0]);
+    oskar_thread_pool_parallel_for(pool, 0, n, 7, fill_range, &data[0]);
+    oskar_thread_pool_free(pool);
+    for (int i = 0; i < n; ++i) ASSERT_EQ(3 * i, data[i]);
+}
+
+struct NestedArgs
+{
+    oskar_ThreadPool* pool;
+    oskar_Mutex* mutex;
+    int* count;
+};
+
+static void increment(void* arg)
+{
+    NestedArgs* a = (NestedArgs*) arg;
+    oskar_mutex_lock(a->mutex);
+    (*a->count)++;
+    oskar_mutex_unlock(a->mutex);
+}
+
+static void submit_and_wait(void* arg)
+{
+    NestedArgs* a = (NestedArgs*) arg;
+    oskar_TaskGroup* group = oskar_task_group_create(a->pool);
+    for (int i = 0; i < 10; ++i)
+        oskar_thread_pool_submit(a->pool, group, increment, arg, -1);
+    oskar_task_group_wait(group);
+    oskar_task_group_free(group);
+    increment(arg);
+}
+
+TEST(thread_pool, nested_task_groups)
+{
+    int count = 0;
+    NestedArgs args;
+    args.pool = oskar_thread_pool_create(2);
+    args.mutex = oskar_mutex_create();
+    args.count = &count;
+
+    // Each task waits for tasks of its own, using more tasks than threads.
+    oskar_TaskGroup* group = oskar_task_group_create(args.pool);
+    for (int i = 0; i < 20; ++i)
+        oskar_thread_pool_submit(args.pool, group, submit_and_wait, &args,
+                i % 2);
+    oskar_task_group_wait(group);
+    ASSERT_EQ(20 * 11, count);
+    oskar_task_group_free(group);
+    oskar_thread_pool_free(args.pool);
+    oskar_mutex_free(args.mutex);
+}
+
+static oskar_Mutex* exit_hook_mutex = 0;
+static int exit_hook_count = 0;
+
+static void count_exit(void)
+{
+    // The hook stays registered for pools created by later tests.
+    if (!exit_hook_mutex) return;
+    oskar_mutex_lock(exit_hook_mutex);
+    exit_hook_count++;
+    oskar_mutex_unlock(exit_hook_mutex);
+}
+
+TEST(thread_pool, exit_hooks)
+{
+    exit_hook_mutex = oskar_mutex_create();
+    ASSERT_EQ(1, oskar_thread_add_exit_hook(count_exit));
+    ASSERT_EQ(1, oskar_thread_add_exit_hook(count_exit));
+
+    // Each worker thread should call the hook once, when the pool is freed.
+    oskar_ThreadPool* pool = oskar_thread_pool_create(3);
+    ASSERT_EQ(0, exit_hook_count);
+    oskar_thread_pool_free(pool);
+    ASSERT_EQ(3, exit_hook_count);
+    oskar_mutex_free(exit_hook_mutex);
+    exit_hook_mutex = 0;
+}
+
+struct StateArgs
+{
+    oskar_Mutex* mutex;
+    int num_not_on_worker;
+};
+
+static void change_thread_state(void* arg)
+{
+    StateArgs* a = (StateArgs*) arg;
+    int status = 0;
+    volatile double sum = 0.0;
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+    const int num_devices = oskar_device_count(&status);
+    if (num_devices > 1)
+        oskar_device_set((oskar_device_get() + 1) % num_devices, &status);
+    for (int i = 0; i < 10000; ++i) sum += i;
+    if (!oskar_thread_is_pool_worker())
+    {
+        oskar_mutex_lock(a->mutex);
+        a->num_not_on_worker++;
+        oskar_mutex_unlock(a->mutex);
+    }
+}
+
+TEST(thread_pool, wait_keeps_caller_state)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(3);
+#endif
+    const int device = oskar_device_get();
+    StateArgs args;
+    args.mutex = oskar_mutex_create();
+    args.num_not_on_worker = 0;
+    EXPECT_EQ(0, oskar_thread_is_pool_worker());
+
+    // Tasks that change per-thread state must only run on worker threads,
+    // even though the caller waits while most of them are still queued.
+    oskar_ThreadPool* pool = oskar_thread_pool_create(2);
+    oskar_TaskGroup* group = oskar_task_group_create(pool);
+    for (int i = 0; i < 200; ++i)
+        oskar_thread_pool_submit(pool, group, change_thread_state, &args,
+                i % 2);
+    oskar_task_group_wait(group);
+    oskar_task_group_free(group);
+    EXPECT_EQ(0, args.num_not_on_worker);
+#ifdef _OPENMP
+    EXPECT_EQ(3, omp_get_max_threads());
+#endif
+    EXPECT_EQ(device, oskar_device_get());
+    oskar_thread_pool_free(pool);
+    oskar_mutex_free(args.mutex);
+}
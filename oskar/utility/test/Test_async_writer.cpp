@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fitsio.h>
+#include "utility/oskar_async_writer.h"
+
+#include <cstdio>
+#include <vector>
+
+TEST(async_writer, fits_planes)
+{
+    // Write planes to several FITS files at once, reusing the same buffer.
+    const int num_files = 3, num_planes = 8, size = 64;
+    const long num_pix = size * size;
+    std::vector<fitsfile*> f(num_files);
+    std::vector<float> buf(num_pix);
+    int status = 0;
+    oskar_AsyncWriter* w = oskar_async_writer_create(num_files, 2 * num_pix);
+    for (int i = 0; i < num_files; ++i)
+    {
+        char name[64];
+        long naxes[3] = {size, size, num_planes};
+        sprintf(name, "!temp_test_async_writer_%d.fits", i);
+        fits_create_file(&f[i], name, &status);
+        fits_create_img(f[i], FLOAT_IMG, 3, naxes, &status);
+    }
+    ASSERT_EQ(0, status);
+    for (int p = 0; p < num_planes; ++p)
+    {
+        for (int i = 0; i < num_files; ++i)
+        {
+            long firstpix[3] = {1, 1, 1 + p};
+            for (long j = 0; j < num_pix; ++j)
+                buf[j] = (float) (1000 * i + 10 * p) + j % 7;
+            oskar_async_writer_fits_write_pix(w, f[i], TFLOAT, 3,
+                    firstpix, num_pix, &buf[0], 1, &status);
+        }
+    }
+    oskar_async_writer_free(w, &status);
+    ASSERT_EQ(0, status);
+
+    // Check the data.
+    for (int i = 0; i < num_files; ++i)
+    {
+        for (int p = 0; p < num_planes; ++p)
+        {
+            long firstpix[3] = {1, 1, 1 + p};
+            int anynul = 0;
+            fits_read_pix(f[i], TFLOAT, firstpix, num_pix, 0,
+                    &buf[0], &anynul, &status);
+            ASSERT_EQ(0, status);
+            for (long j = 0; j < num_pix; ++j)
+                ASSERT_EQ((float) (1000 * i + 10 * p) + j % 7, buf[j]);
+        }
+        fits_close_file(f[i], &status);
+        char name[64];
+        sprintf(name, "temp_test_async_writer_%d.fits", i);
+        remove(name);
+    }
+}
+
+TEST(async_writer, bad_argument)
+{
+    int status = 0;
+    long firstpix[1] = {1};
+    float data[1] = {0.0f};
+    oskar_AsyncWriter* w = oskar_async_writer_create(1, 1024);
+    oskar_async_writer_fits_write_pix(w, 0, TINT, 1, firstpix, 1,
+            data, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_INVALID_ARGUMENT, status);
+    status = 0;
+    oskar_async_writer_free(w, &status);
+    EXPECT_EQ(0, status);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "utility/oskar_compress.h"
+
+TEST(compress, lossless_double)
+{
+    // Smoothly-varying data with a tail that does not fill a group.
+    const size_t n = 1003;
+    std::vector<double> in(n), out(n);
+    for (size_t i = 0; i < n; ++i)
+        in[i] = sin(0.01 * i) * 1e3;
+    std::vector<unsigned char> buf(oskar_compress_bound(n * sizeof(double)));
+
+    // Compress and decompress.
+    int status = 0;
+    size_t bytes = oskar_compress(&in[0], n, sizeof(double), 0,
+            &buf[0], &status);
+    ASSERT_EQ(0, status);
+    ASSERT_GT(bytes, 0u);
+    ASSERT_LE(bytes, buf.size());
+    oskar_decompress(&buf[0], bytes, n, sizeof(double), &out[0], &status);
+    ASSERT_EQ(0, status);
+    EXPECT_EQ(0, memcmp(&in[0], &out[0], n * sizeof(double)));
+}
+
+TEST(compress, lossless_float_constant)
+{
+    // Constant data should compress very well.
+    const size_t n = 4096;
+    std::vector<float> in(n, 1.5f), out(n);
+    std::vector<unsigned char> buf(oskar_compress_bound(n * sizeof(float)));
+    int status = 0;
+    size_t bytes = oskar_compress(&in[0], n, sizeof(float), 0,
+            &buf[0], &status);
+    ASSERT_EQ(0, status);
+    EXPECT_LT(bytes, n * sizeof(float) / 50);
+    oskar_decompress(&buf[0], bytes, n, sizeof(float), &out[0], &status);
+    ASSERT_EQ(0, status);
+    EXPECT_EQ(0, memcmp(&in[0], &out[0], n * sizeof(float)));
+}
+
+TEST(compress, incompressible)
+{
+    // Random bytes must still round-trip within the bound.
+    const size_t n = 2001;
+    std::vector<float> in(n), out(n);
+    srand(2);
+    unsigned char* p = (unsigned char*) &in[0];
+    for (size_t i = 0; i < n * sizeof(float); ++i)
+        p[i] = (unsigned char) (rand() & 0xFF);
+    std::vector<unsigned char> buf(oskar_compress_bound(n * sizeof(float)));
+    int status = 0;
+    size_t bytes = oskar_compress(&in[0], n, sizeof(float), 0,
+            &buf[0], &status);
+    ASSERT_EQ(0, status);
+    ASSERT_LE(bytes, buf.size());
+    oskar_decompress(&buf[0], bytes, n, sizeof(float), &out[0], &status);
+    ASSERT_EQ(0, status);
+    EXPECT_EQ(0, memcmp(&in[0], &out[0], n * sizeof(float)));
+}
+
+TEST(compress, lossy)
+{
+    const int mantissa_bits = 10;
+    const size_t n = 10000;
+    std::vector<float> in(n), out(n);
+    srand(1);
+    for (size_t i = 0; i < n; ++i)
+        in[i] = (float) (rand() / (double) RAND_MAX - 0.5);
+    const size_t num_bytes = n * sizeof(float);
+    std::vector<unsigned char> buf(oskar_compress_bound(num_bytes));
+
+    // Check lossless size first.
+    int status = 0;
+    size_t bytes_lossless = oskar_compress(&in[0], n, sizeof(float), 0,
+            &buf[0], &status);
+    ASSERT_EQ(0, status);
+
+    // Check lossy compression is smaller and within the error bound.
+    size_t bytes = oskar_compress(&in[0], n, sizeof(float), mantissa_bits,
+            &buf[0], &status);
+    ASSERT_EQ(0, status);
+    EXPECT_LT(bytes, bytes_lossless);
+    EXPECT_LT(bytes, num_bytes * 3 / 4);
+    oskar_decompress(&buf[0], bytes, n, sizeof(float), &out[0], &status);
+    ASSERT_EQ(0, status);
+    const double tol = pow(2.0, -(mantissa_bits + 1));
+    for (size_t i = 0; i < n; ++i)
+        EXPECT_LE(fabs(out[i] - in[i]), tol * fabs(in[i]));
+}
+
+TEST(compress, corrupt)
+{
+    const size_t n = 64;
+    std::vector<double> in(n, 2.0), out(n);
+    std::vector<unsigned char> buf(oskar_compress_bound(n * sizeof(double)));
+    int status = 0;
+    size_t bytes = oskar_compress(&in[0], n, sizeof(double), 0,
+            &buf[0], &status);
+    ASSERT_EQ(0, status);
+
+    // A truncated stream must be rejected.
+    oskar_decompress(&buf[0], bytes - 1, n, sizeof(double), &out[0], &status);
+    EXPECT_NE(0, status);
+}
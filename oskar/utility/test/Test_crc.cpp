@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014, The University of Oxford
+ * Copyright (c) 2014-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -33,6 +33,11 @@
 #include <cstring>
 
 #include "binary/oskar_crc.h"
+#include "utility/oskar_timer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 TEST(crc, crc32_standard)
 {
@@ -122,6 +127,11 @@ TEST(crc, crc8_standard)
     oskar_crc_free(crc_data);
 }
 
+TEST(crc, unknown_type)
+{
+    EXPECT_TRUE(oskar_crc_create(-1) == NULL);
+}
+
 TEST(crc, crc8_consistency)
 {
     oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_8_EBU);
@@ -155,3 +165,62 @@ TEST(crc, crc8_consistency)
     // Cleanup.
     oskar_crc_free(crc_data);
 }
+
+TEST(crc, combine)
+{
+    const char data[] = "The quick brown fox jumps over the lazy dog";
+    const size_t len = strlen(data);
+    const int types[] = {OSKAR_CRC_8_EBU, OSKAR_CRC_32, OSKAR_CRC_32C};
+    for (int t = 0; t < 3; ++t)
+    {
+        oskar_CRC* crc_data = oskar_crc_create(types[t]);
+        unsigned long crc = oskar_crc_compute(crc_data, data, len);
+        for (size_t i = 0; i <= len; ++i)
+        {
+            unsigned long crc1 = oskar_crc_compute(crc_data, data, i);
+            unsigned long crc2 = oskar_crc_compute(crc_data, data + i, len - i);
+            EXPECT_EQ(crc, oskar_crc_combine(crc_data, crc1, crc2, len - i));
+        }
+        oskar_crc_free(crc_data);
+    }
+}
+
+TEST(crc, crc32c_large)
+{
+    // Create test data, with an odd length.
+    size_t bytes = 16uL * 1024uL * 1024uL + 13;
+    unsigned char* data = (unsigned char*) malloc(bytes);
+    srand(1);
+    for (size_t i = 0; i < bytes; ++i)
+        data[i] = (unsigned char) (rand() & 0xFF);
+#ifdef _OPENMP
+    int max_threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+#endif
+
+    // Compare the default method (hardware and/or threads if available)
+    // with the lookup tables, for the whole block and an unaligned part.
+    oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    unsigned long crc1 = oskar_crc_compute(crc_data, data, bytes);
+    double t1 = oskar_timer_elapsed(tmr);
+    unsigned long crc3 = oskar_crc_compute(crc_data, data + 3, bytes - 3);
+    oskar_crc_set_hardware(crc_data, 0);
+    oskar_timer_start(tmr);
+    unsigned long crc2 = oskar_crc_compute(crc_data, data, bytes);
+    double t2 = oskar_timer_elapsed(tmr);
+    unsigned long crc4 = oskar_crc_compute(crc_data, data + 3, bytes - 3);
+    EXPECT_EQ(crc2, crc1);
+    EXPECT_EQ(crc4, crc3);
+    printf("CRC-32C of %.0f MB: %.3f s (default), %.3f s (tables)\n",
+            bytes / (1024.0 * 1024.0), t1, t2);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+
+    // Cleanup.
+    oskar_timer_free(tmr);
+    oskar_crc_free(crc_data);
+    free(data);
+}
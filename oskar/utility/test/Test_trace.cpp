@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utility/oskar_trace.h"
+#include "utility/oskar_thread.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static void* trace_thread(void* arg)
+{
+    (void)arg;
+    oskar_trace_set_thread_name("Test thread");
+    for (int i = 0; i < 10; ++i)
+    {
+        oskar_trace_begin("Thread region");
+        oskar_trace_end();
+    }
+    return 0;
+}
+
+TEST(trace, disabled)
+{
+    // Nothing should be recorded if tracing is not enabled.
+    oskar_trace_set_enabled(0);
+    oskar_trace_clear();
+    oskar_trace_begin("Region");
+    oskar_trace_end();
+    EXPECT_EQ(0, oskar_trace_enabled());
+    EXPECT_EQ(0, oskar_trace_num_events());
+}
+
+TEST(trace, nested_regions_and_threads)
+{
+    oskar_trace_set_enabled(1);
+    oskar_trace_clear();
+    ASSERT_EQ(1, oskar_trace_enabled());
+
+    // Record nested regions on this thread.
+    oskar_trace_begin("Outer");
+    for (int i = 0; i < 5; ++i)
+    {
+        oskar_trace_begin("Inner");
+        oskar_trace_end();
+    }
+    oskar_trace_end();
+    EXPECT_EQ(6, oskar_trace_num_events());
+
+    // Unmatched end calls should be ignored.
+    oskar_trace_end();
+    EXPECT_EQ(6, oskar_trace_num_events());
+
+    // Record regions on another thread.
+    oskar_Thread* thread = oskar_thread_create(trace_thread, 0, 0);
+    oskar_thread_join(thread);
+    oskar_thread_free(thread);
+    EXPECT_EQ(16, oskar_trace_num_events());
+
+    // Write the trace file and check it contains the region names.
+    int status = 0;
+    const char* filename = "temp_test_trace.json";
+    oskar_trace_set_enabled(0);
+    oskar_trace_write(filename, &status);
+    ASSERT_EQ(0, status);
+    FILE* fhan = fopen(filename, "rb");
+    ASSERT_TRUE(fhan != NULL);
+    std::string contents;
+    char buffer[1024];
+    size_t n = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), fhan)) > 0)
+        contents.append(buffer, n);
+    fclose(fhan);
+    remove(filename);
+    EXPECT_EQ('{', contents[0]);
+    EXPECT_NE(std::string::npos, contents.find("\"Outer\""));
+    EXPECT_NE(std::string::npos, contents.find("\"Inner\""));
+    EXPECT_NE(std::string::npos, contents.find("\"Thread region\""));
+    EXPECT_NE(std::string::npos, contents.find("\"Test thread\""));
+
+    // Clear the trace.
+    oskar_trace_clear();
+    EXPECT_EQ(0, oskar_trace_num_events());
+}
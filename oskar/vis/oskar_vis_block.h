@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -54,7 +54,9 @@ enum OSKAR_VIS_BLOCK_TAGS
     OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS    = 3,
     OSKAR_VIS_BLOCK_TAG_BASELINE_UU           = 4,
     OSKAR_VIS_BLOCK_TAG_BASELINE_VV           = 5,
-    OSKAR_VIS_BLOCK_TAG_BASELINE_WW           = 6
+    OSKAR_VIS_BLOCK_TAG_BASELINE_WW           = 6,
+    OSKAR_VIS_BLOCK_TAG_AUTO_CORRELATIONS_CHUNK  = 7,
+    OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS_CHUNK = 8
 };
 
 #ifdef __cplusplus
@@ -71,6 +73,7 @@ enum OSKAR_VIS_BLOCK_TAGS
 #include <vis/oskar_vis_block_read.h>
 #include <vis/oskar_vis_block_resize.h>
 #include <vis/oskar_vis_block_write.h>
+#include <vis/oskar_vis_block_write_chunks.h>
 #include <vis/oskar_vis_block_write_ms.h>
 
 #endif /* OSKAR_VIS_BLOCK_H_ */
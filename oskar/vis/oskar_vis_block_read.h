@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -49,6 +49,19 @@ extern "C" {
  * This function fills an empty visibility structure by
  * reading data using the specified file handle.
  *
+ * If the file was opened with mode 'm' (memory-mapped) and the block is in
+ * CPU memory, the arrays in the block are set to alias the data in the
+ * file where possible, rather than being filled with a copy.
+ * The file handle then owns the data, not the block, so:
+ *
+ * - The block must not be used after the file handle has been freed,
+ *   other than to free it.
+ * - The aliased arrays are read-only: they must not be written to or
+ *   resized, and the block must be read again only from the same file.
+ *
+ * Callers that need to keep or modify the data after the file has been
+ * closed should copy the block, or open the file with mode 'r' instead.
+ *
  * @param[in,out] vis         The visibility block structure to fill.
  * @param[in,out] hdr         The visibility header.
  * @param[in,out] h           The OSKAR binary file handle, opened for read.
@@ -59,6 +72,37 @@ OSKAR_EXPORT
 void oskar_vis_block_read(oskar_VisBlock* vis, const oskar_VisHeader* hdr,
         oskar_Binary* h, int block_index, int* status);
 
+/**
+ * @brief
+ * Fills a visibility structure by reading a range of channels from
+ * the specified file.
+ *
+ * @details
+ * This function is the same as oskar_vis_block_read(), except that if the
+ * amplitudes in the file are chunked (see oskar_vis_header_set_chunking()),
+ * only the chunks that contain channels in the given range are
+ * read and decoded. Amplitudes for channels in the other chunks are
+ * set to zero. Each chunk holds all the times in the block, so a
+ * block is the unit of chunking in time.
+ *
+ * If the amplitudes are not chunked, the whole block is read.
+ *
+ * Channel indices are global, not relative to the start of the block.
+ *
+ * @param[in,out] vis           The visibility block structure to fill.
+ * @param[in,out] hdr           The visibility header.
+ * @param[in,out] h             The OSKAR binary file handle, opened for read.
+ * @param[in]     block_index   The visibility block index.
+ * @param[in]     start_channel The first channel index to read.
+ * @param[in]     end_channel   The last channel index to read (inclusive),
+ *                              or -1 for the last channel.
+ * @param[in,out] status        Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_block_read_channels(oskar_VisBlock* vis,
+        const oskar_VisHeader* hdr, oskar_Binary* h, int block_index,
+        int start_channel, int end_channel, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -57,6 +57,31 @@ OSKAR_APPS_EXPORT
 void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         const oskar_VisHeader* hdr, oskar_MeasurementSet* ms, int* status);
 
+/**
+ * @brief Writes part of a visibility data block to a CASA Measurement Set.
+ *
+ * @details
+ * This function writes the channels of a visibility data block that fall
+ * inside the frequency range of a Measurement Set which holds only a
+ * subset of the channels in the observation.
+ *
+ * The Measurement Set should have been created using
+ * oskar_vis_header_write_ms_channels() with the same \p ms_start_channel.
+ * Channels in the block outside the range of the Measurement Set are
+ * ignored.
+ *
+ * @param[in] blk              Pointer to visibility block to write.
+ * @param[in] hdr              Pointer to visibility header.
+ * @param[in,out] ms           Handle to a Measurement Set open for write.
+ * @param[in] ms_start_channel Observation channel index of the first
+ *                             channel in the Measurement Set.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_APPS_EXPORT
+void oskar_vis_block_write_ms_channels(const oskar_VisBlock* blk,
+        const oskar_VisHeader* hdr, oskar_MeasurementSet* ms,
+        int ms_start_channel, int* status);
+
 #ifdef __cplusplus
 }
 #endif
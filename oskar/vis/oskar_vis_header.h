@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -75,7 +75,16 @@ enum OSKAR_VIS_HEADER_TAGS
     OSKAR_VIS_HEADER_TAG_TELESCOPE_REF_ALT_M      = 31,
     OSKAR_VIS_HEADER_TAG_STATION_X_OFFSET_ECEF    = 32,
     OSKAR_VIS_HEADER_TAG_STATION_Y_OFFSET_ECEF    = 33,
-    OSKAR_VIS_HEADER_TAG_STATION_Z_OFFSET_ECEF    = 34
+    OSKAR_VIS_HEADER_TAG_STATION_Z_OFFSET_ECEF    = 34,
+    OSKAR_VIS_HEADER_TAG_PADDING                  = 35,
+    OSKAR_VIS_HEADER_TAG_AMP_CHUNK_SIZE           = 36,
+    OSKAR_VIS_HEADER_TAG_AMP_COMPRESSION          = 37
+};
+
+enum OSKAR_VIS_HEADER_COMPRESSION
+{
+    OSKAR_VIS_COMPRESSION_NONE            = 0,
+    OSKAR_VIS_COMPRESSION_BITSHUFFLE_RLE  = 1
 };
 
 enum OSKAR_VIS_HEADER_POL_TYPE
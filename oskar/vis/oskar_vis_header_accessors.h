@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -86,6 +86,18 @@ int oskar_vis_header_num_stations(const oskar_VisHeader* vis);
 OSKAR_EXPORT
 int oskar_vis_header_pol_type(const oskar_VisHeader* vis);
 
+OSKAR_EXPORT
+int oskar_vis_header_chunk_channels(const oskar_VisHeader* vis);
+
+OSKAR_EXPORT
+int oskar_vis_header_chunk_baselines(const oskar_VisHeader* vis);
+
+OSKAR_EXPORT
+int oskar_vis_header_compression(const oskar_VisHeader* vis);
+
+OSKAR_EXPORT
+int oskar_vis_header_compression_bits(const oskar_VisHeader* vis);
+
 OSKAR_EXPORT
 int oskar_vis_header_phase_centre_coord_type(const oskar_VisHeader* vis);
 
@@ -177,6 +189,42 @@ OSKAR_EXPORT
 void oskar_vis_header_set_pol_type(oskar_VisHeader* vis, int value,
         int* status);
 
+/**
+ * @brief
+ * Sets the storage layout of visibility amplitudes in the binary file.
+ *
+ * @details
+ * Amplitudes in each visibility block are normally written as a single
+ * array. If \p channels_per_chunk is positive, or if \p compression is
+ * not OSKAR_VIS_COMPRESSION_NONE, the amplitudes are instead split into
+ * chunks spanning all the times in the block, up to \p channels_per_chunk
+ * channels and up to \p baselines_per_chunk baselines
+ * (auto-correlations are split by channel only).
+ * Each chunk is stored in its own tag, so that a subset of the
+ * channels can be read without reading or decoding the others.
+ *
+ * Values less than 1 for \p channels_per_chunk or \p baselines_per_chunk
+ * mean all channels or baselines in the block.
+ *
+ * If \p compression is OSKAR_VIS_COMPRESSION_BITSHUFFLE_RLE, each chunk
+ * is compressed using oskar_compress(), keeping \p mantissa_bits bits of
+ * the mantissa (0 for lossless compression).
+ *
+ * Blocks must be written using oskar_vis_block_write_chunks() if this
+ * is set.
+ *
+ * @param[in,out] vis               The visibility header.
+ * @param[in] compression           Enumerated compression type.
+ * @param[in] mantissa_bits         Mantissa bits to keep, or 0 for all.
+ * @param[in] channels_per_chunk    Maximum number of channels per chunk.
+ * @param[in] baselines_per_chunk   Maximum number of baselines per chunk.
+ * @param[in,out] status            Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_header_set_chunking(oskar_VisHeader* vis, int compression,
+        int mantissa_bits, int channels_per_chunk, int baselines_per_chunk,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
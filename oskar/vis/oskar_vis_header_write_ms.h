@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -60,6 +60,32 @@ OSKAR_APPS_EXPORT
 oskar_MeasurementSet* oskar_vis_header_write_ms(const oskar_VisHeader* hdr,
         const char* ms_path, int overwrite, int force_polarised, int* status);
 
+/**
+ * @brief Writes visibility header data for a channel range to a CASA
+ * Measurement Set.
+ *
+ * @details
+ * This function writes visibility header data to a CASA Measurement Set
+ * which will hold only the given range of channels, and returns a handle
+ * to it. It can be used to split the output of an observation across
+ * several Measurement Sets.
+ *
+ * @param[in] hdr             Pointer to visibility header structure to write.
+ * @param[in] ms_path         Pathname of the Measurement Set to write.
+ * @param[in] overwrite       If true, overwrite any existing Measurement Set.
+ * @param[in] force_polarised If true, write Stokes I visibility data in
+ *                            polarised format, by dividing the power
+ *                            equally between XX and YY correlations.
+ * @param[in] start_channel   Index of the first channel to hold.
+ * @param[in] num_channels    Number of channels to hold.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_APPS_EXPORT
+oskar_MeasurementSet* oskar_vis_header_write_ms_channels(
+        const oskar_VisHeader* hdr, const char* ms_path, int overwrite,
+        int force_polarised, int start_channel, int num_channels,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
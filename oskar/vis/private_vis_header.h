@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -51,6 +51,10 @@ struct oskar_VisHeader
     int num_channels_total;          /* Total no. channels. */
     int num_stations;                /* No. interferometer stations. */
     int pol_type;                    /* Polarisation type enumerator. */
+    int chunk_channels;              /* No. channels per amplitude chunk, or 0. */
+    int chunk_baselines;             /* No. baselines per amplitude chunk. */
+    int compression;                 /* Amplitude compression enumerator. */
+    int compression_bits;            /* No. mantissa bits kept, or 0. */
 
     int phase_centre_type;           /* Phase centre coordinate type. */
     double phase_centre_deg[2];      /* Phase centre coordinates [deg]. */
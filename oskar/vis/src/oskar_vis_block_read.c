@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,17 +29,34 @@
 #include "vis/private_vis_block.h"
 #include "binary/oskar_binary.h"
 #include "mem/oskar_binary_read_mem.h"
+#include "utility/oskar_compress.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_header.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void read_chunks(oskar_Binary* h, oskar_Mem* amp,
+        unsigned char tag, int block_index, int compression,
+        int num_times, int num_channels, int num_baselines,
+        int chunk_c, int chunk_b, int num_chunks_c, int num_chunks_b,
+        int start_channel, int end_channel, int* status);
+
 void oskar_vis_block_read(oskar_VisBlock* vis, const oskar_VisHeader* hdr,
         oskar_Binary* h, int block_index, int* status)
 {
-    int num_tags_per_block;
+    oskar_vis_block_read_channels(vis, hdr, h, block_index, 0, -1, status);
+}
+
+void oskar_vis_block_read_channels(oskar_VisBlock* vis,
+        const oskar_VisHeader* hdr, oskar_Binary* h, int block_index,
+        int start_channel, int end_channel, int* status)
+{
+    int num_tags_per_block, chunk_c;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -55,34 +72,204 @@ void oskar_vis_block_read(oskar_VisBlock* vis, const oskar_VisHeader* hdr,
             OSKAR_VIS_BLOCK_TAG_DIM_START_AND_SIZE, block_index,
             sizeof(int) * 6, vis->dim_start_size, status);
 
-    /* Read the auto-correlation data. */
-    if (oskar_vis_header_write_auto_correlations(hdr))
+    /* Read the amplitudes. */
+    chunk_c = oskar_vis_header_chunk_channels(hdr);
+    if (chunk_c > 0)
     {
-        oskar_binary_read_mem(h, vis->auto_correlations,
-                OSKAR_TAG_GROUP_VIS_BLOCK,
-                OSKAR_VIS_BLOCK_TAG_AUTO_CORRELATIONS, block_index, status);
+        int chunk_b, compression, num_stations, num_chunks_c, num_chunks_b;
+        chunk_b = oskar_vis_header_chunk_baselines(hdr);
+        compression = oskar_vis_header_compression(hdr);
+        num_stations = oskar_vis_header_num_stations(hdr);
+        num_chunks_c = (oskar_vis_header_max_channels_per_block(hdr) +
+                chunk_c - 1) / chunk_c;
+        num_chunks_b = (num_stations * (num_stations - 1) / 2 +
+                chunk_b - 1) / chunk_b;
+        start_channel -= oskar_vis_block_start_channel_index(vis);
+        if (end_channel < 0)
+            end_channel = oskar_vis_block_num_channels(vis);
+        else
+            end_channel -= oskar_vis_block_start_channel_index(vis);
+        if (oskar_vis_header_write_auto_correlations(hdr))
+        {
+            read_chunks(h, vis->auto_correlations,
+                    OSKAR_VIS_BLOCK_TAG_AUTO_CORRELATIONS_CHUNK, block_index,
+                    compression, oskar_vis_block_num_times(vis),
+                    oskar_vis_block_num_channels(vis),
+                    oskar_vis_block_num_stations(vis), chunk_c,
+                    oskar_vis_block_num_stations(vis), num_chunks_c, 1,
+                    start_channel, end_channel, status);
+        }
+        if (oskar_vis_header_write_cross_correlations(hdr))
+        {
+            read_chunks(h, vis->cross_correlations,
+                    OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS_CHUNK, block_index,
+                    compression, oskar_vis_block_num_times(vis),
+                    oskar_vis_block_num_channels(vis),
+                    oskar_vis_block_num_baselines(vis), chunk_c, chunk_b,
+                    num_chunks_c, num_chunks_b,
+                    start_channel, end_channel, status);
+        }
+    }
+    else
+    {
+        if (oskar_vis_header_write_auto_correlations(hdr))
+        {
+            oskar_binary_map_mem(h, vis->auto_correlations,
+                    OSKAR_TAG_GROUP_VIS_BLOCK,
+                    OSKAR_VIS_BLOCK_TAG_AUTO_CORRELATIONS, block_index,
+                    status);
+        }
+        if (oskar_vis_header_write_cross_correlations(hdr))
+        {
+            oskar_binary_map_mem(h, vis->cross_correlations,
+                    OSKAR_TAG_GROUP_VIS_BLOCK,
+                    OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS, block_index,
+                    status);
+        }
     }
 
-    /* Read the cross-correlation data. */
+    /* Read the baseline coordinate data. */
     if (oskar_vis_header_write_cross_correlations(hdr))
     {
-        oskar_binary_read_mem(h, vis->cross_correlations,
-                OSKAR_TAG_GROUP_VIS_BLOCK,
-                OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS, block_index, status);
-
-        /* Read the baseline coordinate data. */
-        oskar_binary_read_mem(h, vis->baseline_uu_metres,
+        oskar_binary_map_mem(h, vis->baseline_uu_metres,
                 OSKAR_TAG_GROUP_VIS_BLOCK,
                 OSKAR_VIS_BLOCK_TAG_BASELINE_UU, block_index, status);
-        oskar_binary_read_mem(h, vis->baseline_vv_metres,
+        oskar_binary_map_mem(h, vis->baseline_vv_metres,
                 OSKAR_TAG_GROUP_VIS_BLOCK,
                 OSKAR_VIS_BLOCK_TAG_BASELINE_VV, block_index, status);
-        oskar_binary_read_mem(h, vis->baseline_ww_metres,
+        oskar_binary_map_mem(h, vis->baseline_ww_metres,
                 OSKAR_TAG_GROUP_VIS_BLOCK,
                 OSKAR_VIS_BLOCK_TAG_BASELINE_WW, block_index, status);
     }
 }
 
+
+/*
+ * Reads and decodes only the chunks that overlap the channel range,
+ * using the layout written by oskar_vis_block_write_chunks().
+ * Channels in the other chunks are set to zero.
+ */
+static void read_chunks(oskar_Binary* h, oskar_Mem* amp,
+        unsigned char tag, int block_index, int compression,
+        int num_times, int num_channels, int num_baselines,
+        int chunk_c, int chunk_b, int num_chunks_c, int num_chunks_b,
+        int start_channel, int end_channel, int* status)
+{
+    char *dst, *raw = 0, *dec = 0;
+    size_t elem_size, prec_size, raw_size = 0, num_elements;
+    int ic, ib, mapped;
+    if (*status) return;
+    if (oskar_mem_location(amp) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Make sure there is enough space for the whole block. */
+    num_elements = (size_t) num_times * num_channels * num_baselines;
+    if (oskar_mem_length(amp) < num_elements)
+        oskar_mem_realloc(amp, num_elements, status);
+    if (*status) return;
+    dst = oskar_mem_char(amp);
+    elem_size = oskar_mem_element_size(oskar_mem_type(amp));
+    prec_size = oskar_mem_element_size(
+            oskar_type_precision(oskar_mem_type(amp)));
+    mapped = oskar_binary_is_mapped(h);
+    if (compression != OSKAR_VIS_COMPRESSION_NONE)
+    {
+        dec = (char*) malloc((size_t) num_times * chunk_c * chunk_b *
+                elem_size + 1);
+        if (!dec)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+    }
+
+    for (ic = 0; ic < num_chunks_c; ++ic)
+    {
+        const int c0 = ic * chunk_c;
+        const int c1 = c0 + chunk_c < num_channels ? c0 + chunk_c :
+                num_channels;
+        if (c1 <= c0) continue;
+
+        /* Clear channels that are not read, so that no data from
+         * a previous block is left in them. */
+        if (c1 <= start_channel || c0 > end_channel)
+        {
+            int t;
+            for (t = 0; t < num_times; ++t)
+                memset(dst + elem_size * num_baselines *
+                        ((size_t) c0 + num_channels * (size_t) t), 0,
+                        elem_size * num_baselines * (c1 - c0));
+            continue;
+        }
+        for (ib = 0; ib < num_chunks_b; ++ib)
+        {
+            const char* src = 0;
+            size_t payload_size = 0, num_bytes, row_bytes, offset = 0;
+            int c, t, b0, b1, chunk_index;
+            if (*status) break;
+            b0 = ib * chunk_b;
+            b1 = b0 + chunk_b < num_baselines ? b0 + chunk_b : num_baselines;
+            if (b1 <= b0) continue;
+            row_bytes = (b1 - b0) * elem_size;
+            num_bytes = (size_t) num_times * (c1 - c0) * row_bytes;
+
+            /* Find the chunk's tag and get its payload. */
+            chunk_index = oskar_binary_query(h, 0, OSKAR_TAG_GROUP_VIS_BLOCK,
+                    tag, block_index * num_chunks_c * num_chunks_b +
+                    ic * num_chunks_b + ib, &payload_size, status);
+            if (*status) break;
+            if (mapped)
+                src = (const char*) oskar_binary_map_block(h,
+                        chunk_index, status);
+            else
+            {
+                if (payload_size > raw_size)
+                {
+                    char* tmp = (char*) realloc(raw, payload_size);
+                    if (!tmp)
+                    {
+                        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                        break;
+                    }
+                    raw = tmp;
+                    raw_size = payload_size;
+                }
+                oskar_binary_read_block(h, chunk_index, payload_size,
+                        raw, status);
+                src = raw;
+            }
+            if (*status) break;
+
+            /* Decompress the chunk if required. */
+            if (compression != OSKAR_VIS_COMPRESSION_NONE)
+            {
+                oskar_decompress(src, payload_size, num_bytes / prec_size,
+                        (int) prec_size, dec, status);
+                src = dec;
+            }
+            else if (payload_size != num_bytes)
+                *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+            if (*status) break;
+
+            /* Scatter the chunk into the block. */
+            for (t = 0; t < num_times; ++t)
+            {
+                for (c = c0; c < c1; ++c, offset += row_bytes)
+                {
+                    memcpy(dst + elem_size * (b0 + num_baselines *
+                            ((size_t) c + num_channels * (size_t) t)),
+                            src + offset, row_bytes);
+                }
+            }
+        }
+    }
+    free(raw);
+    free(dec);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/private_vis_block.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_compress.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void write_chunks(oskar_Binary* h, const oskar_Mem* amp,
+        unsigned char tag, int block_index, int compression, int bits,
+        int num_times, int num_channels, int num_baselines,
+        int chunk_c, int chunk_b, int num_chunks_c, int num_chunks_b,
+        int* status);
+
+void oskar_vis_block_write_chunks(const oskar_VisBlock* vis,
+        const oskar_VisHeader* hdr, oskar_Binary* h, int block_index,
+        int* status)
+{
+    int num_times, num_channels, num_baselines, num_stations;
+    int chunk_c, chunk_b, num_chunks_c, num_chunks_b, compression, bits;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Write the block as a single array if not chunked. */
+    chunk_c = oskar_vis_header_chunk_channels(hdr);
+    if (chunk_c < 1)
+    {
+        oskar_vis_block_write(vis, h, block_index, status);
+        return;
+    }
+
+    /* Get the chunk dimensions. The number of chunks depends only on
+     * the header, so that the number of tags per block is constant. */
+    chunk_b = oskar_vis_header_chunk_baselines(hdr);
+    compression = oskar_vis_header_compression(hdr);
+    bits = oskar_vis_header_compression_bits(hdr);
+    num_stations = oskar_vis_header_num_stations(hdr);
+    num_chunks_c = (oskar_vis_header_max_channels_per_block(hdr) +
+            chunk_c - 1) / chunk_c;
+    num_chunks_b = (num_stations * (num_stations - 1) / 2 + chunk_b - 1) /
+            chunk_b;
+    num_times = oskar_vis_block_num_times(vis);
+    num_channels = oskar_vis_block_num_channels(vis);
+    num_baselines = oskar_vis_block_num_baselines(vis);
+
+    /* Write visibility metadata. */
+    oskar_binary_write(h, OSKAR_INT,
+            OSKAR_TAG_GROUP_VIS_BLOCK,
+            OSKAR_VIS_BLOCK_TAG_DIM_START_AND_SIZE, block_index,
+            sizeof(int) * 6, vis->dim_start_size, status);
+
+    /* Write the auto-correlation data, split by channel only. */
+    if (oskar_vis_header_write_auto_correlations(hdr))
+    {
+        write_chunks(h, vis->auto_correlations,
+                OSKAR_VIS_BLOCK_TAG_AUTO_CORRELATIONS_CHUNK, block_index,
+                compression, bits, num_times, num_channels,
+                oskar_vis_block_num_stations(vis), chunk_c,
+                oskar_vis_block_num_stations(vis), num_chunks_c, 1, status);
+    }
+
+    /* Write the cross-correlation data. */
+    if (oskar_vis_header_write_cross_correlations(hdr))
+    {
+        write_chunks(h, vis->cross_correlations,
+                OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS_CHUNK, block_index,
+                compression, bits, num_times, num_channels, num_baselines,
+                chunk_c, chunk_b, num_chunks_c, num_chunks_b, status);
+
+        /* Write the baseline coordinate data. */
+        oskar_binary_write_mem(h, vis->baseline_uu_metres,
+                OSKAR_TAG_GROUP_VIS_BLOCK,
+                OSKAR_VIS_BLOCK_TAG_BASELINE_UU, block_index, 0, status);
+        oskar_binary_write_mem(h, vis->baseline_vv_metres,
+                OSKAR_TAG_GROUP_VIS_BLOCK,
+                OSKAR_VIS_BLOCK_TAG_BASELINE_VV, block_index, 0, status);
+        oskar_binary_write_mem(h, vis->baseline_ww_metres,
+                OSKAR_TAG_GROUP_VIS_BLOCK,
+                OSKAR_VIS_BLOCK_TAG_BASELINE_WW, block_index, 0, status);
+    }
+}
+
+
+/*
+ * Writes one tag per chunk, with user index
+ * (block_index * num_chunks + chunk_index), where chunks are ordered
+ * by channel then baseline. Each chunk holds all times in the block.
+ * Chunks outside the block dimensions are written empty.
+ */
+static void write_chunks(oskar_Binary* h, const oskar_Mem* amp,
+        unsigned char tag, int block_index, int compression, int bits,
+        int num_times, int num_channels, int num_baselines,
+        int chunk_c, int chunk_b, int num_chunks_c, int num_chunks_b,
+        int* status)
+{
+    oskar_Mem* amp_cpu = 0;
+    const char* src;
+    char *buf = 0, *out = 0;
+    size_t elem_size, prec_size, max_bytes;
+    int ic, ib, type;
+    if (*status) return;
+
+    /* Copy amplitudes to the CPU if required. */
+    if (oskar_mem_location(amp) != OSKAR_CPU)
+    {
+        amp_cpu = oskar_mem_create_copy(amp, OSKAR_CPU, status);
+        amp = amp_cpu;
+    }
+    src = oskar_mem_char_const(amp);
+    type = oskar_mem_type(amp);
+    elem_size = oskar_mem_element_size(type);
+    prec_size = oskar_mem_element_size(oskar_type_precision(type));
+
+    /* Allocate scratch buffers for the largest chunk. */
+    max_bytes = (size_t) num_times * chunk_c * chunk_b * elem_size;
+    buf = (char*) malloc(max_bytes > 0 ? max_bytes : 1);
+    if (compression != OSKAR_VIS_COMPRESSION_NONE)
+        out = (char*) malloc(oskar_compress_bound(max_bytes));
+    if (!buf || (compression != OSKAR_VIS_COMPRESSION_NONE && !out))
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+
+    for (ic = 0; ic < num_chunks_c; ++ic)
+    {
+        for (ib = 0; ib < num_chunks_b; ++ib)
+        {
+            int c, t, c0, c1, b0, b1, index;
+            size_t row_bytes, num_bytes = 0;
+            if (*status) break;
+            c0 = ic * chunk_c;
+            b0 = ib * chunk_b;
+            c1 = c0 + chunk_c < num_channels ? c0 + chunk_c : num_channels;
+            b1 = b0 + chunk_b < num_baselines ? b0 + chunk_b : num_baselines;
+            index = block_index * num_chunks_c * num_chunks_b +
+                    ic * num_chunks_b + ib;
+
+            /* Gather the chunk into contiguous memory. */
+            if (c1 > c0 && b1 > b0)
+            {
+                row_bytes = (b1 - b0) * elem_size;
+                for (t = 0; t < num_times; ++t)
+                {
+                    for (c = c0; c < c1; ++c, num_bytes += row_bytes)
+                    {
+                        memcpy(buf + num_bytes, src + elem_size * (b0 +
+                                num_baselines * ((size_t) c +
+                                        num_channels * (size_t) t)),
+                                row_bytes);
+                    }
+                }
+            }
+
+            /* Compress and write the chunk. */
+            if (compression != OSKAR_VIS_COMPRESSION_NONE)
+            {
+                const size_t out_bytes = oskar_compress(buf,
+                        num_bytes / prec_size, (int) prec_size, bits,
+                        out, status);
+                oskar_binary_write(h, OSKAR_CHAR, OSKAR_TAG_GROUP_VIS_BLOCK,
+                        tag, index, out_bytes, out, status);
+            }
+            else
+            {
+                oskar_binary_write(h, (unsigned char) type,
+                        OSKAR_TAG_GROUP_VIS_BLOCK, tag, index,
+                        num_bytes, buf, status);
+            }
+        }
+    }
+    free(buf);
+    free(out);
+    oskar_mem_free(amp_cpu, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2017, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,17 +39,25 @@ extern "C" {
 
 void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         const oskar_VisHeader* header, oskar_MeasurementSet* ms, int* status)
+{
+    oskar_vis_block_write_ms_channels(blk, header, ms, 0, status);
+}
+
+void oskar_vis_block_write_ms_channels(const oskar_VisBlock* blk,
+        const oskar_VisHeader* header, oskar_MeasurementSet* ms,
+        int ms_start_channel, int* status)
 {
     const oskar_Mem *in_acorr, *in_xcorr, *in_uu, *in_vv, *in_ww;
-    oskar_Mem *temp_vis = 0, *temp_uu = 0, *temp_vv = 0, *temp_ww = 0;
     double exposure_sec, interval_sec, t_start_mjd, t_start_sec;
     double ra_rad, dec_rad, freq_start_hz;
     unsigned int a1, a2, num_baseln_in, num_baseln_out, num_channels;
     unsigned int num_pols_in, num_pols_out, num_stations, num_times, b, c, t;
     unsigned int i, i_out, prec, start_time_index, start_chan_index;
+    unsigned int c_first, c_last, ms_chan_first, ms_chan_last;
     unsigned int have_autocorr, have_crosscorr;
+    size_t num_vis_out, stage_bytes;
     const void *xcorr, *acorr;
-    void* out;
+    void *stage, *out;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -75,13 +83,23 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
     exposure_sec     = oskar_vis_header_time_average_sec(header);
     interval_sec     = oskar_vis_header_time_inc_sec(header);
     t_start_mjd      = oskar_vis_header_time_start_mjd_utc(header);
-    freq_start_hz    = oskar_vis_header_freq_start_hz(header);
+    freq_start_hz    = oskar_vis_header_freq_start_hz(header) +
+            ms_start_channel * oskar_vis_header_freq_inc_hz(header);
     prec             = oskar_mem_precision(in_xcorr);
     t_start_sec      = t_start_mjd * 86400.0;
 
     /* Check that there is something to write. */
     if (!have_autocorr && !have_crosscorr) return;
 
+    /* Get the range of block channels inside the Measurement Set. */
+    ms_chan_first = (unsigned int) ms_start_channel;
+    ms_chan_last = ms_chan_first + oskar_ms_num_channels(ms);
+    c_first = (start_chan_index < ms_chan_first) ?
+            ms_chan_first - start_chan_index : 0;
+    c_last = (start_chan_index + num_channels > ms_chan_last) ?
+            ms_chan_last - start_chan_index : num_channels;
+    if (start_chan_index >= ms_chan_last || c_first >= c_last) return;
+
     /* Get number of output baselines. */
     num_baseln_out = num_baseln_in;
     if (have_autocorr)
@@ -118,15 +136,22 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         return;
     }
 
-    /* Add visibilities and u,v,w coordinates. */
-    temp_vis = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
-            num_baseln_out * num_channels * num_pols_out, status);
-    temp_uu = oskar_mem_create(prec, OSKAR_CPU, num_baseln_out, status);
-    temp_vv = oskar_mem_create(prec, OSKAR_CPU, num_baseln_out, status);
-    temp_ww = oskar_mem_create(prec, OSKAR_CPU, num_baseln_out, status);
+    /* Add visibilities and u,v,w coordinates.
+     * Use the staging buffer owned by the Measurement Set, so that it can be
+     * reused for every block, with the visibilities at the start followed
+     * by the u,v,w coordinates. */
+    num_vis_out = (size_t)num_baseln_out * (c_last - c_first) * num_pols_out;
+    stage_bytes = oskar_mem_element_size(prec) *
+            (2 * num_vis_out + 3 * num_baseln_out);
+    stage = oskar_ms_staging_buffer(ms, stage_bytes);
+    if (!stage)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
     xcorr   = oskar_mem_void_const(in_xcorr);
     acorr   = oskar_mem_void_const(in_acorr);
-    out     = oskar_mem_void(temp_vis);
+    out     = stage;
     if (prec == OSKAR_DOUBLE)
     {
         const double *uu_in, *vv_in, *ww_in;
@@ -134,9 +159,9 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         uu_in = oskar_mem_double_const(in_uu, status);
         vv_in = oskar_mem_double_const(in_vv, status);
         ww_in = oskar_mem_double_const(in_ww, status);
-        uu_out = oskar_mem_double(temp_uu, status);
-        vv_out = oskar_mem_double(temp_vv, status);
-        ww_out = oskar_mem_double(temp_ww, status);
+        uu_out = (double*)stage + 2 * num_vis_out;
+        vv_out = uu_out + num_baseln_out;
+        ww_out = vv_out + num_baseln_out;
         for (t = 0; t < num_times; ++t)
         {
             /* Construct the baseline coordinates for the given time. */
@@ -162,7 +187,7 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
                 }
             }
 
-            for (c = 0, i_out = 0; c < num_channels; ++c)
+            for (c = c_first, i_out = 0; c < c_last; ++c)
             {
                 /* Construct amplitude data for the given time and channel. */
                 if (num_pols_in == 4)
@@ -246,8 +271,9 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
             oskar_ms_write_coords_d(ms, start_row, num_baseln_out,
                     uu_out, vv_out, ww_out, exposure_sec, interval_sec,
                     (start_time_index + t + 0.5) * interval_sec + t_start_sec);
-            oskar_ms_write_vis_d(ms, start_row, start_chan_index,
-                    num_channels, num_baseln_out, (const double*)out);
+            oskar_ms_write_vis_d(ms, start_row,
+                    start_chan_index + c_first - ms_chan_first,
+                    c_last - c_first, num_baseln_out, (const double*)out);
         }
     }
     else if (prec == OSKAR_SINGLE)
@@ -257,9 +283,9 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         uu_in = oskar_mem_float_const(in_uu, status);
         vv_in = oskar_mem_float_const(in_vv, status);
         ww_in = oskar_mem_float_const(in_ww, status);
-        uu_out = oskar_mem_float(temp_uu, status);
-        vv_out = oskar_mem_float(temp_vv, status);
-        ww_out = oskar_mem_float(temp_ww, status);
+        uu_out = (float*)stage + 2 * num_vis_out;
+        vv_out = uu_out + num_baseln_out;
+        ww_out = vv_out + num_baseln_out;
         for (t = 0; t < num_times; ++t)
         {
             /* Construct the baseline coordinates for the given time. */
@@ -285,7 +311,7 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
                 }
             }
 
-            for (c = 0, i_out = 0; c < num_channels; ++c)
+            for (c = c_first, i_out = 0; c < c_last; ++c)
             {
                 /* Construct amplitude data for the given time and channel. */
                 if (num_pols_in == 4)
@@ -369,20 +395,15 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
             oskar_ms_write_coords_f(ms, start_row, num_baseln_out,
                     uu_out, vv_out, ww_out, exposure_sec, interval_sec,
                     (start_time_index + t + 0.5) * interval_sec + t_start_sec);
-            oskar_ms_write_vis_f(ms, start_row, start_chan_index,
-                    num_channels, num_baseln_out, (const float*)out);
+            oskar_ms_write_vis_f(ms, start_row,
+                    start_chan_index + c_first - ms_chan_first,
+                    c_last - c_first, num_baseln_out, (const float*)out);
         }
     }
     else
     {
         *status = OSKAR_ERR_BAD_DATA_TYPE;
     }
-
-    /* Cleanup. */
-    oskar_mem_free(temp_vis, status);
-    oskar_mem_free(temp_uu, status);
-    oskar_mem_free(temp_vv, status);
-    oskar_mem_free(temp_ww, status);
 }
 
 #ifdef __cplusplus
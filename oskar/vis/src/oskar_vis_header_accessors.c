@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -109,6 +109,26 @@ int oskar_vis_header_pol_type(const oskar_VisHeader* vis)
     return vis->pol_type;
 }
 
+int oskar_vis_header_chunk_channels(const oskar_VisHeader* vis)
+{
+    return vis->chunk_channels;
+}
+
+int oskar_vis_header_chunk_baselines(const oskar_VisHeader* vis)
+{
+    return vis->chunk_baselines;
+}
+
+int oskar_vis_header_compression(const oskar_VisHeader* vis)
+{
+    return vis->compression;
+}
+
+int oskar_vis_header_compression_bits(const oskar_VisHeader* vis)
+{
+    return vis->compression_bits;
+}
+
 int oskar_vis_header_phase_centre_coord_type(const oskar_VisHeader* vis)
 {
     return vis->phase_centre_type;
@@ -279,6 +299,58 @@ void oskar_vis_header_set_pol_type(oskar_VisHeader* vis, int value,
     }
 }
 
+void oskar_vis_header_set_chunking(oskar_VisHeader* vis, int compression,
+        int mantissa_bits, int channels_per_chunk, int baselines_per_chunk,
+        int* status)
+{
+    int num_baselines, num_chunks_c, num_chunks_b;
+    if (*status) return;
+    if (compression != OSKAR_VIS_COMPRESSION_NONE &&
+            compression != OSKAR_VIS_COMPRESSION_BITSHUFFLE_RLE)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    vis->compression = compression;
+    vis->compression_bits = (compression == OSKAR_VIS_COMPRESSION_NONE ||
+            mantissa_bits < 0) ? 0 : mantissa_bits;
+
+    /* Revert to a single array per block if chunks are not needed. */
+    if (channels_per_chunk < 1 && compression == OSKAR_VIS_COMPRESSION_NONE)
+    {
+        vis->chunk_channels = 0;
+        vis->chunk_baselines = 0;
+        vis->num_tags_per_block = 1;
+        if (vis->write_crosscorr) vis->num_tags_per_block += 4;
+        if (vis->write_autocorr) vis->num_tags_per_block += 1;
+        return;
+    }
+
+    /* Clamp chunk sizes to the block dimensions. */
+    num_baselines = vis->num_stations * (vis->num_stations - 1) / 2;
+    if (channels_per_chunk < 1 ||
+            channels_per_chunk > vis->max_channels_per_block)
+        channels_per_chunk = vis->max_channels_per_block;
+    if (baselines_per_chunk < 1 || baselines_per_chunk > num_baselines)
+        baselines_per_chunk = num_baselines;
+    if (channels_per_chunk < 1) channels_per_chunk = 1;
+    if (baselines_per_chunk < 1) baselines_per_chunk = 1;
+    vis->chunk_channels = channels_per_chunk;
+    vis->chunk_baselines = baselines_per_chunk;
+
+    /* Update the number of tags per block: one per chunk, plus the
+     * dimensions and the baseline coordinates. */
+    num_chunks_c = (vis->max_channels_per_block + channels_per_chunk - 1) /
+            channels_per_chunk;
+    num_chunks_b = (num_baselines + baselines_per_chunk - 1) /
+            baselines_per_chunk;
+    vis->num_tags_per_block = 1;
+    if (vis->write_crosscorr)
+        vis->num_tags_per_block += num_chunks_c * num_chunks_b + 3;
+    if (vis->write_autocorr)
+        vis->num_tags_per_block += num_chunks_c;
+}
+
 #ifdef __cplusplus
 }
 #endif
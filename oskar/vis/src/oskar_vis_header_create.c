@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -75,6 +75,12 @@ oskar_VisHeader* oskar_vis_header_create(int amp_type, int coord_precision,
     hdr->num_channels_total     = num_channels_total;
     hdr->num_stations           = num_stations;
 
+    /* Write each block of amplitudes as a single array by default. */
+    hdr->chunk_channels   = 0;
+    hdr->chunk_baselines  = 0;
+    hdr->compression      = OSKAR_VIS_COMPRESSION_NONE;
+    hdr->compression_bits = 0;
+
     /* Set default polarisation type. */
     if (oskar_type_is_matrix(amp_type))
         hdr->pol_type = OSKAR_VIS_POL_TYPE_LINEAR_XX_XY_YX_YY;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -50,6 +50,11 @@ oskar_VisHeader* oskar_vis_header_create_copy(const oskar_VisHeader* other,
 
     /* Copy meta-data. */
     hdr->pol_type = other->pol_type;
+    hdr->num_tags_per_block = other->num_tags_per_block;
+    hdr->chunk_channels = other->chunk_channels;
+    hdr->chunk_baselines = other->chunk_baselines;
+    hdr->compression = other->compression;
+    hdr->compression_bits = other->compression_bits;
     hdr->freq_start_hz = other->freq_start_hz;
     hdr->freq_inc_hz = other->freq_inc_hz;
     hdr->channel_bandwidth_hz = other->channel_bandwidth_hz;
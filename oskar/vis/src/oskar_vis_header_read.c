@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,6 +43,7 @@ oskar_VisHeader* oskar_vis_header_read(oskar_Binary* h, int* status)
     int max_channels_per_block = 0, max_times_per_block = 0, tag_error = 0;
     int amp_type = 0, coord_precision = 0;
     int write_crosscorr = 0, write_autocorr = 0;
+    int chunk_size[2] = {0, 0}, compression[2] = {0, 0};
     unsigned char grp = OSKAR_TAG_GROUP_VIS_HEADER;
     oskar_VisHeader* vis = 0;
 
@@ -85,6 +86,23 @@ oskar_VisHeader* oskar_vis_header_read(oskar_Binary* h, int* status)
     oskar_binary_read_int(h, grp, OSKAR_VIS_HEADER_TAG_NUM_TAGS_PER_BLOCK, 0,
             &vis->num_tags_per_block, status);
 
+    /* Optionally read the amplitude storage layout (ignore the error code).
+     * Amplitudes are not chunked if these tags are not present. */
+    tag_error = 0;
+    oskar_binary_read(h, OSKAR_INT, grp,
+            OSKAR_VIS_HEADER_TAG_AMP_CHUNK_SIZE, 0,
+            sizeof(chunk_size), chunk_size, &tag_error);
+    if (!tag_error)
+    {
+        oskar_binary_read(h, OSKAR_INT, grp,
+                OSKAR_VIS_HEADER_TAG_AMP_COMPRESSION, 0,
+                sizeof(compression), compression, status);
+        vis->chunk_channels = chunk_size[0];
+        vis->chunk_baselines = chunk_size[1];
+        vis->compression = compression[0];
+        vis->compression_bits = compression[1];
+    }
+
     /* Optionally read the settings data (ignore the error code). */
     tag_error = 0;
     oskar_binary_read_mem(h, vis->settings,
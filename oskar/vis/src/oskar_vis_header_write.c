@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -146,6 +146,27 @@ oskar_Binary* oskar_vis_header_write(const oskar_VisHeader* hdr,
     oskar_binary_write_mem(h, hdr->station_z_offset_ecef_metres, grp,
             OSKAR_VIS_HEADER_TAG_STATION_Z_OFFSET_ECEF, 0, 0, status);
 
+    /* Write the amplitude storage layout, if chunked. */
+    if (hdr->chunk_channels > 0)
+    {
+        int values[2];
+        values[0] = hdr->chunk_channels;
+        values[1] = hdr->chunk_baselines;
+        oskar_binary_write(h, OSKAR_INT, grp,
+                OSKAR_VIS_HEADER_TAG_AMP_CHUNK_SIZE, 0,
+                sizeof(values), values, status);
+        values[0] = hdr->compression;
+        values[1] = hdr->compression_bits;
+        oskar_binary_write(h, OSKAR_INT, grp,
+                OSKAR_VIS_HEADER_TAG_AMP_COMPRESSION, 0,
+                sizeof(values), values, status);
+    }
+
+    /* Align the payloads of the visibility blocks that follow,
+     * so that they can be used in place from a memory-mapped file. */
+    oskar_binary_write_padding(h, grp,
+            OSKAR_VIS_HEADER_TAG_PADDING, (int) sizeof(double), status);
+
     return h;
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2017, The University of Oxford
+ * Copyright (c) 2015-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,11 +42,21 @@ extern "C" {
 
 oskar_MeasurementSet* oskar_vis_header_write_ms(const oskar_VisHeader* hdr,
         const char* ms_path, int overwrite, int force_polarised, int* status)
+{
+    return oskar_vis_header_write_ms_channels(hdr, ms_path, overwrite,
+            force_polarised, 0, oskar_vis_header_num_channels_total(hdr),
+            status);
+}
+
+oskar_MeasurementSet* oskar_vis_header_write_ms_channels(
+        const oskar_VisHeader* hdr, const char* ms_path, int overwrite,
+        int force_polarised, int start_channel, int num_channels,
+        int* status)
 {
     const oskar_Mem *x_metres, *y_metres, *z_metres;
     double freq_start_hz, freq_inc_hz, ra_rad, dec_rad;
     int amp_type, autocorr, crosscorr, dir_exists, len;
-    unsigned int num_stations, num_pols, num_channels;
+    unsigned int num_baselines, num_stations, num_pols;
     char *output_path = 0;
     oskar_MeasurementSet* ms = 0;
 
@@ -56,11 +66,11 @@ oskar_MeasurementSet* oskar_vis_header_write_ms(const oskar_VisHeader* hdr,
     /* Pull data from visibility structure. */
     amp_type      = oskar_vis_header_amp_type(hdr);
     num_stations  = oskar_vis_header_num_stations(hdr);
-    num_channels  = oskar_vis_header_num_channels_total(hdr);
     ra_rad        = oskar_vis_header_phase_centre_ra_deg(hdr) * M_PI / 180.0;
     dec_rad       = oskar_vis_header_phase_centre_dec_deg(hdr) * M_PI / 180.0;
-    freq_start_hz = oskar_vis_header_freq_start_hz(hdr);
     freq_inc_hz   = oskar_vis_header_freq_inc_hz(hdr);
+    freq_start_hz = oskar_vis_header_freq_start_hz(hdr) +
+            start_channel * freq_inc_hz;
     x_metres      = oskar_vis_header_station_x_offset_ecef_metres_const(hdr);
     y_metres      = oskar_vis_header_station_y_offset_ecef_metres_const(hdr);
     z_metres      = oskar_vis_header_station_z_offset_ecef_metres_const(hdr);
@@ -129,6 +139,16 @@ oskar_MeasurementSet* oskar_vis_header_write_ms(const oskar_VisHeader* hdr,
         oskar_ms_add_history(ms, "OSKAR_SETTINGS",
                 oskar_mem_char_const(oskar_vis_header_settings_const(hdr)),
                 oskar_mem_length(oskar_vis_header_settings_const(hdr)));
+
+        /* Add all the rows now, so the main table is not extended block
+         * by block as the data are written. */
+        num_baselines = 0;
+        if (crosscorr)
+            num_baselines += num_stations * (num_stations - 1) / 2;
+        if (autocorr)
+            num_baselines += num_stations;
+        oskar_ms_ensure_num_rows(ms, num_baselines *
+                (unsigned int) oskar_vis_header_num_times_total(hdr));
     }
 
     /* If directory already exists and we're not overwriting, open it. */
@@ -144,7 +164,7 @@ oskar_MeasurementSet* oskar_vis_header_write_ms(const oskar_VisHeader* hdr,
         }
 
         /* Check the dimensions match. */
-        if (oskar_ms_num_channels(ms) != num_channels ||
+        if (oskar_ms_num_channels(ms) != (unsigned int)num_channels ||
                 oskar_ms_num_pols(ms) != num_pols ||
                 oskar_ms_num_stations(ms) != num_stations)
         {
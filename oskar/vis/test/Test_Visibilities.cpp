@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -29,6 +29,8 @@
 #include <gtest/gtest.h>
 
 #include "vis/oskar_vis.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
 #include "utility/oskar_get_error_string.h"
 
 #include <cstring>
@@ -293,3 +295,214 @@ TEST(Visibilities, read_write)
     // Delete temporary file.
     remove(filename);
 }
+
+TEST(Visibilities, read_mapped)
+{
+    int status = 0;
+    int num_channels = 3, num_times = 11, num_stations = 9;
+    int amp_type = OSKAR_SINGLE | OSKAR_COMPLEX | OSKAR_MATRIX;
+    const char* filename = "vis_temp_mapped.dat";
+
+    // Write some random visibilities to file.
+    oskar_Vis* vis1 = oskar_vis_create(amp_type, OSKAR_CPU,
+            num_channels, num_times, num_stations, &status);
+    oskar_mem_random_range(oskar_vis_amplitude(vis1), -1.0, 1.0, &status);
+    oskar_mem_random_range(oskar_vis_baseline_uu_metres(vis1), -1.0, 1.0,
+            &status);
+    oskar_mem_random_range(oskar_vis_baseline_vv_metres(vis1), -1.0, 1.0,
+            &status);
+    oskar_mem_random_range(oskar_vis_baseline_ww_metres(vis1), -1.0, 1.0,
+            &status);
+    oskar_vis_write(vis1, NULL, filename, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Read it back from a memory-mapped file, and check it is the same.
+    oskar_Binary* h = oskar_binary_create(filename, 'm', &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(oskar_binary_is_mapped(h));
+    oskar_Vis* vis2 = oskar_vis_read(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_FALSE(oskar_mem_different(oskar_vis_amplitude(vis1),
+            oskar_vis_amplitude(vis2), 0, &status));
+    EXPECT_FALSE(oskar_mem_different(oskar_vis_baseline_ww_metres(vis1),
+            oskar_vis_baseline_ww_metres(vis2), 0, &status));
+
+    // Check the block data are aliased, as they cannot be resized.
+    oskar_binary_set_query_search_start(h, 0, &status);
+    oskar_VisHeader* hdr = oskar_vis_header_read(h, &status);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    oskar_vis_block_read(blk, hdr, h, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_mem_realloc(oskar_vis_block_cross_correlations(blk), 1, &status);
+    EXPECT_EQ((int) OSKAR_ERR_MEMORY_NOT_ALLOCATED, status);
+    status = 0;
+
+    // Check CRC codes.
+    oskar_binary_verify(h, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Free memory.
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_binary_free(h);
+    oskar_vis_free(vis1, &status);
+    oskar_vis_free(vis2, &status);
+    remove(filename);
+}
+
+TEST(Visibilities, read_mapped_corrupt)
+{
+    int status = 0, i_block, num_blocks;
+    int num_channels = 3, num_times = 11, num_stations = 9;
+    int amp_type = OSKAR_SINGLE | OSKAR_COMPLEX | OSKAR_MATRIX;
+    const char* filename = "vis_temp_mapped_corrupt.dat";
+
+    // Write some random visibilities to file.
+    oskar_Vis* vis1 = oskar_vis_create(amp_type, OSKAR_CPU,
+            num_channels, num_times, num_stations, &status);
+    oskar_mem_random_range(oskar_vis_amplitude(vis1), -1.0, 1.0, &status);
+    oskar_vis_write(vis1, NULL, filename, &status);
+    oskar_vis_free(vis1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Corrupt the last byte of the last payload, before its CRC code.
+    FILE* f = fopen(filename, "r+b");
+    ASSERT_TRUE(f != NULL);
+    fseek(f, -5, SEEK_END);
+    int c = fgetc(f);
+    fseek(f, -5, SEEK_END);
+    fputc(c ^ 0xFF, f);
+    fclose(f);
+
+    // Check that reading the blocks from the mapped file fails the CRC check.
+    oskar_Binary* h = oskar_binary_create(filename, 'm', &status);
+    ASSERT_TRUE(oskar_binary_is_mapped(h));
+    oskar_VisHeader* hdr = oskar_vis_header_read(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    num_blocks = (oskar_vis_header_num_times_total(hdr) +
+            oskar_vis_header_max_times_per_block(hdr) - 1) /
+            oskar_vis_header_max_times_per_block(hdr);
+    for (i_block = 0; i_block < num_blocks && !status; ++i_block)
+        oskar_vis_block_read(blk, hdr, h, i_block, &status);
+    EXPECT_EQ((int) OSKAR_ERR_BINARY_CRC_FAIL, status);
+    status = 0;
+
+    // Free memory.
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_binary_free(h);
+    remove(filename);
+}
+
+TEST(Visibilities, read_write_chunked)
+{
+    int status = 0;
+    int max_times = 4, num_times_total = 7, num_channels = 5;
+    int num_stations = 6, num_baselines = num_stations * (num_stations - 1) / 2;
+    int amp_type = OSKAR_SINGLE | OSKAR_COMPLEX | OSKAR_MATRIX;
+    const char* filename = "vis_temp_chunked.dat";
+
+    // Create a header with compressed chunks of 2 channels and 4 baselines.
+    oskar_VisHeader* hdr = oskar_vis_header_create(amp_type, OSKAR_DOUBLE,
+            max_times, num_times_total, num_channels, num_channels,
+            num_stations, 1, 1, &status);
+    oskar_vis_header_set_chunking(hdr, OSKAR_VIS_COMPRESSION_BITSHUFFLE_RLE,
+            0, 2, 4, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(1 + 3 + (3 * 4 + 3),
+            oskar_vis_header_num_tags_per_block(hdr));
+
+    // Write two blocks of random data, the last one partly filled.
+    oskar_VisBlock* blk[2];
+    oskar_Binary* h = oskar_vis_header_write(hdr, filename, &status);
+    for (int b = 0; b < 2; ++b)
+    {
+        blk[b] = oskar_vis_block_create_from_header(OSKAR_CPU, hdr, &status);
+        oskar_vis_block_set_num_times(blk[b],
+                b == 0 ? max_times : num_times_total - max_times, &status);
+        oskar_vis_block_set_start_time_index(blk[b], b * max_times);
+        oskar_mem_random_range(oskar_vis_block_cross_correlations(blk[b]),
+                -1.0, 1.0, &status);
+        oskar_mem_random_range(oskar_vis_block_auto_correlations(blk[b]),
+                -1.0, 1.0, &status);
+        oskar_mem_random_range(oskar_vis_block_baseline_uu_metres(blk[b]),
+                -1.0, 1.0, &status);
+        oskar_vis_block_write_chunks(blk[b], hdr, h, b, &status);
+    }
+    oskar_binary_free(h);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Read it back, both normally and memory-mapped.
+    const char modes[] = {'r', 'm'};
+    for (int m = 0; m < 2; ++m)
+    {
+        h = oskar_binary_create(filename, modes[m], &status);
+        oskar_VisHeader* hdr2 = oskar_vis_header_read(h, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(2, oskar_vis_header_chunk_channels(hdr2));
+        EXPECT_EQ(4, oskar_vis_header_chunk_baselines(hdr2));
+        EXPECT_EQ((int) OSKAR_VIS_COMPRESSION_BITSHUFFLE_RLE,
+                oskar_vis_header_compression(hdr2));
+
+        // Check complete blocks, read in reverse order.
+        oskar_VisBlock* blk2 = oskar_vis_block_create_from_header(OSKAR_CPU,
+                hdr2, &status);
+        for (int b = 1; b >= 0; --b)
+        {
+            oskar_vis_block_read(blk2, hdr2, h, b, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+            ASSERT_EQ(oskar_vis_block_num_times(blk[b]),
+                    oskar_vis_block_num_times(blk2));
+            EXPECT_FALSE(oskar_mem_different(
+                    oskar_vis_block_cross_correlations(blk[b]),
+                    oskar_vis_block_cross_correlations(blk2),
+                    num_baselines * num_channels *
+                    oskar_vis_block_num_times(blk2), &status));
+            EXPECT_FALSE(oskar_mem_different(
+                    oskar_vis_block_auto_correlations(blk[b]),
+                    oskar_vis_block_auto_correlations(blk2),
+                    num_stations * num_channels *
+                    oskar_vis_block_num_times(blk2), &status));
+            EXPECT_FALSE(oskar_mem_different(
+                    oskar_vis_block_baseline_uu_metres(blk[b]),
+                    oskar_vis_block_baseline_uu_metres(blk2),
+                    num_baselines * oskar_vis_block_num_times(blk2),
+                    &status));
+        }
+        oskar_vis_block_free(blk2, &status);
+
+        // Check a single channel can be read on its own,
+        // and that channels in other chunks are cleared.
+        const int c = 3;
+        blk2 = oskar_vis_block_create_from_header(OSKAR_CPU, hdr2, &status);
+        oskar_vis_block_read(blk2, hdr2, h, 1, &status);
+        oskar_vis_block_read_channels(blk2, hdr2, h, 0, c, c, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const size_t row_bytes = num_baselines * sizeof(float4c);
+        const float4c* v1 = oskar_mem_float4c_const(
+                oskar_vis_block_cross_correlations_const(blk[0]), &status);
+        const float4c* v2 = oskar_mem_float4c_const(
+                oskar_vis_block_cross_correlations_const(blk2), &status);
+        for (int t = 0; t < max_times; ++t)
+        {
+            const size_t i = (t * num_channels + c) * num_baselines;
+            EXPECT_EQ(0, memcmp(v1 + i, v2 + i, row_bytes));
+            const size_t j = t * num_channels * num_baselines;
+            for (size_t k = 0; k < 2 * (size_t) num_baselines; ++k)
+                EXPECT_EQ(0.0f, v2[j + k].a.x);
+        }
+        oskar_vis_block_free(blk2, &status);
+        oskar_vis_header_free(hdr2, &status);
+        oskar_binary_free(h);
+    }
+
+    // Free memory.
+    oskar_vis_block_free(blk[0], &status);
+    oskar_vis_block_free(blk[1], &status);
+    oskar_vis_header_free(hdr, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    remove(filename);
+}
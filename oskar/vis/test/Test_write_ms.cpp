@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015, The University of Oxford
+ * Copyright (c) 2011-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -38,6 +38,7 @@
 #include "math/oskar_cmath.h"
 
 #include <cstdio>
+#include <vector>
 
 TEST(write_ms, test_write)
 {
@@ -221,3 +222,74 @@ TEST(write_ms, test_write_partial)
     oskar_dir_remove(filename);
 }
 
+
+
+TEST(write_ms, test_write_channel_ranges)
+{
+    int status = 0;
+    int num_antennas  = 4;
+    int num_channels  = 5;
+    int num_times     = 2;
+    int num_pols      = 4;
+    int num_baselines = num_antennas * (num_antennas - 1) / 2;
+    int range_start[] = {0, 2};
+    int range_size[]  = {2, 3};
+
+    // Create a visibility block and fill in some data.
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_DOUBLE, num_times, num_times, num_channels,
+            num_channels, num_antennas, 0, 1, &status);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    oskar_vis_block_set_num_times(blk, num_times, &status);
+    double* v_ = oskar_mem_double(
+            oskar_vis_block_cross_correlations(blk), &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    int num_values = 2 * num_pols * num_baselines * num_channels * num_times;
+    for (int i = 0; i < num_values; ++i) v_[i] = (double)i;
+    oskar_vis_header_set_phase_centre(hdr, 0, 160.0, 89.0);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_time_inc_sec(hdr, 1.0);
+
+    // Write each channel range to its own Measurement Set, and read it back.
+    for (int r = 0; r < 2; ++r)
+    {
+        char filename[64];
+        sprintf(filename, "temp_test_write_ms_range%d.ms", r);
+        oskar_MeasurementSet* ms = oskar_vis_header_write_ms_channels(hdr,
+                filename, OSKAR_TRUE, OSKAR_FALSE,
+                range_start[r], range_size[r], &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ((unsigned int)range_size[r], oskar_ms_num_channels(ms));
+        ASSERT_DOUBLE_EQ(100e6 + range_start[r] * 1e6,
+                oskar_ms_freq_start_hz(ms));
+        oskar_vis_block_write_ms_channels(blk, hdr, ms, range_start[r],
+                &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int t = 0; t < num_times; ++t)
+        {
+            std::vector<double> vis(2 * num_pols * num_baselines *
+                    range_size[r]);
+            oskar_ms_read_vis_d(ms, t * num_baselines, 0, range_size[r],
+                    num_baselines, "DATA", &vis[0], &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+            for (int c = 0, i = 0; c < range_size[r]; ++c)
+            {
+                int c_in = t * num_channels + range_start[r] + c;
+                for (int j = 0; j < 2 * num_pols * num_baselines; ++j, ++i)
+                {
+                    ASSERT_FLOAT_EQ((float)v_[c_in * 2 * num_pols *
+                            num_baselines + j], (float)vis[i]);
+                }
+            }
+        }
+        oskar_ms_close(ms);
+        oskar_dir_remove(filename);
+    }
+
+    // Clean up.
+    oskar_vis_header_free(hdr, &status);
+    oskar_vis_block_free(blk, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -1,6 +1,6 @@
 # -*- coding: utf-8 -*-
 #
-# Copyright (c) 2016, The University of Oxford
+# Copyright (c) 2016-2018, The University of Oxford
 # All rights reserved.
 #
 #  This file is part of the OSKAR package.
@@ -58,6 +58,7 @@ class Sky(object):
         if _sky_lib is None:
             raise RuntimeError("OSKAR library not found.")
         self._capsule = None
+        self._index = None
         if precision is not None and settings is not None:
             raise RuntimeError("Specify either precision or all settings.")
         if precision is None:
@@ -75,6 +76,7 @@ class Sky(object):
             other (oskar.Sky): Another sky model.
         """
         self.capsule_ensure()
+        self._index = None
         _sky_lib.append(self._capsule, other.capsule)
 
     def append_sources(self, ra_deg, dec_deg, I, Q=None, U=None, V=None,
@@ -124,6 +126,7 @@ class Sky(object):
             minor_axis_arcsec = numpy.zeros_like(I)
         if position_angle_deg is None:
             position_angle_deg = numpy.zeros_like(I)
+        self._index = None
         _sky_lib.append_sources(
             self._capsule, numpy.radians(ra_deg), numpy.radians(dec_deg),
             I, Q, U, V, ref_freq_hz, spectral_index, rotation_measure,
@@ -138,6 +141,7 @@ class Sky(object):
             filename (str): Name of file to load.
         """
         self.capsule_ensure()
+        self._index = None
         _sky_lib.append_file(self._capsule, filename)
 
     def capsule_ensure(self):
@@ -145,6 +149,12 @@ class Sky(object):
         if self._capsule is None:
             self._capsule = _sky_lib.create(self._precision)
 
+    def _index_ensure(self):
+        """Ensures the spatial index of source positions exists."""
+        self.capsule_ensure()
+        if self._index is None:
+            self._index = _sky_lib.index_create(self._capsule)
+
     def capsule_get(self):
         """Returns the C capsule wrapped by the class."""
         return self._capsule
@@ -158,6 +168,7 @@ class Sky(object):
         if _sky_lib.capsule_name(new_capsule) == 'oskar_Sky':
             del self._capsule
             self._capsule = new_capsule
+            self._index = None
         else:
             raise RuntimeError("Capsule is not of type oskar_Sky.")
 
@@ -178,6 +189,7 @@ class Sky(object):
             max_flux_jy (float): Maximum allowed flux, in Jy.
         """
         self.capsule_ensure()
+        self._index = None
         _sky_lib.filter_by_flux(self._capsule, min_flux_jy, max_flux_jy)
 
     def filter_by_radius(self, inner_radius_deg, outer_radius_deg,
@@ -193,6 +205,7 @@ class Sky(object):
             dec0_deg (float): Declination of phase centre, in degrees.
         """
         self.capsule_ensure()
+        self._index = None
         _sky_lib.filter_by_radius(
             self._capsule, math.radians(inner_radius_deg),
             math.radians(outer_radius_deg),
@@ -333,6 +346,47 @@ class Sky(object):
         t.capsule = _sky_lib.load(filename, precision)
         return t
 
+    def query_nearest(self, ra_deg, dec_deg, k=1):
+        """Returns the sources nearest to a given position.
+
+        A spatial index of the source positions is created when first
+        needed, and re-used until the sky model is modified.
+
+        Args:
+            ra_deg (float): Right Ascension of the position, in degrees.
+            dec_deg (float): Declination of the position, in degrees.
+            k (Optional[int]): Number of sources to find. Default 1.
+
+        Returns:
+            tuple: Arrays of source indices and angular distances, in degrees,
+            sorted by increasing distance.
+        """
+        self._index_ensure()
+        indices, dist_rad = _sky_lib.index_query_nearest(
+            self._index, math.radians(ra_deg), math.radians(dec_deg), k)
+        return indices, numpy.degrees(dist_rad)
+
+    def query_radius(self, ra_deg, dec_deg, radius_deg):
+        """Returns the sources within a given radius of a position.
+
+        A spatial index of the source positions is created when first
+        needed, and re-used until the sky model is modified.
+
+        Args:
+            ra_deg (float): Right Ascension of the position, in degrees.
+            dec_deg (float): Declination of the position, in degrees.
+            radius_deg (float): Search radius, in degrees.
+
+        Returns:
+            tuple: Arrays of source indices, in increasing order, and
+            angular distances, in degrees.
+        """
+        self._index_ensure()
+        indices, dist_rad = _sky_lib.index_query_radius(
+            self._index, math.radians(ra_deg), math.radians(dec_deg),
+            math.radians(radius_deg))
+        return indices, numpy.degrees(dist_rad)
+
     def save(self, filename):
         """Saves data to a sky model text file.
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, The University of Oxford
+ * Copyright (c) 2016-2018, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -38,6 +38,7 @@
 static const char module_doc[] =
         "This module provides an interface to the OSKAR sky model.";
 static const char name[] = "oskar_Sky";
+static const char index_name[] = "oskar_SkyIndex";
 
 #define deg2rad 1.74532925199432957692369e-2
 #define arcsec2rad 4.84813681109535993589914e-6
@@ -66,6 +67,12 @@ static void sky_free(PyObject* capsule)
 }
 
 
+static void index_free(PyObject* capsule)
+{
+    oskar_sky_index_free((oskar_SkyIndex*) get_handle(capsule, index_name));
+}
+
+
 static int numpy_type_from_oskar(int type)
 {
     switch (type)
@@ -580,6 +587,109 @@ static PyObject* generate_random_power_law(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* index_create(PyObject* self, PyObject* args)
+{
+    oskar_Sky *h = 0;
+    oskar_SkyIndex *t = 0;
+    PyObject* capsule = 0;
+    int status = 0;
+    if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
+    if (!(h = (oskar_Sky*) get_handle(capsule, name))) return 0;
+
+    /* Create the spatial index. */
+    t = oskar_sky_index_create(h, &status);
+
+    /* Check for errors. */
+    if (status || !t)
+    {
+        PyErr_Format(PyExc_RuntimeError,
+                "oskar_sky_index_create() failed with code %d (%s).",
+                status, oskar_get_error_string(status));
+        oskar_sky_index_free(t);
+        return 0;
+    }
+
+    capsule = PyCapsule_New((void*)t, index_name,
+            (PyCapsule_Destructor)index_free);
+    return Py_BuildValue("N", capsule); /* Don't increment refcount. */
+}
+
+
+static PyObject* index_results(const char* func, int num,
+        oskar_Mem* indices, oskar_Mem* dist_rad, int* status)
+{
+    PyArrayObject *array1 = 0, *array2 = 0;
+    npy_intp dims = num;
+
+    /* Check for errors. */
+    if (*status)
+    {
+        PyErr_Format(PyExc_RuntimeError, "%s() failed with code %d (%s).",
+                func, *status, oskar_get_error_string(*status));
+        oskar_mem_free(indices, status);
+        oskar_mem_free(dist_rad, status);
+        return 0;
+    }
+
+    /* Copy the results into new arrays. */
+    array1 = (PyArrayObject*)PyArray_SimpleNew(1, &dims, NPY_INT);
+    array2 = (PyArrayObject*)PyArray_SimpleNew(1, &dims, NPY_DOUBLE);
+    if (num > 0)
+    {
+        memcpy(PyArray_DATA(array1), oskar_mem_void(indices),
+                num * sizeof(int));
+        memcpy(PyArray_DATA(array2), oskar_mem_void(dist_rad),
+                num * sizeof(double));
+    }
+    oskar_mem_free(indices, status);
+    oskar_mem_free(dist_rad, status);
+    return Py_BuildValue("NN", array1, array2); /* Don't increment refcount. */
+}
+
+
+static PyObject* index_query_nearest(PyObject* self, PyObject* args)
+{
+    oskar_SkyIndex *h = 0;
+    oskar_Mem *indices, *dist_rad;
+    PyObject* capsule = 0;
+    int k = 0, num = 0, status = 0;
+    double ra_rad = 0.0, dec_rad = 0.0;
+    if (!PyArg_ParseTuple(args, "Oddi", &capsule, &ra_rad, &dec_rad, &k))
+        return 0;
+    if (!(h = (oskar_SkyIndex*) get_handle(capsule, index_name))) return 0;
+
+    /* Find the nearest sources. */
+    indices = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    dist_rad = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    num = oskar_sky_index_query_nearest(h, ra_rad, dec_rad, k,
+            indices, dist_rad, &status);
+    return index_results("oskar_sky_index_query_nearest", num,
+            indices, dist_rad, &status);
+}
+
+
+static PyObject* index_query_radius(PyObject* self, PyObject* args)
+{
+    oskar_SkyIndex *h = 0;
+    oskar_Mem *indices, *dist_rad;
+    PyObject* capsule = 0;
+    int num = 0, status = 0;
+    double ra_rad = 0.0, dec_rad = 0.0, radius_rad = 0.0;
+    if (!PyArg_ParseTuple(args, "Oddd", &capsule,
+            &ra_rad, &dec_rad, &radius_rad))
+        return 0;
+    if (!(h = (oskar_SkyIndex*) get_handle(capsule, index_name))) return 0;
+
+    /* Find the sources within the radius. */
+    indices = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    dist_rad = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    num = oskar_sky_index_query_radius(h, ra_rad, dec_rad, radius_rad,
+            indices, dist_rad, &status);
+    return index_results("oskar_sky_index_query_radius", num,
+            indices, dist_rad, &status);
+}
+
+
 static PyObject* load(PyObject* self, PyObject* args)
 {
     oskar_Sky* h = 0;
@@ -723,6 +833,12 @@ static PyMethodDef methods[] =
         {"generate_random_power_law", (PyCFunction)generate_random_power_law,
                 METH_VARARGS, "generate_random_power_law(num_sources, "
                 "min_flux_jy, max_flux_jy, power, seed, precision)"},
+        {"index_create", (PyCFunction)index_create,
+                METH_VARARGS, "index_create(sky)"},
+        {"index_query_nearest", (PyCFunction)index_query_nearest,
+                METH_VARARGS, "index_query_nearest(index, ra, dec, k)"},
+        {"index_query_radius", (PyCFunction)index_query_radius,
+                METH_VARARGS, "index_query_radius(index, ra, dec, radius)"},
         {"load", (PyCFunction)load, METH_VARARGS, "load(filename, precision)"},
         {"num_sources", (PyCFunction)num_sources,
                 METH_VARARGS, "num_sources()"},